@@ -12,13 +12,19 @@
 #include "esp_err.h"
 #include "esp_check.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_lcd_touch.h"
+#include "esp_lcd_touch_filter.h"
+#include "esp_lcd_touch_gesture.h"
 
 static const char *TAG = "TP";
 
 /*******************************************************************************
 * Function definitions
 *******************************************************************************/
+static void touch_sw_adjust(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint8_t point_num);
+static bool touch_get_track_ids(esp_lcd_touch_handle_t tp, uint8_t *track_id, uint8_t point_num);
+static void touch_feed_gesture(esp_lcd_touch_handle_t tp);
 
 /*******************************************************************************
 * Local variables
@@ -52,10 +58,19 @@ esp_err_t esp_lcd_touch_exit_sleep(esp_lcd_touch_handle_t tp)
 
 esp_err_t esp_lcd_touch_read_data(esp_lcd_touch_handle_t tp)
 {
+    esp_err_t ret;
+
     assert(tp != NULL);
     assert(tp->read_data != NULL);
 
-    return tp->read_data(tp);
+    ret = tp->read_data(tp);
+
+    /* Gestures need every point, not only the ones requested by get_coordinates */
+    if (ret == ESP_OK && tp->gesture != NULL) {
+        touch_feed_gesture(tp);
+    }
+
+    return ret;
 }
 
 bool esp_lcd_touch_get_coordinates(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num)
@@ -77,30 +92,17 @@ bool esp_lcd_touch_get_coordinates(esp_lcd_touch_handle_t tp, uint16_t *x, uint1
         tp->config.process_coordinates(tp, x, y, strength, point_num, max_point_num);
     }
 
-    /* Software coordinates adjustment needed */
-    bool sw_adj_needed = ((tp->config.flags.mirror_x && (tp->set_mirror_x == NULL)) ||
-                          (tp->config.flags.mirror_y && (tp->set_mirror_y == NULL)) ||
-                          (tp->config.flags.swap_xy && (tp->set_swap_xy == NULL)));
-
-    /* Adjust all coordinates */
-    for (int i = 0; (sw_adj_needed && i < *point_num); i++) {
-
-        /*  Mirror X coordinates (if not supported by HW) */
-        if (tp->config.flags.mirror_x && tp->set_mirror_x == NULL) {
-            x[i] = tp->config.x_max - x[i];
-        }
-
-        /*  Mirror Y coordinates (if not supported by HW) */
-        if (tp->config.flags.mirror_y && tp->set_mirror_y == NULL) {
-            y[i] = tp->config.y_max - y[i];
-        }
-
-        /* Swap X and Y coordinates (if not supported by HW) */
-        if (tp->config.flags.swap_xy && tp->set_swap_xy == NULL) {
-            uint16_t tmp = x[i];
-            x[i] = y[i];
-            y[i] = tmp;
-        }
+    touch_sw_adjust(tp, x, y, *point_num);
+
+    /* Jitter filter and prediction on the final screen coordinates */
+    if (tp->filter != NULL) {
+        bool swapped = tp->config.flags.swap_xy;
+        uint8_t track_id[CONFIG_ESP_LCD_TOUCH_MAX_POINTS];
+        bool by_id = touch_get_track_ids(tp, track_id, *point_num);
+        esp_lcd_touch_filter_process(tp->filter, x, y, by_id ? track_id : NULL, *point_num,
+                                     swapped ? tp->config.y_max : tp->config.x_max,
+                                     swapped ? tp->config.x_max : tp->config.y_max,
+                                     esp_timer_get_time());
     }
 
     return touched;
@@ -256,3 +258,74 @@ esp_err_t esp_lcd_touch_register_interrupt_callback(esp_lcd_touch_handle_t tp, e
 
     return ESP_OK;
 }
+
+/*******************************************************************************
+* Private API function
+*******************************************************************************/
+
+static void touch_sw_adjust(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint8_t point_num)
+{
+    /* Software coordinates adjustment needed */
+    bool sw_adj_needed = ((tp->config.flags.mirror_x && (tp->set_mirror_x == NULL)) ||
+                          (tp->config.flags.mirror_y && (tp->set_mirror_y == NULL)) ||
+                          (tp->config.flags.swap_xy && (tp->set_swap_xy == NULL)));
+
+    /* Adjust all coordinates */
+    for (int i = 0; (sw_adj_needed && i < point_num); i++) {
+
+        /*  Mirror X coordinates (if not supported by HW) */
+        if (tp->config.flags.mirror_x && tp->set_mirror_x == NULL) {
+            x[i] = tp->config.x_max - x[i];
+        }
+
+        /*  Mirror Y coordinates (if not supported by HW) */
+        if (tp->config.flags.mirror_y && tp->set_mirror_y == NULL) {
+            y[i] = tp->config.y_max - y[i];
+        }
+
+        /* Swap X and Y coordinates (if not supported by HW) */
+        if (tp->config.flags.swap_xy && tp->set_swap_xy == NULL) {
+            uint16_t tmp = x[i];
+            x[i] = y[i];
+            y[i] = tmp;
+        }
+    }
+}
+
+static void touch_feed_gesture(esp_lcd_touch_handle_t tp)
+{
+    uint16_t x[CONFIG_ESP_LCD_TOUCH_MAX_POINTS];
+    uint16_t y[CONFIG_ESP_LCD_TOUCH_MAX_POINTS];
+    uint8_t point_num;
+
+    taskENTER_CRITICAL(&tp->data.lock);
+    point_num = tp->data.points;
+    for (int i = 0; i < point_num; i++) {
+        x[i] = tp->data.coords[i].x;
+        y[i] = tp->data.coords[i].y;
+    }
+    taskEXIT_CRITICAL(&tp->data.lock);
+
+    touch_sw_adjust(tp, x, y, point_num);
+    esp_lcd_touch_gesture_process(tp->gesture, x, y, point_num, esp_timer_get_time(), NULL, 0);
+}
+
+/* The ids of the points get_xy() returned, when the driver has them and they are still in order */
+static bool touch_get_track_ids(esp_lcd_touch_handle_t tp, uint8_t *track_id, uint8_t point_num)
+{
+    bool valid;
+
+    /* The user callback may drop or reorder the points */
+    if (!tp->data.track_ids || tp->config.process_coordinates != NULL) {
+        return false;
+    }
+
+    taskENTER_CRITICAL(&tp->data.lock);
+    valid = (tp->data.points >= point_num);
+    for (int i = 0; valid && i < point_num; i++) {
+        track_id[i] = tp->data.coords[i].track_id;
+    }
+    taskEXIT_CRITICAL(&tp->data.lock);
+
+    return valid;
+}
@@ -0,0 +1,266 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_lcd_touch.h"
+#include "esp_lcd_touch_filter.h"
+
+static const char *TAG = "TP filter";
+
+/* Coordinates are kept in 1/16 px so slow moves are not rounded away */
+#define FILTER_FRAC_BITS    (4)
+#define FILTER_ONE          (1 << FILTER_FRAC_BITS)
+/* Longest sample interval used for the filter coefficients, longer gaps are clamped */
+#define FILTER_MAX_TE_US    (200000)
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+typedef struct {
+    bool active;
+    int16_t id;     /* Track id of the controller, -1 when matched by distance */
+    int64_t last_us;
+    int32_t x;      /* Filtered position, 1/16 px */
+    int32_t y;
+    int32_t dx;     /* Filtered speed, 1/16 px per second */
+    int32_t dy;
+    uint16_t out_x; /* Last reported position, px */
+    uint16_t out_y;
+} filter_track_t;
+
+struct esp_lcd_touch_filter_s {
+    esp_lcd_touch_filter_config_t config;
+    filter_track_t tracks[CONFIG_ESP_LCD_TOUCH_MAX_POINTS];
+};
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+static uint32_t filter_alpha(uint32_t cutoff_mhz, uint32_t te_us);
+static int32_t filter_lowpass(int32_t prev, int32_t in, uint32_t alpha);
+static int filter_match_track(esp_lcd_touch_filter_handle_t filter, uint16_t x, uint16_t y, int16_t id, int64_t now_us,
+                              uint32_t used);
+static void filter_track_update(esp_lcd_touch_filter_handle_t filter, filter_track_t *track, uint16_t *x, uint16_t *y,
+                                uint16_t x_max, uint16_t y_max, int64_t now_us);
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t esp_lcd_touch_filter_new(const esp_lcd_touch_filter_config_t *config, esp_lcd_touch_filter_handle_t *out_filter)
+{
+    ESP_RETURN_ON_FALSE(config && out_filter, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    esp_lcd_touch_filter_handle_t filter = heap_caps_calloc(1, sizeof(struct esp_lcd_touch_filter_s), MALLOC_CAP_DEFAULT);
+    ESP_RETURN_ON_FALSE(filter, ESP_ERR_NO_MEM, TAG, "no mem for touch filter");
+
+    memcpy(&filter->config, config, sizeof(esp_lcd_touch_filter_config_t));
+    *out_filter = filter;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_touch_filter_del(esp_lcd_touch_filter_handle_t filter)
+{
+    free(filter);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_touch_filter_set_config(esp_lcd_touch_filter_handle_t filter, const esp_lcd_touch_filter_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(filter && config, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    memcpy(&filter->config, config, sizeof(esp_lcd_touch_filter_config_t));
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_touch_filter_get_config(esp_lcd_touch_filter_handle_t filter, esp_lcd_touch_filter_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(filter && config, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    memcpy(config, &filter->config, sizeof(esp_lcd_touch_filter_config_t));
+
+    return ESP_OK;
+}
+
+void esp_lcd_touch_filter_reset(esp_lcd_touch_filter_handle_t filter)
+{
+    assert(filter != NULL);
+
+    for (int i = 0; i < CONFIG_ESP_LCD_TOUCH_MAX_POINTS; i++) {
+        filter->tracks[i].active = false;
+    }
+}
+
+void esp_lcd_touch_filter_process(esp_lcd_touch_filter_handle_t filter, uint16_t *x, uint16_t *y, const uint8_t *track_id,
+                                  uint8_t point_num, uint16_t x_max, uint16_t y_max, int64_t timestamp_us)
+{
+    uint32_t used = 0;
+
+    assert(filter != NULL);
+    assert(x != NULL);
+    assert(y != NULL);
+
+    if (point_num > CONFIG_ESP_LCD_TOUCH_MAX_POINTS) {
+        point_num = CONFIG_ESP_LCD_TOUCH_MAX_POINTS;
+    }
+
+    /* Match every point to the live track of its id, else the nearest one, or start a new one */
+    for (int i = 0; i < point_num; i++) {
+        int16_t id = (track_id ? track_id[i] : -1);
+        int t = filter_match_track(filter, x[i], y[i], id, timestamp_us, used);
+        if (t < 0) {
+            continue;
+        }
+        used |= (1U << t);
+        filter->tracks[t].id = id;
+        filter_track_update(filter, &filter->tracks[t], &x[i], &y[i], x_max, y_max, timestamp_us);
+    }
+
+    /* Tracks without a point this round are released fingers */
+    for (int t = 0; t < CONFIG_ESP_LCD_TOUCH_MAX_POINTS; t++) {
+        if (!(used & (1U << t))) {
+            filter->tracks[t].active = false;
+        }
+    }
+}
+
+esp_err_t esp_lcd_touch_set_filter(esp_lcd_touch_handle_t tp, esp_lcd_touch_filter_handle_t filter)
+{
+    assert(tp != NULL);
+
+    if (filter) {
+        esp_lcd_touch_filter_reset(filter);
+    }
+    tp->filter = filter;
+
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Private API function
+*******************************************************************************/
+
+/* Smoothing factor in Q16: alpha = r / (1 + r) with r = 2 * pi * fc * Te */
+static uint32_t filter_alpha(uint32_t cutoff_mhz, uint32_t te_us)
+{
+    /* r scaled by 1e9 (mHz * us) */
+    uint64_t r = (uint64_t)cutoff_mhz * te_us * 6283 / 1000;
+
+    return (uint32_t)((r << 16) / (r + 1000000000ULL));
+}
+
+static int32_t filter_lowpass(int32_t prev, int32_t in, uint32_t alpha)
+{
+    return prev + (int32_t)(((int64_t)(in - prev) * alpha) >> 16);
+}
+
+static int filter_match_track(esp_lcd_touch_filter_handle_t filter, uint16_t x, uint16_t y, int16_t id, int64_t now_us,
+                              uint32_t used)
+{
+    const int64_t timeout_us = (int64_t)filter->config.track_timeout_ms * 1000;
+    const int32_t radius = filter->config.track_radius;
+    int32_t best_dist = radius * radius;
+    int best = -1;
+    int free_slot = -1;
+
+    for (int t = 0; t < CONFIG_ESP_LCD_TOUCH_MAX_POINTS; t++) {
+        filter_track_t *track = &filter->tracks[t];
+
+        if (used & (1U << t)) {
+            continue;
+        }
+        if (!track->active || (now_us - track->last_us) > timeout_us) {
+            track->active = false;
+            if (free_slot < 0) {
+                free_slot = t;
+            }
+            continue;
+        }
+
+        /* The controller tells the fingers apart, even two that come close */
+        if (id >= 0) {
+            if (track->id == id) {
+                return t;
+            }
+            continue;
+        }
+
+        int32_t ddx = (int32_t)x - (track->x >> FILTER_FRAC_BITS);
+        int32_t ddy = (int32_t)y - (track->y >> FILTER_FRAC_BITS);
+        int32_t dist = ddx * ddx + ddy * ddy;
+        if (dist <= best_dist) {
+            best_dist = dist;
+            best = t;
+        }
+    }
+
+    return (best >= 0 ? best : free_slot);
+}
+
+static void filter_track_update(esp_lcd_touch_filter_handle_t filter, filter_track_t *track, uint16_t *x, uint16_t *y,
+                                uint16_t x_max, uint16_t y_max, int64_t now_us)
+{
+    const esp_lcd_touch_filter_config_t *cfg = &filter->config;
+    int32_t in_x = (int32_t)*x << FILTER_FRAC_BITS;
+    int32_t in_y = (int32_t)*y << FILTER_FRAC_BITS;
+
+    /* First sample of a finger passes through unchanged */
+    if (!track->active) {
+        track->active = true;
+        track->last_us = now_us;
+        track->x = in_x;
+        track->y = in_y;
+        track->dx = 0;
+        track->dy = 0;
+        track->out_x = *x;
+        track->out_y = *y;
+        return;
+    }
+
+    int64_t te = now_us - track->last_us;
+    uint32_t te_us = (te <= 0 ? 1 : (te > FILTER_MAX_TE_US ? FILTER_MAX_TE_US : (uint32_t)te));
+    track->last_us = now_us;
+
+    /* Speed estimate, low passed with the fixed derivative cutoff */
+    int32_t raw_dx = (int32_t)(((int64_t)(in_x - track->x) * 1000000) / te_us);
+    int32_t raw_dy = (int32_t)(((int64_t)(in_y - track->y) * 1000000) / te_us);
+    uint32_t a_d = filter_alpha(cfg->d_cutoff_mhz, te_us);
+    track->dx = filter_lowpass(track->dx, raw_dx, a_d);
+    track->dy = filter_lowpass(track->dy, raw_dy, a_d);
+
+    /* Cutoff grows with speed: steady when resting, responsive when dragging */
+    uint32_t adx = (uint32_t)abs(track->dx) >> FILTER_FRAC_BITS;
+    uint32_t ady = (uint32_t)abs(track->dy) >> FILTER_FRAC_BITS;
+    uint32_t speed = (adx > ady ? adx + (ady >> 1) : ady + (adx >> 1));
+    uint32_t a = filter_alpha(cfg->min_cutoff_mhz + cfg->beta * speed, te_us);
+    track->x = filter_lowpass(track->x, in_x, a);
+    track->y = filter_lowpass(track->y, in_y, a);
+
+    /* Linear prediction over the render delay */
+    int32_t px = track->x + (int32_t)(((int64_t)track->dx * cfg->predict_ms) / 1000);
+    int32_t py = track->y + (int32_t)(((int64_t)track->dy * cfg->predict_ms) / 1000);
+    px = (px + (FILTER_ONE / 2)) >> FILTER_FRAC_BITS;
+    py = (py + (FILTER_ONE / 2)) >> FILTER_FRAC_BITS;
+    px = (px < 0 ? 0 : (px > x_max ? x_max : px));
+    py = (py < 0 ? 0 : (py > y_max ? y_max : py));
+
+    /* Hold the output inside the deadband so resting fingers do not trigger redraws */
+    if (abs(px - (int32_t)track->out_x) > cfg->deadband || abs(py - (int32_t)track->out_y) > cfg->deadband) {
+        track->out_x = (uint16_t)px;
+        track->out_y = (uint16_t)py;
+    }
+
+    *x = track->out_x;
+    *y = track->out_y;
+}
@@ -0,0 +1,298 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_lcd_touch_gesture.h"
+
+static const char *TAG = "TP gesture";
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+typedef struct {
+    int32_t x;
+    int32_t y;
+} gesture_point_t;
+
+struct esp_lcd_touch_gesture_s {
+    esp_lcd_touch_gesture_config_t config;
+    QueueHandle_t queue;
+
+    bool down;                  /* A contact is in progress */
+    bool long_press_sent;
+    uint8_t max_points;         /* Most fingers seen during this contact */
+    int64_t start_us;
+    int64_t last_seen_us;       /* Last sample with points */
+    gesture_point_t start;      /* First finger at touch down */
+    gesture_point_t last;       /* First finger at last sample */
+
+    /* Two finger tracking: centre and finger distance at start and last sample */
+    bool two_started;
+    int64_t two_start_us;
+    gesture_point_t two_start_c;
+    gesture_point_t two_last_c;
+    int32_t two_start_d;
+    int32_t two_last_d;
+
+    /* Previous tap for double tap detection */
+    int64_t last_tap_us;
+    gesture_point_t last_tap;
+};
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+static int32_t gesture_dist(int32_t dx, int32_t dy);
+static uint8_t gesture_dir(int32_t dx, int32_t dy);
+static int16_t gesture_speed(int32_t dist, int64_t duration_us);
+static void gesture_emit(esp_lcd_touch_gesture_handle_t gesture, uint8_t type, uint8_t dir, int32_t value, gesture_point_t p,
+                         esp_lcd_touch_gesture_event_t *events, uint8_t max_events, uint8_t *count);
+static void gesture_release(esp_lcd_touch_gesture_handle_t gesture, esp_lcd_touch_gesture_event_t *events, uint8_t max_events, uint8_t *count);
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t esp_lcd_touch_gesture_new(const esp_lcd_touch_gesture_config_t *config, esp_lcd_touch_gesture_handle_t *out_gesture)
+{
+    ESP_RETURN_ON_FALSE(config && out_gesture, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    esp_lcd_touch_gesture_handle_t gesture = heap_caps_calloc(1, sizeof(struct esp_lcd_touch_gesture_s), MALLOC_CAP_DEFAULT);
+    ESP_RETURN_ON_FALSE(gesture, ESP_ERR_NO_MEM, TAG, "no mem for gesture recogniser");
+
+    memcpy(&gesture->config, config, sizeof(esp_lcd_touch_gesture_config_t));
+    gesture->last_tap_us = INT64_MIN / 2;
+
+    if (config->queue_len > 0) {
+        gesture->queue = xQueueCreate(config->queue_len, sizeof(esp_lcd_touch_gesture_event_t));
+        if (gesture->queue == NULL) {
+            free(gesture);
+            ESP_LOGE(TAG, "no mem for gesture queue");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    *out_gesture = gesture;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_touch_gesture_del(esp_lcd_touch_gesture_handle_t gesture)
+{
+    if (gesture && gesture->queue) {
+        vQueueDelete(gesture->queue);
+    }
+    free(gesture);
+
+    return ESP_OK;
+}
+
+QueueHandle_t esp_lcd_touch_gesture_get_queue(esp_lcd_touch_gesture_handle_t gesture)
+{
+    assert(gesture != NULL);
+
+    return gesture->queue;
+}
+
+uint8_t esp_lcd_touch_gesture_process(esp_lcd_touch_gesture_handle_t gesture, const uint16_t *x, const uint16_t *y,
+                                      uint8_t point_num, int64_t timestamp_us,
+                                      esp_lcd_touch_gesture_event_t *events, uint8_t max_events)
+{
+    const esp_lcd_touch_gesture_config_t *cfg;
+    uint8_t count = 0;
+
+    assert(gesture != NULL);
+    cfg = &gesture->config;
+
+    if (point_num == 0) {
+        /* Controllers skip samples, only a gap longer than release_ms ends the contact */
+        if (gesture->down && (timestamp_us - gesture->last_seen_us) >= (int64_t)cfg->release_ms * 1000) {
+            gesture_release(gesture, events, max_events, &count);
+        }
+        return count;
+    }
+
+    assert(x != NULL);
+    assert(y != NULL);
+
+    gesture_point_t p0 = { x[0], y[0] };
+
+    if (!gesture->down) {
+        gesture->down = true;
+        gesture->long_press_sent = false;
+        gesture->two_started = false;
+        gesture->max_points = 0;
+        gesture->start_us = timestamp_us;
+        gesture->start = p0;
+    }
+
+    gesture->last_seen_us = timestamp_us;
+    gesture->last = p0;
+    if (point_num > gesture->max_points) {
+        gesture->max_points = point_num;
+    }
+
+    if (point_num >= 2) {
+        gesture_point_t c = { ((int32_t)x[0] + x[1]) / 2, ((int32_t)y[0] + y[1]) / 2 };
+        int32_t d = gesture_dist((int32_t)x[1] - x[0], (int32_t)y[1] - y[0]);
+        if (!gesture->two_started) {
+            gesture->two_started = true;
+            gesture->two_start_us = timestamp_us;
+            gesture->two_start_c = c;
+            gesture->two_start_d = d;
+        }
+        gesture->two_last_c = c;
+        gesture->two_last_d = d;
+    }
+
+    /* Long press fires while the finger is still down */
+    if (!gesture->long_press_sent && gesture->max_points == 1 &&
+            (timestamp_us - gesture->start_us) >= (int64_t)cfg->long_press_ms * 1000 &&
+            gesture_dist(p0.x - gesture->start.x, p0.y - gesture->start.y) <= cfg->slop) {
+        gesture->long_press_sent = true;
+        gesture_emit(gesture, ESP_LCD_TOUCH_GESTURE_LONG_PRESS, ESP_LCD_TOUCH_GESTURE_DIR_NONE, 0, gesture->start,
+                     events, max_events, &count);
+    }
+
+    return count;
+}
+
+#if !CONFIG_IDF_TARGET_LINUX
+esp_err_t esp_lcd_touch_set_gesture(esp_lcd_touch_handle_t tp, esp_lcd_touch_gesture_handle_t gesture)
+{
+    assert(tp != NULL);
+
+    tp->gesture = gesture;
+
+    return ESP_OK;
+}
+#endif
+
+/*******************************************************************************
+* Private API function
+*******************************************************************************/
+
+/* Octagonal distance approximation, within 4% of the euclidean distance */
+static int32_t gesture_dist(int32_t dx, int32_t dy)
+{
+    dx = abs(dx);
+    dy = abs(dy);
+
+    int32_t mx = (dx > dy ? dx : dy);
+    int32_t mn = (dx > dy ? dy : dx);
+
+    return mx + ((mn * 13) >> 5);
+}
+
+static uint8_t gesture_dir(int32_t dx, int32_t dy)
+{
+    if (abs(dx) >= abs(dy)) {
+        return (dx < 0 ? ESP_LCD_TOUCH_GESTURE_DIR_LEFT : ESP_LCD_TOUCH_GESTURE_DIR_RIGHT);
+    }
+
+    return (dy < 0 ? ESP_LCD_TOUCH_GESTURE_DIR_UP : ESP_LCD_TOUCH_GESTURE_DIR_DOWN);
+}
+
+static int16_t gesture_speed(int32_t dist, int64_t duration_us)
+{
+    if (duration_us <= 0) {
+        return INT16_MAX;
+    }
+
+    int64_t speed = ((int64_t)dist * 1000000) / duration_us;
+
+    return (speed > INT16_MAX ? INT16_MAX : (int16_t)speed);
+}
+
+static void gesture_emit(esp_lcd_touch_gesture_handle_t gesture, uint8_t type, uint8_t dir, int32_t value, gesture_point_t p,
+                         esp_lcd_touch_gesture_event_t *events, uint8_t max_events, uint8_t *count)
+{
+    esp_lcd_touch_gesture_event_t evt = {
+        .type = type,
+        .dir = dir,
+        .value = (int16_t)(value > INT16_MAX ? INT16_MAX : value),
+        .x = (uint16_t)(p.x < 0 ? 0 : p.x),
+        .y = (uint16_t)(p.y < 0 ? 0 : p.y),
+    };
+
+    if (events && *count < max_events) {
+        events[*count] = evt;
+    }
+    (*count)++;
+
+    /* Never block the touch task: a full queue drops the event */
+    if (gesture->queue) {
+        xQueueSend(gesture->queue, &evt, 0);
+    }
+}
+
+static void gesture_release(esp_lcd_touch_gesture_handle_t gesture, esp_lcd_touch_gesture_event_t *events, uint8_t max_events, uint8_t *count)
+{
+    const esp_lcd_touch_gesture_config_t *cfg = &gesture->config;
+    int64_t duration_us = gesture->last_seen_us - gesture->start_us;
+
+    gesture->down = false;
+
+    if (gesture->max_points >= 2 && gesture->two_started) {
+        int32_t cdx = gesture->two_last_c.x - gesture->two_start_c.x;
+        int32_t cdy = gesture->two_last_c.y - gesture->two_start_c.y;
+        int32_t travel = gesture_dist(cdx, cdy);
+        int32_t delta = abs(gesture->two_last_d - gesture->two_start_d);
+
+        /* Fingers spreading or closing more than moving together: pinch */
+        if (delta >= cfg->pinch_min_delta && delta > travel && gesture->two_start_d > 0) {
+            int32_t scale = (gesture->two_last_d * 256) / gesture->two_start_d;
+            gesture_emit(gesture, ESP_LCD_TOUCH_GESTURE_PINCH, ESP_LCD_TOUCH_GESTURE_DIR_NONE, scale, gesture->two_start_c,
+                         events, max_events, count);
+        } else if (travel >= cfg->swipe_min_dist) {
+            gesture_emit(gesture, ESP_LCD_TOUCH_GESTURE_TWO_FINGER_SWIPE, gesture_dir(cdx, cdy),
+                         gesture_speed(travel, gesture->last_seen_us - gesture->two_start_us), gesture->two_start_c,
+                         events, max_events, count);
+        }
+        return;
+    }
+
+    if (gesture->long_press_sent) {
+        return;
+    }
+
+    int32_t dx = gesture->last.x - gesture->start.x;
+    int32_t dy = gesture->last.y - gesture->start.y;
+    int32_t dist = gesture_dist(dx, dy);
+
+    if (dist >= cfg->swipe_min_dist) {
+        int16_t speed = gesture_speed(dist, duration_us);
+        if (speed >= cfg->swipe_min_speed) {
+            gesture_emit(gesture, ESP_LCD_TOUCH_GESTURE_SWIPE, gesture_dir(dx, dy), speed, gesture->start,
+                         events, max_events, count);
+        }
+        return;
+    }
+
+    if (dist <= cfg->slop && duration_us <= (int64_t)cfg->tap_max_ms * 1000) {
+        /* Tap is sent at once so single taps are not delayed, a double tap follows it */
+        gesture_emit(gesture, ESP_LCD_TOUCH_GESTURE_TAP, ESP_LCD_TOUCH_GESTURE_DIR_NONE, 0, gesture->start,
+                     events, max_events, count);
+
+        bool near = gesture_dist(gesture->start.x - gesture->last_tap.x, gesture->start.y - gesture->last_tap.y) <= cfg->slop * 2;
+        if (near && (gesture->start_us - gesture->last_tap_us) <= (int64_t)cfg->double_tap_ms * 1000) {
+            gesture_emit(gesture, ESP_LCD_TOUCH_GESTURE_DOUBLE_TAP, ESP_LCD_TOUCH_GESTURE_DIR_NONE, 0, gesture->start,
+                         events, max_events, count);
+            /* A third tap starts a new pair */
+            gesture->last_tap_us = INT64_MIN / 2;
+        } else {
+            gesture->last_tap_us = gesture->last_seen_us;
+            gesture->last_tap = gesture->start;
+        }
+    }
+}
@@ -0,0 +1,263 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_lcd_touch.h"
+#include "esp_lcd_touch_pm.h"
+
+static const char *TAG = "TP pm";
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+struct esp_lcd_touch_pm_s {
+    esp_lcd_touch_pm_config_t config;
+    esp_lcd_touch_handle_t tp;
+    SemaphoreHandle_t wake;         /* Given by the interrupt */
+    portMUX_TYPE lock;              /* Guards state and stats against get_stats() */
+    bool can_sleep;                 /* Interrupt pin and driver sleep hooks available */
+
+    esp_lcd_touch_pm_state_t state;
+    int64_t state_since_us;
+    int64_t last_sample_us;
+    int64_t last_touch_us;
+    volatile int64_t int_us;        /* Time of the last interrupt */
+    bool wake_pending;              /* Woken, first touched sample not seen yet */
+    int64_t wake_int_us;
+
+    esp_lcd_touch_pm_stats_t stats;
+};
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+static void touch_pm_isr(esp_lcd_touch_handle_t tp);
+static void touch_pm_set_state(esp_lcd_touch_pm_handle_t pm, esp_lcd_touch_pm_state_t state, int64_t now_us);
+static bool touch_pm_peek_touched(esp_lcd_touch_handle_t tp);
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t esp_lcd_touch_pm_new(esp_lcd_touch_handle_t tp, const esp_lcd_touch_pm_config_t *config, esp_lcd_touch_pm_handle_t *out_pm)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(tp && config && out_pm, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->active_period_ms > 0 && config->idle_period_ms > 0, ESP_ERR_INVALID_ARG, TAG, "invalid period");
+
+    esp_lcd_touch_pm_handle_t pm = heap_caps_calloc(1, sizeof(struct esp_lcd_touch_pm_s), MALLOC_CAP_DEFAULT);
+    ESP_RETURN_ON_FALSE(pm, ESP_ERR_NO_MEM, TAG, "no mem for touch power manager");
+
+    pm->wake = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(pm->wake, ESP_ERR_NO_MEM, err, TAG, "no mem for wake semaphore");
+
+    memcpy(&pm->config, config, sizeof(esp_lcd_touch_pm_config_t));
+    pm->tp = tp;
+    portMUX_INITIALIZE(&pm->lock);
+    pm->state = ESP_LCD_TOUCH_PM_ACTIVE;
+    pm->state_since_us = esp_timer_get_time();
+    pm->last_sample_us = pm->state_since_us;
+    pm->last_touch_us = pm->state_since_us;
+    tp->pm = pm;
+
+    /* The interrupt shortens every wait and is the only way out of sleep */
+    if (tp->config.int_gpio_num != GPIO_NUM_NC) {
+        gpio_set_intr_type(tp->config.int_gpio_num, tp->config.levels.interrupt ? GPIO_INTR_POSEDGE : GPIO_INTR_NEGEDGE);
+        ret = esp_lcd_touch_register_interrupt_callback(tp, touch_pm_isr);
+        ESP_GOTO_ON_ERROR(ret, err, TAG, "interrupt register failed");
+        pm->can_sleep = (tp->enter_sleep != NULL && tp->exit_sleep != NULL);
+    }
+    if (!pm->can_sleep && config->sleep_after_ms > 0) {
+        ESP_LOGW(TAG, "Controller sleep needs the interrupt pin and driver sleep support, staying idle instead");
+    }
+
+    *out_pm = pm;
+
+    return ESP_OK;
+
+err:
+    tp->pm = NULL;
+    if (pm->wake) {
+        vSemaphoreDelete(pm->wake);
+    }
+    free(pm);
+
+    return ret;
+}
+
+esp_err_t esp_lcd_touch_pm_del(esp_lcd_touch_pm_handle_t pm)
+{
+    if (pm == NULL) {
+        return ESP_OK;
+    }
+
+    if (pm->state == ESP_LCD_TOUCH_PM_SLEEP) {
+        esp_lcd_touch_exit_sleep(pm->tp);
+    }
+    if (pm->tp->config.int_gpio_num != GPIO_NUM_NC) {
+        esp_lcd_touch_register_interrupt_callback(pm->tp, NULL);
+    }
+    pm->tp->pm = NULL;
+    vSemaphoreDelete(pm->wake);
+    free(pm);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_touch_pm_read_data(esp_lcd_touch_pm_handle_t pm)
+{
+    const esp_lcd_touch_pm_config_t *cfg;
+    TickType_t ticks = portMAX_DELAY;
+    esp_err_t ret;
+
+    assert(pm != NULL);
+    cfg = &pm->config;
+
+    /* Sleep waits for the interrupt only, the other states until the next sample is due */
+    if (pm->state != ESP_LCD_TOUCH_PM_SLEEP) {
+        uint32_t period_ms = (pm->state == ESP_LCD_TOUCH_PM_ACTIVE ? cfg->active_period_ms : cfg->idle_period_ms);
+        int64_t wait_us = pm->last_sample_us + (int64_t)period_ms * 1000 - esp_timer_get_time();
+        ticks = (wait_us > 0 ? (TickType_t)((wait_us * configTICK_RATE_HZ + 999999) / 1000000) : 0);
+    }
+    bool by_int = (xSemaphoreTake(pm->wake, ticks) == pdTRUE);
+
+    int64_t now = esp_timer_get_time();
+
+    if (pm->state == ESP_LCD_TOUCH_PM_SLEEP) {
+        ret = esp_lcd_touch_exit_sleep(pm->tp);
+        ESP_RETURN_ON_ERROR(ret, TAG, "exit sleep failed");
+        taskENTER_CRITICAL(&pm->lock);
+        pm->stats.wakeups++;
+        taskEXIT_CRITICAL(&pm->lock);
+        pm->wake_pending = true;
+        pm->wake_int_us = (by_int ? pm->int_us : now);
+        pm->last_touch_us = now;
+        touch_pm_set_state(pm, ESP_LCD_TOUCH_PM_ACTIVE, now);
+    }
+
+    ret = esp_lcd_touch_read_data(pm->tp);
+    pm->last_sample_us = now;
+    taskENTER_CRITICAL(&pm->lock);
+    pm->stats.samples[pm->state]++;
+    taskEXIT_CRITICAL(&pm->lock);
+    ESP_RETURN_ON_ERROR(ret, TAG, "read failed");
+
+    if (touch_pm_peek_touched(pm->tp)) {
+        pm->last_touch_us = now;
+        if (pm->wake_pending) {
+            uint32_t latency = (uint32_t)(esp_timer_get_time() - pm->wake_int_us);
+            pm->wake_pending = false;
+            taskENTER_CRITICAL(&pm->lock);
+            pm->stats.wake_latency_us = latency;
+            if (latency > pm->stats.wake_latency_max_us) {
+                pm->stats.wake_latency_max_us = latency;
+            }
+            taskEXIT_CRITICAL(&pm->lock);
+        }
+        if (pm->state != ESP_LCD_TOUCH_PM_ACTIVE) {
+            touch_pm_set_state(pm, ESP_LCD_TOUCH_PM_ACTIVE, now);
+        }
+        return ESP_OK;
+    }
+
+    int64_t untouched_us = now - pm->last_touch_us;
+    if (pm->can_sleep && cfg->sleep_after_ms > 0 && untouched_us >= (int64_t)cfg->sleep_after_ms * 1000) {
+        ret = esp_lcd_touch_enter_sleep(pm->tp);
+        ESP_RETURN_ON_ERROR(ret, TAG, "enter sleep failed");
+        /* Edges seen before sleeping must not wake it at once */
+        xSemaphoreTake(pm->wake, 0);
+        pm->wake_pending = false;
+        taskENTER_CRITICAL(&pm->lock);
+        pm->stats.sleeps++;
+        taskEXIT_CRITICAL(&pm->lock);
+        touch_pm_set_state(pm, ESP_LCD_TOUCH_PM_SLEEP, now);
+    } else if (pm->state == ESP_LCD_TOUCH_PM_ACTIVE && untouched_us >= (int64_t)cfg->idle_after_ms * 1000) {
+        touch_pm_set_state(pm, ESP_LCD_TOUCH_PM_IDLE, now);
+    }
+
+    return ESP_OK;
+}
+
+esp_lcd_touch_pm_state_t esp_lcd_touch_pm_get_state(esp_lcd_touch_pm_handle_t pm)
+{
+    assert(pm != NULL);
+
+    return pm->state;
+}
+
+esp_err_t esp_lcd_touch_pm_get_stats(esp_lcd_touch_pm_handle_t pm, esp_lcd_touch_pm_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(pm && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    int64_t now = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&pm->lock);
+    memcpy(stats, &pm->stats, sizeof(esp_lcd_touch_pm_stats_t));
+    stats->state_us[pm->state] += now - pm->state_since_us;
+    taskEXIT_CRITICAL(&pm->lock);
+
+    return ESP_OK;
+}
+
+void esp_lcd_touch_pm_reset_stats(esp_lcd_touch_pm_handle_t pm)
+{
+    assert(pm != NULL);
+
+    taskENTER_CRITICAL(&pm->lock);
+    memset(&pm->stats, 0, sizeof(esp_lcd_touch_pm_stats_t));
+    pm->state_since_us = esp_timer_get_time();
+    taskEXIT_CRITICAL(&pm->lock);
+}
+
+/*******************************************************************************
+* Private API function
+*******************************************************************************/
+
+static void IRAM_ATTR touch_pm_isr(esp_lcd_touch_handle_t tp)
+{
+    esp_lcd_touch_pm_handle_t pm = tp->pm;
+    BaseType_t woken = pdFALSE;
+
+    pm->int_us = esp_timer_get_time();
+    xSemaphoreGiveFromISR(pm->wake, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void touch_pm_set_state(esp_lcd_touch_pm_handle_t pm, esp_lcd_touch_pm_state_t state, int64_t now_us)
+{
+    taskENTER_CRITICAL(&pm->lock);
+    pm->stats.state_us[pm->state] += now_us - pm->state_since_us;
+    pm->state_since_us = now_us;
+    pm->state = state;
+    taskEXIT_CRITICAL(&pm->lock);
+
+    ESP_LOGD(TAG, "state %d", state);
+}
+
+/* Look at the stored points without consuming them, get_coordinates() is left to the user */
+static bool touch_pm_peek_touched(esp_lcd_touch_handle_t tp)
+{
+    uint8_t points;
+
+    taskENTER_CRITICAL(&tp->data.lock);
+    points = tp->data.points;
+    taskEXIT_CRITICAL(&tp->data.lock);
+
+    return (points > 0);
+}
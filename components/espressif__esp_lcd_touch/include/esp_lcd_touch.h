@@ -30,6 +30,24 @@ extern "C" {
 typedef struct esp_lcd_touch_s esp_lcd_touch_t;
 typedef esp_lcd_touch_t *esp_lcd_touch_handle_t;
 
+/**
+ * @brief Touch point filter type (see esp_lcd_touch_filter.h)
+ *
+ */
+typedef struct esp_lcd_touch_filter_s *esp_lcd_touch_filter_handle_t;
+
+/**
+ * @brief Gesture recogniser type (see esp_lcd_touch_gesture.h)
+ *
+ */
+typedef struct esp_lcd_touch_gesture_s *esp_lcd_touch_gesture_handle_t;
+
+/**
+ * @brief Power manager type (see esp_lcd_touch_pm.h)
+ *
+ */
+typedef struct esp_lcd_touch_pm_s *esp_lcd_touch_pm_handle_t;
+
 /**
  * @brief Touch controller interrupt callback type
  *
@@ -71,7 +89,9 @@ typedef struct {
         uint16_t x; /*!< X coordinate */
         uint16_t y; /*!< Y coordinate */
         uint16_t strength; /*!< Strength */
+        uint8_t track_id; /*!< Id of the finger, kept by the controller while it touches (if track_ids) */
     } coords[CONFIG_ESP_LCD_TOUCH_MAX_POINTS];
+    bool track_ids; /*!< Set by drivers whose controller reports the track_id of the points */
 
 #if (CONFIG_ESP_LCD_TOUCH_MAX_BUTTONS > 0)
     uint8_t buttons; /*!< Count of buttons states saved */
@@ -249,6 +269,21 @@ struct esp_lcd_touch_s {
      * @brief Data structure
      */
     esp_lcd_touch_data_t data;
+
+    /**
+     * @brief Optional filter applied to coordinates (NULL when not used)
+     */
+    esp_lcd_touch_filter_handle_t filter;
+
+    /**
+     * @brief Optional gesture recogniser fed with all points on every read (NULL when not used)
+     */
+    esp_lcd_touch_gesture_handle_t gesture;
+
+    /**
+     * @brief Optional power manager pacing reads and controller sleep (NULL when not used)
+     */
+    esp_lcd_touch_pm_handle_t pm;
 };
 
 /**
@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LCD touch: jitter filter and latency prediction
+ *
+ * Per-point 1 Euro filter (Casiez et al.) in integer arithmetic. Every finger keeps its own filter
+ * state even when the controller reorders the reported points: points are matched to tracks by
+ * the track id of the controller when it reports one (GT911 does), else by nearest neighbour.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_lcd_touch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Filter configuration, all values are integers so the filter runs without FPU
+ *
+ */
+typedef struct {
+    uint32_t min_cutoff_mhz;    /*!< Cutoff frequency at rest in mHz. Lower removes more jitter, adds lag */
+    uint32_t beta;              /*!< Cutoff increase in mHz per px/s of speed. Higher reduces lag on fast moves */
+    uint32_t d_cutoff_mhz;      /*!< Cutoff frequency of the speed estimate in mHz */
+    uint16_t predict_ms;        /*!< Linear prediction horizon in ms to offset sampling-to-render delay (0: off) */
+    uint16_t track_radius;      /*!< Max distance in px to match a new sample to an existing track, without track ids */
+    uint16_t track_timeout_ms;  /*!< A track not updated for this long is restarted from the raw point */
+    uint16_t deadband;          /*!< Output is held until the filtered point moves more than this many px */
+} esp_lcd_touch_filter_config_t;
+
+/**
+ * @brief Default filter configuration, tuned for 4..5 inch capacitive panels polled every 10..30 ms
+ *
+ */
+#define ESP_LCD_TOUCH_FILTER_DEFAULT_CONFIG()   \
+    {                                           \
+        .min_cutoff_mhz = 1500,                 \
+        .beta = 30,                             \
+        .d_cutoff_mhz = 1000,                   \
+        .predict_ms = 0,                        \
+        .track_radius = 80,                     \
+        .track_timeout_ms = 100,                \
+        .deadband = 2,                          \
+    }
+
+/**
+ * @brief Create a new filter
+ *
+ * @param config: Filter configuration
+ * @param out_filter: Filter handle
+ *
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *      - ESP_ERR_NO_MEM        if there is no memory for the filter state
+ */
+esp_err_t esp_lcd_touch_filter_new(const esp_lcd_touch_filter_config_t *config, esp_lcd_touch_filter_handle_t *out_filter);
+
+/**
+ * @brief Delete filter
+ *
+ * @note Detach it with esp_lcd_touch_set_filter(tp, NULL) first when it is in use.
+ *
+ * @param filter: Filter handle
+ *
+ * @return
+ *      - ESP_OK on success
+ */
+esp_err_t esp_lcd_touch_filter_del(esp_lcd_touch_filter_handle_t filter);
+
+/**
+ * @brief Change filter parameters at runtime, tracks keep their state
+ *
+ * @param filter: Filter handle
+ * @param config: New configuration
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if parameter is invalid
+ */
+esp_err_t esp_lcd_touch_filter_set_config(esp_lcd_touch_filter_handle_t filter, const esp_lcd_touch_filter_config_t *config);
+
+/**
+ * @brief Read current filter parameters
+ *
+ * @param filter: Filter handle
+ * @param config: Current configuration
+ *
+ * @return
+ *      - ESP_OK on success
+ */
+esp_err_t esp_lcd_touch_filter_get_config(esp_lcd_touch_filter_handle_t filter, esp_lcd_touch_filter_config_t *config);
+
+/**
+ * @brief Drop all tracks, next samples are passed through and start new tracks
+ *
+ * @param filter: Filter handle
+ */
+void esp_lcd_touch_filter_reset(esp_lcd_touch_filter_handle_t filter);
+
+/**
+ * @brief Filter one sample set in place
+ *
+ * @note This is what esp_lcd_touch_get_coordinates() calls when a filter is attached. It has no
+ *       dependency on the touch handle, so recorded traces can be replayed through it.
+ *
+ * @param filter: Filter handle
+ * @param x: Array of X coordinates
+ * @param y: Array of Y coordinates
+ * @param track_id: Array of the track ids of the controller, NULL to match the points by distance
+ * @param point_num: Count of points in x and y
+ * @param x_max: Upper X bound for predicted points
+ * @param y_max: Upper Y bound for predicted points
+ * @param timestamp_us: Sample time in microseconds
+ */
+void esp_lcd_touch_filter_process(esp_lcd_touch_filter_handle_t filter, uint16_t *x, uint16_t *y, const uint8_t *track_id,
+                                  uint8_t point_num, uint16_t x_max, uint16_t y_max, int64_t timestamp_us);
+
+/**
+ * @brief Attach a filter to the touch handle (NULL detaches)
+ *
+ * @param tp: Touch handler
+ * @param filter: Filter handle or NULL
+ *
+ * @return
+ *      - ESP_OK on success
+ */
+esp_err_t esp_lcd_touch_set_filter(esp_lcd_touch_handle_t tp, esp_lcd_touch_filter_handle_t filter);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,176 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LCD touch: multi-touch gesture recogniser
+ *
+ * Works on all points reported by the controller, not only the single pointer LVGL sees.
+ * The recogniser is a fixed size state machine: no allocation after creation.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#if CONFIG_IDF_TARGET_LINUX
+/* The host build has the recogniser alone, there is no touch driver to attach it to */
+typedef struct esp_lcd_touch_gesture_s *esp_lcd_touch_gesture_handle_t;
+#else
+#include "esp_lcd_touch.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Recognised gestures
+ *
+ */
+typedef enum {
+    ESP_LCD_TOUCH_GESTURE_NONE = 0,
+    ESP_LCD_TOUCH_GESTURE_TAP,              /*!< Short touch without movement */
+    ESP_LCD_TOUCH_GESTURE_DOUBLE_TAP,       /*!< Second tap close in time and place (follows a TAP event) */
+    ESP_LCD_TOUCH_GESTURE_LONG_PRESS,       /*!< Finger held still, sent while still touching */
+    ESP_LCD_TOUCH_GESTURE_SWIPE,            /*!< One finger flick, value is the speed in px/s */
+    ESP_LCD_TOUCH_GESTURE_PINCH,            /*!< Two finger zoom, value is the scale in 1/256 (>256 zoom in) */
+    ESP_LCD_TOUCH_GESTURE_TWO_FINGER_SWIPE, /*!< Two fingers moved together, e.g. page turn; value is the speed in px/s */
+} esp_lcd_touch_gesture_type_t;
+
+/**
+ * @brief Direction of swipes
+ *
+ */
+typedef enum {
+    ESP_LCD_TOUCH_GESTURE_DIR_NONE = 0,
+    ESP_LCD_TOUCH_GESTURE_DIR_LEFT,
+    ESP_LCD_TOUCH_GESTURE_DIR_RIGHT,
+    ESP_LCD_TOUCH_GESTURE_DIR_UP,
+    ESP_LCD_TOUCH_GESTURE_DIR_DOWN,
+} esp_lcd_touch_gesture_dir_t;
+
+/**
+ * @brief Compact gesture event (8 bytes), cheap to pass through a queue
+ *
+ */
+typedef struct {
+    uint8_t type;   /*!< esp_lcd_touch_gesture_type_t */
+    uint8_t dir;    /*!< esp_lcd_touch_gesture_dir_t */
+    int16_t value;  /*!< Speed in px/s for swipes, scale in 1/256 for pinch, 0 otherwise */
+    uint16_t x;     /*!< Start point (centre of both fingers for two finger gestures) */
+    uint16_t y;
+} esp_lcd_touch_gesture_event_t;
+
+/**
+ * @brief Recogniser thresholds
+ *
+ */
+typedef struct {
+    uint16_t tap_max_ms;        /*!< Longest touch still counted as tap */
+    uint16_t double_tap_ms;     /*!< Max time between two taps of a double tap */
+    uint16_t long_press_ms;     /*!< Hold time for a long press */
+    uint16_t release_ms;        /*!< No points for this long means released (hides controller gaps) */
+    uint16_t slop;              /*!< Movement in px tolerated for taps and long press */
+    uint16_t swipe_min_dist;    /*!< Min travel in px for swipes */
+    uint16_t swipe_min_speed;   /*!< Min speed in px/s for one finger swipes */
+    uint16_t pinch_min_delta;   /*!< Min change of finger distance in px for pinch */
+    uint8_t queue_len;          /*!< Length of the event queue, 0 to not create a queue */
+} esp_lcd_touch_gesture_config_t;
+
+/**
+ * @brief Default thresholds for 4..10 inch panels
+ *
+ */
+#define ESP_LCD_TOUCH_GESTURE_DEFAULT_CONFIG()  \
+    {                                           \
+        .tap_max_ms = 250,                      \
+        .double_tap_ms = 350,                   \
+        .long_press_ms = 700,                   \
+        .release_ms = 40,                       \
+        .slop = 15,                             \
+        .swipe_min_dist = 80,                   \
+        .swipe_min_speed = 250,                 \
+        .pinch_min_delta = 40,                  \
+        .queue_len = 8,                         \
+    }
+
+/**
+ * @brief Create a gesture recogniser
+ *
+ * @param config: Thresholds
+ * @param out_gesture: Recogniser handle
+ *
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *      - ESP_ERR_NO_MEM        if there is no memory for the state or the queue
+ */
+esp_err_t esp_lcd_touch_gesture_new(const esp_lcd_touch_gesture_config_t *config, esp_lcd_touch_gesture_handle_t *out_gesture);
+
+/**
+ * @brief Delete a gesture recogniser and its queue
+ *
+ * @param gesture: Recogniser handle
+ *
+ * @return
+ *      - ESP_OK on success
+ */
+esp_err_t esp_lcd_touch_gesture_del(esp_lcd_touch_gesture_handle_t gesture);
+
+/**
+ * @brief Queue the recogniser publishes events to (NULL if queue_len was 0)
+ *
+ * @note Receive with xQueueReceive(queue, &event, 0) from the GUI task.
+ *
+ * @param gesture: Recogniser handle
+ *
+ * @return
+ *      - Queue of esp_lcd_touch_gesture_event_t
+ */
+QueueHandle_t esp_lcd_touch_gesture_get_queue(esp_lcd_touch_gesture_handle_t gesture);
+
+/**
+ * @brief Feed one sample of all touched points
+ *
+ * @note Called from esp_lcd_touch_read_data() when the recogniser is attached. Call it with
+ *       point_num 0 when nothing is touched. Has no dependency on the touch handle, so recorded
+ *       traces can be replayed through it.
+ *
+ * @param gesture: Recogniser handle
+ * @param x: Array of X coordinates
+ * @param y: Array of Y coordinates
+ * @param point_num: Count of touched points
+ * @param timestamp_us: Sample time in microseconds
+ * @param events: Recognised events are written here (can be NULL, events still go to the queue)
+ * @param max_events: Size of the events array (2 is always enough)
+ *
+ * @return
+ *      - Number of events recognised by this sample
+ */
+uint8_t esp_lcd_touch_gesture_process(esp_lcd_touch_gesture_handle_t gesture, const uint16_t *x, const uint16_t *y,
+                                      uint8_t point_num, int64_t timestamp_us,
+                                      esp_lcd_touch_gesture_event_t *events, uint8_t max_events);
+
+/**
+ * @brief Attach a gesture recogniser to the touch handle (NULL detaches)
+ *
+ * @param tp: Touch handler
+ * @param gesture: Recogniser handle or NULL
+ *
+ * @return
+ *      - ESP_OK on success
+ */
+#if !CONFIG_IDF_TARGET_LINUX
+esp_err_t esp_lcd_touch_set_gesture(esp_lcd_touch_handle_t tp, esp_lcd_touch_gesture_handle_t gesture);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
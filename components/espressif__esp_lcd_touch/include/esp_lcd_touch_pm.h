@@ -0,0 +1,145 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LCD touch: adaptive sample rate and controller sleep
+ *
+ * Samples fast while a finger is down, slower after release and puts the controller to sleep
+ * after a timeout. The interrupt pin wakes it again. Works with every driver that implements the
+ * enter_sleep/exit_sleep hooks; without them the controller just stays in the idle rate.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_lcd_touch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Power states
+ *
+ */
+typedef enum {
+    ESP_LCD_TOUCH_PM_ACTIVE = 0,    /*!< Finger down or just released: fast sampling */
+    ESP_LCD_TOUCH_PM_IDLE,          /*!< No touch for idle_after_ms: slow sampling */
+    ESP_LCD_TOUCH_PM_SLEEP,         /*!< Controller sleeping, waiting for the interrupt */
+    ESP_LCD_TOUCH_PM_STATE_MAX,
+} esp_lcd_touch_pm_state_t;
+
+/**
+ * @brief Power manager configuration
+ *
+ */
+typedef struct {
+    uint16_t active_period_ms;  /*!< Sample period while touched */
+    uint16_t idle_period_ms;    /*!< Sample period when idle (the interrupt, if any, cuts it short) */
+    uint16_t idle_after_ms;     /*!< Time without touch before going idle */
+    uint32_t sleep_after_ms;    /*!< Time without touch before the controller sleeps, 0 to never sleep */
+} esp_lcd_touch_pm_config_t;
+
+/**
+ * @brief Default configuration: 100 Hz touched, 10 Hz idle, sleep after 10 s
+ *
+ */
+#define ESP_LCD_TOUCH_PM_DEFAULT_CONFIG()   \
+    {                                       \
+        .active_period_ms = 10,             \
+        .idle_period_ms = 100,              \
+        .idle_after_ms = 500,               \
+        .sleep_after_ms = 10000,            \
+    }
+
+/**
+ * @brief Counters, times are in microseconds
+ *
+ */
+typedef struct {
+    uint64_t state_us[ESP_LCD_TOUCH_PM_STATE_MAX];  /*!< Time spent in each state */
+    uint32_t samples[ESP_LCD_TOUCH_PM_STATE_MAX];   /*!< Reads done in each state */
+    uint32_t sleeps;                /*!< Times the controller was put to sleep */
+    uint32_t wakeups;               /*!< Times it was woken by the interrupt */
+    uint32_t wake_latency_us;       /*!< Interrupt to first sample with points, last wake */
+    uint32_t wake_latency_max_us;   /*!< Same, worst case */
+} esp_lcd_touch_pm_stats_t;
+
+/**
+ * @brief Create a power manager and attach it to the touch handle
+ *
+ * @note Controller sleep needs int_gpio_num in the touch config and the driver sleep hooks.
+ *       The interrupt callback of the touch handle is taken over by the power manager.
+ *
+ * @param tp: Touch handler
+ * @param config: Configuration
+ * @param out_pm: Power manager handle
+ *
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *      - ESP_ERR_NO_MEM        if there is no memory for the state
+ */
+esp_err_t esp_lcd_touch_pm_new(esp_lcd_touch_handle_t tp, const esp_lcd_touch_pm_config_t *config, esp_lcd_touch_pm_handle_t *out_pm);
+
+/**
+ * @brief Detach and delete the power manager, a sleeping controller is woken first
+ *
+ * @param pm: Power manager handle
+ *
+ * @return
+ *      - ESP_OK on success
+ */
+esp_err_t esp_lcd_touch_pm_del(esp_lcd_touch_pm_handle_t pm);
+
+/**
+ * @brief Wait until the next sample is due and read it
+ *
+ * @note Use it instead of esp_lcd_touch_read_data() in the touch task loop. Blocks for the
+ *       period of the current state, or until the interrupt fires. A sleeping controller is
+ *       woken and read in the same call, so full rate resumes with the first sample.
+ *
+ * @param pm: Power manager handle
+ *
+ * @return
+ *      - ESP_OK on success, otherwise the error of the read
+ */
+esp_err_t esp_lcd_touch_pm_read_data(esp_lcd_touch_pm_handle_t pm);
+
+/**
+ * @brief Current power state
+ *
+ * @param pm: Power manager handle
+ *
+ * @return
+ *      - esp_lcd_touch_pm_state_t
+ */
+esp_lcd_touch_pm_state_t esp_lcd_touch_pm_get_state(esp_lcd_touch_pm_handle_t pm);
+
+/**
+ * @brief Read the counters, the time of the current state is included
+ *
+ * @param pm: Power manager handle
+ * @param stats: Counters
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if parameter is invalid
+ */
+esp_err_t esp_lcd_touch_pm_get_stats(esp_lcd_touch_pm_handle_t pm, esp_lcd_touch_pm_stats_t *stats);
+
+/**
+ * @brief Zero the counters
+ *
+ * @param pm: Power manager handle
+ */
+void esp_lcd_touch_pm_reset_stats(esp_lcd_touch_pm_handle_t pm);
+
+#ifdef __cplusplus
+}
+#endif
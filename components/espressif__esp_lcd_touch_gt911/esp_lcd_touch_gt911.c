@@ -16,6 +16,7 @@
 #include "driver/i2c.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_touch.h"
+#include "esp_lcd_touch_gt911.h"
 
 static const char *TAG = "GT911";
 
@@ -24,6 +25,21 @@ static const char *TAG = "GT911";
 #define ESP_LCD_TOUCH_GT911_CONFIG_REG  (0x8047)
 #define ESP_LCD_TOUCH_GT911_PRODUCT_ID_REG (0x8140)
 
+/* Points reported by the controller, 8 bytes each after the status byte */
+#define ESP_LCD_TOUCH_GT911_MAX_POINTS  (5)
+#define ESP_LCD_TOUCH_GT911_POINT_SIZE  (8)
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+typedef struct {
+    esp_lcd_touch_t base;   /* Must stay first, the handle points to it */
+    esp_lcd_touch_gt911_read_mode_t read_mode;
+    uint8_t last_cnt;       /* Points of the last report, sizes the next burst read */
+    uint8_t hits;           /* Saturating 0..3, up when a read found a new report, down when not */
+} esp_lcd_touch_gt911_t;
+
 /*******************************************************************************
 * Function definitions
 *******************************************************************************/
@@ -53,7 +69,8 @@ esp_err_t esp_lcd_touch_new_i2c_gt911(const esp_lcd_panel_io_handle_t io, const
     assert(out_touch != NULL);
 
     /* Prepare main structure */
-    esp_lcd_touch_handle_t esp_lcd_touch_gt911 = heap_caps_calloc(1, sizeof(esp_lcd_touch_t), MALLOC_CAP_DEFAULT);
+    esp_lcd_touch_gt911_t *gt911 = heap_caps_calloc(1, sizeof(esp_lcd_touch_gt911_t), MALLOC_CAP_DEFAULT);
+    esp_lcd_touch_handle_t esp_lcd_touch_gt911 = (gt911 ? &gt911->base : NULL);
     ESP_GOTO_ON_FALSE(esp_lcd_touch_gt911, ESP_ERR_NO_MEM, err, TAG, "no mem for GT911 controller");
 
     /* Communication interface */
@@ -67,6 +84,9 @@ esp_err_t esp_lcd_touch_new_i2c_gt911(const esp_lcd_panel_io_handle_t io, const
     /* Mutex */
     esp_lcd_touch_gt911->data.lock.owner = portMUX_FREE_VAL;
 
+    /* Every point record starts with the id the controller tracks the finger with */
+    esp_lcd_touch_gt911->data.track_ids = true;
+
     /* Save config */
     memcpy(&esp_lcd_touch_gt911->config, config, sizeof(esp_lcd_touch_config_t));
 
@@ -110,37 +130,80 @@ err:
     return ret;
 }
 
+esp_err_t esp_lcd_touch_gt911_set_read_mode(esp_lcd_touch_handle_t tp, esp_lcd_touch_gt911_read_mode_t mode)
+{
+    assert(tp != NULL);
+
+    esp_lcd_touch_gt911_t *gt911 = __containerof(tp, esp_lcd_touch_gt911_t, base);
+    gt911->read_mode = mode;
+    gt911->last_cnt = 0;
+    gt911->hits = 0;
+
+    return ESP_OK;
+}
+
 static esp_err_t esp_lcd_touch_gt911_read_data(esp_lcd_touch_handle_t tp)
 {
     esp_err_t err;
-    uint8_t buf[41];
+    uint8_t buf[1 + ESP_LCD_TOUCH_GT911_MAX_POINTS * ESP_LCD_TOUCH_GT911_POINT_SIZE];
     uint8_t touch_cnt = 0;
+    uint8_t burst_cnt = 0;
     uint8_t clear = 0;
     size_t i = 0;
 
     assert(tp != NULL);
 
-    err = touch_gt911_i2c_read(tp, ESP_LCD_TOUCH_GT911_READ_XY_REG, buf, 1);
+    esp_lcd_touch_gt911_t *gt911 = __containerof(tp, esp_lcd_touch_gt911_t, base);
+    bool burst = (gt911->read_mode == ESP_LCD_TOUCH_GT911_READ_BURST);
+
+    /* Burst: status and as many points as the last report had, in one transaction.
+     * When polled faster than the controller reports, most reads find no new report and the
+     * speculative points are wasted bus time, so speculate only while reads keep hitting. */
+    if (burst && gt911->hits >= 2) {
+        burst_cnt = gt911->last_cnt;
+    }
+    err = touch_gt911_i2c_read(tp, ESP_LCD_TOUCH_GT911_READ_XY_REG, buf, 1 + burst_cnt * ESP_LCD_TOUCH_GT911_POINT_SIZE);
     ESP_RETURN_ON_ERROR(err, TAG, "I2C read error!");
 
     /* Any touch data? */
     if ((buf[0] & 0x80) == 0x00) {
-        touch_gt911_i2c_write(tp, ESP_LCD_TOUCH_GT911_READ_XY_REG, clear);
+        if (gt911->hits > 0) {
+            gt911->hits--;
+        }
+        /* Nothing to acknowledge, the status is already clear */
+        if (!burst) {
+            touch_gt911_i2c_write(tp, ESP_LCD_TOUCH_GT911_READ_XY_REG, clear);
+        }
     } else {
+        if (gt911->hits < 3) {
+            gt911->hits++;
+        }
+
         /* Count of touched points */
         touch_cnt = buf[0] & 0x0f;
-        if (touch_cnt > 5 || touch_cnt == 0) {
+        if (touch_cnt > ESP_LCD_TOUCH_GT911_MAX_POINTS || touch_cnt == 0) {
             touch_gt911_i2c_write(tp, ESP_LCD_TOUCH_GT911_READ_XY_REG, clear);
+            gt911->last_cnt = 0;
+
+            /* Released: do not keep reporting the last points */
+            taskENTER_CRITICAL(&tp->data.lock);
+            tp->data.points = 0;
+            taskEXIT_CRITICAL(&tp->data.lock);
             return ESP_OK;
         }
 
-        /* Read all points */
-        err = touch_gt911_i2c_read(tp, ESP_LCD_TOUCH_GT911_READ_XY_REG + 1, &buf[1], touch_cnt * 8);
-        ESP_RETURN_ON_ERROR(err, TAG, "I2C read error!");
+        /* Read the points the burst did not cover */
+        if (touch_cnt > burst_cnt) {
+            err = touch_gt911_i2c_read(tp, ESP_LCD_TOUCH_GT911_READ_XY_REG + 1 + burst_cnt * ESP_LCD_TOUCH_GT911_POINT_SIZE,
+                                       &buf[1 + burst_cnt * ESP_LCD_TOUCH_GT911_POINT_SIZE],
+                                       (touch_cnt - burst_cnt) * ESP_LCD_TOUCH_GT911_POINT_SIZE);
+            ESP_RETURN_ON_ERROR(err, TAG, "I2C read error!");
+        }
 
         /* Clear all */
         err = touch_gt911_i2c_write(tp, ESP_LCD_TOUCH_GT911_READ_XY_REG, clear);
         ESP_RETURN_ON_ERROR(err, TAG, "I2C read error!");
+        gt911->last_cnt = touch_cnt;
 
         taskENTER_CRITICAL(&tp->data.lock);
 
@@ -150,6 +213,7 @@ static esp_err_t esp_lcd_touch_gt911_read_data(esp_lcd_touch_handle_t tp)
 
         /* Fill all coordinates */
         for (i = 0; i < touch_cnt; i++) {
+            tp->data.coords[i].track_id = buf[(i * 8) + 1];
             tp->data.coords[i].x = ((uint16_t)buf[(i * 8) + 3] << 8) + buf[(i * 8) + 2];
             tp->data.coords[i].y = (((uint16_t)buf[(i * 8) + 5] << 8) + buf[(i * 8) + 4]);
             tp->data.coords[i].strength = (((uint16_t)buf[(i * 8) + 7] << 8) + buf[(i * 8) + 6]);
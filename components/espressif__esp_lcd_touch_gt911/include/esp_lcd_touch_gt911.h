@@ -25,12 +25,40 @@ extern "C" {
  */
 esp_err_t esp_lcd_touch_new_i2c_gt911(const esp_lcd_panel_io_handle_t io, const esp_lcd_touch_config_t *config, esp_lcd_touch_handle_t *out_touch);
 
+/**
+ * @brief How the driver reads a sample from the controller
+ *
+ */
+typedef enum {
+    ESP_LCD_TOUCH_GT911_READ_BURST = 0, /*!< Status and the points of the last report in one transaction, clear only after a report (default) */
+    ESP_LCD_TOUCH_GT911_READ_LEGACY,    /*!< Status, points and clear as separate transactions on every read */
+} esp_lcd_touch_gt911_read_mode_t;
+
+/**
+ * @brief Select how samples are read from the controller
+ *
+ * @note Burst mode needs 1 transaction per idle sample and usually 2 per touched sample (read, clear),
+ *       legacy mode needs 2 and 3. Legacy is kept for comparison and for controllers that misbehave.
+ *
+ * @param tp: Touch handle created with esp_lcd_touch_new_i2c_gt911()
+ * @param mode: Read mode
+ * @return
+ *      - ESP_OK on success
+ */
+esp_err_t esp_lcd_touch_gt911_set_read_mode(esp_lcd_touch_handle_t tp, esp_lcd_touch_gt911_read_mode_t mode);
+
 /**
  * @brief I2C address of the GT911 controller
  *
  */
 #define ESP_LCD_TOUCH_IO_I2C_GT911_ADDRESS (0x5D)
 
+/**
+ * @brief Alternate I2C address, selected by the INT level during reset
+ *
+ */
+#define ESP_LCD_TOUCH_IO_I2C_GT911_ADDRESS_BACKUP (0x14)
+
 /**
  * @brief Touch IO configuration structure
  *
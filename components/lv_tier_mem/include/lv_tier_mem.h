@@ -0,0 +1,167 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Tiered LVGL heap, internal RAM and PSRAM
+ *
+ * The LVGL allocator when CONFIG_LV_USE_CUSTOM_MALLOC is set. Small allocations, the objects,
+ * styles and event lists LVGL touches on every refresh, go to TLSF pools in internal RAM.
+ * Larger ones, and everything allocated between lv_tier_mem_cold_begin() and _end(), go to
+ * TLSF pools in PSRAM. Both tiers add a pool when they are full, up to their limit, then the
+ * allocation goes to the other tier. lv_tier_mem_trim() gives the added pools back once empty.
+ *
+ * lv_mem_monitor() reports both tiers together, lv_tier_mem_get_stats() each one.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Memory tiers
+ *
+ */
+typedef enum {
+    LV_TIER_MEM_INTERNAL = 0,
+    LV_TIER_MEM_PSRAM,
+    LV_TIER_MEM_NUM,
+} lv_tier_mem_tier_t;
+
+/**
+ * @brief Where allocations go, see lv_tier_mem_set_policy()
+ *
+ */
+typedef struct {
+    size_t small_max;           /*!< Largest allocation for internal RAM, SIZE_MAX for all of them */
+    size_t internal_limit;      /*!< Internal pools grow up to this many bytes */
+    size_t psram_limit;         /*!< PSRAM pools grow up to this many bytes, 0 to not use PSRAM */
+} lv_tier_mem_policy_t;
+
+/**
+ * @brief Usage of a tier
+ *
+ */
+typedef struct {
+    size_t total;               /*!< Bytes in the pools */
+    size_t used;                /*!< Bytes allocated, as TLSF rounds the blocks up */
+    size_t peak;                /*!< Highest used since init or the last reset */
+    size_t largest_free;        /*!< Largest block that can be allocated without a new pool */
+    uint8_t frag_pct;           /*!< 100 - largest_free * 100 / free bytes */
+    uint32_t pools;
+    uint32_t blocks;            /*!< Allocations held */
+    uint32_t allocs;            /*!< malloc and realloc served since the last reset */
+    uint32_t grows;             /*!< Pools added since the last reset */
+    uint32_t spills;            /*!< Allocations meant for this tier that went to the other one */
+    uint32_t failed;            /*!< Allocations that fit in neither tier */
+} lv_tier_mem_stats_t;
+
+/**
+ * @brief Gives the tag of a block being allocated, 0 to 127. Called with the heap locked
+ *
+ */
+typedef uint8_t (*lv_tier_mem_tag_cb_t)(void);
+
+/**
+ * @brief Adds bytes to a tag (allocated) or takes them off (freed). Called with the heap locked,
+ * it must not allocate from LVGL
+ *
+ */
+typedef void (*lv_tier_mem_account_cb_t)(uint8_t tag, lv_tier_mem_tier_t tier, int32_t bytes);
+
+/**
+ * @brief Policy from menuconfig, LVGL heap (tiered)
+ *
+ */
+void lv_tier_mem_get_default_policy(lv_tier_mem_policy_t *policy);
+
+/**
+ * @brief Change where the next allocations go, the blocks already allocated stay where they are
+ *
+ * With {SIZE_MAX, 48 KB, 0} the heap works like the built-in LVGL heap of 48 KB.
+ *
+ * @param policy: New policy, copied. The limits do not free pools above them, see lv_tier_mem_trim()
+ */
+void lv_tier_mem_set_policy(const lv_tier_mem_policy_t *policy);
+
+/**
+ * @brief Get the policy in use
+ *
+ */
+void lv_tier_mem_get_policy(lv_tier_mem_policy_t *policy);
+
+/**
+ * @brief Send the allocations of the calling task to PSRAM whatever their size, until
+ * lv_tier_mem_cold_end(). For data that is drawn seldom, like the text of list rows.
+ * Calls nest.
+ *
+ */
+void lv_tier_mem_cold_begin(void);
+
+/**
+ * @brief End lv_tier_mem_cold_begin()
+ *
+ */
+void lv_tier_mem_cold_end(void);
+
+/**
+ * @brief Tag the blocks, for telemetry of who holds the heap. Needs CONFIG_LV_TIER_MEM_TAGS,
+ * which puts the tag and the size in a word before each block.
+ *
+ * Blocks allocated before are left out, also when they are freed.
+ *
+ * @param tag_cb: Tag of a new block, NULL for 0
+ * @param account_cb: Told the bytes of a block when it is allocated, resized or freed, NULL for none
+ */
+void lv_tier_mem_set_tag_cbs(lv_tier_mem_tag_cb_t tag_cb, lv_tier_mem_account_cb_t account_cb);
+
+/**
+ * @brief Free the pools added on demand that hold no allocation
+ *
+ * @return Bytes given back to the system heap
+ */
+size_t lv_tier_mem_trim(void);
+
+/**
+ * @brief Get the usage of a tier
+ *
+ * @param tier: Tier
+ * @param stats: Set to its usage
+ *
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter is invalid
+ */
+esp_err_t lv_tier_mem_get_stats(lv_tier_mem_tier_t tier, lv_tier_mem_stats_t *stats);
+
+/**
+ * @brief Zero the peak and the counters of both tiers, the peak starts again from what is used
+ *
+ */
+void lv_tier_mem_reset_stats(void);
+
+/**
+ * @brief Log the usage of both tiers
+ *
+ */
+void lv_tier_mem_dump(void);
+
+/**
+ * @brief Name of the tier for logs
+ *
+ */
+const char *lv_tier_mem_tier_name(lv_tier_mem_tier_t tier);
+
+#ifdef __cplusplus
+}
+#endif
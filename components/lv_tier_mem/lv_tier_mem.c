@@ -0,0 +1,664 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#include "multi_heap.h"
+#include "lvgl.h"
+#include "lv_tier_mem.h"
+
+static const char *TAG = "lv_tier_mem";
+
+/* Pools a tier holds, the first one, the added ones and the ones from lv_mem_add_pool() */
+#define TIER_POOLS_MAX      24
+/* Room for the TLSF control structure when a pool is added for a block larger than the step */
+#define TIER_POOL_MARGIN    4096
+#define TIER_POOL_ALIGN     4096
+
+#if CONFIG_LV_TIER_MEM_TAGS
+/* A word before each block: the tag in the top 7 bits, the accounted flag, the size in the low 24 bits */
+#define TIER_TAG_SIZE       4
+#define TIER_TAG_SHIFT      25
+#define TIER_TAG_ACCOUNTED  (1UL << 24)
+#define TIER_TAG_SIZE_MASK  0xFFFFFFUL
+#else
+#define TIER_TAG_SIZE       0
+#endif
+
+#ifndef CONFIG_LV_TIER_MEM_INTERNAL_KB
+#define CONFIG_LV_TIER_MEM_INTERNAL_KB          48
+#define CONFIG_LV_TIER_MEM_INTERNAL_LIMIT_KB    96
+#define CONFIG_LV_TIER_MEM_INTERNAL_STEP_KB     16
+#define CONFIG_LV_TIER_MEM_PSRAM_LIMIT_KB       2048
+#define CONFIG_LV_TIER_MEM_PSRAM_STEP_KB        128
+#define CONFIG_LV_TIER_MEM_SMALL_MAX            512
+#endif
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+typedef struct {
+    multi_heap_handle_t heap;
+    uint8_t *start;
+    size_t size;
+    bool owned;                 /* Allocated here from the system heap */
+    bool fixed;                 /* The first pool or one from lv_mem_add_pool(), never trimmed */
+} tier_pool_t;
+
+typedef struct {
+    tier_pool_t pools[TIER_POOLS_MAX];
+    uint32_t pool_cnt;
+    uint32_t caps;
+    size_t step;
+    size_t total;
+    size_t used;
+    size_t peak;
+    uint32_t blocks;
+    uint32_t allocs;
+    uint32_t grows;
+    uint32_t spills;
+    uint32_t failed;
+} tier_t;
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+static tier_pool_t *tier_find(void *p, lv_tier_mem_tier_t *out_id) __attribute__((unused));
+static bool tier_add_pool(tier_t *t, void *mem, size_t size, bool owned, bool fixed);
+static void tier_remove_pool(tier_t *t, uint32_t index);
+static bool tier_grow(lv_tier_mem_tier_t id, size_t need);
+static void *tier_alloc(lv_tier_mem_tier_t id, size_t size);
+static void *tier_mem_alloc(size_t size) __attribute__((unused));
+static void *tier_realloc(void *p, size_t new_size) __attribute__((unused));
+static void tier_free(void *p) __attribute__((unused));
+#if CONFIG_LV_TIER_MEM_TAGS
+static void *tier_tag_put(void *block, size_t size, uint8_t tag);
+static void *tier_tag_take(void *p);
+#endif
+static lv_tier_mem_tier_t tier_pick(size_t size);
+static void tier_account(tier_t *t, multi_heap_handle_t heap, void *p);
+static void tier_lock(void);
+static void tier_unlock(void);
+
+/*******************************************************************************
+* Local variables
+*******************************************************************************/
+static tier_t tiers[LV_TIER_MEM_NUM];
+static lv_tier_mem_policy_t tier_policy;
+static bool tier_has_psram;
+static SemaphoreHandle_t tier_mutex;
+static StaticSemaphore_t tier_mutex_buf __attribute__((unused));
+static TaskHandle_t cold_task;
+static uint32_t cold_depth;
+static lv_tier_mem_tag_cb_t tier_tag_cb;
+static lv_tier_mem_account_cb_t tier_account_cb;
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void lv_tier_mem_get_default_policy(lv_tier_mem_policy_t *policy)
+{
+    policy->small_max = CONFIG_LV_TIER_MEM_SMALL_MAX;
+    policy->internal_limit = CONFIG_LV_TIER_MEM_INTERNAL_LIMIT_KB * 1024;
+    policy->psram_limit = CONFIG_LV_TIER_MEM_PSRAM_LIMIT_KB * 1024;
+}
+
+void lv_tier_mem_set_policy(const lv_tier_mem_policy_t *policy)
+{
+    tier_lock();
+    tier_policy = *policy;
+    tier_unlock();
+}
+
+void lv_tier_mem_get_policy(lv_tier_mem_policy_t *policy)
+{
+    tier_lock();
+    *policy = tier_policy;
+    tier_unlock();
+}
+
+void lv_tier_mem_cold_begin(void)
+{
+    tier_lock();
+    if (cold_depth == 0) {
+        cold_task = xTaskGetCurrentTaskHandle();
+    }
+    if (cold_task == xTaskGetCurrentTaskHandle()) {
+        cold_depth++;
+    }
+    tier_unlock();
+}
+
+void lv_tier_mem_cold_end(void)
+{
+    tier_lock();
+    if (cold_depth > 0 && cold_task == xTaskGetCurrentTaskHandle()) {
+        cold_depth--;
+    }
+    tier_unlock();
+}
+
+void lv_tier_mem_set_tag_cbs(lv_tier_mem_tag_cb_t tag_cb, lv_tier_mem_account_cb_t account_cb)
+{
+    tier_lock();
+    tier_tag_cb = tag_cb;
+    tier_account_cb = account_cb;
+    tier_unlock();
+}
+
+size_t lv_tier_mem_trim(void)
+{
+    size_t freed = 0;
+
+    tier_lock();
+    for (int id = 0; id < LV_TIER_MEM_NUM; id++) {
+        tier_t *t = &tiers[id];
+        for (uint32_t i = t->pool_cnt; i-- > 0;) {
+            tier_pool_t *pool = &t->pools[i];
+            multi_heap_info_t info;
+            if (pool->fixed || !pool->owned) {
+                continue;
+            }
+            multi_heap_get_info(pool->heap, &info);
+            if (info.allocated_blocks == 0) {
+                void *mem = pool->start;
+                freed += pool->size;
+                tier_remove_pool(t, i);
+                heap_caps_free(mem);
+            }
+        }
+    }
+    tier_unlock();
+    return freed;
+}
+
+esp_err_t lv_tier_mem_get_stats(lv_tier_mem_tier_t tier, lv_tier_mem_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(tier < LV_TIER_MEM_NUM && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    size_t free_bytes = 0;
+    memset(stats, 0, sizeof(*stats));
+    tier_lock();
+    tier_t *t = &tiers[tier];
+    for (uint32_t i = 0; i < t->pool_cnt; i++) {
+        multi_heap_info_t info;
+        multi_heap_get_info(t->pools[i].heap, &info);
+        free_bytes += info.total_free_bytes;
+        if (info.largest_free_block > stats->largest_free) {
+            stats->largest_free = info.largest_free_block;
+        }
+    }
+    stats->total = t->total;
+    stats->used = t->used;
+    stats->peak = t->peak;
+    stats->pools = t->pool_cnt;
+    stats->blocks = t->blocks;
+    stats->allocs = t->allocs;
+    stats->grows = t->grows;
+    stats->spills = t->spills;
+    stats->failed = t->failed;
+    tier_unlock();
+
+    stats->frag_pct = free_bytes ? 100 - (uint8_t)((uint64_t)stats->largest_free * 100 / free_bytes) : 0;
+    return ESP_OK;
+}
+
+void lv_tier_mem_reset_stats(void)
+{
+    tier_lock();
+    for (int id = 0; id < LV_TIER_MEM_NUM; id++) {
+        tier_t *t = &tiers[id];
+        t->peak = t->used;
+        t->allocs = 0;
+        t->grows = 0;
+        t->spills = 0;
+        t->failed = 0;
+    }
+    tier_unlock();
+}
+
+void lv_tier_mem_dump(void)
+{
+    for (int id = 0; id < LV_TIER_MEM_NUM; id++) {
+        lv_tier_mem_stats_t s;
+        lv_tier_mem_get_stats((lv_tier_mem_tier_t)id, &s);
+        ESP_LOGI(TAG, "%-8s %2lu pools %7u B, used %7u B (peak %7u) in %5lu blocks, largest free %7u B, frag %3u%%, "
+                 "%lu grows, %lu spills, %lu failed", lv_tier_mem_tier_name((lv_tier_mem_tier_t)id),
+                 (unsigned long)s.pools, (unsigned)s.total, (unsigned)s.used, (unsigned)s.peak, (unsigned long)s.blocks,
+                 (unsigned)s.largest_free, s.frag_pct, (unsigned long)s.grows, (unsigned long)s.spills,
+                 (unsigned long)s.failed);
+    }
+}
+
+const char *lv_tier_mem_tier_name(lv_tier_mem_tier_t tier)
+{
+    switch (tier) {
+    case LV_TIER_MEM_INTERNAL:
+        return "internal";
+    case LV_TIER_MEM_PSRAM:
+        return "PSRAM";
+    default:
+        return "?";
+    }
+}
+
+/*******************************************************************************
+* LVGL allocator, lv_mem.h
+*******************************************************************************/
+#if CONFIG_LV_USE_CUSTOM_MALLOC
+
+void lv_mem_init(void)
+{
+    if (tier_mutex == NULL) {
+        tier_mutex = xSemaphoreCreateMutexStatic(&tier_mutex_buf);
+    }
+    memset(tiers, 0, sizeof(tiers));
+    cold_depth = 0;
+    tier_has_psram = heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0;
+    lv_tier_mem_get_default_policy(&tier_policy);
+
+    tiers[LV_TIER_MEM_INTERNAL].caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    tiers[LV_TIER_MEM_INTERNAL].step = CONFIG_LV_TIER_MEM_INTERNAL_STEP_KB * 1024;
+    tiers[LV_TIER_MEM_PSRAM].caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+    tiers[LV_TIER_MEM_PSRAM].step = CONFIG_LV_TIER_MEM_PSRAM_STEP_KB * 1024;
+
+    /* The first pool is taken at once, as the built-in heap has its pool, the others on demand */
+    size_t size = CONFIG_LV_TIER_MEM_INTERNAL_KB * 1024;
+    void *mem = heap_caps_malloc(size, tiers[LV_TIER_MEM_INTERNAL].caps);
+    if (mem == NULL || !tier_add_pool(&tiers[LV_TIER_MEM_INTERNAL], mem, size, true, true)) {
+        ESP_LOGE(TAG, "no mem for the first %u B pool", (unsigned)size);
+        heap_caps_free(mem);
+    }
+    ESP_LOGD(TAG, "internal %u B, up to %u B; PSRAM %s, up to %u B; internal up to %u B blocks",
+             (unsigned)size, (unsigned)tier_policy.internal_limit, tier_has_psram ? "found" : "not found",
+             (unsigned)tier_policy.psram_limit, (unsigned)tier_policy.small_max);
+}
+
+void lv_mem_deinit(void)
+{
+    tier_lock();
+    for (int id = 0; id < LV_TIER_MEM_NUM; id++) {
+        tier_t *t = &tiers[id];
+        for (uint32_t i = 0; i < t->pool_cnt; i++) {
+            if (t->pools[i].owned) {
+                heap_caps_free(t->pools[i].start);
+            }
+        }
+    }
+    memset(tiers, 0, sizeof(tiers));
+    tier_unlock();
+}
+
+lv_mem_pool_t lv_mem_add_pool(void *mem, size_t bytes)
+{
+    lv_tier_mem_tier_t id = esp_ptr_external_ram(mem) ? LV_TIER_MEM_PSRAM : LV_TIER_MEM_INTERNAL;
+    lv_mem_pool_t pool = NULL;
+
+    tier_lock();
+    tier_t *t = &tiers[id];
+    if (tier_add_pool(t, mem, bytes, false, true)) {
+        pool = t->pools[t->pool_cnt - 1].heap;
+    }
+    tier_unlock();
+    return pool;
+}
+
+void lv_mem_remove_pool(lv_mem_pool_t pool)
+{
+    tier_lock();
+    for (int id = 0; id < LV_TIER_MEM_NUM; id++) {
+        tier_t *t = &tiers[id];
+        for (uint32_t i = 0; i < t->pool_cnt; i++) {
+            if (t->pools[i].heap == pool && !t->pools[i].owned) {
+                tier_remove_pool(t, i);
+                tier_unlock();
+                return;
+            }
+        }
+    }
+    tier_unlock();
+    ESP_LOGW(TAG, "pool %p not found", pool);
+}
+
+void *lv_malloc_core(size_t size)
+{
+    tier_lock();
+    void *p = tier_mem_alloc(size + TIER_TAG_SIZE);
+#if CONFIG_LV_TIER_MEM_TAGS
+    if (p) {
+        p = tier_tag_put(p, size, tier_tag_cb ? tier_tag_cb() : 0);
+    }
+#endif
+    tier_unlock();
+    return p;
+}
+
+void *lv_realloc_core(void *p, size_t new_size)
+{
+    if (p == NULL) {
+        return lv_malloc_core(new_size);
+    }
+
+    tier_lock();
+#if CONFIG_LV_TIER_MEM_TAGS
+    /* The block keeps the tag it was allocated with */
+    uint32_t *block = (uint32_t *)tier_tag_take(p);
+    uint32_t word = *block;
+    void *q = tier_realloc(block, new_size + TIER_TAG_SIZE);
+    if (q) {
+        q = tier_tag_put(q, new_size, word >> TIER_TAG_SHIFT);
+    } else {
+        tier_tag_put(block, word & TIER_TAG_SIZE_MASK, word >> TIER_TAG_SHIFT);
+    }
+#else
+    void *q = tier_realloc(p, new_size);
+#endif
+    tier_unlock();
+    return q;
+}
+
+void lv_free_core(void *p)
+{
+    tier_lock();
+#if CONFIG_LV_TIER_MEM_TAGS
+    p = tier_tag_take(p);
+#endif
+    tier_free(p);
+    tier_unlock();
+}
+
+void lv_mem_monitor_core(lv_mem_monitor_t *mon_p)
+{
+    tier_lock();
+    for (int id = 0; id < LV_TIER_MEM_NUM; id++) {
+        tier_t *t = &tiers[id];
+        for (uint32_t i = 0; i < t->pool_cnt; i++) {
+            multi_heap_info_t info;
+            multi_heap_get_info(t->pools[i].heap, &info);
+            mon_p->free_cnt += info.free_blocks;
+            mon_p->free_size += info.total_free_bytes;
+            if (info.largest_free_block > mon_p->free_biggest_size) {
+                mon_p->free_biggest_size = info.largest_free_block;
+            }
+        }
+        mon_p->total_size += t->total;
+        mon_p->used_cnt += t->blocks;
+        mon_p->max_used += t->peak;
+    }
+    tier_unlock();
+
+    if (mon_p->total_size) {
+        mon_p->used_pct = 100 - (uint8_t)((uint64_t)mon_p->free_size * 100 / mon_p->total_size);
+    }
+    if (mon_p->free_size) {
+        mon_p->frag_pct = 100 - (uint8_t)((uint64_t)mon_p->free_biggest_size * 100 / mon_p->free_size);
+    }
+}
+
+lv_result_t lv_mem_test_core(void)
+{
+    lv_result_t res = LV_RESULT_OK;
+
+    tier_lock();
+    for (int id = 0; id < LV_TIER_MEM_NUM; id++) {
+        for (uint32_t i = 0; i < tiers[id].pool_cnt; i++) {
+            if (!multi_heap_check(tiers[id].pools[i].heap, true)) {
+                res = LV_RESULT_INVALID;
+            }
+        }
+    }
+    tier_unlock();
+    return res;
+}
+
+#endif /* CONFIG_LV_USE_CUSTOM_MALLOC */
+
+/*******************************************************************************
+* Private API function
+*******************************************************************************/
+
+static tier_pool_t *tier_find(void *p, lv_tier_mem_tier_t *out_id)
+{
+    /* Look in the tier of the address first, a pool from lv_mem_add_pool() may be anywhere */
+    lv_tier_mem_tier_t first = esp_ptr_external_ram(p) ? LV_TIER_MEM_PSRAM : LV_TIER_MEM_INTERNAL;
+    for (int n = 0; n < LV_TIER_MEM_NUM; n++) {
+        lv_tier_mem_tier_t id = (lv_tier_mem_tier_t)((first + n) % LV_TIER_MEM_NUM);
+        tier_t *t = &tiers[id];
+        for (uint32_t i = 0; i < t->pool_cnt; i++) {
+            tier_pool_t *pool = &t->pools[i];
+            if ((uint8_t *)p >= pool->start && (uint8_t *)p < pool->start + pool->size) {
+                *out_id = id;
+                return pool;
+            }
+        }
+    }
+    return NULL;
+}
+
+static bool tier_add_pool(tier_t *t, void *mem, size_t size, bool owned, bool fixed)
+{
+    if (t->pool_cnt == TIER_POOLS_MAX) {
+        return false;
+    }
+    multi_heap_handle_t heap = multi_heap_register(mem, size);
+    if (heap == NULL) {
+        return false;
+    }
+    tier_pool_t *pool = &t->pools[t->pool_cnt++];
+    pool->heap = heap;
+    pool->start = (uint8_t *)mem;
+    pool->size = size;
+    pool->owned = owned;
+    pool->fixed = fixed;
+    t->total += size;
+    return true;
+}
+
+static void tier_remove_pool(tier_t *t, uint32_t index)
+{
+    multi_heap_info_t info;
+    multi_heap_get_info(t->pools[index].heap, &info);
+    t->used -= info.total_allocated_bytes < t->used ? info.total_allocated_bytes : t->used;
+    t->blocks -= info.allocated_blocks < t->blocks ? info.allocated_blocks : t->blocks;
+    t->total -= t->pools[index].size;
+    t->pool_cnt--;
+    memmove(&t->pools[index], &t->pools[index + 1], (t->pool_cnt - index) * sizeof(tier_pool_t));
+}
+
+static bool tier_grow(lv_tier_mem_tier_t id, size_t need)
+{
+    tier_t *t = &tiers[id];
+    size_t limit = id == LV_TIER_MEM_INTERNAL ? tier_policy.internal_limit : tier_policy.psram_limit;
+    size_t min = (need + TIER_POOL_MARGIN + TIER_POOL_ALIGN - 1) & ~(size_t)(TIER_POOL_ALIGN - 1);
+    size_t size = t->step > min ? t->step : min;
+
+    if (id == LV_TIER_MEM_PSRAM && !tier_has_psram) {
+        return false;
+    }
+    if (t->total + size > limit) {
+        size = limit > t->total ? limit - t->total : 0;
+    }
+    if (size < min) {
+        return false;
+    }
+
+    void *mem = heap_caps_malloc(size, t->caps);
+    if (mem == NULL) {
+        return false;
+    }
+    if (!tier_add_pool(t, mem, size, true, false)) {
+        heap_caps_free(mem);
+        return false;
+    }
+    t->grows++;
+    return true;
+}
+
+static void *tier_alloc(lv_tier_mem_tier_t id, size_t size)
+{
+    tier_t *t = &tiers[id];
+
+    for (uint32_t i = 0; i < t->pool_cnt; i++) {
+        void *p = multi_heap_malloc(t->pools[i].heap, size);
+        if (p) {
+            tier_account(t, t->pools[i].heap, p);
+            return p;
+        }
+    }
+    if (tier_grow(id, size)) {
+        multi_heap_handle_t heap = t->pools[t->pool_cnt - 1].heap;
+        void *p = multi_heap_malloc(heap, size);
+        if (p) {
+            tier_account(t, heap, p);
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/* With the lock held. A block stays in its tier, unless it grows too large for internal RAM */
+static void *tier_realloc(void *p, size_t new_size)
+{
+    lv_tier_mem_tier_t id;
+    tier_pool_t *pool = tier_find(p, &id);
+    if (pool == NULL) {
+        ESP_LOGE(TAG, "realloc of %p, not in the heap", p);
+        return NULL;
+    }
+
+    tier_t *t = &tiers[id];
+    size_t old_size = multi_heap_get_allocated_size(pool->heap, p);
+    bool move = id == LV_TIER_MEM_INTERNAL && tier_pick(new_size) == LV_TIER_MEM_PSRAM;
+    if (!move) {
+        void *q = multi_heap_realloc(pool->heap, p, new_size);
+        if (q) {
+            t->used -= old_size;
+            t->blocks--;
+            tier_account(t, pool->heap, q);
+            return q;
+        }
+    }
+
+    /* Not in place: in another pool, or in the other tier */
+    void *q = move ? tier_alloc(LV_TIER_MEM_PSRAM, new_size) : NULL;
+    if (q == NULL) {
+        q = tier_mem_alloc(new_size);
+    }
+    if (q) {
+        memcpy(q, p, old_size < new_size ? old_size : new_size);
+        t->used -= old_size;
+        t->blocks--;
+        multi_heap_free(pool->heap, p);
+    }
+    return q;
+}
+
+/* With the lock held */
+static void tier_free(void *p)
+{
+    lv_tier_mem_tier_t id;
+    tier_pool_t *pool = tier_find(p, &id);
+    if (pool == NULL) {
+        ESP_LOGE(TAG, "free of %p, not in the heap", p);
+        return;
+    }
+    tiers[id].used -= multi_heap_get_allocated_size(pool->heap, p);
+    tiers[id].blocks--;
+    multi_heap_free(pool->heap, p);
+}
+
+#if CONFIG_LV_TIER_MEM_TAGS
+/* With the lock held. Writes the tag word at the start of the block, returns what LVGL gets */
+static void *tier_tag_put(void *block, size_t size, uint8_t tag)
+{
+    uint32_t word = ((uint32_t)tag << TIER_TAG_SHIFT) | (size & TIER_TAG_SIZE_MASK);
+
+    if (tier_account_cb) {
+        word |= TIER_TAG_ACCOUNTED;
+        tier_account_cb(tag, esp_ptr_external_ram(block) ? LV_TIER_MEM_PSRAM : LV_TIER_MEM_INTERNAL, (int32_t)size);
+    }
+    *(uint32_t *)block = word;
+    return (uint8_t *)block + TIER_TAG_SIZE;
+}
+
+/* With the lock held. Takes the bytes of a block off its tag, returns the block */
+static void *tier_tag_take(void *p)
+{
+    uint32_t *block = (uint32_t *)((uint8_t *)p - TIER_TAG_SIZE);
+
+    /* Blocks from before the callback was set were never added */
+    if ((*block & TIER_TAG_ACCOUNTED) && tier_account_cb) {
+        tier_account_cb(*block >> TIER_TAG_SHIFT, esp_ptr_external_ram(block) ? LV_TIER_MEM_PSRAM : LV_TIER_MEM_INTERNAL,
+                        -(int32_t)(*block & TIER_TAG_SIZE_MASK));
+    }
+    return block;
+}
+#endif
+
+/* With the lock held */
+static void *tier_mem_alloc(size_t size)
+{
+    lv_tier_mem_tier_t id = tier_pick(size);
+    void *p = tier_alloc(id, size);
+
+    if (p == NULL) {
+        p = tier_alloc(id == LV_TIER_MEM_INTERNAL ? LV_TIER_MEM_PSRAM : LV_TIER_MEM_INTERNAL, size);
+        if (p) {
+            tiers[id].spills++;
+        } else {
+            tiers[id].failed++;
+        }
+    }
+    return p;
+}
+
+static lv_tier_mem_tier_t tier_pick(size_t size)
+{
+    if (!tier_has_psram || tier_policy.psram_limit == 0) {
+        return LV_TIER_MEM_INTERNAL;
+    }
+    if (size > tier_policy.small_max) {
+        return LV_TIER_MEM_PSRAM;
+    }
+    if (cold_depth && cold_task == xTaskGetCurrentTaskHandle()) {
+        return LV_TIER_MEM_PSRAM;
+    }
+    return LV_TIER_MEM_INTERNAL;
+}
+
+static void tier_account(tier_t *t, multi_heap_handle_t heap, void *p)
+{
+    t->used += multi_heap_get_allocated_size(heap, p);
+    t->blocks++;
+    t->allocs++;
+    if (t->used > t->peak) {
+        t->peak = t->used;
+    }
+}
+
+static void tier_lock(void)
+{
+    if (tier_mutex) {
+        xSemaphoreTake(tier_mutex, portMAX_DELAY);
+    }
+}
+
+static void tier_unlock(void)
+{
+    if (tier_mutex) {
+        xSemaphoreGive(tier_mutex);
+    }
+}
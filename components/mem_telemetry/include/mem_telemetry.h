@@ -0,0 +1,219 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Memory telemetry: who holds the heap, and how close the task stacks got to the end
+ *
+ * The mem_tel_ allocation functions are heap_caps_ with a tag of the subsystem the bytes are
+ * for. Blocks of the LVGL heap are tagged too when the tiered LVGL heap tags them
+ * (CONFIG_LV_TIER_MEM_TAGS): MEM_TEL_LVGL, or the tag of mem_tel_scope_begin() of the task.
+ * A task samples the stack high-water mark of all tasks. mem_tel_report() prints it all on
+ * the console, mem_tel_snapshot() packs it for scripts/mem_snapshot.py, which shows and diffs
+ * snapshots of two builds.
+ *
+ * With CONFIG_MEM_TELEMETRY off the allocation functions are the heap_caps_ ones and the
+ * rest does nothing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Subsystems the bytes are counted for
+ *
+ */
+typedef enum {
+    MEM_TEL_OTHER = 0,
+    MEM_TEL_LVGL,           /*!< LVGL heap blocks outside of a scope: objects, styles, draw layers */
+    MEM_TEL_EXPLORER,       /*!< Directory entries and names, sort and scan state, list rows */
+    MEM_TEL_FILE_BUF,       /*!< SD bounce and read-ahead buffers */
+    MEM_TEL_DRAW_BUF,       /*!< Display draw buffers */
+    MEM_TEL_IMAGE,          /*!< Decoded images, thumbnails, decoder work areas */
+    MEM_TEL_TEXT,           /*!< Text files and pages */
+    MEM_TEL_GLYPH,          /*!< Glyph cache */
+    MEM_TEL_TAG_NUM,
+} mem_tel_tag_t;
+
+/**
+ * @brief Bytes of a tag, as the heaps round them up
+ *
+ */
+typedef struct {
+    uint32_t heap_internal;     /*!< System heap, internal RAM */
+    uint32_t heap_psram;        /*!< System heap, PSRAM */
+    uint32_t lvgl_internal;     /*!< LVGL heap, internal RAM */
+    uint32_t lvgl_psram;        /*!< LVGL heap, PSRAM */
+    uint32_t peak;              /*!< Highest sum of the four */
+    uint32_t allocs;            /*!< Allocations and reallocations */
+    uint32_t failed;            /*!< Allocations that returned NULL */
+} mem_tel_counters_t;
+
+/**
+ * @brief Lowest free stack seen of a task
+ *
+ */
+typedef struct {
+    char name[16];
+    uint32_t min_free;          /*!< Bytes never touched, over all the samples */
+    bool alive;                 /*!< Seen in the last sample */
+} mem_tel_stack_t;
+
+#if CONFIG_MEM_TELEMETRY
+
+/**
+ * @brief Start the telemetry: tag the LVGL heap and sample the stacks every
+ * CONFIG_MEM_TELEMETRY_PERIOD_MS. Call before lv_init(), the blocks allocated earlier are not counted.
+ *
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_NO_MEM        if the sampling task could not be created
+ */
+esp_err_t mem_tel_init(void);
+
+void *mem_tel_malloc(mem_tel_tag_t tag, size_t size, uint32_t caps);
+void *mem_tel_calloc(mem_tel_tag_t tag, size_t n, size_t size, uint32_t caps);
+/* heap_caps_malloc_prefer(size, 2, caps, fallback_caps) */
+void *mem_tel_malloc_prefer(mem_tel_tag_t tag, size_t size, uint32_t caps, uint32_t fallback_caps);
+void *mem_tel_calloc_prefer(mem_tel_tag_t tag, size_t n, size_t size, uint32_t caps, uint32_t fallback_caps);
+void *mem_tel_realloc_prefer(mem_tel_tag_t tag, void *p, size_t size, uint32_t caps, uint32_t fallback_caps);
+
+/**
+ * @brief Free a block of the mem_tel_ functions
+ *
+ * @param tag: Tag it was allocated with
+ * @param p: Block, or NULL
+ */
+void mem_tel_free(mem_tel_tag_t tag, void *p);
+
+/**
+ * @brief Count the LVGL heap blocks the calling task allocates for a tag, until
+ * mem_tel_scope_end(). Calls nest 4 deep.
+ *
+ */
+void mem_tel_scope_begin(mem_tel_tag_t tag);
+
+/**
+ * @brief End mem_tel_scope_begin()
+ *
+ */
+void mem_tel_scope_end(void);
+
+/**
+ * @brief Sample the stacks now, the task does it periodically
+ *
+ */
+void mem_tel_sample_stacks(void);
+
+/**
+ * @brief Get the bytes of a tag
+ *
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter is invalid
+ */
+esp_err_t mem_tel_get_counters(mem_tel_tag_t tag, mem_tel_counters_t *counters);
+
+/**
+ * @brief Get the stack of the index-th task seen
+ *
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_NOT_FOUND     past the last task
+ */
+esp_err_t mem_tel_get_stack(uint32_t index, mem_tel_stack_t *stack);
+
+/**
+ * @brief Print the heaps, the tags and the stacks on the console
+ *
+ */
+void mem_tel_report(void);
+
+/**
+ * @brief Pack the heaps, the tags and the stacks, see scripts/mem_snapshot.py for the format
+ *
+ * @param buf: Where to write, NULL to get the size
+ * @param size: Room in buf
+ *
+ * @return Bytes of the snapshot, 0 if it does not fit
+ */
+size_t mem_tel_snapshot(void *buf, size_t size);
+
+/**
+ * @brief Print a snapshot on the console as one "MTEL1 <hex>" line, for mem_snapshot.py to take from the log
+ *
+ */
+void mem_tel_print_snapshot(void);
+
+/**
+ * @brief Write a snapshot to a file
+ *
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_NO_MEM        if the snapshot could not be allocated
+ *      - ESP_FAIL              if the file could not be written
+ */
+esp_err_t mem_tel_write_snapshot(const char *path);
+
+/**
+ * @brief Name of the tag for logs
+ *
+ */
+const char *mem_tel_tag_name(mem_tel_tag_t tag);
+
+#else
+
+static inline esp_err_t mem_tel_init(void)
+{
+    return ESP_OK;
+}
+static inline void *mem_tel_malloc(mem_tel_tag_t tag, size_t size, uint32_t caps)
+{
+    return heap_caps_malloc(size, caps);
+}
+static inline void *mem_tel_calloc(mem_tel_tag_t tag, size_t n, size_t size, uint32_t caps)
+{
+    return heap_caps_calloc(n, size, caps);
+}
+static inline void *mem_tel_malloc_prefer(mem_tel_tag_t tag, size_t size, uint32_t caps, uint32_t fallback_caps)
+{
+    return heap_caps_malloc_prefer(size, 2, caps, fallback_caps);
+}
+static inline void *mem_tel_calloc_prefer(mem_tel_tag_t tag, size_t n, size_t size, uint32_t caps,
+                                          uint32_t fallback_caps)
+{
+    return heap_caps_calloc_prefer(n, size, 2, caps, fallback_caps);
+}
+static inline void *mem_tel_realloc_prefer(mem_tel_tag_t tag, void *p, size_t size, uint32_t caps,
+                                           uint32_t fallback_caps)
+{
+    return heap_caps_realloc_prefer(p, size, 2, caps, fallback_caps);
+}
+static inline void mem_tel_free(mem_tel_tag_t tag, void *p)
+{
+    heap_caps_free(p);
+}
+static inline void mem_tel_scope_begin(mem_tel_tag_t tag) {}
+static inline void mem_tel_scope_end(void) {}
+static inline void mem_tel_sample_stacks(void) {}
+static inline void mem_tel_report(void) {}
+static inline void mem_tel_print_snapshot(void) {}
+
+#endif /* CONFIG_MEM_TELEMETRY */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,467 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#include "esp_timer.h"
+#include "esp_app_desc.h"
+#include "lvgl.h"
+#include "mem_telemetry.h"
+#if CONFIG_LV_TIER_MEM_TAGS
+#include "lv_tier_mem.h"
+#endif
+
+#if CONFIG_MEM_TELEMETRY
+
+static const char *TAG = "mem_tel";
+
+#define MEM_TEL_SCOPE_DEPTH     4
+#define MEM_TEL_STACKS          32
+#define MEM_TEL_TASK_STACK      3072
+/* Snapshot, little endian, see scripts/mem_snapshot.py */
+#define MEM_TEL_MAGIC           0x4C45544DUL    /* "MTEL" */
+#define MEM_TEL_VERSION         1
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t tag_count;
+    uint16_t stack_count;
+    uint16_t reserved;
+    uint32_t uptime_ms;
+    char app_version[32];
+    uint8_t elf_sha256[8];
+    uint32_t internal_free;
+    uint32_t internal_min_free;
+    uint32_t internal_largest;
+    uint32_t psram_free;
+    uint32_t psram_min_free;
+    uint32_t psram_largest;
+    uint32_t lvgl_total;
+    uint32_t lvgl_used;
+    uint32_t lvgl_max_used;
+} mem_tel_snap_header_t;
+
+typedef struct __attribute__((packed)) {
+    char name[12];
+    mem_tel_counters_t counters;
+} mem_tel_snap_tag_t;
+
+typedef struct __attribute__((packed)) {
+    char name[16];
+    uint32_t min_free;
+} mem_tel_snap_stack_t;
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+static void mem_tel_add(mem_tel_tag_t tag, void *p, int32_t bytes);
+static void mem_tel_added(mem_tel_tag_t tag, void *p);
+static void mem_tel_count(mem_tel_counters_t *c, uint32_t *field, int32_t bytes);
+static void mem_tel_task(void *arg);
+#if CONFIG_LV_TIER_MEM_TAGS
+static uint8_t mem_tel_lv_tag(void);
+static void mem_tel_lv_account(uint8_t tag, lv_tier_mem_tier_t tier, int32_t bytes);
+#endif
+
+/*******************************************************************************
+* Local variables
+*******************************************************************************/
+static portMUX_TYPE mem_tel_mux = portMUX_INITIALIZER_UNLOCKED;
+static mem_tel_counters_t counters[MEM_TEL_TAG_NUM];
+static mem_tel_stack_t stacks[MEM_TEL_STACKS];
+static uint32_t stack_count;
+static TaskHandle_t scope_task;
+static uint8_t scope_tags[MEM_TEL_SCOPE_DEPTH];
+static uint32_t scope_depth;
+static TaskHandle_t sample_task;
+
+static const char *const tag_names[MEM_TEL_TAG_NUM] = {
+    "other", "lvgl", "explorer", "file buf", "draw buf", "image", "text", "glyph",
+};
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t mem_tel_init(void)
+{
+#if CONFIG_LV_TIER_MEM_TAGS
+    lv_tier_mem_set_tag_cbs(mem_tel_lv_tag, mem_tel_lv_account);
+#endif
+    if (CONFIG_MEM_TELEMETRY_PERIOD_MS > 0 && sample_task == NULL) {
+        ESP_RETURN_ON_FALSE(xTaskCreate(mem_tel_task, "mem_tel", MEM_TEL_TASK_STACK, NULL, tskIDLE_PRIORITY + 1,
+                                        &sample_task) == pdPASS, ESP_ERR_NO_MEM, TAG, "no mem for sampling task");
+    }
+    return ESP_OK;
+}
+
+void *mem_tel_malloc(mem_tel_tag_t tag, size_t size, uint32_t caps)
+{
+    void *p = heap_caps_malloc(size, caps);
+    mem_tel_added(tag, p);
+    return p;
+}
+
+void *mem_tel_calloc(mem_tel_tag_t tag, size_t n, size_t size, uint32_t caps)
+{
+    void *p = heap_caps_calloc(n, size, caps);
+    mem_tel_added(tag, p);
+    return p;
+}
+
+void *mem_tel_malloc_prefer(mem_tel_tag_t tag, size_t size, uint32_t caps, uint32_t fallback_caps)
+{
+    void *p = heap_caps_malloc_prefer(size, 2, caps, fallback_caps);
+    mem_tel_added(tag, p);
+    return p;
+}
+
+void *mem_tel_calloc_prefer(mem_tel_tag_t tag, size_t n, size_t size, uint32_t caps, uint32_t fallback_caps)
+{
+    void *p = heap_caps_calloc_prefer(n, size, 2, caps, fallback_caps);
+    mem_tel_added(tag, p);
+    return p;
+}
+
+void *mem_tel_realloc_prefer(mem_tel_tag_t tag, void *p, size_t size, uint32_t caps, uint32_t fallback_caps)
+{
+    size_t old_size = p ? heap_caps_get_allocated_size(p) : 0;
+    bool old_psram = p && esp_ptr_external_ram(p);
+
+    void *q = heap_caps_realloc_prefer(p, size, 2, caps, fallback_caps);
+    if (q == NULL && size) {
+        /* p is untouched */
+        mem_tel_added(tag, NULL);
+        return NULL;
+    }
+    if (p) {
+        /* The bytes of the old block come off where it was */
+        mem_tel_counters_t *c = &counters[tag < MEM_TEL_TAG_NUM ? tag : MEM_TEL_OTHER];
+        mem_tel_count(c, old_psram ? &c->heap_psram : &c->heap_internal, -(int32_t)old_size);
+    }
+    if (q) {
+        mem_tel_added(tag, q);
+    }
+    return q;
+}
+
+void mem_tel_free(mem_tel_tag_t tag, void *p)
+{
+    if (p == NULL) {
+        return;
+    }
+    mem_tel_add(tag, p, -(int32_t)heap_caps_get_allocated_size(p));
+    heap_caps_free(p);
+}
+
+void mem_tel_scope_begin(mem_tel_tag_t tag)
+{
+    portENTER_CRITICAL(&mem_tel_mux);
+    if (scope_depth == 0) {
+        scope_task = xTaskGetCurrentTaskHandle();
+    }
+    if (scope_task == xTaskGetCurrentTaskHandle()) {
+        if (scope_depth < MEM_TEL_SCOPE_DEPTH) {
+            scope_tags[scope_depth] = tag;
+        }
+        scope_depth++;
+    }
+    portEXIT_CRITICAL(&mem_tel_mux);
+}
+
+void mem_tel_scope_end(void)
+{
+    portENTER_CRITICAL(&mem_tel_mux);
+    if (scope_depth > 0 && scope_task == xTaskGetCurrentTaskHandle()) {
+        scope_depth--;
+    }
+    portEXIT_CRITICAL(&mem_tel_mux);
+}
+
+void mem_tel_sample_stacks(void)
+{
+    static TaskStatus_t status[MEM_TEL_STACKS];
+
+    /* Keeps the lowest free stack by name, the explorer tasks come and go */
+    UBaseType_t n = uxTaskGetSystemState(status, MEM_TEL_STACKS, NULL);
+    portENTER_CRITICAL(&mem_tel_mux);
+    for (uint32_t i = 0; i < stack_count; i++) {
+        stacks[i].alive = false;
+    }
+    for (UBaseType_t t = 0; t < n; t++) {
+        uint32_t free_bytes = status[t].usStackHighWaterMark * sizeof(StackType_t);
+        uint32_t i;
+        for (i = 0; i < stack_count; i++) {
+            if (strncmp(stacks[i].name, status[t].pcTaskName, sizeof(stacks[i].name)) == 0) {
+                break;
+            }
+        }
+        if (i == stack_count) {
+            if (stack_count == MEM_TEL_STACKS) {
+                continue;
+            }
+            strlcpy(stacks[i].name, status[t].pcTaskName, sizeof(stacks[i].name));
+            stacks[i].min_free = free_bytes;
+            stack_count++;
+        }
+        if (free_bytes < stacks[i].min_free) {
+            stacks[i].min_free = free_bytes;
+        }
+        stacks[i].alive = true;
+    }
+    portEXIT_CRITICAL(&mem_tel_mux);
+}
+
+esp_err_t mem_tel_get_counters(mem_tel_tag_t tag, mem_tel_counters_t *out_counters)
+{
+    ESP_RETURN_ON_FALSE(tag < MEM_TEL_TAG_NUM && out_counters, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    portENTER_CRITICAL(&mem_tel_mux);
+    *out_counters = counters[tag];
+    portEXIT_CRITICAL(&mem_tel_mux);
+    return ESP_OK;
+}
+
+esp_err_t mem_tel_get_stack(uint32_t index, mem_tel_stack_t *stack)
+{
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+
+    portENTER_CRITICAL(&mem_tel_mux);
+    if (index < stack_count) {
+        *stack = stacks[index];
+        ret = ESP_OK;
+    }
+    portEXIT_CRITICAL(&mem_tel_mux);
+    return ret;
+}
+
+void mem_tel_report(void)
+{
+    lv_mem_monitor_t mon;
+    mem_tel_counters_t c;
+    mem_tel_stack_t s;
+
+    lv_mem_monitor(&mon);
+    printf("MEM %lu ms | internal free %u min %u largest %u | PSRAM free %u min %u largest %u | "
+           "LVGL %u/%u max %u\n", (unsigned long)(esp_timer_get_time() / 1000),
+           (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+           (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL),
+           (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL),
+           (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+           (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM),
+           (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM),
+           (unsigned)(mon.total_size - mon.free_size), (unsigned)mon.total_size, (unsigned)mon.max_used);
+    printf("%-8s %8s %8s %8s %8s %8s %7s %5s\n", "tag", "heap int", "heap ps", "lv int", "lv ps", "peak", "allocs",
+           "fail");
+    for (int tag = 0; tag < MEM_TEL_TAG_NUM; tag++) {
+        mem_tel_get_counters((mem_tel_tag_t)tag, &c);
+        if (c.allocs == 0 && c.peak == 0) {
+            continue;
+        }
+        printf("%-8s %8lu %8lu %8lu %8lu %8lu %7lu %5lu\n", tag_names[tag], (unsigned long)c.heap_internal,
+               (unsigned long)c.heap_psram, (unsigned long)c.lvgl_internal, (unsigned long)c.lvgl_psram,
+               (unsigned long)c.peak, (unsigned long)c.allocs, (unsigned long)c.failed);
+    }
+    printf("stack min free:");
+    for (uint32_t i = 0; mem_tel_get_stack(i, &s) == ESP_OK; i++) {
+        printf(" %s%s %lu%s", s.name, s.alive ? "" : "(ended)", (unsigned long)s.min_free,
+               s.min_free < CONFIG_MEM_TELEMETRY_STACK_WARN ? "!" : "");
+    }
+    printf("\n");
+}
+
+size_t mem_tel_snapshot(void *buf, size_t size)
+{
+    uint32_t n_stacks = stack_count;
+    size_t need = sizeof(mem_tel_snap_header_t) + MEM_TEL_TAG_NUM * sizeof(mem_tel_snap_tag_t) +
+                  n_stacks * sizeof(mem_tel_snap_stack_t);
+
+    if (buf == NULL) {
+        return need;
+    }
+    if (size < need) {
+        return 0;
+    }
+
+    const esp_app_desc_t *app = esp_app_get_description();
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+
+    mem_tel_snap_header_t h = {0};
+    h.magic = MEM_TEL_MAGIC;
+    h.version = MEM_TEL_VERSION;
+    h.tag_count = MEM_TEL_TAG_NUM;
+    h.stack_count = n_stacks;
+    h.uptime_ms = esp_timer_get_time() / 1000;
+    strlcpy(h.app_version, app->version, sizeof(h.app_version));
+    memcpy(h.elf_sha256, app->app_elf_sha256, sizeof(h.elf_sha256));
+    h.internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    h.internal_min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    h.internal_largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    h.psram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    h.psram_min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM);
+    h.psram_largest = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+    h.lvgl_total = mon.total_size;
+    h.lvgl_used = mon.total_size - mon.free_size;
+    h.lvgl_max_used = mon.max_used;
+
+    uint8_t *out = (uint8_t *)buf;
+    memcpy(out, &h, sizeof(h));
+    out += sizeof(h);
+    for (int tag = 0; tag < MEM_TEL_TAG_NUM; tag++) {
+        mem_tel_snap_tag_t t = {0};
+        mem_tel_counters_t c;
+        strlcpy(t.name, tag_names[tag], sizeof(t.name));
+        /* The record is packed, the counters may not be aligned */
+        mem_tel_get_counters((mem_tel_tag_t)tag, &c);
+        memcpy(&t.counters, &c, sizeof(c));
+        memcpy(out, &t, sizeof(t));
+        out += sizeof(t);
+    }
+    for (uint32_t i = 0; i < n_stacks; i++) {
+        mem_tel_snap_stack_t st = {0};
+        mem_tel_stack_t s;
+        mem_tel_get_stack(i, &s);
+        strlcpy(st.name, s.name, sizeof(st.name));
+        st.min_free = s.min_free;
+        memcpy(out, &st, sizeof(st));
+        out += sizeof(st);
+    }
+    return need;
+}
+
+void mem_tel_print_snapshot(void)
+{
+    size_t size = mem_tel_snapshot(NULL, 0);
+    uint8_t *buf = (uint8_t *)malloc(size);
+    if (buf == NULL) {
+        ESP_LOGE(TAG, "no mem for snapshot");
+        return;
+    }
+    size = mem_tel_snapshot(buf, size);
+    printf("MTEL1 ");
+    for (size_t i = 0; i < size; i++) {
+        printf("%02x", buf[i]);
+    }
+    printf("\n");
+    free(buf);
+}
+
+esp_err_t mem_tel_write_snapshot(const char *path)
+{
+    size_t size = mem_tel_snapshot(NULL, 0);
+    uint8_t *buf = (uint8_t *)malloc(size);
+    ESP_RETURN_ON_FALSE(buf, ESP_ERR_NO_MEM, TAG, "no mem for snapshot");
+    size = mem_tel_snapshot(buf, size);
+
+    esp_err_t ret = ESP_OK;
+    FILE *f = fopen(path, "wb");
+    if (f == NULL || fwrite(buf, 1, size, f) != size) {
+        ESP_LOGE(TAG, "can not write %s", path);
+        ret = ESP_FAIL;
+    }
+    if (f) {
+        fclose(f);
+    }
+    free(buf);
+    return ret;
+}
+
+const char *mem_tel_tag_name(mem_tel_tag_t tag)
+{
+    return tag < MEM_TEL_TAG_NUM ? tag_names[tag] : "?";
+}
+
+/*******************************************************************************
+* Private API function
+*******************************************************************************/
+
+/* System heap bytes of a block, where it is */
+static void mem_tel_add(mem_tel_tag_t tag, void *p, int32_t bytes)
+{
+    mem_tel_counters_t *c = &counters[tag < MEM_TEL_TAG_NUM ? tag : MEM_TEL_OTHER];
+
+    mem_tel_count(c, esp_ptr_external_ram(p) ? &c->heap_psram : &c->heap_internal, bytes);
+}
+
+static void mem_tel_count(mem_tel_counters_t *c, uint32_t *field, int32_t bytes)
+{
+    portENTER_CRITICAL(&mem_tel_mux);
+    if (bytes >= 0) {
+        *field += bytes;
+        c->allocs++;
+        uint32_t sum = c->heap_internal + c->heap_psram + c->lvgl_internal + c->lvgl_psram;
+        if (sum > c->peak) {
+            c->peak = sum;
+        }
+    } else {
+        *field -= (uint32_t)-bytes < *field ? (uint32_t)-bytes : *field;
+    }
+    portEXIT_CRITICAL(&mem_tel_mux);
+}
+
+static void mem_tel_added(mem_tel_tag_t tag, void *p)
+{
+    if (p) {
+        mem_tel_add(tag, p, (int32_t)heap_caps_get_allocated_size(p));
+        return;
+    }
+    portENTER_CRITICAL(&mem_tel_mux);
+    counters[tag < MEM_TEL_TAG_NUM ? tag : MEM_TEL_OTHER].failed++;
+    portEXIT_CRITICAL(&mem_tel_mux);
+}
+
+static void mem_tel_task(void *arg)
+{
+    uint32_t periods = 0;
+
+    while (1) {
+        mem_tel_sample_stacks();
+        periods++;
+        if (CONFIG_MEM_TELEMETRY_REPORT_S > 0 &&
+                periods * CONFIG_MEM_TELEMETRY_PERIOD_MS >= CONFIG_MEM_TELEMETRY_REPORT_S * 1000) {
+            periods = 0;
+            mem_tel_report();
+        }
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_MEM_TELEMETRY_PERIOD_MS));
+    }
+}
+
+#if CONFIG_LV_TIER_MEM_TAGS
+/* With the LVGL heap locked */
+static uint8_t mem_tel_lv_tag(void)
+{
+    uint8_t tag = MEM_TEL_LVGL;
+
+    portENTER_CRITICAL(&mem_tel_mux);
+    if (scope_depth && scope_task == xTaskGetCurrentTaskHandle()) {
+        tag = scope_tags[(scope_depth > MEM_TEL_SCOPE_DEPTH ? MEM_TEL_SCOPE_DEPTH : scope_depth) - 1];
+    }
+    portEXIT_CRITICAL(&mem_tel_mux);
+    return tag;
+}
+
+static void mem_tel_lv_account(uint8_t tag, lv_tier_mem_tier_t tier, int32_t bytes)
+{
+    mem_tel_counters_t *c = &counters[tag < MEM_TEL_TAG_NUM ? tag : MEM_TEL_OTHER];
+
+    mem_tel_count(c, tier == LV_TIER_MEM_PSRAM ? &c->lvgl_psram : &c->lvgl_internal, bytes);
+}
+#endif
+
+#endif /* CONFIG_MEM_TELEMETRY */
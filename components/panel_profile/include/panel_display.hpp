@@ -0,0 +1,122 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief LVGL display on the framebuffer of a panel profile
+ *
+ * panel::Display<panel::Panel<Profile, Rotation>>::create() makes an RGB332 LVGL display of the
+ * size of the rotated panel. Its flush callback writes each rendered area into the framebuffer
+ * with the kernels of the profile, and after the last area of a refresh calls the update
+ * callback with the panel area that changed, to start the panel update of the driver.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "lvgl.h"
+#include "panel_profile.hpp"
+
+namespace panel {
+
+/**
+ * @brief Tells the driver to show the framebuffer
+ *
+ * @param fb: The framebuffer
+ * @param area: What changed since the last call, on the panel
+ * @param user_data: Given to create()
+ */
+typedef void (*update_cb_t)(uint8_t *fb, const lv_area_t *area, void *user_data);
+
+template <class K>
+class Display {
+public:
+    using profile = typename K::profile;
+
+    /**
+     * @brief Create the display, the draw buffers are set with lv_display_set_buffers() after
+     *
+     * @param fb: Framebuffer of profile::size bytes, in the layout of the driver
+     * @param update_cb: Called after the last area of each refresh
+     * @param user_data: For update_cb
+     *
+     * @return The display, NULL if there is not enough memory
+     */
+    static lv_display_t *create(uint8_t *fb, update_cb_t update_cb, void *user_data)
+    {
+        lv_display_t *disp = lv_display_create(K::hor_res, K::ver_res);
+        if (disp == NULL) {
+            return NULL;
+        }
+        state_t *st = (state_t *)lv_malloc_zeroed(sizeof(state_t));
+        if (st == NULL) {
+            lv_display_delete(disp);
+            return NULL;
+        }
+        st->fb = fb;
+        st->update_cb = update_cb;
+        st->user_data = user_data;
+        lv_display_set_driver_data(disp, st);
+        lv_display_set_color_format(disp, LV_COLOR_FORMAT_RGB332);
+        lv_display_set_flush_cb(disp, flush_cb);
+        lv_display_add_event_cb(disp, delete_cb, LV_EVENT_DELETE, NULL);
+        return disp;
+    }
+
+private:
+    typedef struct {
+        uint8_t *fb;
+        update_cb_t update_cb;
+        void *user_data;
+        lv_area_t dirty;        /* On the panel */
+        bool has_dirty;
+    } state_t;
+
+    static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+    {
+        state_t *st = (state_t *)lv_display_get_driver_data(disp);
+
+        K::flush(area->x1, area->y1, area->x2, area->y2, px_map, st->fb);
+
+        /* The corners on the panel, then clipped to it */
+        int32_t ax, ay, bx, by;
+        K::map(area->x1, area->y1, &ax, &ay);
+        K::map(area->x2, area->y2, &bx, &by);
+        lv_area_t a;
+        a.x1 = LV_MAX(LV_MIN(ax, bx), 0);
+        a.y1 = LV_MAX(LV_MIN(ay, by), 0);
+        a.x2 = LV_MIN(LV_MAX(ax, bx), profile::width - 1);
+        a.y2 = LV_MIN(LV_MAX(ay, by), profile::height - 1);
+        if (a.x1 <= a.x2 && a.y1 <= a.y2) {
+            if (st->has_dirty) {
+                st->dirty.x1 = LV_MIN(st->dirty.x1, a.x1);
+                st->dirty.y1 = LV_MIN(st->dirty.y1, a.y1);
+                st->dirty.x2 = LV_MAX(st->dirty.x2, a.x2);
+                st->dirty.y2 = LV_MAX(st->dirty.y2, a.y2);
+            } else {
+                st->dirty = a;
+                st->has_dirty = true;
+            }
+        }
+
+        if (lv_display_flush_is_last(disp) && st->has_dirty) {
+            st->has_dirty = false;
+            if (st->update_cb) {
+                st->update_cb(st->fb, &st->dirty, st->user_data);
+            }
+        }
+        lv_display_flush_ready(disp);
+    }
+
+    static void delete_cb(lv_event_t *e)
+    {
+        lv_display_t *disp = (lv_display_t *)lv_event_get_target(e);
+        lv_free(lv_display_get_driver_data(disp));
+        lv_display_set_driver_data(disp, NULL);
+    }
+};
+
+} // namespace panel
@@ -0,0 +1,406 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Panel profiles: the flush, convert and rotate kernels built for one panel at compile time
+ *
+ * A profile is a type with the size, bits per pixel, pixel order and color of the panel
+ * framebuffer. panel::Panel<Profile, Rotation> writes RGB332 areas, as LVGL renders them, into
+ * that framebuffer. The area is clipped once, the pixel format and the rotation are constants,
+ * so the inner loops convert through a table and write whole bytes where they can.
+ *
+ * panel::generic_flush() is the same write for a panel described at run time. It maps, checks
+ * and converts each pixel on its own like a draw_pixel() call, for panels without a profile.
+ * Both give the same framebuffer.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+
+namespace panel {
+
+/**
+ * @brief Where pixels sit in the bytes of the framebuffer
+ *
+ */
+enum class Order : uint8_t {
+    LowNibbleFirst,     /*!< 4 bpp, even x in bits 0-3 (epdiy) */
+    HighNibbleFirst,    /*!< 4 bpp, even x in bits 4-7 */
+    LsbFirst,           /*!< 1 bpp, x % 8 == 0 in bit 0 (Sharp memory LCD) */
+    MsbFirst,           /*!< 1 bpp, x % 8 == 0 in bit 7 */
+};
+
+/**
+ * @brief What a pixel of the framebuffer holds
+ *
+ */
+enum class Color : uint8_t {
+    Gray,               /*!< Luma of the RGB332 pixel, 0 black */
+    Cfa,                /*!< The channel of the color filter over the pixel: R, G, B shifting by one a row */
+};
+
+/**
+ * @brief Clockwise rotation of the LVGL display on the panel
+ *
+ */
+enum class Rotation : uint8_t {
+    R0,                 /*!< (x, y) on (x, y) */
+    R90,                /*!< (x, y) on (width - 1 - y, x) */
+    R180,               /*!< (x, y) on (width - 1 - x, height - 1 - y) */
+    R270,               /*!< (x, y) on (y, height - 1 - x) */
+};
+
+/**
+ * @brief Framebuffer of a panel, the base of the profiles
+ *
+ */
+template <uint16_t W, uint16_t H, uint8_t BPP, Order ORDER, Color COLOR = Color::Gray>
+struct Profile {
+    static constexpr uint16_t width = W;
+    static constexpr uint16_t height = H;
+    static constexpr uint8_t bpp = BPP;
+    static constexpr Order order = ORDER;
+    static constexpr Color color = COLOR;
+    static constexpr uint32_t stride = (uint32_t)W * BPP / 8;      /*!< Bytes of a row */
+    static constexpr uint32_t size = stride * H;                    /*!< Bytes of the framebuffer */
+
+    static_assert(BPP == 4 || BPP == 1, "4 or 1 bits per pixel");
+    static_assert((BPP == 4) == (ORDER == Order::LowNibbleFirst || ORDER == Order::HighNibbleFirst),
+                  "nibble orders are for 4 bpp, bit orders for 1 bpp");
+    static_assert(W % (8 / BPP) == 0, "rows are whole bytes");
+    static_assert(COLOR == Color::Gray || BPP == 4, "a color filter needs gray levels");
+};
+
+/* 4.7" 960 x 540, LilyGo T5 and epdiy boards */
+struct ED047TC1 : Profile<960, 540, 4, Order::LowNibbleFirst> {
+    static constexpr const char *name = "ED047TC1";
+};
+
+/* 9.7" 1200 x 825 */
+struct ED097OC4 : Profile<1200, 825, 4, Order::LowNibbleFirst> {
+    static constexpr const char *name = "ED097OC4";
+};
+
+/* 6" 800 x 600 */
+struct ED060SC4 : Profile<800, 600, 4, Order::LowNibbleFirst> {
+    static constexpr const char *name = "ED060SC4";
+};
+
+/* Sharp memory LCD LS027B7DH01, 2.7" 400 x 240, 1 is white, lines sent LSB first */
+struct SharpLS027 : Profile<400, 240, 1, Order::LsbFirst> {
+    static constexpr const char *name = "Sharp LS027";
+};
+
+/* 6" Kaleido Plus 1448 x 1072 on epdiy, gray levels under an RGB color filter */
+struct Kaleido : Profile<1448, 1072, 4, Order::LowNibbleFirst, Color::Cfa> {
+    static constexpr const char *name = "Kaleido";
+};
+
+/**
+ * @brief A panel at run time, for generic_flush()
+ *
+ */
+struct Desc {
+    uint16_t width;
+    uint16_t height;
+    uint8_t bpp;
+    Order order;
+    Color color;
+};
+
+template <class P>
+constexpr Desc describe()
+{
+    return Desc{P::width, P::height, P::bpp, P::order, P::color};
+}
+
+/*******************************************************************************
+* Conversion
+*******************************************************************************/
+
+/* 0 to 255 of an RGB332 pixel, as the drivers take it */
+constexpr uint8_t rgb332_luma(uint8_t c)
+{
+    uint32_t r = (c >> 5) * 255 / 7;
+    uint32_t g = ((c >> 2) & 0x7) * 255 / 7;
+    uint32_t b = (c & 0x3) * 255 / 3;
+    return (uint8_t)((r * 77 + g * 150 + b * 29) >> 8);
+}
+
+/* 0 to 255 of a channel of an RGB332 pixel, 0 R, 1 G, 2 B */
+constexpr uint8_t rgb332_channel(uint8_t c, uint32_t channel)
+{
+    return channel == 0 ? (uint8_t)((c >> 5) * 255 / 7) :
+           channel == 1 ? (uint8_t)(((c >> 2) & 0x7) * 255 / 7) : (uint8_t)((c & 0x3) * 255 / 3);
+}
+
+/* The framebuffer value, 4 bits for 4 bpp and 1 bit for 1 bpp */
+constexpr uint8_t to_level(uint8_t v8, uint8_t bpp)
+{
+    return bpp == 4 ? (uint8_t)(v8 >> 4) : (uint8_t)(v8 >= 128);
+}
+
+/* Framebuffer value of each RGB332 value, one table per filter channel */
+template <class P>
+constexpr std::array<std::array<uint8_t, 256>, 3> make_lut()
+{
+    std::array<std::array<uint8_t, 256>, 3> lut{};
+    for (uint32_t ch = 0; ch < 3; ch++) {
+        for (uint32_t c = 0; c < 256; c++) {
+            uint8_t v8 = P::color == Color::Cfa ? rgb332_channel((uint8_t)c, ch) : rgb332_luma((uint8_t)c);
+            lut[ch][c] = to_level(v8, P::bpp);
+        }
+    }
+    return lut;
+}
+
+/*******************************************************************************
+* Specialised kernels
+*******************************************************************************/
+
+/**
+ * @brief A profile seen through a rotation
+ *
+ * @tparam P: Profile
+ * @tparam R: Rotation of the LVGL display
+ */
+template <class P, Rotation R = Rotation::R0>
+struct Panel {
+    using profile = P;
+    static constexpr Rotation rotation = R;
+    static constexpr bool swap_xy = R == Rotation::R90 || R == Rotation::R270;
+    /* Size to give lv_display_create() */
+    static constexpr uint16_t hor_res = swap_xy ? P::height : P::width;
+    static constexpr uint16_t ver_res = swap_xy ? P::width : P::height;
+
+    /**
+     * @brief Map a point of the display to the panel
+     *
+     */
+    static constexpr void map(int32_t x, int32_t y, int32_t *px, int32_t *py)
+    {
+        switch (R) {
+        case Rotation::R0:
+            *px = x;
+            *py = y;
+            break;
+        case Rotation::R90:
+            *px = P::width - 1 - y;
+            *py = x;
+            break;
+        case Rotation::R180:
+            *px = P::width - 1 - x;
+            *py = P::height - 1 - y;
+            break;
+        case Rotation::R270:
+            *px = y;
+            *py = P::height - 1 - x;
+            break;
+        }
+    }
+
+    /**
+     * @brief Write an area of RGB332 pixels into the framebuffer
+     *
+     * @param x1, y1, x2, y2: Area on the display, inclusive, as LVGL gives it. Clipped to the display
+     * @param src: Its pixels, rows of x2 - x1 + 1 bytes
+     * @param fb: Framebuffer of P::size bytes
+     */
+    static void flush(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const uint8_t *src, uint8_t *fb)
+    {
+        const uint32_t src_stride = (uint32_t)(x2 - x1 + 1);
+
+        /* Clipped once, not for every pixel */
+        if (x1 < 0) {
+            src -= x1;
+            x1 = 0;
+        }
+        if (y1 < 0) {
+            src -= (int32_t)src_stride * y1;
+            y1 = 0;
+        }
+        if (x2 >= hor_res) {
+            x2 = hor_res - 1;
+        }
+        if (y2 >= ver_res) {
+            y2 = ver_res - 1;
+        }
+        if (x1 > x2 || y1 > y2) {
+            return;
+        }
+
+        const uint32_t n = (uint32_t)(x2 - x1 + 1);
+        for (int32_t y = y1; y <= y2; y++, src += src_stride) {
+            int32_t px, py;
+            map(x1, y, &px, &py);
+            if (swap_xy) {
+                column(src, n, (uint32_t)px, (uint32_t)py, fb);
+            } else {
+                row(src, n, (uint32_t)px, (uint32_t)py, fb);
+            }
+        }
+    }
+
+private:
+    static constexpr std::array<std::array<uint8_t, 256>, 3> lut = make_lut<P>();
+    /* A step along a display row moves one pixel on the panel, back for these */
+    static constexpr bool backward = R == Rotation::R180 || R == Rotation::R270;
+    static constexpr uint32_t per_byte = 8 / P::bpp;
+
+    static constexpr uint32_t shift(uint32_t px)
+    {
+        if (P::bpp == 4) {
+            return ((px & 1) != 0) == (P::order == Order::LowNibbleFirst) ? 4 : 0;
+        }
+        return P::order == Order::LsbFirst ? (px & 7) : 7 - (px & 7);
+    }
+
+    static inline void put(uint8_t *byte, uint32_t px, uint8_t v)
+    {
+        constexpr uint8_t mask = (1U << P::bpp) - 1;
+        const uint32_t s = shift(px);
+        *byte = (uint8_t)((*byte & ~(mask << s)) | (v << s));
+    }
+
+    /* Channel of the filter at the start, and how it moves with each pixel */
+    static inline uint32_t channel(uint32_t px, uint32_t py)
+    {
+        return P::color == Color::Cfa ? (px + py) % 3 : 0;
+    }
+
+    static inline uint32_t next_channel(uint32_t ch)
+    {
+        if (P::color != Color::Cfa) {
+            return 0;
+        }
+        return backward ? (ch == 0 ? 2 : ch - 1) : (ch == 2 ? 0 : ch + 1);
+    }
+
+    /* R0 and R180: the pixels go along a panel row, whole bytes are packed at once */
+    static inline void row(const uint8_t *s, uint32_t n, uint32_t px, uint32_t py, uint8_t *fb)
+    {
+        uint8_t *line = fb + py * P::stride;
+        uint32_t ch = channel(px, py);
+
+        /* Up to a byte boundary pixel by pixel, then a byte per per_byte pixels */
+        while (n && (backward ? (px % per_byte) != per_byte - 1 : (px % per_byte) != 0)) {
+            put(line + px / per_byte, px, lut[ch][*s++]);
+            ch = next_channel(ch);
+            px = backward ? px - 1 : px + 1;
+            n--;
+        }
+        uint8_t *d = line + px / per_byte;
+        for (; n >= per_byte; n -= per_byte, s += per_byte) {
+            uint8_t b = 0;
+            /* px is at the first pixel of the byte, the shifts are constants */
+            for (uint32_t i = 0; i < per_byte; i++) {
+                b |= (uint8_t)(lut[ch][s[i]] << shift(backward ? per_byte - 1 - i : i));
+                ch = next_channel(ch);
+            }
+            if (backward) {
+                *d-- = b;
+                px -= per_byte;
+            } else {
+                *d++ = b;
+                px += per_byte;
+            }
+        }
+        /* The last pixels */
+        for (; n; n--) {
+            put(line + px / per_byte, px, lut[ch][*s++]);
+            ch = next_channel(ch);
+            px = backward ? px - 1 : px + 1;
+        }
+    }
+
+    /* R90 and R270: the pixels go down a panel column, same bits of a byte one row apart */
+    static inline void column(const uint8_t *s, uint32_t n, uint32_t px, uint32_t py, uint8_t *fb)
+    {
+        constexpr uint8_t mask = (1U << P::bpp) - 1;
+        const uint32_t sh = shift(px);
+        const uint8_t keep = (uint8_t)~(mask << sh);
+        uint8_t *d = fb + py * P::stride + px / per_byte;
+        uint32_t ch = channel(px, py);
+
+        for (; n; n--) {
+            *d = (uint8_t)((*d & keep) | (lut[ch][*s++] << sh));
+            ch = next_channel(ch);
+            if (backward) {
+                d -= P::stride;
+            } else {
+                d += P::stride;
+            }
+        }
+    }
+};
+
+/*******************************************************************************
+* Generic path
+*******************************************************************************/
+
+/**
+ * @brief Write an area of RGB332 pixels into the framebuffer of a panel described at run time
+ *
+ * Each pixel is rotated, checked against the panel, converted and written with the format
+ * looked up again, like a draw_pixel() call for each one.
+ *
+ * @param desc: The panel
+ * @param rotation: Rotation of the LVGL display
+ * @param x1, y1, x2, y2: Area on the display, inclusive
+ * @param src: Its pixels, rows of x2 - x1 + 1 bytes
+ * @param fb: Framebuffer of the panel
+ */
+inline void generic_flush(const Desc &desc, Rotation rotation, int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                          const uint8_t *src, uint8_t *fb)
+{
+    const uint32_t stride = (uint32_t)desc.width * desc.bpp / 8;
+
+    for (int32_t y = y1; y <= y2; y++) {
+        for (int32_t x = x1; x <= x2; x++) {
+            uint8_t c = *src++;
+            int32_t px, py;
+            switch (rotation) {
+            case Rotation::R0:
+                px = x;
+                py = y;
+                break;
+            case Rotation::R90:
+                px = desc.width - 1 - y;
+                py = x;
+                break;
+            case Rotation::R180:
+                px = desc.width - 1 - x;
+                py = desc.height - 1 - y;
+                break;
+            default:
+                px = y;
+                py = desc.height - 1 - x;
+                break;
+            }
+            if (px < 0 || py < 0 || px >= desc.width || py >= desc.height) {
+                continue;
+            }
+            uint8_t v8 = desc.color == Color::Cfa ? rgb332_channel(c, (uint32_t)(px + py) % 3) : rgb332_luma(c);
+            uint8_t *b = fb + (uint32_t)py * stride;
+            if (desc.bpp == 4) {
+                uint8_t v = (uint8_t)(v8 >> 4);
+                b += px / 2;
+                bool high = ((px & 1) != 0) == (desc.order == Order::LowNibbleFirst);
+                *b = high ? (uint8_t)((*b & 0x0F) | (v << 4)) : (uint8_t)((*b & 0xF0) | v);
+            } else {
+                uint8_t bit = desc.order == Order::LsbFirst ? (uint8_t)(1U << (px & 7)) : (uint8_t)(0x80U >> (px & 7));
+                b += px / 8;
+                *b = v8 >= 128 ? (uint8_t)(*b | bit) : (uint8_t)(*b & ~bit);
+            }
+        }
+    }
+}
+
+} // namespace panel
@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Performance build: frame times, and the profile that picks the functions run from IRAM
+ *
+ * perf_iram_start() times the refreshes of a display (CONFIG_PERF_IRAM_FRAME_STATS). In the
+ * profile build (CONFIG_PERF_IRAM_PROFILE) it also counts the cycles of every instrumented
+ * function the calling task runs, and prints the profile after CONFIG_PERF_IRAM_PROFILE_S.
+ * scripts/iram_placement.py turns the profile and the link map into perf_iram.lf, which puts
+ * the hottest functions that fit in CONFIG_PERF_IRAM_BUDGET in IRAM (CONFIG_PERF_IRAM_PLACE).
+ *
+ * Everything is printed as "PIRAM1" lines for the script to take from the console log.
+ */
+
+#pragma once
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_PERF_IRAM_FRAME_STATS || CONFIG_PERF_IRAM_PROFILE
+
+/**
+ * @brief Time the refreshes of disp and, in the profile build, profile the calling task.
+ * Call from the task that runs lv_timer_handler(), pinned to a core, after the display is created.
+ *
+ * @param disp: Display to time, NULL for the default one
+ *
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_STATE if there is no display or it was already called
+ *      - ESP_ERR_NO_MEM        if the LVGL timers could not be created
+ */
+esp_err_t perf_iram_start(lv_display_t *disp);
+
+/**
+ * @brief Print the frame times since the last report and start counting again
+ *
+ */
+void perf_iram_frame_report(void);
+
+/**
+ * @brief Stop profiling and print the profile, the hottest function first. Called after
+ * CONFIG_PERF_IRAM_PROFILE_S, does nothing when not profiling.
+ *
+ */
+void perf_iram_profile_dump(void);
+
+#else
+
+static inline esp_err_t perf_iram_start(lv_display_t *disp)
+{
+    return ESP_OK;
+}
+static inline void perf_iram_frame_report(void) {}
+static inline void perf_iram_profile_dump(void) {}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,273 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lvgl.h"
+#include "perf_iram.h"
+
+#if CONFIG_PERF_IRAM_FRAME_STATS || CONFIG_PERF_IRAM_PROFILE
+
+static const char *TAG = "perf_iram";
+
+#define PERF_IRAM_HASH_BITS     10
+#define PERF_IRAM_FUNCTIONS     (1 << PERF_IRAM_HASH_BITS)
+#define PERF_IRAM_DEPTH         64
+#define PERF_IRAM_NO_INSTR      __attribute__((no_instrument_function))
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+typedef struct {
+    uint32_t count;
+    uint64_t sum_us;
+    uint32_t min_us;
+    uint32_t max_us;
+    int64_t since_us;           /* Start of the report */
+} perf_iram_frames_t;
+
+typedef struct {
+    uint32_t fn;                /* Address, 0 for a free slot */
+    uint32_t calls;
+    uint64_t self;              /* Cycles without the calls it made */
+} perf_iram_fn_t;
+
+typedef struct {
+    uint32_t fn;
+    uint32_t start;             /* Cycle count at the entry */
+    uint32_t callees;           /* Cycles of the calls it made */
+} perf_iram_call_t;
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+#if CONFIG_PERF_IRAM_FRAME_STATS
+static void perf_iram_event_cb(lv_event_t *e);
+static void perf_iram_report_cb(lv_timer_t *t);
+#endif
+#if CONFIG_PERF_IRAM_PROFILE
+static void perf_iram_profile_cb(lv_timer_t *t);
+static int perf_iram_cmp(const void *a, const void *b);
+static void perf_iram_count(uint32_t fn, uint32_t cycles) PERF_IRAM_NO_INSTR;
+void __cyg_profile_func_enter(void *fn, void *call_site) PERF_IRAM_NO_INSTR;
+void __cyg_profile_func_exit(void *fn, void *call_site) PERF_IRAM_NO_INSTR;
+#endif
+
+/*******************************************************************************
+* Local variables
+*******************************************************************************/
+static lv_display_t *frames_disp;
+#if CONFIG_PERF_IRAM_FRAME_STATS
+static perf_iram_frames_t frames;
+static int64_t frame_start;
+static bool frame_rendered;
+#endif
+#if CONFIG_PERF_IRAM_PROFILE
+static TaskHandle_t prof_task;
+static volatile bool prof_on;
+static int64_t prof_start_us;
+static perf_iram_call_t prof_stack[PERF_IRAM_DEPTH];
+static uint32_t prof_depth;
+static perf_iram_fn_t prof_fns[PERF_IRAM_FUNCTIONS];
+static uint32_t prof_used;
+static uint32_t prof_dropped;
+#endif
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t perf_iram_start(lv_display_t *disp)
+{
+    if (disp == NULL) {
+        disp = lv_display_get_default();
+    }
+    ESP_RETURN_ON_FALSE(disp != NULL && frames_disp == NULL, ESP_ERR_INVALID_STATE, TAG, "no display or already started");
+    frames_disp = disp;
+
+#if CONFIG_PERF_IRAM_FRAME_STATS
+    frames.min_us = UINT32_MAX;
+    frames.since_us = esp_timer_get_time();
+    lv_display_add_event_cb(disp, perf_iram_event_cb, LV_EVENT_ALL, NULL);
+    if (CONFIG_PERF_IRAM_REPORT_S > 0) {
+        ESP_RETURN_ON_FALSE(lv_timer_create(perf_iram_report_cb, CONFIG_PERF_IRAM_REPORT_S * 1000, NULL) != NULL,
+                            ESP_ERR_NO_MEM, TAG, "no mem for report timer");
+    }
+#endif
+#if CONFIG_PERF_IRAM_PROFILE
+    lv_timer_t *t = lv_timer_create(perf_iram_profile_cb, CONFIG_PERF_IRAM_PROFILE_S * 1000, NULL);
+    ESP_RETURN_ON_FALSE(t != NULL, ESP_ERR_NO_MEM, TAG, "no mem for profile timer");
+    lv_timer_set_repeat_count(t, 1);
+    ESP_LOGI(TAG, "profiling %s for %d s", pcTaskGetName(NULL), CONFIG_PERF_IRAM_PROFILE_S);
+    prof_task = xTaskGetCurrentTaskHandle();
+    prof_start_us = esp_timer_get_time();
+    prof_on = true;
+#endif
+    return ESP_OK;
+}
+
+void perf_iram_frame_report(void)
+{
+#if CONFIG_PERF_IRAM_FRAME_STATS
+    int64_t now = esp_timer_get_time();
+
+    if (frames.count) {
+        printf("PIRAM1 frames %u avg %u min %u max %u us in %u ms\n", (unsigned)frames.count,
+               (unsigned)(frames.sum_us / frames.count), (unsigned)frames.min_us, (unsigned)frames.max_us,
+               (unsigned)((now - frames.since_us) / 1000));
+    }
+    memset(&frames, 0, sizeof(frames));
+    frames.min_us = UINT32_MAX;
+    frames.since_us = now;
+#endif
+}
+
+void perf_iram_profile_dump(void)
+{
+#if CONFIG_PERF_IRAM_PROFILE
+    if (!prof_on) {
+        return;
+    }
+    prof_on = false;
+    uint32_t ms = (esp_timer_get_time() - prof_start_us) / 1000;
+
+    /* The table is not needed as a hash any more */
+    qsort(prof_fns, PERF_IRAM_FUNCTIONS, sizeof(perf_iram_fn_t), perf_iram_cmp);
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < prof_used; i++) {
+        total += prof_fns[i].self;
+    }
+    printf("PIRAM1 profile %u functions %u dropped %u ms %d MHz %llu cycles\n", (unsigned)prof_used,
+           (unsigned)prof_dropped, (unsigned)ms, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, (unsigned long long)total);
+    for (uint32_t i = 0; i < prof_used; i++) {
+        printf("PIRAM1 fn %08x %u %llu\n", (unsigned)prof_fns[i].fn, (unsigned)prof_fns[i].calls,
+               (unsigned long long)prof_fns[i].self);
+    }
+    printf("PIRAM1 end\n");
+#endif
+}
+
+/*******************************************************************************
+* Private API function
+*******************************************************************************/
+
+#if CONFIG_PERF_IRAM_FRAME_STATS
+/* A frame is a refresh that rendered something, up to the end of its last flush */
+static void perf_iram_event_cb(lv_event_t *e)
+{
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_REFR_START:
+        frame_start = esp_timer_get_time();
+        frame_rendered = false;
+        break;
+    case LV_EVENT_RENDER_START:
+        frame_rendered = true;
+        break;
+    case LV_EVENT_REFR_READY:
+        if (frame_rendered) {
+            uint32_t us = esp_timer_get_time() - frame_start;
+            frames.count++;
+            frames.sum_us += us;
+            frames.min_us = LV_MIN(frames.min_us, us);
+            frames.max_us = LV_MAX(frames.max_us, us);
+            frame_rendered = false;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void perf_iram_report_cb(lv_timer_t *t)
+{
+    perf_iram_frame_report();
+}
+#endif
+
+#if CONFIG_PERF_IRAM_PROFILE
+static void perf_iram_profile_cb(lv_timer_t *t)
+{
+    perf_iram_profile_dump();
+}
+
+/* Most cycles first, the free slots last */
+static int perf_iram_cmp(const void *a, const void *b)
+{
+    const perf_iram_fn_t *fa = a, *fb = b;
+
+    if (fa->self != fb->self) {
+        return fa->self < fb->self ? 1 : -1;
+    }
+    return fa->fn < fb->fn ? 1 : (fa->fn > fb->fn ? -1 : 0);
+}
+
+static void IRAM_ATTR perf_iram_count(uint32_t fn, uint32_t cycles)
+{
+    uint32_t i = ((fn >> 2) * 2654435761u) >> (32 - PERF_IRAM_HASH_BITS);
+
+    for (uint32_t n = 0; n < PERF_IRAM_FUNCTIONS; n++, i = (i + 1) & (PERF_IRAM_FUNCTIONS - 1)) {
+        perf_iram_fn_t *f = &prof_fns[i];
+        if (f->fn == fn) {
+            f->calls++;
+            f->self += cycles;
+            return;
+        }
+        if (f->fn == 0) {
+            f->fn = fn;
+            f->calls = 1;
+            f->self = cycles;
+            prof_used++;
+            return;
+        }
+    }
+    prof_dropped++;
+}
+
+/* -finstrument-functions calls these around every function of the profiled components */
+void IRAM_ATTR __cyg_profile_func_enter(void *fn, void *call_site)
+{
+    if (!prof_on || xTaskGetCurrentTaskHandle() != prof_task) {
+        return;
+    }
+    if (prof_depth < PERF_IRAM_DEPTH) {
+        perf_iram_call_t *c = &prof_stack[prof_depth];
+        c->fn = (uint32_t)(uintptr_t)fn;
+        c->callees = 0;
+        c->start = esp_cpu_get_cycle_count();
+    }
+    prof_depth++;
+}
+
+void IRAM_ATTR __cyg_profile_func_exit(void *fn, void *call_site)
+{
+    uint32_t now = esp_cpu_get_cycle_count();
+
+    /* Exits of the calls entered before perf_iram_start() are not counted */
+    if (!prof_on || xTaskGetCurrentTaskHandle() != prof_task || prof_depth == 0) {
+        return;
+    }
+    if (--prof_depth >= PERF_IRAM_DEPTH) {
+        return;     /* Deeper than the stack: its cycles go to the deepest call kept */
+    }
+    perf_iram_call_t *c = &prof_stack[prof_depth];
+    perf_iram_count(c->fn, now - c->start - c->callees);
+    if (prof_depth > 0) {
+        /* Read again, so the caller does not get the cycles of the counting */
+        prof_stack[prof_depth - 1].callees += esp_cpu_get_cycle_count() - c->start;
+    }
+}
+#endif
+
+#endif /* CONFIG_PERF_IRAM_FRAME_STATS || CONFIG_PERF_IRAM_PROFILE */
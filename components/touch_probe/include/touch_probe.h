@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Touch controller auto-probe
+ *
+ * Finds which touch controller is on the I2C bus by checking only the known addresses, reads the
+ * ID registers and creates the matching esp_lcd_touch driver. The result is cached in NVS, later
+ * boots read the ID at the cached address only and skip the probe when it is the same controller.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "driver/i2c.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_touch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Controllers the probe knows
+ *
+ */
+typedef enum {
+    TOUCH_PROBE_CHIP_NONE = 0,
+    TOUCH_PROBE_CHIP_GT911,     /*!< Goodix, 0x5D or 0x14 */
+    TOUCH_PROBE_CHIP_TMA445,    /*!< Cypress TTSP Gen3 (Kindle), 0x24 */
+    TOUCH_PROBE_CHIP_TT21100,   /*!< Parade TrueTouch, 0x24 */
+    TOUCH_PROBE_CHIP_FT6X36,    /*!< FocalTech, 0x38 */
+} touch_probe_chip_t;
+
+/**
+ * @brief Probe configuration
+ *
+ */
+typedef struct {
+    i2c_port_t port;                /*!< I2C port, the driver must be installed already */
+    esp_lcd_touch_config_t touch;   /*!< Passed to the driver that matches */
+    uint16_t timeout_ms;            /*!< Timeout of each probe transaction */
+    bool no_cache;                  /*!< Always probe, do not read or write NVS */
+} touch_probe_config_t;
+
+/**
+ * @brief Default probe configuration, touch settings still have to be filled in
+ *
+ */
+#define TOUCH_PROBE_DEFAULT_CONFIG()    \
+    {                                   \
+        .port = I2C_NUM_0,              \
+        .touch = {                      \
+            .rst_gpio_num = -1,         \
+            .int_gpio_num = -1,         \
+        },                              \
+        .timeout_ms = 10,               \
+        .no_cache = false,              \
+    }
+
+/**
+ * @brief What was found and created
+ *
+ */
+typedef struct {
+    touch_probe_chip_t chip;
+    uint8_t addr;                   /*!< 7 bit I2C address */
+    bool from_cache;                /*!< Taken from NVS, no probe was needed */
+    uint32_t probe_us;              /*!< Time to identify the controller */
+    uint32_t total_us;              /*!< Including the driver initialisation */
+    esp_lcd_panel_io_handle_t io;   /*!< Panel IO created for the controller */
+    esp_lcd_touch_handle_t tp;      /*!< Touch handle, NULL when no driver is built in for the chip */
+} touch_probe_result_t;
+
+/**
+ * @brief Find the controller and create its driver
+ *
+ * @param config: Probe configuration
+ * @param out_result: Result
+ *
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *      - ESP_ERR_NOT_FOUND     if no known controller answers
+ *      - ESP_ERR_NOT_SUPPORTED if the controller was identified but its driver is not built in
+ */
+esp_err_t touch_probe_new(const touch_probe_config_t *config, touch_probe_result_t *out_result);
+
+/**
+ * @brief Run touch_probe_new() in a background task, so it overlaps with display init
+ *
+ * @param config: Probe configuration, copied
+ *
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_STATE if a probe is already running
+ *      - ESP_ERR_NO_MEM        if the task could not be created
+ */
+esp_err_t touch_probe_start(const touch_probe_config_t *config);
+
+/**
+ * @brief Wait for the probe started with touch_probe_start()
+ *
+ * @param timeout: Ticks to wait
+ * @param out_result: Result
+ *
+ * @return
+ *      - Return value of touch_probe_new()
+ *      - ESP_ERR_TIMEOUT       if the probe has not finished
+ *      - ESP_ERR_INVALID_STATE if no probe was started
+ */
+esp_err_t touch_probe_wait(TickType_t timeout, touch_probe_result_t *out_result);
+
+/**
+ * @brief Drop the cached result, the next boot probes again
+ *
+ * @return
+ *      - ESP_OK on success, otherwise the NVS error
+ */
+esp_err_t touch_probe_forget(void);
+
+/**
+ * @brief Name of the chip for logs
+ *
+ */
+const char *touch_probe_chip_name(touch_probe_chip_t chip);
+
+#ifdef __cplusplus
+}
+#endif
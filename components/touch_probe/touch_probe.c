@@ -0,0 +1,431 @@
+/*
+ * SPDX-FileCopyrightText: 2024 FASANI CORPORATION
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_touch.h"
+#include "esp_lcd_touch_gt911.h"
+#include "touch_tma445.h"
+#include "touch_probe.h"
+
+/* Drivers that are not part of this repository are used when their component is added */
+#if __has_include("esp_lcd_touch_tt21100.h")
+#include "esp_lcd_touch_tt21100.h"
+#define TOUCH_PROBE_HAS_TT21100 1
+#endif
+#if __has_include("esp_lcd_touch_ft5x06.h")
+#include "esp_lcd_touch_ft5x06.h"
+#define TOUCH_PROBE_HAS_FT5X06 1
+#endif
+
+static const char *TAG = "touch_probe";
+
+#define TOUCH_PROBE_NVS_NAMESPACE   "touch_probe"
+#define TOUCH_PROBE_NVS_KEY         "chip"
+
+/* FocalTech registers */
+#define FT_REG_CHIP_ID      (0xA3)
+#define FT_REG_VENDOR_ID    (0xA8)
+#define FT_VENDOR_FOCALTECH (0x11)
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+typedef struct {
+    uint8_t addr;
+    touch_probe_chip_t (*identify)(const touch_probe_config_t *config, uint8_t addr);
+} touch_probe_candidate_t;
+
+typedef struct {
+    TaskHandle_t task;
+    SemaphoreHandle_t done;
+    touch_probe_config_t config;
+    touch_probe_result_t result;
+    esp_err_t ret;
+} touch_probe_async_t;
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+static esp_err_t touch_probe_ack(const touch_probe_config_t *config, uint8_t addr);
+static touch_probe_chip_t touch_probe_identify(const touch_probe_config_t *config, uint8_t addr);
+static touch_probe_chip_t touch_probe_identify_gt911(const touch_probe_config_t *config, uint8_t addr);
+static touch_probe_chip_t touch_probe_identify_cypress(const touch_probe_config_t *config, uint8_t addr);
+static touch_probe_chip_t touch_probe_identify_ft(const touch_probe_config_t *config, uint8_t addr);
+static void touch_probe_reset_pulse(const touch_probe_config_t *config);
+static esp_err_t touch_probe_cache_load(touch_probe_chip_t *chip, uint8_t *addr);
+static void touch_probe_cache_store(touch_probe_chip_t chip, uint8_t addr);
+static esp_err_t touch_probe_create(const touch_probe_config_t *config, touch_probe_result_t *result);
+static void touch_probe_task(void *arg);
+
+/*******************************************************************************
+* Local variables
+*******************************************************************************/
+
+/* Known addresses only, most common first */
+static const touch_probe_candidate_t candidates[] = {
+    {ESP_LCD_TOUCH_IO_I2C_GT911_ADDRESS, touch_probe_identify_gt911},
+    {ESP_LCD_TOUCH_IO_I2C_GT911_ADDRESS_BACKUP, touch_probe_identify_gt911},
+    {ESP_LCD_TOUCH_IO_I2C_TMA445_ADDRESS, touch_probe_identify_cypress},
+    {0x38, touch_probe_identify_ft},
+};
+
+static touch_probe_async_t probe_async;
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t touch_probe_new(const touch_probe_config_t *config, touch_probe_result_t *out_result)
+{
+    touch_probe_chip_t chip = TOUCH_PROBE_CHIP_NONE;
+    uint8_t addr = 0;
+    bool from_cache = false;
+
+    ESP_RETURN_ON_FALSE(config && out_result, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    memset(out_result, 0, sizeof(touch_probe_result_t));
+
+    int64_t start = esp_timer_get_time();
+
+    /* Cached: the ID of one address instead of the probe. A swapped panel with another controller
+     * at the same address gives another ID and falls back to probing */
+    if (!config->no_cache && touch_probe_cache_load(&chip, &addr) == ESP_OK) {
+        touch_probe_chip_t found = TOUCH_PROBE_CHIP_NONE;
+        if (touch_probe_ack(config, addr) == ESP_OK) {
+            found = touch_probe_identify(config, addr);
+        }
+        if (found == chip) {
+            from_cache = true;
+        } else {
+            ESP_LOGW(TAG, "Cached %s at 0x%02x %s, probing", touch_probe_chip_name(chip), addr,
+                     found == TOUCH_PROBE_CHIP_NONE ? "not answering" : touch_probe_chip_name(found));
+            chip = TOUCH_PROBE_CHIP_NONE;
+        }
+    }
+
+    if (chip == TOUCH_PROBE_CHIP_NONE) {
+        /* Controllers with a reset pin only answer after reset. The candidates are checked one
+         * after the other: they share the bus, which carries one transfer at a time */
+        touch_probe_reset_pulse(config);
+        for (int i = 0; i < sizeof(candidates) / sizeof(candidates[0]) && chip == TOUCH_PROBE_CHIP_NONE; i++) {
+            if (touch_probe_ack(config, candidates[i].addr) != ESP_OK) {
+                continue;
+            }
+            addr = candidates[i].addr;
+            chip = candidates[i].identify(config, addr);
+        }
+    }
+
+    out_result->chip = chip;
+    out_result->addr = addr;
+    out_result->from_cache = from_cache;
+    out_result->probe_us = (uint32_t)(esp_timer_get_time() - start);
+
+    if (chip == TOUCH_PROBE_CHIP_NONE) {
+        ESP_LOGW(TAG, "No touch controller found (%lu us)", (unsigned long)out_result->probe_us);
+        return ESP_ERR_NOT_FOUND;
+    }
+    ESP_LOGI(TAG, "%s at 0x%02x%s (%lu us)", touch_probe_chip_name(chip), addr, from_cache ? " from cache" : "",
+             (unsigned long)out_result->probe_us);
+
+    esp_err_t ret = touch_probe_create(config, out_result);
+    out_result->total_us = (uint32_t)(esp_timer_get_time() - start);
+
+    if (ret == ESP_OK && !from_cache && !config->no_cache) {
+        touch_probe_cache_store(chip, addr);
+    }
+
+    return ret;
+}
+
+esp_err_t touch_probe_start(const touch_probe_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(config, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(probe_async.task == NULL, ESP_ERR_INVALID_STATE, TAG, "probe already running");
+
+    if (probe_async.done == NULL) {
+        probe_async.done = xSemaphoreCreateBinary();
+        ESP_RETURN_ON_FALSE(probe_async.done, ESP_ERR_NO_MEM, TAG, "no mem for probe semaphore");
+    }
+    memcpy(&probe_async.config, config, sizeof(touch_probe_config_t));
+
+    if (xTaskCreate(touch_probe_task, "touch_probe", 3072, NULL, tskIDLE_PRIORITY + 1, &probe_async.task) != pdPASS) {
+        probe_async.task = NULL;
+        ESP_LOGE(TAG, "no mem for probe task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t touch_probe_wait(TickType_t timeout, touch_probe_result_t *out_result)
+{
+    ESP_RETURN_ON_FALSE(out_result, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(probe_async.task != NULL, ESP_ERR_INVALID_STATE, TAG, "no probe started");
+
+    if (xSemaphoreTake(probe_async.done, timeout) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    probe_async.task = NULL;
+    memcpy(out_result, &probe_async.result, sizeof(touch_probe_result_t));
+
+    return probe_async.ret;
+}
+
+esp_err_t touch_probe_forget(void)
+{
+    nvs_handle_t nvs;
+
+    esp_err_t ret = nvs_open(TOUCH_PROBE_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    ESP_RETURN_ON_ERROR(ret, TAG, "NVS open failed");
+    ret = nvs_erase_key(nvs, TOUCH_PROBE_NVS_KEY);
+    if (ret == ESP_OK || ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+
+    return ret;
+}
+
+const char *touch_probe_chip_name(touch_probe_chip_t chip)
+{
+    switch (chip) {
+    case TOUCH_PROBE_CHIP_GT911:
+        return "GT911";
+    case TOUCH_PROBE_CHIP_TMA445:
+        return "TMA445";
+    case TOUCH_PROBE_CHIP_TT21100:
+        return "TT21100";
+    case TOUCH_PROBE_CHIP_FT6X36:
+        return "FT6X36";
+    default:
+        return "none";
+    }
+}
+
+/*******************************************************************************
+* Private API function
+*******************************************************************************/
+
+/* Address phase only: a missing device NACKs right away, the timeout only covers a stuck bus */
+static esp_err_t touch_probe_ack(const touch_probe_config_t *config, uint8_t addr)
+{
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_stop(cmd);
+    esp_err_t ret = i2c_master_cmd_begin(config->port, cmd, pdMS_TO_TICKS(config->timeout_ms) + 1);
+    i2c_cmd_link_delete(cmd);
+
+    return ret;
+}
+
+/* The controller at a known address, by the ID registers of its candidate */
+static touch_probe_chip_t touch_probe_identify(const touch_probe_config_t *config, uint8_t addr)
+{
+    for (int i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        if (candidates[i].addr == addr) {
+            return candidates[i].identify(config, addr);
+        }
+    }
+
+    return TOUCH_PROBE_CHIP_NONE;
+}
+
+/* Product ID at 0x8140 is ASCII: "911", "9147", "928" ... */
+static touch_probe_chip_t touch_probe_identify_gt911(const touch_probe_config_t *config, uint8_t addr)
+{
+    uint8_t reg[2] = {0x81, 0x40};
+    uint8_t id[4] = {0};
+
+    if (i2c_master_write_read_device(config->port, addr, reg, sizeof(reg), id, sizeof(id), pdMS_TO_TICKS(config->timeout_ms) + 1) != ESP_OK) {
+        return TOUCH_PROBE_CHIP_NONE;
+    }
+    ESP_LOGD(TAG, "0x%02x ID %02x %02x %02x %02x", addr, id[0], id[1], id[2], id[3]);
+
+    return (id[0] == '9' ? TOUCH_PROBE_CHIP_GT911 : TOUCH_PROBE_CHIP_NONE);
+}
+
+/* TMA445 and TT21100 share 0x24. Read only, nothing is written before the driver takes over:
+ * TT21100 answers a plain read with its little endian report length (2 when idle),
+ * TTSP Gen3 with bl_file (0x00) and the bootloader status. */
+static touch_probe_chip_t touch_probe_identify_cypress(const touch_probe_config_t *config, uint8_t addr)
+{
+    uint8_t buf[2] = {0};
+
+    if (i2c_master_read_from_device(config->port, addr, buf, sizeof(buf), pdMS_TO_TICKS(config->timeout_ms) + 1) != ESP_OK) {
+        return TOUCH_PROBE_CHIP_NONE;
+    }
+    ESP_LOGD(TAG, "0x%02x read %02x %02x", addr, buf[0], buf[1]);
+
+    if (buf[0] >= 2 && buf[1] == 0x00) {
+        return TOUCH_PROBE_CHIP_TT21100;
+    }
+
+    return TOUCH_PROBE_CHIP_TMA445;
+}
+
+static touch_probe_chip_t touch_probe_identify_ft(const touch_probe_config_t *config, uint8_t addr)
+{
+    uint8_t reg = FT_REG_VENDOR_ID;
+    uint8_t vendor = 0;
+
+    if (i2c_master_write_read_device(config->port, addr, &reg, 1, &vendor, 1, pdMS_TO_TICKS(config->timeout_ms) + 1) != ESP_OK) {
+        return TOUCH_PROBE_CHIP_NONE;
+    }
+
+    uint8_t chip_id = 0;
+    reg = FT_REG_CHIP_ID;
+    i2c_master_write_read_device(config->port, addr, &reg, 1, &chip_id, 1, pdMS_TO_TICKS(config->timeout_ms) + 1);
+    ESP_LOGD(TAG, "0x%02x vendor %02x chip %02x", addr, vendor, chip_id);
+
+    return (vendor == FT_VENDOR_FOCALTECH ? TOUCH_PROBE_CHIP_FT6X36 : TOUCH_PROBE_CHIP_NONE);
+}
+
+static void touch_probe_reset_pulse(const touch_probe_config_t *config)
+{
+    gpio_num_t rst = config->touch.rst_gpio_num;
+
+    if (rst == GPIO_NUM_NC) {
+        return;
+    }
+
+    const gpio_config_t rst_gpio_config = {
+        .mode = GPIO_MODE_OUTPUT,
+        .pin_bit_mask = BIT64(rst)
+    };
+    gpio_config(&rst_gpio_config);
+    gpio_set_level(rst, config->touch.levels.reset);
+    vTaskDelay(pdMS_TO_TICKS(10));
+    gpio_set_level(rst, !config->touch.levels.reset);
+    vTaskDelay(pdMS_TO_TICKS(50));
+}
+
+static esp_err_t touch_probe_cache_load(touch_probe_chip_t *chip, uint8_t *addr)
+{
+    nvs_handle_t nvs;
+    uint16_t value = 0;
+
+    esp_err_t ret = nvs_open(TOUCH_PROBE_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = nvs_get_u16(nvs, TOUCH_PROBE_NVS_KEY, &value);
+    nvs_close(nvs);
+
+    /* Chip in the high byte, address in the low byte */
+    if (ret == ESP_OK) {
+        *chip = (touch_probe_chip_t)(value >> 8);
+        *addr = value & 0xff;
+        if (*chip == TOUCH_PROBE_CHIP_NONE || *chip > TOUCH_PROBE_CHIP_FT6X36) {
+            ret = ESP_ERR_INVALID_STATE;
+        }
+    }
+
+    return ret;
+}
+
+static void touch_probe_cache_store(touch_probe_chip_t chip, uint8_t addr)
+{
+    nvs_handle_t nvs;
+
+    if (nvs_open(TOUCH_PROBE_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        ESP_LOGW(TAG, "NVS not available, result not cached (call nvs_flash_init first)");
+        return;
+    }
+    nvs_set_u16(nvs, TOUCH_PROBE_NVS_KEY, ((uint16_t)chip << 8) | addr);
+    nvs_commit(nvs);
+    nvs_close(nvs);
+}
+
+static esp_err_t touch_probe_create(const touch_probe_config_t *config, touch_probe_result_t *result)
+{
+    esp_lcd_panel_io_i2c_config_t io_config;
+    esp_err_t ret;
+
+    switch (result->chip) {
+    case TOUCH_PROBE_CHIP_GT911: {
+        esp_lcd_panel_io_i2c_config_t cfg = ESP_LCD_TOUCH_IO_I2C_GT911_CONFIG();
+        io_config = cfg;
+        break;
+    }
+    case TOUCH_PROBE_CHIP_TMA445: {
+        esp_lcd_panel_io_i2c_config_t cfg = ESP_LCD_TOUCH_IO_I2C_TMA445_CONFIG();
+        io_config = cfg;
+        break;
+    }
+#ifdef TOUCH_PROBE_HAS_TT21100
+    case TOUCH_PROBE_CHIP_TT21100: {
+        esp_lcd_panel_io_i2c_config_t cfg = ESP_LCD_TOUCH_IO_I2C_TT21100_CONFIG();
+        io_config = cfg;
+        break;
+    }
+#endif
+#ifdef TOUCH_PROBE_HAS_FT5X06
+    case TOUCH_PROBE_CHIP_FT6X36: {
+        esp_lcd_panel_io_i2c_config_t cfg = ESP_LCD_TOUCH_IO_I2C_FT5x06_CONFIG();
+        io_config = cfg;
+        break;
+    }
+#endif
+    default:
+        ESP_LOGW(TAG, "No driver built in for %s", touch_probe_chip_name(result->chip));
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    io_config.dev_addr = result->addr;
+
+    ret = esp_lcd_new_panel_io_i2c((esp_lcd_i2c_bus_handle_t)config->port, &io_config, &result->io);
+    ESP_RETURN_ON_ERROR(ret, TAG, "panel IO create failed");
+
+    switch (result->chip) {
+    case TOUCH_PROBE_CHIP_GT911:
+        ret = esp_lcd_touch_new_i2c_gt911(result->io, &config->touch, &result->tp);
+        break;
+    case TOUCH_PROBE_CHIP_TMA445:
+        ret = esp_lcd_touch_new_i2c_tma445(result->io, &config->touch, &result->tp);
+        break;
+#ifdef TOUCH_PROBE_HAS_TT21100
+    case TOUCH_PROBE_CHIP_TT21100:
+        ret = esp_lcd_touch_new_i2c_tt21100(result->io, &config->touch, &result->tp);
+        break;
+#endif
+#ifdef TOUCH_PROBE_HAS_FT5X06
+    case TOUCH_PROBE_CHIP_FT6X36:
+        ret = esp_lcd_touch_new_i2c_ft5x06(result->io, &config->touch, &result->tp);
+        break;
+#endif
+    default:
+        ret = ESP_ERR_NOT_SUPPORTED;
+        break;
+    }
+
+    if (ret != ESP_OK) {
+        esp_lcd_panel_io_del(result->io);
+        result->io = NULL;
+        result->tp = NULL;
+    }
+
+    return ret;
+}
+
+static void touch_probe_task(void *arg)
+{
+    probe_async.ret = touch_probe_new(&probe_async.config, &probe_async.result);
+    xSemaphoreGive(probe_async.done);
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,198 @@
+/* Asset pack benchmark: the same pack of scripts/asset_pack.py used three ways.
+ * "flash" maps the assets partition, "app" is the pack compiled into the app (when
+ * asset_pack_data.c of the tool's --c-out is next to this file) and "sd" reads /S/ASSETS.EPK
+ * into PSRAM first, as assets loaded from the card would be.
+ * Per way: time to mount (for "sd" with the read), to make the descriptors of all images and
+ * fonts, to look up every glyph, to read every blob once through the cache and again, and the
+ * internal RAM, PSRAM and LVGL heap taken while mounted.
+ * Boot: the time from reset to app_main is printed first. Build it with and without
+ * asset_pack_data.c to see what compiling the assets in costs the bootloader, which loads
+ * and checks the whole app image.
+ * Select this file in main/CMakeLists.txt
+ */
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_vfs_fat.h"
+#include "sdmmc_cmd.h"
+#include "driver/sdmmc_host.h"
+#include "lvgl.h"
+
+extern "C"
+{
+    void app_main();
+    #include "lv_fe_io.c"
+    #include "lv_fe_reader.c"
+    #include "lv_text_loader.c"
+    #include "lv_fe_type.c"
+    #include "lv_fe_dir.c"
+    #include "lv_fe_cache.c"
+    #include "lv_fe_sort.c"
+    #include "lv_fe_scan.c"
+    #include "lv_fe_list.c"
+    #include "lv_fe_thumb.c"
+    #include "lv_file_explorer.c"
+    #include "lv_jpeg_loader.c"
+    #include "lv_text_pager.c"
+    #include "lv_fe_tabs.c"
+    #include "lv_asset_pack.c"
+#if __has_include("asset_pack_data.c")
+    #define BENCH_EMBEDDED 1
+    #include "asset_pack_data.c"
+#endif
+}
+
+#define BENCH_PACK_FILE MOUNT_POINT "/ASSETS.EPK"
+
+typedef struct {
+    size_t internal;
+    size_t psram;
+    size_t lvgl;
+} bench_heap_t;
+
+static void bench_heap(bench_heap_t * heap)
+{
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    heap->internal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    heap->psram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    heap->lvgl = mon.free_size;
+}
+
+/* Sum the bytes, so the reads are not optimized out */
+static uint32_t bench_touch(const uint8_t * data, uint32_t size)
+{
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < size; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+static void bench_pack(const char * way, int64_t mount_us, const bench_heap_t * before)
+{
+    lv_asset_pack_info_t info;
+    lv_asset_pack_get_info(&info);
+
+    /* Descriptors of all images and fonts, as a UI asks for them at startup */
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < info.count; i++) {
+        const lv_asset_pack_entry_t * e = lv_asset_pack_get_entry(i);
+        if (e->type == LV_ASSET_PACK_TYPE_IMAGE) {
+            lv_asset_pack_image(e->name);
+        } else if (e->type == LV_ASSET_PACK_TYPE_FONT) {
+            lv_asset_pack_font(e->name);
+        }
+    }
+    uint32_t dsc_us = (uint32_t)(esp_timer_get_time() - start);
+
+    /* What drawing a label asks the font for each letter */
+    uint32_t glyphs = 0;
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < info.count; i++) {
+        const lv_asset_pack_entry_t * e = lv_asset_pack_get_entry(i);
+        const lv_font_t * font = e->type == LV_ASSET_PACK_TYPE_FONT ? lv_asset_pack_font(e->name) : NULL;
+        for (uint32_t cp = e->range_start; font && cp < e->range_start + e->glyph_count; cp++) {
+            lv_font_glyph_dsc_t g;
+            glyphs += lv_font_get_glyph_dsc(font, &g, cp, 0);
+        }
+    }
+    uint32_t glyph_us = (uint32_t)(esp_timer_get_time() - start);
+
+    /* The blobs as drawing reads them: first through a cold cache, then again */
+    uint32_t touch_us[2];
+    uint32_t sum = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        start = esp_timer_get_time();
+        for (uint32_t i = 0; i < info.count; i++) {
+            uint32_t size;
+            const void * data = lv_asset_pack_raw(lv_asset_pack_get_entry(i)->name, &size);
+            sum += bench_touch((const uint8_t *)data, size);
+        }
+        touch_us[pass] = (uint32_t)(esp_timer_get_time() - start);
+    }
+
+    bench_heap_t after;
+    bench_heap(&after);
+    lv_asset_pack_get_info(&info);
+    printf("%-5s | %8lu %8lu %5lu %6lu %6lu %8lu %8lu | %8ld %8ld %6ld %5lu | %08lx\n", way, (unsigned long)info.size,
+           (unsigned long)mount_us, (unsigned long)dsc_us, (unsigned long)glyphs, (unsigned long)glyph_us,
+           (unsigned long)touch_us[0], (unsigned long)touch_us[1], (long)(before->internal - after.internal),
+           (long)(before->psram - after.psram), (long)(before->lvgl - after.lvgl), (unsigned long)info.ram_bytes,
+           (unsigned long)sum);
+}
+
+void app_main()
+{
+    /* Cycle counter since reset, the bootloader included */
+    uint32_t boot_ms = esp_log_early_timestamp();
+    bench_heap_t before;
+
+    lv_init();
+    printf("app_main %lu ms after reset\n", (unsigned long)boot_ms);
+#if BENCH_EMBEDDED
+    printf("The app carries the pack, %lu bytes\n", (unsigned long)asset_pack_data_size);
+#endif
+
+    printf("\nAsset pack, times in us, memory in bytes\n");
+    printf("%-5s | %8s %8s %5s %6s %6s %8s %8s | %8s %8s %6s %5s | %8s\n", "way", "pack", "mount", "dsc", "glyphs",
+           "lookup", "read", "again", "internal", "psram", "lvgl", "dscs", "sum");
+
+    bench_heap(&before);
+    int64_t start = esp_timer_get_time();
+    esp_err_t res = lv_asset_pack_mount(NULL);
+    int64_t mount_us = esp_timer_get_time() - start;
+    if (res == ESP_OK) {
+        bench_pack("flash", mount_us, &before);
+        lv_asset_pack_unmount();
+    } else {
+        printf("%-5s | %s, flash the pack to the \"%s\" partition\n", "flash", esp_err_to_name(res),
+               LV_ASSET_PACK_PARTITION);
+    }
+
+#if BENCH_EMBEDDED
+    bench_heap(&before);
+    start = esp_timer_get_time();
+    res = lv_asset_pack_mount_buffer(asset_pack_data, asset_pack_data_size);
+    mount_us = esp_timer_get_time() - start;
+    if (res == ESP_OK) {
+        bench_pack("app", mount_us, &before);
+        lv_asset_pack_unmount();
+    } else {
+        printf("%-5s | %s\n", "app", esp_err_to_name(res));
+    }
+#endif
+
+    fs_init();
+    struct stat st;
+    if (stat(BENCH_PACK_FILE, &st) != 0) {
+        printf("%-5s | no %s\n", "sd", BENCH_PACK_FILE);
+        return;
+    }
+    bench_heap(&before);
+    start = esp_timer_get_time();
+    void * copy = heap_caps_malloc(st.st_size, MALLOC_CAP_SPIRAM);
+    int fd = open(BENCH_PACK_FILE, O_RDONLY);
+    if (copy == NULL || fd < 0 || lv_fe_io_read(fd, copy, st.st_size) != st.st_size) {
+        printf("%-5s | can not read %s into PSRAM\n", "sd", BENCH_PACK_FILE);
+    } else {
+        res = lv_asset_pack_mount_buffer(copy, st.st_size);
+        mount_us = esp_timer_get_time() - start;
+        if (res == ESP_OK) {
+            bench_pack("sd", mount_us, &before);
+            lv_asset_pack_unmount();
+        } else {
+            printf("%-5s | %s\n", "sd", esp_err_to_name(res));
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    free(copy);
+}
@@ -0,0 +1,226 @@
+/* Directory open benchmark: the lv_table rows show_dir used to create against the virtual
+ * list, for 100, 1000 and 3000 files. Prints open time (read + first frame) and LVGL heap.
+ * The explorer opens each folder twice: a scan that writes the index cache, then a cache hit.
+ * Then, with the cache cleared, once more on the scan worker: time to the first rows, time
+ * to complete, and the longest the GUI loop had to wait meanwhile.
+ * Runs headless, the display flush does nothing. The test folders are created on the SD
+ * card on the first run, that takes a while for the big one. Board only, the explorer mounts
+ * the card with fs_init.
+ * Select this file in main/CMakeLists.txt
+ */
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#if CONFIG_IDF_TARGET_LINUX
+#error "bench-dir reads the SD card, build it for the board"
+#endif
+#include "esp_vfs_fat.h"
+#include "sdmmc_cmd.h"
+#include "driver/sdmmc_host.h"
+#include "lvgl.h"
+#include "../bench_display.h"
+
+extern "C"
+{
+    void app_main();
+    #include "lv_fe_io.c"
+    #include "lv_fe_reader.c"
+    #include "lv_text_loader.c"
+    #include "lv_fe_type.c"
+    #include "lv_fe_dir.c"
+    #include "lv_fe_cache.c"
+    #include "lv_fe_sort.c"
+    #include "lv_fe_scan.c"
+    #include "lv_fe_list.c"
+    #include "lv_fe_thumb.c"
+    #include "lv_file_explorer.c"
+    #include "lv_jpeg_loader.c"
+    #include "lv_text_pager.c"
+    #include "lv_fe_tabs.c"
+}
+
+/* Stop filling the table before LVGL runs out, it asserts then */
+#define TABLE_HEAP_RESERVE (4 * 1024)
+
+static const uint32_t bench_counts[] = {100, 1000, 3000};
+static SemaphoreHandle_t gui_lock;
+static volatile bool explorer_ready;
+
+static uint32_t tick_cb(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static uint32_t lv_heap_used(void)
+{
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    return mon.total_size - mon.free_size;
+}
+
+static void make_dir(const char * path, uint32_t count)
+{
+    static const char * ext[] = {"jpg", "txt", "mp3", "bin", "png"};
+    char fn[64];
+    struct stat st;
+
+    if (stat(path, &st) == 0) {
+        return;
+    }
+    printf("Creating %lu files in %s\n", (unsigned long)count, path);
+    mkdir(path, 0775);
+    for (uint32_t i = 0; i < count; i++) {
+        snprintf(fn, sizeof(fn), "%s/F%05lu.%s", path, (unsigned long)i, ext[i % 5]);
+        FILE * f = fopen(fn, "w");
+        if (f) {
+            fclose(f);
+        }
+    }
+}
+
+/* show_dir as it was: two cells per row */
+static uint32_t table_fill(lv_obj_t * table, const char * path)
+{
+    uint32_t index = 0;
+    struct dirent * dp;
+    lv_mem_monitor_t mon;
+
+    DIR * d = opendir(path);
+    if (d == NULL) {
+        return 0;
+    }
+    while ((dp = readdir(d)) != NULL) {
+        lv_mem_monitor(&mon);
+        if (mon.free_biggest_size < TABLE_HEAP_RESERVE) {
+            break;
+        }
+        lv_table_set_cell_value_fmt(table, index, 0, LV_SYMBOL_FILE "  %s", dp->d_name);
+        lv_table_set_cell_value(table, index, 1, "4");
+        index++;
+    }
+    closedir(d);
+    lv_table_set_row_count(table, index);
+    return index;
+}
+
+static void ready_cb(lv_event_t * e)
+{
+    explorer_ready = true;
+}
+
+/* Open on the scan worker while this task plays the GUI loop */
+static void bench_async(const char * path, uint32_t * first_us, uint32_t * total_us, uint32_t * gap_us)
+{
+    lv_fe_cache_clear();
+    explorer_ready = false;
+    *first_us = 0;
+    *gap_us = 0;
+
+    xSemaphoreTake(gui_lock, portMAX_DELAY);
+    lv_obj_t * explorer = lv_file_explorer_create(lv_screen_active());
+    lv_file_explorer_set_gui_lock(explorer, gui_lock);
+    lv_obj_add_event_cb(explorer, ready_cb, LV_EVENT_READY, NULL);
+    lv_file_explorer_t * fe = (lv_file_explorer_t *)explorer;
+    int64_t start = esp_timer_get_time();
+    lv_file_explorer_open_dir(explorer, path);
+    xSemaphoreGive(gui_lock);
+
+    int64_t last = esp_timer_get_time();
+    while (!explorer_ready) {
+        vTaskDelay(1);
+        xSemaphoreTake(gui_lock, portMAX_DELAY);
+        int64_t now = esp_timer_get_time();
+        if ((uint32_t)(now - last) > *gap_us) {
+            *gap_us = (uint32_t)(now - last);
+        }
+        /* Past "." and "..", the first real rows */
+        if (*first_us == 0 && lv_fe_list_get_count(fe->file_list) > 2) {
+            lv_refr_now(NULL);
+            *first_us = (uint32_t)(esp_timer_get_time() - start);
+        }
+        lv_timer_handler();
+        last = esp_timer_get_time();
+        xSemaphoreGive(gui_lock);
+    }
+    *total_us = (uint32_t)(esp_timer_get_time() - start);
+
+    xSemaphoreTake(gui_lock, portMAX_DELAY);
+    lv_obj_delete(explorer);
+    xSemaphoreGive(gui_lock);
+}
+
+static void bench_dir(uint32_t count)
+{
+    char path[32];
+    snprintf(path, sizeof(path), MOUNT_POINT "/B%lu", (unsigned long)count);
+    make_dir(path, count);
+
+    uint32_t heap0 = lv_heap_used();
+    int64_t start = esp_timer_get_time();
+    lv_obj_t * table = lv_table_create(lv_screen_active());
+    lv_obj_set_size(table, LV_PCT(100), LV_PCT(100));
+    uint32_t rows = table_fill(table, path);
+    lv_refr_now(NULL);
+    uint32_t table_us = (uint32_t)(esp_timer_get_time() - start);
+    uint32_t table_heap = lv_heap_used() - heap0;
+    lv_obj_delete(table);
+
+    heap0 = lv_heap_used();
+    start = esp_timer_get_time();
+    lv_obj_t * explorer = lv_file_explorer_create(lv_screen_active());
+    lv_file_explorer_open_dir(explorer, path);
+    lv_refr_now(NULL);
+    uint32_t list_us = (uint32_t)(esp_timer_get_time() - start);
+    uint32_t list_heap = lv_heap_used() - heap0;
+    lv_file_explorer_t * fe = (lv_file_explorer_t *)explorer;
+    uint32_t list_rows = ((lv_fe_list_t *)fe->file_list)->pool_size;
+    size_t native = fe->dir.entries_cap * sizeof(lv_fe_entry_t) + fe->dir.names_cap;
+
+    /* Scroll through the whole list, rows are rebound on the way */
+    start = esp_timer_get_time();
+    lv_obj_scroll_to_y(fe->file_list, LV_COORD_MAX, LV_ANIM_OFF);
+    lv_refr_now(NULL);
+    uint32_t scroll_us = (uint32_t)(esp_timer_get_time() - start);
+
+    start = esp_timer_get_time();
+    lv_file_explorer_open_dir(explorer, path);
+    lv_refr_now(NULL);
+    uint32_t again_us = (uint32_t)(esp_timer_get_time() - start);
+    lv_obj_delete(explorer);
+
+    uint32_t first_us, total_us, gap_us;
+    bench_async(path, &first_us, &total_us, &gap_us);
+
+    printf("%6lu | %5lu %9lu %7lu | %4lu %9lu %7lu %8lu %9lu %9lu | %9lu %9lu %9lu\n", (unsigned long)count,
+           (unsigned long)rows, (unsigned long)table_us, (unsigned long)table_heap, (unsigned long)list_rows,
+           (unsigned long)list_us, (unsigned long)list_heap, (unsigned long)native, (unsigned long)scroll_us,
+           (unsigned long)again_us, (unsigned long)first_us, (unsigned long)total_us, (unsigned long)gap_us);
+}
+
+void app_main()
+{
+    fs_init();
+
+    gui_lock = xSemaphoreCreateMutex();
+    lv_init();
+    lv_tick_set_cb(tick_cb);
+    if (bench_display_create(NULL) == NULL) {
+        printf("No memory for the draw buffer\n");
+        return;
+    }
+
+    lv_fe_cache_clear();
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    printf("Directory open, times in us, LVGL heap in bytes (%u KB at start)\n", (unsigned)(mon.total_size / 1024));
+    printf("%6s | %5s %9s %7s | %4s %9s %7s %8s %9s %9s | %9s %9s %9s\n", "files", "rows", "table", "heap", "rows",
+           "list", "heap", "native", "to end", "cached", "1st rows", "complete", "gui wait");
+    for (size_t i = 0; i < sizeof(bench_counts) / sizeof(bench_counts[0]); i++) {
+        bench_dir(bench_counts[i]);
+    }
+}
@@ -0,0 +1,102 @@
+/* Glyph cache benchmark: a full page of text rendered on the 960x540 RGB332 display of
+ * bench_display.h, the flush only reports ready. Per font, the time of one refresh of the page with
+ * the font as it is, then through the glyph cache: the first refresh renders and adds every
+ * glyph, the next ones take them from PSRAM. Prints the hit rate and what the cache holds.
+ * The built-in Montserrat fonts are uncompressed, a compressed or TrueType font gains more;
+ * put one in the asset pack as "ui" to measure it as well.
+ * Select this file in main/CMakeLists.txt
+ */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "lvgl.h"
+#include "../bench_display.h"
+
+extern "C"
+{
+    void app_main();
+    #include "lv_asset_pack.c"
+    #include "lv_glyph_cache.c"
+}
+
+#define BENCH_FRAMES 10
+
+static const char * bench_text =
+    "It was the best of times, it was the worst of times, it was the age of wisdom, it was the age of "
+    "foolishness, it was the epoch of belief, it was the epoch of incredulity, it was the season of Light, "
+    "it was the season of Darkness, it was the spring of hope, it was the winter of despair, we had "
+    "everything before us, we had nothing before us, we were all going direct to Heaven, we were all going "
+    "direct the other way - in short, the period was so far like the present period, that some of its "
+    "noisiest authorities insisted on its being received, for good or for evil, in the superlative degree "
+    "of comparison only. There were a king with a large jaw and a queen with a plain face, on the throne of "
+    "England; there were a king with a large jaw and a queen with a fair face, on the throne of France. "
+    "In both countries it was clearer than crystal to the lords of the State preserves of loaves and "
+    "fishes, that things in general were settled for ever. 0123456789 (!?) [;:] \"quotes\" & 100%.";
+
+/* Average time of a refresh of the whole page */
+static uint32_t bench_refresh(lv_obj_t * label, uint32_t frames)
+{
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < frames; i++) {
+        lv_obj_invalidate(label);
+        lv_refr_now(NULL);
+    }
+    return (uint32_t)((esp_timer_get_time() - start) / frames);
+}
+
+static void bench_font(lv_obj_t * label, const char * name, const lv_font_t * font)
+{
+    lv_glyph_cache_stats_t stats;
+
+    lv_obj_set_style_text_font(label, font, 0);
+    uint32_t off_us = bench_refresh(label, BENCH_FRAMES);
+
+    lv_glyph_cache_clear();
+    lv_glyph_cache_reset_stats();
+    lv_obj_set_style_text_font(label, lv_glyph_cache_font(font), 0);
+    uint32_t cold_us = bench_refresh(label, 1);
+    uint32_t warm_us = bench_refresh(label, BENCH_FRAMES);
+    lv_glyph_cache_get_stats(&stats);
+
+    uint32_t lookups = stats.hits + stats.misses;
+    printf("%-14s | %9lu | %9lu %9lu | %5lu.%lu %7lu %7lu %6lu | %6lu\n", name, (unsigned long)off_us,
+           (unsigned long)cold_us, (unsigned long)warm_us,
+           (unsigned long)(lookups ? stats.hits * 100 / lookups : 0),
+           (unsigned long)(lookups ? stats.hits * 1000 / lookups % 10 : 0), (unsigned long)stats.misses,
+           (unsigned long)stats.evictions, (unsigned long)stats.entries, (unsigned long)(stats.bytes / 1024));
+}
+
+void app_main()
+{
+    lv_init();
+    if (lv_glyph_cache_init(CONFIG_FE_GLYPH_CACHE_KB * 1024) != ESP_OK || CONFIG_FE_GLYPH_CACHE_KB == 0) {
+        printf("Set a glyph cache size in menuconfig, File explorer\n");
+        return;
+    }
+
+    if (bench_display_create(NULL) == NULL) {
+        printf("No memory for the draw buffer\n");
+        return;
+    }
+
+    lv_obj_t * label = lv_label_create(lv_screen_active());
+    lv_obj_set_size(label, LV_PCT(100), LV_PCT(100));
+    lv_label_set_long_mode(label, LV_LABEL_LONG_CLIP);
+    lv_label_set_text_static(label, bench_text);
+
+    printf("Text page %dx%d RGB332, %d KB glyph cache, times in us per refresh\n", BENCH_HOR_RES, BENCH_VER_RES,
+           CONFIG_FE_GLYPH_CACHE_KB);
+    printf("%-14s | %9s | %9s %9s | %7s %7s %7s %6s | %6s\n", "font", "no cache", "cold", "warm", "hit %",
+           "misses", "evicted", "glyphs", "KB");
+#if CONFIG_LV_FONT_MONTSERRAT_20
+    bench_font(label, "montserrat 20", &lv_font_montserrat_20);
+#endif
+#if CONFIG_LV_FONT_MONTSERRAT_32
+    bench_font(label, "montserrat 32", &lv_font_montserrat_32);
+#endif
+    if (lv_asset_pack_mount(NULL) == ESP_OK && lv_asset_pack_font("ui")) {
+        bench_font(label, "pack ui", lv_asset_pack_font("ui"));
+    }
+}
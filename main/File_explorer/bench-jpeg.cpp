@@ -0,0 +1,222 @@
+/* JPEG decode benchmark: every .jpg in the root of the SD card (the first 16) is decoded to
+ * fit the display, once to RGB332 and once to L8. Prints the photo size, the scale the
+ * decoder picked, blocks read, decode time, the part of it spent waiting for the card and the
+ * peak the loader holds: work area, read-ahead blocks and output image. For comparison, the file size is what reading it whole used to take.
+ * "internal" is the internal RAM still held after the load, 0 when the image went to PSRAM.
+ * Then the same photos as EPI, if NAME.EPI of scripts/epi_convert.py is next to NAME.JPG:
+ * load time into an image, and straight into a display sized buffer as into the panel
+ * framebuffer, against the JPEG decode time above.
+ * Then the thumbnails of the same folder, as the explorer asks for them: made on the worker
+ * with the sidecar file removed, then read back from it with the RAM cleared. The time is
+ * from the requests to the last thumbnail ready.
+ * Put a few camera photos on the card before running it.
+ * Select this file in main/CMakeLists.txt
+ */
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_vfs_fat.h"
+#include "sdmmc_cmd.h"
+#include "driver/sdmmc_host.h"
+#include "lvgl.h"
+
+extern "C"
+{
+    void app_main();
+    #include "lv_fe_io.c"
+    #include "lv_fe_reader.c"
+    #include "lv_text_loader.c"
+    #include "lv_fe_type.c"
+    #include "lv_fe_dir.c"
+    #include "lv_fe_cache.c"
+    #include "lv_fe_sort.c"
+    #include "lv_fe_scan.c"
+    #include "lv_fe_list.c"
+    #include "lv_fe_thumb.c"
+    #include "lv_file_explorer.c"
+    #include "lv_jpeg_loader.c"
+    #include "lv_text_pager.c"
+    #include "lv_fe_tabs.c"
+    #include "lv_epi_loader.c"
+}
+
+#define BENCH_HOR_RES 960
+#define BENCH_VER_RES 540
+#define BENCH_MAX_FILES 16
+
+static SemaphoreHandle_t gui_lock;
+
+static uint32_t bench_decode(const char * path, const char * name, lv_color_format_t cf)
+{
+    lv_image_dsc_t img;
+    lv_jpeg_load_stats_t stats;
+    struct stat st;
+
+    if (stat(path, &st) != 0) {
+        st.st_size = 0;
+    }
+    size_t internal0 = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    esp_err_t res = lv_jpeg_load(path, BENCH_HOR_RES, BENCH_VER_RES, cf, &img, &stats);
+    if (res != ESP_OK) {
+        printf("%-12s | %s\n", name, esp_err_to_name(res));
+        return 0;
+    }
+    size_t internal_used = internal0 - heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+
+    printf("%-12s %-6s | %4u x %-4u 1/%u %4lu x %-4u | %6lu %9lu %8lu | %8lu %8lu %8lu\n", name,
+           cf == LV_COLOR_FORMAT_RGB332 ? "RGB332" : "L8", stats.src_w, stats.src_h, stats.scale,
+           (unsigned long)img.header.w, (unsigned)img.header.h, (unsigned long)stats.reads,
+           (unsigned long)stats.decode_us, (unsigned long)stats.stall_us, (unsigned long)stats.peak_bytes,
+           (unsigned long)internal_used,
+           (unsigned long)st.st_size);
+    lv_jpeg_free(&img);
+    return stats.decode_us;
+}
+
+/* The EPI of a photo: into an image, then into a display sized buffer */
+static void bench_epi(const char * path, const char * name, lv_color_format_t cf, uint32_t jpeg_us, uint8_t * fb)
+{
+    lv_image_dsc_t img;
+    lv_epi_load_stats_t stats;
+    lv_epi_load_stats_t fb_stats;
+
+    size_t internal0 = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    esp_err_t res = lv_epi_load(path, BENCH_HOR_RES, BENCH_VER_RES, cf, &img, &stats);
+    if (res != ESP_OK) {
+        printf("%-12s | %s\n", name, esp_err_to_name(res));
+        return;
+    }
+    size_t internal_used = internal0 - heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    lv_epi_free(&img);
+
+    res = lv_epi_load_into(path, fb, BENCH_HOR_RES, BENCH_HOR_RES, BENCH_VER_RES, cf, &fb_stats);
+    if (res != ESP_OK) {
+        fb_stats.load_us = 0;
+    }
+
+    printf("%-12s %-6s | %4u x %-4u %-6s | %6lu %9lu %8lu %9lu | %8lu %8lu %8lu | %9lu\n", name,
+           cf == LV_COLOR_FORMAT_RGB332 ? "RGB332" : "L8", stats.w, stats.h,
+           stats.format == LV_EPI_FORMAT_GRAY4 ? "gray4" : "rgb332", (unsigned long)stats.reads,
+           (unsigned long)stats.load_us, (unsigned long)stats.stall_us, (unsigned long)fb_stats.load_us,
+           (unsigned long)stats.peak_bytes, (unsigned long)internal_used, (unsigned long)stats.file_bytes,
+           (unsigned long)jpeg_us);
+}
+
+/* The explorer refreshes the row here */
+static void thumb_ready_cb(uint32_t index, void * user_data)
+{
+}
+
+/* Ask for every thumbnail, wait until the worker is done with them */
+static void bench_thumbs(const lv_fe_dir_t * dir, const char * pass)
+{
+    lv_fe_thumb_stats_t before, after;
+    uint32_t asked = 0;
+
+    lv_fe_thumb_get_stats(&before);
+    xSemaphoreTake(gui_lock, portMAX_DELAY);
+    lv_fe_thumb_set_dir(MOUNT_POINT "/", thumb_ready_cb, NULL);
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < dir->count && asked < LV_FE_THUMB_QUEUE; i++) {
+        if (lv_fe_type_from_name(lv_fe_dir_name(dir, i)) == LV_FE_TYPE_JPEG) {
+            lv_fe_thumb_get(dir, i);
+            asked++;
+        }
+    }
+    xSemaphoreGive(gui_lock);
+
+    /* Failed ones are not called back, the counters tell when all were handled */
+    while (true) {
+        lv_fe_thumb_get_stats(&after);
+        if (after.made + after.failed + after.file_hits - before.made - before.failed - before.file_hits >= asked) {
+            break;
+        }
+        vTaskDelay(1);
+    }
+    uint32_t total_us = (uint32_t)(esp_timer_get_time() - start);
+
+    printf("%-6s | %5lu %5lu %5lu %5lu | %9lu %9lu\n", pass, (unsigned long)asked,
+           (unsigned long)(after.made - before.made), (unsigned long)(after.file_hits - before.file_hits),
+           (unsigned long)(after.failed - before.failed), (unsigned long)(after.make_us - before.make_us),
+           (unsigned long)total_us);
+}
+
+void app_main()
+{
+    char path[300];
+    static char names[BENCH_MAX_FILES][256];
+    static uint32_t jpeg_us[BENCH_MAX_FILES][2];
+    uint32_t files = 0;
+    struct dirent * dp;
+
+    fs_init();
+    /* Only for the image descriptor, nothing is drawn */
+    lv_init();
+
+    DIR * d = opendir(MOUNT_POINT);
+    if (d == NULL) {
+        printf("No SD card at %s\n", MOUNT_POINT);
+        return;
+    }
+
+    printf("JPEG decode to fit %dx%d, times in us, memory in bytes\n", BENCH_HOR_RES, BENCH_VER_RES);
+    printf("%-12s %-6s | %-11s %-4s %-11s | %6s %9s %8s | %8s %8s %8s\n", "file", "format", "photo", "", "image",
+           "blocks", "decode", "stall", "peak", "internal", "file");
+    while ((dp = readdir(d)) != NULL && files < BENCH_MAX_FILES) {
+        if (lv_fe_type_from_name(dp->d_name) != LV_FE_TYPE_JPEG) {
+            continue;
+        }
+        snprintf(path, sizeof(path), MOUNT_POINT "/%s", dp->d_name);
+        jpeg_us[files][0] = bench_decode(path, dp->d_name, LV_COLOR_FORMAT_RGB332);
+        jpeg_us[files][1] = bench_decode(path, dp->d_name, LV_COLOR_FORMAT_L8);
+        snprintf(names[files], sizeof(names[files]), "%s", dp->d_name);
+        files++;
+    }
+    closedir(d);
+
+    if (files == 0) {
+        printf("No .jpg files in %s\n", MOUNT_POINT);
+        return;
+    }
+
+    /* Same name, .EPI extension */
+    uint8_t * fb = (uint8_t *)heap_caps_malloc(BENCH_HOR_RES * BENCH_VER_RES, MALLOC_CAP_SPIRAM);
+    printf("\nEPI load to %dx%d, times in us, memory in bytes\n", BENCH_HOR_RES, BENCH_VER_RES);
+    printf("%-12s %-6s | %-11s %-6s | %6s %9s %8s %9s | %8s %8s %8s | %9s\n", "file", "format", "image", "pixels",
+           "blocks", "load", "stall", "into fb", "peak", "internal", "file", "jpeg");
+    for (uint32_t i = 0; fb && i < files; i++) {
+        char * dot = strrchr(names[i], '.');
+        snprintf(path, sizeof(path), MOUNT_POINT "/%.*s.EPI", (int)(dot - names[i]), names[i]);
+        if (lv_fe_type_from_file(path) != LV_FE_TYPE_EPI) {
+            continue;
+        }
+        bench_epi(path, names[i], LV_COLOR_FORMAT_RGB332, jpeg_us[i][0], fb);
+        bench_epi(path, names[i], LV_COLOR_FORMAT_L8, jpeg_us[i][1], fb);
+    }
+    heap_caps_free(fb);
+
+    lv_fe_dir_t dir;
+    lv_fe_dir_init(&dir);
+    lv_fe_dir_scan(&dir, MOUNT_POINT);
+    unlink(MOUNT_POINT "/" LV_FE_THUMB_FILE);
+    gui_lock = xSemaphoreCreateMutex();
+    if (lv_fe_thumb_start(gui_lock) != ESP_OK) {
+        printf("No memory for the thumbnails\n");
+        return;
+    }
+
+    printf("\nThumbnails %dx%d 4 bpp, times in us\n", LV_FE_THUMB_SIZE, LV_FE_THUMB_SIZE);
+    printf("%-6s | %5s %5s %5s %5s | %9s %9s\n", "pass", "asked", "made", "file", "fail", "decode", "all ready");
+    bench_thumbs(&dir, "make");
+    xSemaphoreTake(gui_lock, portMAX_DELAY);
+    lv_fe_thumb_clear();
+    xSemaphoreGive(gui_lock);
+    bench_thumbs(&dir, "file");
+    lv_fe_dir_free(&dir);
+}
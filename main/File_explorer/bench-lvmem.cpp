@@ -0,0 +1,200 @@
+/* LVGL heap benchmark: the tiered heap of components/lv_tier_mem run with three policies.
+ * "builtin" keeps every block in one 48 KB internal pool that does not grow, as the built-in
+ * LVGL heap did. "tiered" is the policy of menuconfig, small blocks in internal RAM and large
+ * ones in PSRAM. "psram" puts every block in PSRAM.
+ * Per policy: the time of lv_malloc() and lv_free() for blocks of one size, how many of them
+ * fit, a churn of mixed sizes, the time to build a screen of list rows and buttons with a
+ * translucent panel, the time of a full refresh of it on the 960x540 RGB332 display of
+ * bench_display.h, and what the tiers hold then.
+ * Needs CONFIG_LV_USE_CUSTOM_MALLOC.
+ * Select this file in main/CMakeLists.txt
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "lvgl.h"
+#include "lv_tier_mem.h"
+#include "../bench_display.h"
+
+extern "C"
+{
+    void app_main();
+}
+
+#define BENCH_FRAMES 10
+#define BENCH_BLOCKS 64
+#define BENCH_CHURN_SLOTS 128
+#define BENCH_CHURN_OPS 4000
+/* Rows of the list, so the scene fits the 48 KB of "builtin" */
+#define BENCH_ROWS 40
+
+static const size_t bench_sizes[] = {16, 64, 256, 1024, 4096};
+
+static void * blocks[BENCH_CHURN_SLOTS];
+
+/* Time of one lv_malloc() and one lv_free() in ns, over BENCH_BLOCKS blocks of a size */
+static void bench_alloc(size_t size, uint32_t * malloc_ns, uint32_t * free_ns, uint32_t * fit)
+{
+    uint32_t n = 0;
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_BLOCKS; i++) {
+        blocks[i] = lv_malloc(size);
+        n += blocks[i] != NULL;
+    }
+    int64_t mid = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_BLOCKS; i++) {
+        if (blocks[i]) {
+            lv_free(blocks[i]);
+        }
+    }
+    int64_t end = esp_timer_get_time();
+
+    *malloc_ns = (uint32_t)((mid - start) * 1000 / BENCH_BLOCKS);
+    *free_ns = n ? (uint32_t)((end - mid) * 1000 / n) : 0;
+    *fit = n;
+}
+
+/* Allocations and frees of 8 B to 2 KB in random slots, the way widgets come and go */
+static uint32_t bench_churn(uint32_t * failed)
+{
+    uint32_t seed = 12345;
+
+    *failed = 0;
+    memset(blocks, 0, sizeof(blocks));
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_CHURN_OPS; i++) {
+        seed = seed * 1103515245 + 12345;
+        uint32_t slot = (seed >> 16) % BENCH_CHURN_SLOTS;
+        if (blocks[slot]) {
+            lv_free(blocks[slot]);
+            blocks[slot] = NULL;
+        } else {
+            /* Mostly small, one in eight up to 2 KB */
+            size_t size = (seed & 0x7) ? 8 + (seed >> 8) % 120 : 128 + (seed >> 8) % 1920;
+            blocks[slot] = lv_malloc(size);
+            *failed += blocks[slot] == NULL;
+        }
+    }
+    int64_t end = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_CHURN_SLOTS; i++) {
+        if (blocks[i]) {
+            lv_free(blocks[i]);
+        }
+    }
+    return (uint32_t)((end - start) * 1000 / BENCH_CHURN_OPS);
+}
+
+static lv_obj_t * bench_scene(void)
+{
+    lv_obj_t * scr = lv_obj_create(NULL);
+
+    lv_obj_t * list = lv_list_create(scr);
+    lv_obj_set_size(list, LV_PCT(60), LV_PCT(100));
+    for (uint32_t i = 0; i < BENCH_ROWS; i++) {
+        char text[32];
+        snprintf(text, sizeof(text), "DSC_%04lu.JPG  %lu KB", (unsigned long)i, (unsigned long)(i * 37 % 4000));
+        lv_list_add_button(list, LV_SYMBOL_FILE, text);
+    }
+
+    lv_obj_t * side = lv_obj_create(scr);
+    lv_obj_set_size(side, LV_PCT(38), LV_PCT(100));
+    lv_obj_align(side, LV_ALIGN_TOP_RIGHT, 0, 0);
+    lv_obj_set_flex_flow(side, LV_FLEX_FLOW_COLUMN);
+    for (uint32_t i = 0; i < 6; i++) {
+        lv_obj_t * btn = lv_button_create(side);
+        lv_obj_t * label = lv_label_create(btn);
+        lv_label_set_text_fmt(label, "Action %lu", (unsigned long)i);
+    }
+
+    /* Drawn through a layer, the draw buffer of it comes from the LVGL heap */
+    lv_obj_t * panel = lv_obj_create(side);
+    lv_obj_set_size(panel, 100, 30);
+    lv_obj_set_style_opa(panel, LV_OPA_70, 0);
+    return scr;
+}
+
+static void bench_policy(const char * name, const lv_tier_mem_policy_t * policy)
+{
+    lv_tier_mem_stats_t internal, psram;
+    uint32_t malloc_ns, free_ns, fit, churn_failed;
+
+    lv_tier_mem_set_policy(policy);
+    lv_tier_mem_reset_stats();
+
+    printf("\n%s: internal blocks up to %u B, internal up to %u KB, PSRAM up to %u KB\n", name,
+           policy->small_max == SIZE_MAX ? 0 : (unsigned)policy->small_max, (unsigned)(policy->internal_limit / 1024),
+           (unsigned)(policy->psram_limit / 1024));
+    printf("%8s | %9s %9s | %4s\n", "size", "malloc ns", "free ns", "fit");
+    for (size_t i = 0; i < sizeof(bench_sizes) / sizeof(bench_sizes[0]); i++) {
+        bench_alloc(bench_sizes[i], &malloc_ns, &free_ns, &fit);
+        printf("%8u | %9lu %9lu | %4lu\n", (unsigned)bench_sizes[i], (unsigned long)malloc_ns, (unsigned long)free_ns,
+               (unsigned long)fit);
+    }
+    uint32_t churn_ns = bench_churn(&churn_failed);
+    printf("%8s | %9lu ns per op, %lu failed\n", "churn", (unsigned long)churn_ns, (unsigned long)churn_failed);
+
+    lv_obj_t * old = lv_screen_active();
+    int64_t start = esp_timer_get_time();
+    lv_obj_t * scr = bench_scene();
+    lv_screen_load(scr);
+    lv_refr_now(NULL);
+    uint32_t build_us = (uint32_t)(esp_timer_get_time() - start);
+
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_FRAMES; i++) {
+        lv_obj_invalidate(scr);
+        lv_refr_now(NULL);
+    }
+    uint32_t refresh_us = (uint32_t)((esp_timer_get_time() - start) / BENCH_FRAMES);
+
+    lv_tier_mem_get_stats(LV_TIER_MEM_INTERNAL, &internal);
+    lv_tier_mem_get_stats(LV_TIER_MEM_PSRAM, &psram);
+    printf("scene %d rows: build %lu us, refresh %lu us\n", BENCH_ROWS, (unsigned long)build_us,
+           (unsigned long)refresh_us);
+    printf("%8s | %6s %6s %6s | %5s %5s | %6s %6s %6s\n", "tier", "KB", "used", "peak", "frag", "pools", "grows",
+           "spills", "failed");
+    printf("%8s | %6u %6u %6u | %4u%% %5lu | %6lu %6lu %6lu\n", "internal", (unsigned)(internal.total / 1024),
+           (unsigned)(internal.used / 1024), (unsigned)(internal.peak / 1024), internal.frag_pct,
+           (unsigned long)internal.pools, (unsigned long)internal.grows, (unsigned long)internal.spills,
+           (unsigned long)internal.failed);
+    printf("%8s | %6u %6u %6u | %4u%% %5lu | %6lu %6lu %6lu\n", "PSRAM", (unsigned)(psram.total / 1024),
+           (unsigned)(psram.used / 1024), (unsigned)(psram.peak / 1024), psram.frag_pct, (unsigned long)psram.pools,
+           (unsigned long)psram.grows, (unsigned long)psram.spills, (unsigned long)psram.failed);
+
+    /* Back to an empty screen, the next policy starts from the first pool */
+    lv_screen_load(old);
+    lv_obj_delete(scr);
+    lv_refr_now(NULL);
+    lv_tier_mem_trim();
+}
+
+void app_main()
+{
+    lv_tier_mem_policy_t tiered, builtin, psram;
+
+    lv_init();
+    lv_tier_mem_get_default_policy(&tiered);
+    builtin.small_max = SIZE_MAX;
+    builtin.internal_limit = 48 * 1024;
+    builtin.psram_limit = 0;
+    psram = tiered;
+    psram.small_max = 0;
+
+    /* The display and its screen in internal RAM for all the runs */
+    lv_tier_mem_set_policy(&builtin);
+    if (bench_display_create(NULL) == NULL) {
+        printf("No memory for the draw buffer\n");
+        return;
+    }
+
+    printf("LVGL heap, %d blocks a size, %d churn ops, %dx%d RGB332\n", BENCH_BLOCKS, BENCH_CHURN_OPS,
+           BENCH_HOR_RES, BENCH_VER_RES);
+    bench_policy("builtin", &builtin);
+    bench_policy("tiered", &tiered);
+    bench_policy("psram", &psram);
+    lv_tier_mem_dump();
+}
@@ -0,0 +1,175 @@
+/* Sort benchmark: the 3-way quicksort the explorer used to run on lv_table cells against
+ * lv_fe_sort on the entry array, for 1000 and 10000 entries of random names, kinds, sizes
+ * and dates. The table is filled only as far as the LVGL heap allows, its row count is
+ * printed. Runs headless, nothing is drawn. lv_fe_dir.c makes the entry array and lv_fe_type.c
+ * the kinds, so FatFs is linked in although nothing is read from a card.
+ * Select this file in main/CMakeLists.txt
+ */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "lvgl.h"
+#include "../bench_display.h"
+
+extern "C"
+{
+    void app_main();
+    #include "lv_fe_type.c"
+    #include "lv_fe_dir.c"
+    #include "lv_fe_sort.c"
+}
+
+/* Stop filling the table before LVGL runs out, it asserts then */
+#define TABLE_HEAP_RESERVE (4 * 1024)
+
+static const uint32_t bench_counts[] = {1000, 10000};
+static const char * bench_ext[] = {"JPG", "TXT", "MP3", "BIN", "PNG", "MP4", ""};
+static uint32_t rand_state = 1;
+
+static uint32_t tick_cb(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static uint32_t bench_rand(void)
+{
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+static void make_entries(lv_fe_dir_t * dir, uint32_t count)
+{
+    char fn[32];
+
+    for (uint32_t i = 0; i < count; i++) {
+        const char * ext = bench_ext[bench_rand() % 7];
+        lv_fe_kind_t kind = LV_FE_KIND_DIR;
+        if (ext[0]) {
+            snprintf(fn, sizeof(fn), "IMG%lu.%s", (unsigned long)(bench_rand() % 100000), ext);
+            kind = lv_fe_kind_of(fn);
+        } else {
+            snprintf(fn, sizeof(fn), "DIR%lu", (unsigned long)(bench_rand() % 1000));
+        }
+        lv_fe_dir_add(dir, fn, kind, bench_rand() % 100000, bench_rand());
+    }
+}
+
+/* The table sort as it was: kind digit in column 1, swaps through a scratch cell */
+static void exch_table_item(lv_obj_t * tb, int16_t i, int16_t j)
+{
+    const char * tmp;
+    tmp = lv_table_get_cell_value(tb, i, 0);
+    lv_table_set_cell_value(tb, 0, 2, tmp);
+    lv_table_set_cell_value(tb, i, 0, lv_table_get_cell_value(tb, j, 0));
+    lv_table_set_cell_value(tb, j, 0, lv_table_get_cell_value(tb, 0, 2));
+
+    tmp = lv_table_get_cell_value(tb, i, 1);
+    lv_table_set_cell_value(tb, 0, 2, tmp);
+    lv_table_set_cell_value(tb, i, 1, lv_table_get_cell_value(tb, j, 1));
+    lv_table_set_cell_value(tb, j, 1, lv_table_get_cell_value(tb, 0, 2));
+}
+
+static void sort_by_file_kind(lv_obj_t * tb, int16_t lo, int16_t hi)
+{
+    if (lo >= hi) {
+        return;
+    }
+
+    int16_t lt = lo;
+    int16_t i = lo + 1;
+    int16_t gt = hi;
+    const char * v = lv_table_get_cell_value(tb, lo, 1);
+    while (i <= gt) {
+        if (lv_strcmp(lv_table_get_cell_value(tb, i, 1), v) < 0) {
+            exch_table_item(tb, lt++, i++);
+        } else if (lv_strcmp(lv_table_get_cell_value(tb, i, 1), v) > 0) {
+            exch_table_item(tb, i, gt--);
+        } else {
+            i++;
+        }
+    }
+
+    sort_by_file_kind(tb, lo, lt - 1);
+    sort_by_file_kind(tb, gt + 1, hi);
+}
+
+static uint32_t table_fill(lv_obj_t * table, const lv_fe_dir_t * dir)
+{
+    lv_mem_monitor_t mon;
+    char kind[2] = {0};
+    uint32_t index;
+
+    for (index = 0; index < dir->count && index < INT16_MAX; index++) {
+        lv_mem_monitor(&mon);
+        if (mon.free_biggest_size < TABLE_HEAP_RESERVE) {
+            break;
+        }
+        kind[0] = '0' + dir->entries[index].kind;
+        lv_table_set_cell_value_fmt(table, index, 0, "%s  %s", lv_fe_kind_symbol((lv_fe_kind_t)dir->entries[index].kind),
+                                    lv_fe_dir_name(dir, index));
+        lv_table_set_cell_value(table, index, 1, kind);
+    }
+    lv_table_set_row_count(table, index);
+    return index;
+}
+
+static void bench_sort(uint32_t count)
+{
+    lv_fe_dir_t dir;
+    lv_fe_dir_init(&dir);
+    make_entries(&dir, count);
+
+    lv_obj_t * table = lv_table_create(lv_screen_active());
+    uint32_t rows = table_fill(table, &dir);
+    int64_t start = esp_timer_get_time();
+    sort_by_file_kind(table, 0, (int16_t)(rows - 1));
+    uint32_t table_us = (uint32_t)(esp_timer_get_time() - start);
+    lv_obj_delete(table);
+
+    /* Every key starts from the same unsorted order */
+    size_t bytes = count * sizeof(lv_fe_entry_t);
+    lv_fe_entry_t * orig = (lv_fe_entry_t *)heap_caps_malloc_prefer(bytes, 2, MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT);
+    if (orig == NULL) {
+        printf("No memory for %lu entries\n", (unsigned long)count);
+        lv_fe_dir_free(&dir);
+        return;
+    }
+    memcpy(orig, dir.entries, bytes);
+
+    uint32_t key_us[4];
+    for (int key = LV_FE_SORT_KIND; key <= LV_FE_SORT_DATE; key++) {
+        memcpy(dir.entries, orig, bytes);
+        start = esp_timer_get_time();
+        lv_fe_sort(&dir, 0, (lv_fe_sort_key_t)key);
+        key_us[key] = (uint32_t)(esp_timer_get_time() - start);
+    }
+
+    printf("%6lu | %5lu %9lu | %9lu %9lu %9lu %9lu\n", (unsigned long)count, (unsigned long)rows,
+           (unsigned long)table_us, (unsigned long)key_us[LV_FE_SORT_KIND], (unsigned long)key_us[LV_FE_SORT_NAME],
+           (unsigned long)key_us[LV_FE_SORT_SIZE], (unsigned long)key_us[LV_FE_SORT_DATE]);
+
+    heap_caps_free(orig);
+    lv_fe_dir_free(&dir);
+}
+
+void app_main()
+{
+    lv_init();
+    lv_tick_set_cb(tick_cb);
+    if (bench_display_create(NULL) == NULL) {
+        printf("No memory for the draw buffer\n");
+        return;
+    }
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    printf("Sort, times in us (LVGL heap %u KB at start)\n", (unsigned)(mon.total_size / 1024));
+    printf("%6s | %5s %9s | %9s %9s %9s %9s\n", "items", "rows", "table", "kind", "name", "size", "date");
+    for (size_t i = 0; i < sizeof(bench_counts) / sizeof(bench_counts[0]); i++) {
+        bench_sort(bench_counts[i]);
+    }
+}
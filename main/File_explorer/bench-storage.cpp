@@ -0,0 +1,344 @@
+/* Storage benchmark: sequential and random read MB/s of an 8 MB file and the latency of open
+ * and stat over 32 small files, through FatFs as the VFS uses it. Sequential reads are 32 KB,
+ * random ones 4 KB at random sector aligned offsets, both into DMA-capable internal RAM.
+ * On the board then the same file through the VFS the way the loaders read it: read() into
+ * PSRAM, lv_fe_io_read() into PSRAM, read() into internal RAM, and 256 byte freads with the
+ * stdio buffer of newlib and of lv_fe_io_fopen(). The card is mounted by fs_init with the bus
+ * set in menuconfig, File explorer; the mode it came up with is in the log.
+ * Built for the IDF linux target (idf.py --preview set-target linux) FatFs runs on a 64 MB image
+ * file in /tmp, a file-backed block device, so the numbers are of FatFs and the host alone.
+ * There only lv_fe_io.c is built, with the fatfs and mem_telemetry of the linux MAIN_REQUIRES.
+ * The test files are written on the first run.
+ * Select this file in main/CMakeLists.txt
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "ff.h"
+#include "lvgl.h"
+
+extern "C"
+{
+    void app_main();
+    #include "lv_fe_io.c"
+#if CONFIG_IDF_TARGET_LINUX
+    #include "diskio_impl.h"
+#else
+    #include "lv_text_loader.c"
+    #include "lv_fe_type.c"
+    #include "lv_fe_dir.c"
+    #include "lv_fe_cache.c"
+    #include "lv_fe_sort.c"
+    #include "lv_fe_scan.c"
+    #include "lv_fe_list.c"
+    #include "lv_fe_thumb.c"
+    #include "lv_file_explorer.c"
+    #include "lv_jpeg_loader.c"
+    #include "lv_text_pager.c"
+    #include "lv_fe_tabs.c"
+#endif
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+#define BENCH_DRIVE "0:"
+#define BENCH_IMAGE "/tmp/fe_storage.img"
+#define BENCH_SECTOR 512
+#define BENCH_IMAGE_SECTORS (64 * 1024 * 1024 / BENCH_SECTOR)
+#else
+#define BENCH_DRIVE FATFS_DRIVE
+#endif
+
+/* 8.3 names, long names may be disabled */
+#define BENCH_FILE BENCH_DRIVE "/FE_BENCH.DAT"
+#define BENCH_SMALL_DIR BENCH_DRIVE "/FE_BENCH"
+#define BENCH_FILE_BYTES (8 * 1024 * 1024)
+#define BENCH_SEQ_CHUNK (32 * 1024)
+#define BENCH_RANDOM_CHUNK (4 * 1024)
+#define BENCH_RANDOM_READS 256
+#define BENCH_SMALL_FILES 32
+#define BENCH_FREAD_CHUNK 256
+
+static uint8_t * buf;
+
+static void print_row(const char * name, size_t bytes, uint32_t calls, int64_t us)
+{
+    printf("%-24s | %6lu %6lu %9lu | %7.2f %7lu\n", name, (unsigned long)(bytes / 1024), (unsigned long)calls,
+           (unsigned long)us, us > 0 ? (double)bytes / us : 0.0, (unsigned long)(calls ? us / calls : 0));
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+/* The block device: sectors of an image file */
+static int image_fd = -1;
+
+static DSTATUS image_status(BYTE pdrv)
+{
+    return image_fd < 0 ? STA_NOINIT : 0;
+}
+
+static DRESULT image_read(BYTE pdrv, BYTE * buff, DWORD sector, UINT count)
+{
+    ssize_t len = (ssize_t)count * BENCH_SECTOR;
+    return pread(image_fd, buff, len, (off_t)sector * BENCH_SECTOR) == len ? RES_OK : RES_ERROR;
+}
+
+static DRESULT image_write(BYTE pdrv, const BYTE * buff, DWORD sector, UINT count)
+{
+    ssize_t len = (ssize_t)count * BENCH_SECTOR;
+    return pwrite(image_fd, buff, len, (off_t)sector * BENCH_SECTOR) == len ? RES_OK : RES_ERROR;
+}
+
+static DRESULT image_ioctl(BYTE pdrv, BYTE cmd, void * buff)
+{
+    switch (cmd) {
+    case GET_SECTOR_COUNT:
+        *(DWORD *)buff = BENCH_IMAGE_SECTORS;
+        break;
+    case GET_SECTOR_SIZE:
+        *(WORD *)buff = BENCH_SECTOR;
+        break;
+    case GET_BLOCK_SIZE:
+        *(DWORD *)buff = 1;
+        break;
+    default:
+        break;
+    }
+    return RES_OK;
+}
+
+static const ff_diskio_impl_t image_impl = {image_status, image_status, image_read, image_write, image_ioctl};
+
+static bool image_mount(void)
+{
+    static FATFS fs;
+
+    image_fd = open(BENCH_IMAGE, O_RDWR | O_CREAT, 0644);
+    if (image_fd < 0 || ftruncate(image_fd, (off_t)BENCH_IMAGE_SECTORS * BENCH_SECTOR) != 0) {
+        printf("Can not create %s\n", BENCH_IMAGE);
+        return false;
+    }
+    ff_diskio_register(0, &image_impl);
+
+    FRESULT res = f_mount(&fs, BENCH_DRIVE, 1);
+    if (res == FR_NO_FILESYSTEM) {
+        /* Same allocation unit as the card is formatted with */
+        MKFS_PARM opt = {FM_ANY | FM_SFD, 0, 0, 0, 16 * 1024};
+        res = f_mkfs(BENCH_DRIVE, &opt, buf, BENCH_SEQ_CHUNK);
+        if (res == FR_OK) {
+            res = f_mount(&fs, BENCH_DRIVE, 1);
+        }
+    }
+    if (res != FR_OK) {
+        printf("Can not mount %s (%d)\n", BENCH_IMAGE, (int)res);
+        return false;
+    }
+    return true;
+}
+#endif
+
+static bool make_files(void)
+{
+    FILINFO info;
+    FIL f;
+    UINT written;
+    char path[64];
+
+    if (f_stat(BENCH_FILE, &info) != FR_OK || info.fsize != BENCH_FILE_BYTES) {
+        if (f_open(&f, BENCH_FILE, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+            printf("Can not create %s\n", BENCH_FILE);
+            return false;
+        }
+        for (size_t i = 0; i < BENCH_SEQ_CHUNK; i++) {
+            buf[i] = (uint8_t)(i * 7);
+        }
+        for (size_t done = 0; done < BENCH_FILE_BYTES; done += BENCH_SEQ_CHUNK) {
+            if (f_write(&f, buf, BENCH_SEQ_CHUNK, &written) != FR_OK || written != BENCH_SEQ_CHUNK) {
+                printf("Writing %s failed, card full?\n", BENCH_FILE);
+                f_close(&f);
+                return false;
+            }
+        }
+        f_close(&f);
+    }
+
+    f_mkdir(BENCH_SMALL_DIR);
+    for (int i = 0; i < BENCH_SMALL_FILES; i++) {
+        snprintf(path, sizeof(path), BENCH_SMALL_DIR "/F%02d.TXT", i);
+        if (f_stat(path, &info) == FR_OK) {
+            continue;
+        }
+        if (f_open(&f, path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+            printf("Can not create %s\n", path);
+            return false;
+        }
+        f_write(&f, path, strlen(path), &written);
+        f_close(&f);
+    }
+    return true;
+}
+
+static void bench_sequential(void)
+{
+    FIL f;
+    UINT n;
+    size_t total = 0;
+    uint32_t calls = 0;
+
+    int64_t start = esp_timer_get_time();
+    if (f_open(&f, BENCH_FILE, FA_READ) != FR_OK) {
+        return;
+    }
+    while (f_read(&f, buf, BENCH_SEQ_CHUNK, &n) == FR_OK && n > 0) {
+        total += n;
+        calls++;
+    }
+    f_close(&f);
+    print_row("sequential 32 KB", total, calls, esp_timer_get_time() - start);
+}
+
+static void bench_random(void)
+{
+    FIL f;
+    UINT n;
+    size_t total = 0;
+    uint32_t seed = 1;
+
+    if (f_open(&f, BENCH_FILE, FA_READ) != FR_OK) {
+        return;
+    }
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_RANDOM_READS; i++) {
+        seed = seed * 1103515245 + 12345;
+        FSIZE_t pos = (FSIZE_t)((seed >> 8) % (BENCH_FILE_BYTES / BENCH_RANDOM_CHUNK)) * BENCH_RANDOM_CHUNK;
+        if (f_lseek(&f, pos) == FR_OK && f_read(&f, buf, BENCH_RANDOM_CHUNK, &n) == FR_OK) {
+            total += n;
+        }
+    }
+    print_row("random 4 KB", total, BENCH_RANDOM_READS, esp_timer_get_time() - start);
+    f_close(&f);
+}
+
+static void bench_small_files(void)
+{
+    FILINFO info;
+    FIL f;
+    char path[64];
+    int64_t open_us = 0;
+    int64_t stat_us = 0;
+    uint32_t open_max = 0;
+    uint32_t stat_max = 0;
+
+    for (int i = 0; i < BENCH_SMALL_FILES; i++) {
+        snprintf(path, sizeof(path), BENCH_SMALL_DIR "/F%02d.TXT", i);
+
+        int64_t start = esp_timer_get_time();
+        if (f_open(&f, path, FA_READ) == FR_OK) {
+            f_close(&f);
+        }
+        uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+        open_us += us;
+        open_max = us > open_max ? us : open_max;
+
+        start = esp_timer_get_time();
+        f_stat(path, &info);
+        us = (uint32_t)(esp_timer_get_time() - start);
+        stat_us += us;
+        stat_max = us > stat_max ? us : stat_max;
+    }
+
+    printf("%-24s | %6d %9lu %9lu\n", "open + close", BENCH_SMALL_FILES,
+           (unsigned long)(open_us / BENCH_SMALL_FILES), (unsigned long)open_max);
+    printf("%-24s | %6d %9lu %9lu\n", "stat", BENCH_SMALL_FILES, (unsigned long)(stat_us / BENCH_SMALL_FILES),
+           (unsigned long)stat_max);
+}
+
+#if !CONFIG_IDF_TARGET_LINUX
+typedef enum {
+    VFS_READ,
+    VFS_IO_READ,
+    VFS_FREAD,
+    VFS_IO_FREAD,
+} vfs_mode_t;
+
+/* The whole file through the VFS, as the loaders read */
+static void bench_vfs(const char * name, vfs_mode_t mode, uint8_t * dst, size_t chunk)
+{
+    const char * path = MOUNT_POINT "/FE_BENCH.DAT";
+    size_t total = 0;
+    uint32_t calls = 0;
+
+    if (dst == NULL) {
+        printf("%-24s | no memory\n", name);
+        return;
+    }
+    int64_t start = esp_timer_get_time();
+    if (mode == VFS_FREAD || mode == VFS_IO_FREAD) {
+        FILE * f = mode == VFS_FREAD ? fopen(path, "rb") : lv_fe_io_fopen(path, "rb");
+        if (f == NULL) {
+            return;
+        }
+        size_t n;
+        while ((n = fread(dst, 1, chunk, f)) > 0) {
+            total += n;
+            calls++;
+        }
+        fclose(f);
+    } else {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        ssize_t n;
+        while ((n = mode == VFS_READ ? read(fd, dst, chunk) : lv_fe_io_read(fd, dst, chunk)) > 0) {
+            total += n;
+            calls++;
+        }
+        close(fd);
+    }
+    print_row(name, total, calls, esp_timer_get_time() - start);
+}
+#endif
+
+void app_main()
+{
+    buf = (uint8_t *)lv_fe_io_alloc(BENCH_SEQ_CHUNK);
+    if (buf == NULL) {
+        printf("No internal memory for the read buffer\n");
+        return;
+    }
+#if CONFIG_IDF_TARGET_LINUX
+    if (!image_mount()) {
+        return;
+    }
+    printf("FatFs on %s\n", BENCH_IMAGE);
+#else
+    fs_init();
+    printf("FatFs on the SD card, %s\n", MOUNT_POINT);
+#endif
+    if (!make_files()) {
+        return;
+    }
+
+    printf("%-24s | %6s %6s %9s | %7s %7s\n", "read", "KB", "calls", "us", "MB/s", "us/call");
+    bench_sequential();
+    bench_random();
+    printf("\n%-24s | %6s %9s %9s\n", "latency", "files", "avg us", "max us");
+    bench_small_files();
+
+#if !CONFIG_IDF_TARGET_LINUX
+    uint8_t * psram = (uint8_t *)heap_caps_malloc(BENCH_SEQ_CHUNK, MALLOC_CAP_SPIRAM);
+    printf("\n%-24s | %6s %6s %9s | %7s %7s\n", "VFS", "KB", "calls", "us", "MB/s", "us/call");
+    bench_vfs("read() PSRAM 32 KB", VFS_READ, psram, BENCH_SEQ_CHUNK);
+    bench_vfs("lv_fe_io_read PSRAM", VFS_IO_READ, psram, BENCH_SEQ_CHUNK);
+    bench_vfs("read() internal 32 KB", VFS_READ, buf, BENCH_SEQ_CHUNK);
+    bench_vfs("fread 256 B", VFS_FREAD, buf, BENCH_FREAD_CHUNK);
+    bench_vfs("lv_fe_io_fopen fread", VFS_IO_FREAD, buf, BENCH_FREAD_CHUNK);
+    heap_caps_free(psram);
+#endif
+    lv_fe_io_free(buf);
+}
@@ -0,0 +1,228 @@
+/* Text loading benchmark: the old fgets/strcat lv_read_file against lv_text_load and the
+ * streaming first screen of lv_text_stream, on 10 KB, 1 MB and 10 MB files.
+ * On the board also the paged viewer on a 960x540 screen: making the page index, opening
+ * again with the index read back, random page jumps and page turns, the heap it holds and how
+ * long making the index waited for the read-ahead.
+ * On the board the files are written to the SD card (fs_init, /S). Built for the IDF linux
+ * target (idf.py --preview set-target linux) they go to /tmp, as a host file system stand-in,
+ * and only the loader is built: lv_fe_io.c, lv_fe_reader.c and lv_text_loader.c, with the
+ * mem_telemetry of the linux MAIN_REQUIRES.
+ * Select this file in main/CMakeLists.txt
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "lvgl.h"
+
+extern "C"
+{
+    void app_main();
+    #include "lv_fe_io.c"
+    #include "lv_fe_reader.c"
+    #include "lv_text_loader.c"
+#if !CONFIG_IDF_TARGET_LINUX
+    #include "lv_fe_type.c"
+    #include "lv_fe_dir.c"
+    #include "lv_fe_cache.c"
+    #include "lv_fe_sort.c"
+    #include "lv_fe_scan.c"
+    #include "lv_fe_list.c"
+    #include "lv_fe_thumb.c"
+    #include "lv_file_explorer.c"
+    #include "lv_jpeg_loader.c"
+    #include "lv_text_pager.c"
+    #include "lv_fe_tabs.c"
+#endif
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+#define BENCH_DIR "/tmp"
+/* strcat is quadratic, above this size it takes minutes */
+#define LEGACY_MAX_BYTES (1024 * 1024)
+#else
+#define BENCH_DIR MOUNT_POINT
+#define LEGACY_MAX_BYTES (128 * 1024)
+#define BENCH_HOR_RES 960
+#define BENCH_VER_RES 540
+#define BENCH_JUMPS 100
+#endif
+
+static const size_t bench_sizes[] = {10 * 1024, 1024 * 1024, 10 * 1024 * 1024};
+
+static SemaphoreHandle_t stream_done;
+static lv_text_load_stats_t stream_stats;
+
+/* Same lines as a book: words and a line end every 60-80 bytes */
+static bool make_file(const char * path, size_t size)
+{
+    struct stat st;
+    if (stat(path, &st) == 0 && (size_t)st.st_size == size) {
+        return true;
+    }
+    FILE * f = fopen(path, "w");
+    if (f == NULL) {
+        printf("Can not create %s\n", path);
+        return false;
+    }
+    static char line[96];
+    size_t written = 0;
+    uint32_t n = 0;
+    while (written < size) {
+        int len = snprintf(line, sizeof(line), "%06lu The quick brown fox jumps over the lazy dog %.*s\n",
+                           (unsigned long)n, (int)(n % 20), "....................");
+        if ((size_t)len > size - written) {
+            len = size - written;
+        }
+        fwrite(line, 1, len, f);
+        written += len;
+        n++;
+    }
+    fclose(f);
+    return true;
+}
+
+/* lv_read_file as it was, with the buffer terminated so it can run at all */
+static char * legacy_read(const char * path)
+{
+    FILE * f = fopen(path, "r");
+    struct stat st;
+    if (f == NULL || stat(path, &st) != 0) {
+        return NULL;
+    }
+    char * output = (char *)heap_caps_calloc(1, st.st_size + 1, MALLOC_CAP_SPIRAM);
+    char buf[1025];
+    while (output && fgets(buf, sizeof(buf), f) != NULL) {
+        strcat(output, buf);
+    }
+    fclose(f);
+    return output;
+}
+
+static void stream_done_cb(lv_obj_t * ta, const lv_text_buf_t * text, esp_err_t res,
+                           const lv_text_load_stats_t * stats, void * user_data)
+{
+    stream_stats = *stats;
+    lv_text_buf_free((lv_text_buf_t *)text);
+    xSemaphoreGive(stream_done);
+}
+
+static void bench_file(size_t size)
+{
+    char path[64];
+    snprintf(path, sizeof(path), BENCH_DIR "/bench%lu.txt", (unsigned long)(size / 1024));
+    if (!make_file(path, size)) {
+        return;
+    }
+
+    char legacy[24] = "skipped";
+    if (size <= LEGACY_MAX_BYTES) {
+        int64_t start = esp_timer_get_time();
+        char * out = legacy_read(path);
+        snprintf(legacy, sizeof(legacy), "%lu", (unsigned long)(esp_timer_get_time() - start));
+        heap_caps_free(out);
+    }
+
+    lv_text_buf_t text;
+    lv_text_load_stats_t load;
+    if (lv_text_load(path, &text, &load) != ESP_OK || text.len != size) {
+        printf("%s: load failed (%u bytes)\n", path, (unsigned)text.len);
+    }
+    lv_text_buf_free(&text);
+
+    lv_text_stream_config_t cfg = {};
+    cfg.done_cb = stream_done_cb;
+    if (lv_text_stream(path, &cfg) == ESP_OK) {
+        xSemaphoreTake(stream_done, portMAX_DELAY);
+    }
+
+    printf("%9lu %12s %10lu %8.2f %6lu %10lu %10lu\n", (unsigned long)size, legacy, (unsigned long)load.total_us,
+           load.total_us ? (double)size / load.total_us : 0.0, (unsigned long)load.reads,
+           (unsigned long)stream_stats.first_us, (unsigned long)stream_stats.total_us);
+}
+
+#if !CONFIG_IDF_TARGET_LINUX
+/* Nothing is drawn, the pages are only laid out */
+static void bench_pager(lv_obj_t * pager, size_t size)
+{
+    char path[64];
+    char index[64];
+    snprintf(path, sizeof(path), BENCH_DIR "/bench%lu.txt", (unsigned long)(size / 1024));
+    snprintf(index, sizeof(index), BENCH_DIR "/bench%lu.txt." LV_TEXT_PAGER_INDEX_EXT, (unsigned long)(size / 1024));
+    unlink(index);
+
+    size_t free0 = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    if (lv_text_pager_open(pager, path) != ESP_OK) {
+        printf("%s: open failed\n", path);
+        return;
+    }
+    size_t held = free0 - heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    uint32_t index_us = lv_text_pager_get_stats(pager)->index_us;
+    uint32_t stall_us = lv_text_pager_get_stats(pager)->index_stall_us;
+    uint32_t pages = lv_text_pager_get_page_count(pager, NULL);
+
+    int64_t start = esp_timer_get_time();
+    lv_text_pager_open(pager, path);
+    uint32_t reopen_us = (uint32_t)(esp_timer_get_time() - start);
+    bool reused = lv_text_pager_get_stats(pager)->index_reused;
+
+    uint32_t jump_max = 0;
+    uint64_t jump_total = 0;
+    srand(1);
+    for (int i = 0; i < BENCH_JUMPS; i++) {
+        if (lv_text_pager_set_page(pager, rand() % pages)) {
+            uint32_t us = lv_text_pager_get_stats(pager)->page_us;
+            jump_total += us;
+            jump_max = us > jump_max ? us : jump_max;
+        }
+    }
+
+    lv_text_pager_set_page(pager, 0);
+    uint64_t next_total = 0;
+    int turns = 0;
+    while (turns < BENCH_JUMPS && lv_text_pager_next(pager)) {
+        next_total += lv_text_pager_get_stats(pager)->page_us;
+        turns++;
+    }
+
+    printf("%9lu %7lu %6lu %10lu %10s %8lu %8lu %8lu %7lu\n", (unsigned long)size, (unsigned long)pages,
+           (unsigned long)lv_text_pager_get_stats(pager)->window, (unsigned long)index_us,
+           reused ? "read back" : "rebuilt", (unsigned long)reopen_us, (unsigned long)(jump_total / BENCH_JUMPS),
+           (unsigned long)jump_max, (unsigned long)(turns ? next_total / turns : 0));
+    printf("%9s held %u bytes, the index waited %lu us for the card\n", "", (unsigned)held, (unsigned long)stall_us);
+}
+#endif
+
+void app_main()
+{
+#if !CONFIG_IDF_TARGET_LINUX
+    fs_init();
+#endif
+    stream_done = xSemaphoreCreateBinary();
+
+    printf("Text loading in %s, block %d bytes, times in us\n", BENCH_DIR, LV_TEXT_LOADER_BLOCK_SIZE);
+    printf("%9s %12s %10s %8s %6s %10s %10s\n", "bytes", "strcat", "load", "MB/s", "reads", "1st screen", "streamed");
+    for (size_t i = 0; i < sizeof(bench_sizes) / sizeof(bench_sizes[0]); i++) {
+        bench_file(bench_sizes[i]);
+    }
+
+#if !CONFIG_IDF_TARGET_LINUX
+    lv_init();
+    lv_display_create(BENCH_HOR_RES, BENCH_VER_RES);
+    lv_obj_t * pager = lv_text_pager_create(lv_screen_active());
+    lv_obj_set_size(pager, BENCH_HOR_RES, BENCH_VER_RES);
+    lv_obj_update_layout(pager);
+
+    printf("\nPaged viewer %dx%d, times in us\n", BENCH_HOR_RES, BENCH_VER_RES);
+    printf("%9s %7s %6s %10s %10s %8s %8s %8s %7s\n", "bytes", "pages", "window", "index", "index file", "reopen",
+           "jump", "jump max", "next");
+    for (size_t i = 0; i < sizeof(bench_sizes) / sizeof(bench_sizes[0]); i++) {
+        bench_pager(pager, bench_sizes[i]);
+    }
+#endif
+}
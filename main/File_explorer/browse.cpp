@@ -28,12 +28,37 @@
 // LVGL
 #include "lvgl/lvgl.h"
 #include "lvgl_helpers.h"
+#include "lv_tier_mem.h"
+#include "mem_telemetry.h"
+#if CONFIG_FE_TOUCH_GESTURES
+#include "driver/i2c.h"
+#include "nvs_flash.h"
+#include "touch_probe.h"
+#include "esp_lcd_touch_gesture.h"
+#endif
 
 extern "C"
 {
     void app_main();
     // Our custom lv_file_explorer
+    #include "lv_fe_io.c"
+    #include "lv_fe_reader.c"
+    #include "lv_text_loader.c"
+    #include "lv_fe_type.c"
+    #include "lv_fe_dir.c"
+    #include "lv_fe_cache.c"
+    #include "lv_fe_sort.c"
+    #include "lv_fe_scan.c"
+    #include "lv_fe_list.c"
+    #include "lv_fe_thumb.c"
     #include "lv_file_explorer.c"
+    #include "lv_jpeg_loader.c"
+    #include "lv_text_pager.c"
+    #include "lv_fe_tabs.c"
+    #include "lv_asset_pack.c"
+    #include "lv_epi_loader.c"
+    #include "lv_glyph_cache.c"
+    #include "lv_fe_gesture.c"
     //#include "include/lv_file_explorer.h"
 }
 
@@ -46,9 +71,15 @@ extern "C"
 lv_obj_t * tab_main_view;
 lv_obj_t * tab_main;
 lv_obj_t * tab_settings;
-lv_obj_t * tab_open_file;
+lv_obj_t * tabs_label;
 lv_obj_t * switch_label;
 uint8_t led_duty_multiplier = 80;
+static lv_fe_tabs_t doc_tabs;
+#if CONFIG_FE_TOUCH_GESTURES
+static esp_lcd_touch_handle_t fe_touch;
+static esp_lcd_touch_gesture_handle_t fe_touch_gesture;
+static lv_fe_gesture_t fe_gestures;
+#endif
 
 /**********************
  *  STATIC PROTOTYPES
@@ -56,8 +87,15 @@ uint8_t led_duty_multiplier = 80;
 static void lv_tick_task(void *arg);
 static void guiTask(void *pvParameter);
 static void create_demo_application(void);
+#if CONFIG_FE_TOUCH_GESTURES
+static void touch_gesture_init(void);
+static void touch_gesture_read(lv_indev_t * indev, lv_indev_data_t * data);
+#endif
 
 #define DISPLAY_FRONTLIGHT    GPIO_NUM_11
+#define TOUCH_SDA             CONFIG_TOUCH_I2C_SDA
+#define TOUCH_SCL             CONFIG_TOUCH_I2C_SCL
+#define TOUCH_I2C_PORT        ((i2c_port_t)CONFIG_TOUCH_I2C_PORT)
 
 #define LV_TICK_PERIOD_MS 1
 #define LEDC_TIMER              LEDC_TIMER_0
@@ -109,7 +147,9 @@ void app_main() {
     /* If you want to use a task to create the graphic, you NEED to create a Pinned task
      * Otherwise there can be problem such as memory corruption and so on.
      * NOTE: When not using Wi-Fi nor Bluetooth you can pin the guiTask to core 0 */
-    xTaskCreatePinnedToCore(guiTask, "gui", 4096*2, NULL, 0, NULL, 1);
+    /* Before lv_init(), the LVGL heap blocks are counted from the first one */
+    ESP_ERROR_CHECK(mem_tel_init());
+    xTaskCreatePinnedToCore(guiTask, "gui", CONFIG_FE_GUI_TASK_STACK, NULL, 0, NULL, 1);
 }
 
 static void guiTask(void *pvParameter) {
@@ -125,11 +165,11 @@ static void guiTask(void *pvParameter) {
        This size must much the size of DISP_BUF_SIZE declared on lvgl_helpers.h
     */
     printf("DISP_BUF*sizeof(lv_color_t) %d", DISP_BUF_SIZE * sizeof(lv_color_t));
-    lv_color_t* buf1 = (lv_color_t*) heap_caps_malloc(DISP_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
+    lv_color_t* buf1 = (lv_color_t*) mem_tel_malloc(MEM_TEL_DRAW_BUF, DISP_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
     
     // OPTIONAL: Do not use double buffer for epaper
     //lv_color_t* buf2 = NULL;
-    lv_color_t* buf2 = (lv_color_t*) heap_caps_malloc(DISP_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
+    lv_color_t* buf2 = (lv_color_t*) mem_tel_malloc(MEM_TEL_DRAW_BUF, DISP_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
     assert(buf1 != NULL);
     
     //size_in_px /= 8; // In v9 size is in bytes
@@ -151,7 +191,9 @@ static void guiTask(void *pvParameter) {
     lv_display_set_buffers(disp, buf1, buf2, DISP_BUF_SIZE, LV_DISPLAY_RENDER_MODE_PARTIAL);
 
     /* Register an input device when enabled on the menuconfig */
-#if CONFIG_LV_TOUCH_CONTROLLER != TOUCH_CONTROLLER_NONE
+#if CONFIG_FE_TOUCH_GESTURES
+    touch_gesture_init();
+#elif CONFIG_LV_TOUCH_CONTROLLER != TOUCH_CONTROLLER_NONE
     lv_indev_t * indev = lv_indev_create();
     lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
     lv_indev_set_read_cb(indev, (lv_indev_read_cb_t) touch_driver_read);
@@ -166,10 +208,12 @@ static void guiTask(void *pvParameter) {
     ESP_ERROR_CHECK(esp_timer_create(&periodic_timer_args, &periodic_timer));
     ESP_ERROR_CHECK(esp_timer_start_periodic(periodic_timer, LV_TICK_PERIOD_MS * 1000));
 
-    /* Create the demo application */
+    /* Create the demo application. Under the lock: the explorer already reads /S on its worker task */
+    xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
     create_demo_application();
     /* Force screen refresh */
     lv_refr_now(NULL);
+    xSemaphoreGive(xGuiSemaphore);
 
     while (1) {
         /* Delay 1 tick (assumes FreeRTOS tick is 10ms */
@@ -183,11 +227,106 @@ static void guiTask(void *pvParameter) {
     }
 
     /* A task should NEVER return */
-    free(buf1);
+    mem_tel_free(MEM_TEL_DRAW_BUF, buf1);
+    mem_tel_free(MEM_TEL_DRAW_BUF, buf2);
     vTaskDelete(NULL);
 }
 
 
+static void text_page_event_handler(lv_event_t * e)
+{
+    lv_obj_t * pager = (lv_obj_t*)lv_event_get_target(e);
+    lv_obj_t * page_label = (lv_obj_t*)lv_event_get_user_data(e);
+    bool complete;
+    uint32_t count = lv_text_pager_get_page_count(pager, &complete);
+
+    /* Pages are still counted while reading starts */
+    lv_label_set_text_fmt(page_label, "%lu / %lu%s", (unsigned long)lv_text_pager_get_page(pager) + 1,
+                          (unsigned long)count, complete ? "" : "+");
+}
+
+/* Fill the tab of an opened file */
+static size_t doc_load(lv_obj_t * tab, lv_fe_doc_t * doc)
+{
+    const char * name = strrchr(doc->path, '/') + 1;
+
+    if (doc->type == LV_FE_TYPE_JPEG) {
+        /* Decoded to fit the tab, scaled down in the decoder and converted to the display format */
+        lv_obj_t * wp = lv_image_create(tab);
+        esp_err_t res = lv_jpeg_image_set_src(wp, doc->path, lv_obj_get_content_width(tab),
+                                              lv_obj_get_content_height(tab), LV_COLOR_FORMAT_RGB332);
+        if (res != ESP_OK) {
+            lv_obj_delete(wp);
+            lv_obj_t * label = lv_label_create(tab);
+            lv_label_set_text_fmt(label, "Can not show %s: %s", name, esp_err_to_name(res));
+            return 0;
+        }
+        lv_obj_center(wp);
+        const lv_image_dsc_t * dsc = (const lv_image_dsc_t *)lv_image_get_src(wp);
+        return sizeof(lv_image_dsc_t) + dsc->data_size;
+    }
+
+    if (doc->type == LV_FE_TYPE_EPI) {
+        /* Already in the panel format, the rows are unpacked into the image as they are read */
+        lv_obj_t * wp = lv_image_create(tab);
+        esp_err_t res = lv_epi_image_set_src(wp, doc->path, lv_obj_get_content_width(tab),
+                                             lv_obj_get_content_height(tab), LV_COLOR_FORMAT_RGB332);
+        if (res != ESP_OK) {
+            lv_obj_delete(wp);
+            lv_obj_t * label = lv_label_create(tab);
+            lv_label_set_text_fmt(label, "Can not show %s: %s", name, esp_err_to_name(res));
+            return 0;
+        }
+        lv_obj_center(wp);
+        const lv_image_dsc_t * dsc = (const lv_image_dsc_t *)lv_image_get_src(wp);
+        return sizeof(lv_image_dsc_t) + dsc->data_size;
+    }
+
+    /* Text: one page per screen above the page number, the pages are laid out for the size it gets */
+    lv_obj_set_flex_flow(tab, LV_FLEX_FLOW_COLUMN);
+    lv_obj_t * pager = lv_text_pager_create(tab);
+    lv_obj_set_width(pager, LV_PCT(100));
+    lv_obj_set_flex_grow(pager, 1);
+    lv_text_pager_set_gui_lock(pager, xGuiSemaphore);
+    lv_obj_t * page_label = lv_label_create(tab);
+    lv_label_set_text(page_label, "");
+    lv_obj_add_event_cb(pager, text_page_event_handler, LV_EVENT_VALUE_CHANGED, page_label);
+    lv_obj_update_layout(tab);
+    if (lv_text_pager_open(pager, doc->path) != ESP_OK) {
+        lv_label_set_text(page_label, "Failed to open file");
+        return 0;
+    }
+    /* Back on the page it was left at, if the index is there */
+    lv_text_pager_set_page(pager, doc->state);
+    return lv_text_pager_get_stats(pager)->held;
+}
+
+/* The tab manager tells when, the objects of the tab count for the document */
+static size_t doc_load_cb(lv_obj_t * tab, lv_fe_doc_t * doc, void * user_data)
+{
+    mem_tel_scope_begin(lv_fe_type_kind(doc->type) == LV_FE_KIND_IMAGE ? MEM_TEL_IMAGE : MEM_TEL_TEXT);
+    size_t bytes = doc_load(tab, doc);
+    mem_tel_scope_end();
+    return bytes;
+}
+
+static void doc_unload_cb(lv_obj_t * tab, lv_fe_doc_t * doc, void * user_data)
+{
+    lv_obj_t * pager = lv_obj_get_child(tab, 0);
+    if (pager && lv_obj_check_type(pager, &lv_text_pager_class)) {
+        doc->state = lv_text_pager_get_page(pager);
+    }
+}
+
+static void doc_changed_cb(void * user_data)
+{
+    static char text[512];
+    lv_fe_tabs_format(&doc_tabs, text, sizeof(text));
+    lv_label_set_text(tabs_label, text);
+    /* A tab was opened, closed or unloaded: give the emptied LVGL heap pools back */
+    lv_tier_mem_trim();
+}
+
 static void file_explorer_event_handler(lv_event_t * e)
 {
     lv_event_code_t code = lv_event_get_code(e);
@@ -196,62 +335,28 @@ static void file_explorer_event_handler(lv_event_t * e)
     if(code == LV_EVENT_VALUE_CHANGED) {
         const char * cur_path =  lv_file_explorer_get_current_path(obj);
         const char * sel_fn = lv_file_explorer_get_selected_file_name(obj);
+        char file_open[LV_FILE_EXPLORER_PATH_MAX_LEN];
         
         LV_LOG_USER("%s%s", cur_path, sel_fn);
         printf("CHANGED path: %s file: %s\n", cur_path, sel_fn);
-        // Todo move this to a central location
-        char * file_open = (char *) malloc(1 + strlen(cur_path)+ strlen(sel_fn) );
-        strcpy(file_open, cur_path);
-        strcat(file_open, sel_fn);
+        snprintf(file_open, sizeof(file_open), "%s%s", cur_path, sel_fn);
 
-        if (is_end_with(sel_fn, ".gif") == true) {
-            printf("GIF viewer not implemented\n");
+        lv_fe_type_t type = lv_fe_type_from_name(sel_fn);
+        /* Images are checked against their first bytes, a renamed file would crash the decoder */
+        if (lv_fe_type_kind(type) == LV_FE_KIND_IMAGE && lv_fe_type_from_file(file_open) != type) {
+            ESP_LOGW(TAG, "%s is not what its extension says", file_open);
+            type = LV_FE_TYPE_UNKNOWN;
         }
 
-        if (is_end_with(sel_fn, ".jpg") || is_end_with(sel_fn, ".JPG")) {
-            tab_open_file = lv_tabview_add_tab(tab_main_view, sel_fn);
-            lv_tabview_set_active(tab_main_view, lv_tabview_get_tab_count(tab_main_view), LV_ANIM_OFF);
-            
-            /* Build up the img descriptor of LVGL */
-            lv_image_dsc_t imgdsc;
-            imgdsc.header.cf = LV_COLOR_FORMAT_RGB332;
-            imgdsc.header.w = 720;
-            imgdsc.header.h = 609;
-            // TODO how to set w & h dynamically
-            imgdsc.data = lv_read_img(file_open, imgdsc);
-            //decoder_info() outputs JPEGDEC is being used
-            ESP_LOG_BUFFER_HEX(TAG, imgdsc.data, 10);
-            ESP_LOGI(TAG, "DOES NOT WORK YET!\nimg w:%d h:%d with %d bytes", imgdsc.header.w, imgdsc.header.h, (int) imgdsc.data_size);
-            lv_obj_t * wp;
-
-            wp = lv_img_create(tab_open_file);
-            lv_image_set_src(wp, &imgdsc);
-            lv_obj_center(wp);
-            //lv_obj_set_width(wp, 1000);
-            //lv_obj_set_height(wp, 700);
+        if (type == LV_FE_TYPE_GIF) {
+            printf("GIF viewer not implemented\n");
         }
 
-        if (is_end_with(sel_fn, ".txt") == true) {
-            // Check how to delete when we have more than X tabs
-            /* if (file_open_tabs>0) {
-              lv_obj_clean(tab_open_file);
-            } */
-            
-            /*Add content to the tabs*/
-            tab_open_file = lv_tabview_add_tab(tab_main_view, sel_fn);
-        
-            // TODO: Check how to set last Tab as active
-            lv_tabview_set_active(tab_main_view, lv_tabview_get_tab_count(tab_main_view), LV_ANIM_OFF);
+        /* A tab each, the least recently used are unloaded and closed by the tab manager */
+        if (type == LV_FE_TYPE_JPEG || type == LV_FE_TYPE_EPI || type == LV_FE_TYPE_TXT) {
             printf("PATH to open: %s\n\n", file_open);
-            const char * file_content = lv_read_file(file_open);
-            printf("\n\n%s", file_content);
-            /* Create the text area */
-            lv_obj_t * ta = lv_textarea_create(tab_open_file);
-            lv_obj_set_width(ta, 1000);
-            lv_obj_set_height(ta, 700);
-            lv_textarea_set_text(ta, file_content);
+            lv_fe_tabs_open(&doc_tabs, file_open, type);
         }
-        
     }
 }
 
@@ -260,6 +365,7 @@ void lv_example_file_explorer(lv_obj_t * tab)
     fs_init();
     lv_obj_t * file_explorer = lv_file_explorer_create(tab);
     lv_file_explorer_set_sort(file_explorer, LV_EXPLORER_SORT_KIND);
+    lv_file_explorer_set_gui_lock(file_explorer, xGuiSemaphore);
     lv_file_explorer_open_dir(file_explorer, "/S");
 
     lv_obj_add_event_cb(file_explorer, file_explorer_event_handler, LV_EVENT_ALL, NULL);
@@ -284,11 +390,30 @@ static void switch_event_handler(lv_event_t * e) {
     }
 }
 
+#if CONFIG_MEM_TELEMETRY
+/* Who holds the heap and the stacks, as a table and as a snapshot line for scripts/mem_snapshot.py */
+static void mem_report_event_handler(lv_event_t * e)
+{
+    mem_tel_sample_stacks();
+    mem_tel_report();
+    mem_tel_print_snapshot();
+}
+#endif
+
 /**
  * A default slider with a label displaying the current value
  */
 void create_demo_application(void)
 {
+    /* Fonts and images of the assets partition, read in place from flash. Without it the built-in ones */
+    lv_glyph_cache_init(CONFIG_FE_GLYPH_CACHE_KB * 1024);
+    const lv_font_t * ui_font = NULL;
+    if (lv_asset_pack_mount(NULL) == ESP_OK) {
+        ui_font = lv_asset_pack_font("ui");
+    }
+    /* The rendered glyphs are kept in PSRAM */
+    lv_obj_set_style_text_font(lv_scr_act(), lv_glyph_cache_font(ui_font ? ui_font : LV_FONT_DEFAULT), 0);
+
     /* Create a Tab view object (global) */
     tab_main_view = lv_tabview_create(lv_scr_act());
     lv_obj_set_scrollbar_mode(lv_scr_act(), LV_SCROLLBAR_MODE_OFF);
@@ -298,9 +423,15 @@ void create_demo_application(void)
     tab_settings = lv_tabview_add_tab(tab_main_view, "Settings");
     lv_obj_remove_flag(tab_settings, LV_OBJ_FLAG_SCROLLABLE);
 
+    lv_obj_set_flex_flow(tab_settings, LV_FLEX_FLOW_COLUMN);
+    const lv_image_dsc_t * logo_dsc = lv_asset_pack_image("logo");
+    if (logo_dsc) {
+        lv_obj_t * logo = lv_image_create(tab_settings);
+        lv_image_set_src(logo, logo_dsc);
+    }
+
     lv_obj_t * sw;
     sw = lv_switch_create(tab_settings);
-    lv_obj_set_flex_flow(tab_settings, LV_FLEX_FLOW_COLUMN);
     lv_obj_set_flex_align(sw, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
 
     switch_label = lv_label_create(tab_settings);
@@ -312,10 +443,101 @@ void create_demo_application(void)
 
     lv_obj_add_event_cb(sw, switch_event_handler, LV_EVENT_ALL, NULL);
     lv_obj_add_flag(sw, LV_OBJ_FLAG_EVENT_BUBBLE);
-    
+
+    /* Memory of the opened files, updated by the tab manager */
+    tabs_label = lv_label_create(tab_settings);
+
+    lv_fe_tabs_config_t tabs_cfg = {};
+    tabs_cfg.max_tabs = CONFIG_FE_TABS_MAX;
+    tabs_cfg.budget_bytes = CONFIG_FE_TABS_BUDGET_KB * 1024;
+    tabs_cfg.load_cb = doc_load_cb;
+    tabs_cfg.unload_cb = doc_unload_cb;
+    tabs_cfg.changed_cb = doc_changed_cb;
+    lv_fe_tabs_init(&doc_tabs, tab_main_view, &tabs_cfg);
+    doc_changed_cb(NULL);
+
+#if CONFIG_MEM_TELEMETRY
+    lv_obj_t * mem_btn = lv_button_create(tab_settings);
+    lv_obj_t * mem_label = lv_label_create(mem_btn);
+    lv_label_set_text(mem_label, "Memory report");
+    lv_obj_add_event_cb(mem_btn, mem_report_event_handler, LV_EVENT_CLICKED, NULL);
+#endif
+
+    mem_tel_scope_begin(MEM_TEL_EXPLORER);
     lv_example_file_explorer(tab_main);
+    mem_tel_scope_end();
+
+#if CONFIG_FE_TOUCH_GESTURES
+    /* The explorer is the first child of its tab */
+    if (fe_touch_gesture) {
+        lv_fe_gesture_init(&fe_gestures, lv_obj_get_child(tab_main, 0), esp_lcd_touch_gesture_get_queue(fe_touch_gesture));
+    }
+#endif
 }
 
+#if CONFIG_FE_TOUCH_GESTURES
+/* The controller on its own I2C bus, read as the LVGL pointer. The recogniser gets all its points. */
+static void touch_gesture_init(void)
+{
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        nvs_flash_init();
+    }
+
+    i2c_config_t i2c_conf = {};
+    i2c_conf.mode = I2C_MODE_MASTER;
+    i2c_conf.sda_io_num = TOUCH_SDA;
+    i2c_conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
+    i2c_conf.scl_io_num = TOUCH_SCL;
+    i2c_conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
+    i2c_conf.master.clk_speed = CONFIG_TOUCH_I2C_CLK_HZ;
+    ESP_ERROR_CHECK(i2c_param_config(TOUCH_I2C_PORT, &i2c_conf));
+    ESP_ERROR_CHECK(i2c_driver_install(TOUCH_I2C_PORT, i2c_conf.mode, 0, 0, 0));
+
+    /* As TOUCH_PROBE_DEFAULT_CONFIG(), which C++ does not take */
+    touch_probe_config_t cfg = {};
+    cfg.port = TOUCH_I2C_PORT;
+    cfg.touch.x_max = LV_HOR_RES_MAX;
+    cfg.touch.y_max = LV_VER_RES_MAX;
+    cfg.touch.rst_gpio_num = GPIO_NUM_NC;
+    cfg.touch.int_gpio_num = GPIO_NUM_NC;
+    cfg.timeout_ms = 10;
+    touch_probe_result_t res;
+    if (touch_probe_new(&cfg, &res) != ESP_OK || res.tp == NULL) {
+        ESP_LOGW(TAG, "No touch controller found");
+        return;
+    }
+    fe_touch = res.tp;
+    ESP_LOGI(TAG, "Touch %s at 0x%02x", touch_probe_chip_name(res.chip), res.addr);
+
+    esp_lcd_touch_gesture_config_t gesture_cfg = ESP_LCD_TOUCH_GESTURE_DEFAULT_CONFIG();
+    if (esp_lcd_touch_gesture_new(&gesture_cfg, &fe_touch_gesture) == ESP_OK) {
+        esp_lcd_touch_set_gesture(fe_touch, fe_touch_gesture);
+    }
+
+    lv_indev_t * indev = lv_indev_create();
+    lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_read_cb(indev, touch_gesture_read);
+}
+
+static void touch_gesture_read(lv_indev_t * indev, lv_indev_data_t * data)
+{
+    uint16_t x, y;
+    uint8_t count = 0;
+
+    /* Feeds the recogniser too */
+    esp_lcd_touch_read_data(fe_touch);
+    if (esp_lcd_touch_get_coordinates(fe_touch, &x, &y, NULL, &count, 1) && count > 0) {
+        data->point.x = x;
+        data->point.y = y;
+        data->state = LV_INDEV_STATE_PRESSED;
+    } else {
+        data->state = LV_INDEV_STATE_RELEASED;
+    }
+}
+#endif
+
 static void lv_tick_task(void *arg) {
     (void) arg;
     lv_tick_inc(LV_TICK_PERIOD_MS);
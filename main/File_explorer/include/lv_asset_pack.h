@@ -0,0 +1,158 @@
+/**
+ * @file lv_asset_pack.h
+ *
+ * Fixed UI assets (icons, splash, fonts) in one flash partition, built on the host by
+ * scripts/asset_pack.py from a manifest. The pack is an index and blobs already in the
+ * display formats, each on a 64 byte boundary. Mounting maps the partition into the data
+ * address space with esp_partition_mmap(): the pixels of an image and the glyph bitmaps of a
+ * font are read in place through the flash cache, only their small descriptors are in RAM.
+ * A pack can also be mounted from a buffer: an array compiled into the app or a copy of the
+ * pack file read from the SD card, to compare them.
+ */
+#ifndef LV_ASSET_PACK_H
+#define LV_ASSET_PACK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Label of the partition in partitions.csv*/
+#define LV_ASSET_PACK_PARTITION     "assets"
+#define LV_ASSET_PACK_MAGIC         0x4B415045  /*"EPAK"*/
+#define LV_ASSET_PACK_VERSION       1
+/*Longest name in the manifest, without the terminating 0*/
+#define LV_ASSET_PACK_NAME_MAX      15
+/*Every blob starts on it*/
+#define LV_ASSET_PACK_ALIGN         64
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+/*Entry types, as written by scripts/asset_pack.py*/
+typedef enum {
+    LV_ASSET_PACK_TYPE_IMAGE = 1,
+    LV_ASSET_PACK_TYPE_FONT = 2,
+    LV_ASSET_PACK_TYPE_RAW = 3,
+} lv_asset_pack_type_t;
+
+/*Pixel formats of the images, kept apart from lv_color_format_t as the tool does not know LVGL*/
+typedef enum {
+    LV_ASSET_PACK_CF_RGB332 = 1,
+    LV_ASSET_PACK_CF_L8 = 2,
+    LV_ASSET_PACK_CF_A8 = 3,
+} lv_asset_pack_cf_t;
+
+/*Start of the pack, the entries follow*/
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;             /*Entries*/
+    uint32_t size;              /*Bytes of the whole pack*/
+    uint32_t crc;               /*CRC32 of the entries*/
+} lv_asset_pack_header_t;
+
+/*One asset, 44 bytes. Offsets are from the start of the pack.*/
+typedef struct {
+    char name[LV_ASSET_PACK_NAME_MAX + 1];
+    uint8_t type;               /*lv_asset_pack_type_t*/
+    uint8_t cf;                 /*lv_asset_pack_cf_t of an image*/
+    uint8_t bpp;                /*Glyph bits per pixel of a font*/
+    uint8_t reserved;
+    uint32_t offset;
+    uint32_t size;
+    uint16_t w;                 /*Image width*/
+    uint16_t h;                 /*Image height*/
+    uint16_t stride;            /*Image bytes per row*/
+    uint16_t line_height;       /*Font line height*/
+    int16_t base_line;          /*Font base line from the bottom of the line*/
+    uint16_t glyph_count;       /*Font glyphs, one per code point from range_start*/
+    uint32_t range_start;
+} lv_asset_pack_entry_t;
+
+typedef struct {
+    uint32_t size;              /*Bytes of the pack*/
+    uint32_t count;             /*Entries*/
+    uint32_t ram_bytes;         /*Held by the descriptors made so far*/
+    bool mapped;                /*Mounted from the partition*/
+} lv_asset_pack_info_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Map the pack partition. Only its header is read, the index and the blobs are read
+ * through the flash cache when used.
+ * @param label     label of the partition, NULL for LV_ASSET_PACK_PARTITION
+ * @return          ESP_OK, ESP_ERR_NOT_FOUND without the partition,
+ *                  ESP_ERR_INVALID_VERSION or ESP_ERR_INVALID_CRC if it holds no valid pack
+ */
+esp_err_t lv_asset_pack_mount(const char * label);
+
+/**
+ * Use a pack already in memory: an array in the app or a copy of the pack file
+ * @param data      the pack, word aligned, it has to stay until unmounted
+ * @param size      bytes of data
+ * @return          ESP_OK, ESP_ERR_INVALID_SIZE, ESP_ERR_INVALID_VERSION or ESP_ERR_INVALID_CRC
+ */
+esp_err_t lv_asset_pack_mount_buffer(const void * data, uint32_t size);
+
+/**
+ * Free the descriptors and unmap the partition. Nothing may use the assets any more.
+ */
+void lv_asset_pack_unmount(void);
+
+/**
+ * Get an image to use as source of an lv_image. The descriptor is made on the first call,
+ * its data points into the pack.
+ * @param name      name in the manifest
+ * @return          the image, NULL if there is no image of that name
+ */
+const lv_image_dsc_t * lv_asset_pack_image(const char * name);
+
+/**
+ * Get a font. The descriptors are made on the first call, the glyph descriptions and the
+ * bitmaps stay in the pack.
+ * @param name      name in the manifest
+ * @return          the font, NULL if there is no font of that name or the glyph format
+ *                  differs (LV_FONT_FMT_TXT_LARGE)
+ */
+const lv_font_t * lv_asset_pack_font(const char * name);
+
+/**
+ * Get the bytes of any entry
+ * @param name      name in the manifest
+ * @param size      set to the bytes of the entry, NULL if not needed
+ * @return          the bytes, NULL if there is no entry of that name
+ */
+const void * lv_asset_pack_raw(const char * name, uint32_t * size);
+
+/**
+ * Get an entry of the index, to list the pack
+ * @param index     0 .. count - 1 of lv_asset_pack_get_info()
+ * @return          the entry, in the pack, NULL past the last one
+ */
+const lv_asset_pack_entry_t * lv_asset_pack_get_entry(uint32_t index);
+
+/**
+ * Get the size of the mounted pack and the RAM its descriptors hold
+ * @param info      set to the numbers, all 0 if nothing is mounted
+ */
+void lv_asset_pack_get_info(lv_asset_pack_info_t * info);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_ASSET_PACK_H*/
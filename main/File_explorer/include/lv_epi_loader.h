@@ -0,0 +1,135 @@
+/**
+ * @file lv_epi_loader.h
+ *
+ * EPI, the panel-native image of scripts/epi_convert.py: a 16 byte header, then the rows
+ * of RGB332 or 4 bpp gray pixels, each packed with PackBits on its own. Nothing is decoded or
+ * converted from RGB at load time: the rows are unpacked as the file is read ahead in blocks
+ * (lv_fe_reader), straight into the image or any other buffer, e.g. a draw buffer or the
+ * panel framebuffer. Only a gray to RGB332 or RGB332 to gray mapping is left, by table.
+ */
+#ifndef LV_EPI_LOADER_H
+#define LV_EPI_LOADER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define LV_EPI_MAGIC            "EPI"
+#define LV_EPI_VERSION          1
+#define LV_EPI_HEADER_SIZE      16
+/*Bytes per block of the read-ahead reader, a multiple of the FAT sector*/
+#define LV_EPI_BLOCK_SIZE       (8 * 1024)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+/*Pixels of the file*/
+typedef enum {
+    LV_EPI_FORMAT_RGB332 = 1,
+    LV_EPI_FORMAT_GRAY4 = 2,    /*Two pixels a byte, the left one in the high nibble*/
+} lv_epi_format_t;
+
+typedef enum {
+    LV_EPI_COMPRESS_NONE = 0,
+    LV_EPI_COMPRESS_PACKBITS = 1,   /*Each row on its own*/
+} lv_epi_compress_t;
+
+/*The file header, little endian*/
+typedef struct {
+    char magic[3];
+    uint8_t version;
+    uint16_t w;
+    uint16_t h;
+    uint8_t format;             /*lv_epi_format_t*/
+    uint8_t compress;           /*lv_epi_compress_t*/
+    uint16_t reserved;
+    uint32_t data_size;         /*Bytes after the header*/
+} lv_epi_header_t;
+
+typedef struct {
+    uint32_t load_us;           /*Open to last row written*/
+    uint32_t reads;             /*Blocks read*/
+    uint32_t stall_us;          /*Of load_us, waiting for the card*/
+    uint32_t file_bytes;
+    uint16_t w;                 /*Size of the image in the file*/
+    uint16_t h;
+    uint8_t format;             /*lv_epi_format_t*/
+    size_t peak_bytes;          /*Read-ahead blocks, row buffer and output image*/
+} lv_epi_load_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Read the header of an EPI file
+ * @param path      file to read
+ * @param header    set to the header
+ * @return          ESP_OK, ESP_ERR_NOT_FOUND, or ESP_ERR_NOT_SUPPORTED if it is not an EPI
+ *                  this build reads
+ */
+esp_err_t lv_epi_get_header(const char * path, lv_epi_header_t * header);
+
+/**
+ * Unpack an EPI file into a buffer. Rows and columns beyond max_w x max_h are left out.
+ * @param path      file to read
+ * @param buf       destination, one byte per pixel, it can be PSRAM
+ * @param stride    bytes per row of buf
+ * @param max_w     pixels per row of buf
+ * @param max_h     rows of buf
+ * @param cf        LV_COLOR_FORMAT_RGB332 or LV_COLOR_FORMAT_L8
+ * @param stats     optional timing and memory, NULL if not needed
+ * @return          ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NOT_FOUND, ESP_ERR_NO_MEM,
+ *                  ESP_ERR_NOT_SUPPORTED, or ESP_ERR_INVALID_SIZE if the file is cut short
+ */
+esp_err_t lv_epi_load_into(const char * path, uint8_t * buf, uint32_t stride, uint32_t max_w, uint32_t max_h,
+                           lv_color_format_t cf, lv_epi_load_stats_t * stats);
+
+/**
+ * Load an EPI file into an image of its size, up to max_w x max_h. The pixels are in PSRAM
+ * when there is some.
+ * @param path      file to read
+ * @param max_w     largest width, wider images are cut on the right
+ * @param max_h     largest height, taller images are cut at the bottom
+ * @param cf        LV_COLOR_FORMAT_RGB332 or LV_COLOR_FORMAT_L8
+ * @param out       the image, free it with lv_epi_free()
+ * @param stats     optional timing and memory, NULL if not needed
+ * @return          see lv_epi_load_into()
+ */
+esp_err_t lv_epi_load(const char * path, uint32_t max_w, uint32_t max_h, lv_color_format_t cf,
+                      lv_image_dsc_t * out, lv_epi_load_stats_t * stats);
+
+/**
+ * Free the pixels of an image from lv_epi_load()
+ * @param dsc       the image, data is set to NULL
+ */
+void lv_epi_free(lv_image_dsc_t * dsc);
+
+/**
+ * Load an EPI file into an image object, the pixels are freed with the object
+ * @param img       pointer to an image object
+ * @param path      file to read
+ * @param max_w     largest width
+ * @param max_h     largest height
+ * @param cf        LV_COLOR_FORMAT_RGB332 or LV_COLOR_FORMAT_L8
+ * @return          see lv_epi_load()
+ */
+esp_err_t lv_epi_image_set_src(lv_obj_t * img, const char * path, uint32_t max_w, uint32_t max_h,
+                               lv_color_format_t cf);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_EPI_LOADER_H*/
@@ -0,0 +1,118 @@
+/**
+ * @file lv_fe_cache.h
+ *
+ * Directory index cache of the file explorer. A directory read once is kept as a binary
+ * index in a hidden folder on the card and, for the last few, in RAM. An index is used
+ * while the count, sizes and dates of the visible entries are unchanged. Those are read
+ * with the directory without names, as neither FatFs nor a PC updates directory dates.
+ * lv_fe_cache_read_dir() checks them before it takes an index. A caller that shows the
+ * index at once uses lv_fe_cache_lookup() and lv_fe_cache_check() afterwards instead.
+ */
+#ifndef LV_FE_CACHE_H
+#define LV_FE_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include "esp_err.h"
+#include "lv_fe_dir.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Hidden folder on the card, 8.3 name as long names may be disabled*/
+#define LV_FE_CACHE_DIR         "FECACHE"
+/*Directories kept in RAM*/
+#define LV_FE_CACHE_RAM_DIRS    4
+/*Smaller directories are not worth a file*/
+#define LV_FE_CACHE_MIN_ENTRIES 32
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef enum {
+    LV_FE_CACHE_SRC_SCAN,   /*Read from the directory*/
+    LV_FE_CACHE_SRC_RAM,
+    LV_FE_CACHE_SRC_CARD,
+} lv_fe_cache_src_t;
+
+typedef struct {
+    uint32_t ram_hits;
+    uint32_t card_hits;
+    uint32_t misses;
+    uint32_t stale;         /*Index found but out of date or damaged*/
+    uint32_t last_us;       /*Time of the last lv_fe_cache_read_dir()*/
+} lv_fe_cache_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Read a directory through the cache: RAM, then the index on the card, then the
+ * directory itself, which is indexed for the next time. Paths outside MOUNT_POINT
+ * are always read from the directory.
+ * @param dir   pointer to a directory, the entries are appended
+ * @param path  path of the directory
+ * @param src   where the entries came from, NULL if not needed
+ * @return      ESP_OK, ESP_ERR_NOT_FOUND or ESP_ERR_NO_MEM
+ */
+esp_err_t lv_fe_cache_read_dir(lv_fe_dir_t * dir, const char * path, lv_fe_cache_src_t * src);
+
+/**
+ * Look a directory up in RAM and on the card, without reading the directory. The index
+ * may be out of date, pass the stamp to lv_fe_cache_check().
+ * @param dir   pointer to a directory, the entries are appended
+ * @param path  path of the directory
+ * @param src   where the entries came from
+ * @param stamp the stamp of the index
+ * @return      ESP_OK, ESP_ERR_INVALID_STATE if there is no valid index
+ */
+esp_err_t lv_fe_cache_lookup(lv_fe_dir_t * dir, const char * path, lv_fe_cache_src_t * src, uint32_t * stamp);
+
+/**
+ * Read the stamp of a directory, without its names, and compare it with the index from
+ * lv_fe_cache_lookup(). An index that is out of date is dropped.
+ * @param path  path of the directory
+ * @param stamp the stamp from lv_fe_cache_lookup()
+ * @return      ESP_OK if the index is up to date, ESP_ERR_INVALID_STATE if it is not,
+ *              ESP_ERR_NOT_FOUND if there is no such directory any more
+ */
+esp_err_t lv_fe_cache_check(const char * path, uint32_t stamp);
+
+/**
+ * Write the index of a directory that was read after a failed lookup, on the card and in
+ * RAM. Saves and lookups may run on different tasks, a lookup waits for a save.
+ * @param path  path of the directory
+ * @param dir   pointer to the directory
+ * @param first entries before it are not part of the directory, e.g. "." and ".."
+ */
+void lv_fe_cache_save(const char * path, const lv_fe_dir_t * dir, uint32_t first);
+
+/**
+ * Drop the index of a directory from RAM and from the card
+ * @param path  path of the directory
+ */
+void lv_fe_cache_invalidate(const char * path);
+
+/**
+ * Drop every index, e.g. after the card was changed
+ */
+void lv_fe_cache_clear(void);
+
+/**
+ * Get the counters
+ * @param stats pointer to the counters
+ */
+void lv_fe_cache_get_stats(lv_fe_cache_stats_t * stats);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_FE_CACHE_H*/
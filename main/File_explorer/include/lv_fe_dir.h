@@ -0,0 +1,168 @@
+/**
+ * @file lv_fe_dir.h
+ *
+ * Directory contents of the file explorer as a compact native array: one fixed size
+ * record per entry and all names packed in one string pool. Both live in PSRAM when
+ * there is some, nothing of it is in the LVGL heap.
+ */
+#ifndef LV_FE_DIR_H
+#define LV_FE_DIR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+/*In the order LV_EXPLORER_SORT_KIND lists them*/
+typedef enum {
+    LV_FE_KIND_DIR,
+    LV_FE_KIND_IMAGE,
+    LV_FE_KIND_AUDIO,
+    LV_FE_KIND_VIDEO,
+    LV_FE_KIND_TEXT,
+    LV_FE_KIND_OTHER,
+} lv_fe_kind_t;
+
+typedef struct {
+    uint32_t name;      /*Offset of the name in the names pool*/
+    uint32_t size;      /*Bytes, 0 for directories*/
+    uint32_t mtime;     /*FAT date << 16 | FAT time, compares like a timestamp*/
+    uint8_t kind;       /*lv_fe_kind_t*/
+} lv_fe_entry_t;
+
+typedef struct {
+    lv_fe_entry_t * entries;
+    uint32_t count;
+    uint32_t entries_cap;
+    char * names;
+    uint32_t names_len;
+    uint32_t names_cap;
+} lv_fe_dir_t;
+
+/**
+ * Called by lv_fe_dir_scan_each() after each entry it adds
+ * @param dir       the directory being read, entries may be moved out of it and cleared
+ * @param user_data as given to lv_fe_dir_scan_each()
+ * @return          false to stop reading
+ */
+typedef bool (*lv_fe_dir_entry_cb_t)(lv_fe_dir_t * dir, void * user_data);
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Initialize an empty directory
+ * @param dir   pointer to a directory
+ */
+void lv_fe_dir_init(lv_fe_dir_t * dir);
+
+/**
+ * Remove all entries, the memory is kept for the next directory
+ * @param dir   pointer to a directory
+ */
+void lv_fe_dir_clear(lv_fe_dir_t * dir);
+
+/**
+ * Free the entries and the names
+ * @param dir   pointer to a directory
+ */
+void lv_fe_dir_free(lv_fe_dir_t * dir);
+
+/**
+ * Append an entry
+ * @param dir   pointer to a directory
+ * @param name  file name, copied into the pool
+ * @param kind  the kind from 'lv_fe_kind_t' enum
+ * @param size  size in bytes
+ * @param mtime FAT date << 16 | FAT time
+ * @return      false if out of memory
+ */
+bool lv_fe_dir_add(lv_fe_dir_t * dir, const char * name, lv_fe_kind_t kind, uint32_t size, uint32_t mtime);
+
+/**
+ * Make room for more entries and names without growing again on each add
+ * @param dir       pointer to a directory
+ * @param entries   entries to add
+ * @param names     bytes of names to add, terminators included
+ * @return          false if out of memory
+ */
+bool lv_fe_dir_reserve(lv_fe_dir_t * dir, uint32_t entries, uint32_t names);
+
+/**
+ * Append all entries of another directory
+ * @param dir   pointer to a directory
+ * @param src   entries to copy
+ * @return      false if out of memory
+ */
+bool lv_fe_dir_append(lv_fe_dir_t * dir, const lv_fe_dir_t * src);
+
+/**
+ * Read a directory from the file system. Under MOUNT_POINT FatFs is asked directly,
+ * so sizes and dates come with the names and no stat() per file is needed.
+ * @param dir   pointer to a directory, the entries are appended
+ * @param path  path of the directory
+ * @return      ESP_OK, ESP_ERR_NOT_FOUND or ESP_ERR_NO_MEM
+ */
+esp_err_t lv_fe_dir_scan(lv_fe_dir_t * dir, const char * path);
+
+/**
+ * Read a directory like lv_fe_dir_scan(), calling back after each entry, e.g. to hand
+ * the entries over in batches
+ * @param dir       pointer to a directory, the entries are appended
+ * @param path      path of the directory
+ * @param cb        called after each entry
+ * @param user_data passed to cb
+ * @return          ESP_OK, also when cb stopped it, ESP_ERR_NOT_FOUND or ESP_ERR_NO_MEM
+ */
+esp_err_t lv_fe_dir_scan_each(lv_fe_dir_t * dir, const char * path, lv_fe_dir_entry_cb_t cb, void * user_data);
+
+/**
+ * FatFs path of a path under MOUNT_POINT, e.g. "/S/Photos" is "0:/Photos"
+ * @param path  path of a file or directory
+ * @param out   buffer for the FatFs path
+ * @param size  size of the buffer
+ * @return      false if the path is not under MOUNT_POINT
+ */
+bool lv_fe_dir_fatfs_path(const char * path, char * out, size_t size);
+
+/**
+ * Kind of a file from its extension, see lv_fe_type_from_name()
+ * @param name  file name
+ * @return      the kind from 'lv_fe_kind_t' enum
+ */
+lv_fe_kind_t lv_fe_kind_of(const char * name);
+
+/**
+ * Symbol shown in front of the name
+ * @param kind  the kind from 'lv_fe_kind_t' enum
+ * @return      an LV_SYMBOL_... string
+ */
+const char * lv_fe_kind_symbol(lv_fe_kind_t kind);
+
+/**
+ * Name of an entry
+ * @param dir   pointer to a directory
+ * @param index entry index
+ * @return      the name, valid until the directory is cleared
+ */
+static inline const char * lv_fe_dir_name(const lv_fe_dir_t * dir, uint32_t index)
+{
+    return dir->names + dir->entries[index].name;
+}
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_FE_DIR_H*/
@@ -0,0 +1,64 @@
+/**
+ * @file lv_fe_gesture.h
+ *
+ * Multi-touch gestures of the explorer app. LVGL reads one pointer, the esp_lcd_touch gesture
+ * recogniser reads all of them and queues what it recognised. A timer of the GUI task takes
+ * the events from the queue and sends them to the object under the gesture:
+ * - a swipe turns a page of the text pager under it, as the arrow keys do, or scrolls the
+ *   list under it by one page. One refresh per page instead of one per pointer move.
+ * - a two finger swipe to the right in the explorer opens the parent directory.
+ * Taps and long presses still come through the pointer.
+ */
+#ifndef LV_FE_GESTURE_H
+#define LV_FE_GESTURE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "lvgl.h"
+#include "esp_lcd_touch_gesture.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    lv_obj_t * explorer;
+    QueueHandle_t queue;
+    lv_timer_t * timer;
+    uint32_t pages;         /*Swipes that turned or scrolled a page*/
+    uint32_t parents;       /*Two finger swipes that opened the parent directory*/
+    uint32_t ignored;       /*Events with nothing to act on*/
+} lv_fe_gesture_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Deliver the events of a gesture recogniser to the objects of the screen
+ * @param gesture   the state, usually static
+ * @param explorer  pointer to the file explorer object
+ * @param queue     queue of the recogniser, esp_lcd_touch_gesture_get_queue()
+ */
+void lv_fe_gesture_init(lv_fe_gesture_t * gesture, lv_obj_t * explorer, QueueHandle_t queue);
+
+/**
+ * Act on one gesture, as the timer does for the queued ones. Needs the GUI lock.
+ * @param gesture   the state
+ * @param event     a recognised gesture
+ * @return          true if an object took it
+ */
+bool lv_fe_gesture_dispatch(lv_fe_gesture_t * gesture, const esp_lcd_touch_gesture_event_t * event);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_FE_GESTURE_H*/
@@ -0,0 +1,95 @@
+/**
+ * @file lv_fe_io.h
+ *
+ * Bulk file reads of the loaders. The SD host moves data with DMA only to word aligned
+ * internal RAM. FatFs hands whole sectors to the driver in the buffer of the caller, and
+ * into any other buffer, PSRAM included, the driver reads them one sector per command
+ * through its own bounce sector. lv_fe_io_read() gives DMA-capable buffers to read() as
+ * they are and reads into the others through a bounce buffer of up to LV_FE_IO_BOUNCE_SIZE,
+ * so a command still moves many sectors. In the throughput mode of the SD card that buffer is
+ * allocated once and kept, else each read allocates its own.
+ * Files of small records are read with stdio. Its buffer on the VFS is 128 bytes unless
+ * CONFIG_FATFS_VFS_FSTAT_BLKSIZE is set, lv_fe_io_fopen() gives it LV_FE_IO_STDIO_BUF.
+ */
+#ifndef LV_FE_IO_H
+#define LV_FE_IO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include "esp_err.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*The SD host DMA needs word aligned buffers*/
+#define LV_FE_IO_ALIGN          4
+/*Largest read through the bounce buffer, a multiple of the sector size*/
+#define LV_FE_IO_BOUNCE_SIZE    (16 * 1024)
+/*stdio buffer of lv_fe_io_fopen()*/
+#define LV_FE_IO_STDIO_BUF      (4 * 1024)
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Allocate a buffer the SD host reads into with DMA: internal RAM, word aligned
+ * @param size  bytes
+ * @return      the buffer, free it with lv_fe_io_free(). NULL if there is not enough internal RAM.
+ */
+void * lv_fe_io_alloc(size_t size);
+
+/**
+ * Free a buffer of lv_fe_io_alloc(), or a file buffer from the heap
+ * @param buf   the buffer, or NULL
+ */
+void lv_fe_io_free(void * buf);
+
+/**
+ * Tell if read() into a buffer goes to the card with DMA, many sectors per command
+ * @param buf   the buffer
+ * @return      true if it is DMA-capable and word aligned
+ */
+bool lv_fe_io_is_direct(const void * buf);
+
+/**
+ * Keep a bounce buffer of LV_FE_IO_BOUNCE_SIZE, or the largest that fits, for the reads into
+ * other than DMA-capable buffers. Without it they go through a static one of 2 KB. A read that
+ * finds the buffer in use by another one allocates its own.
+ * @param enable    true to allocate and keep it, false to free it and use the static one
+ * @return          ESP_OK, ESP_ERR_NO_MEM if no bounce buffer fits in internal RAM
+ */
+esp_err_t lv_fe_io_set_throughput(bool enable);
+
+/**
+ * Read like read(), but until len bytes or the end of the file: a short count is the end.
+ * Into other than DMA-capable buffers the whole sectors go through a bounce buffer.
+ * @param fd    file opened with open()
+ * @param buf   destination, any memory
+ * @param len   bytes to read
+ * @return      bytes read, -1 on an error
+ */
+ssize_t lv_fe_io_read(int fd, void * buf, size_t len);
+
+/**
+ * fopen() with a stdio buffer of LV_FE_IO_STDIO_BUF bytes, for sequential freads of records
+ * @param path  path of the file
+ * @param mode  as for fopen()
+ * @return      the file, NULL if it could not be opened
+ */
+FILE * lv_fe_io_fopen(const char * path, const char * mode);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_FE_IO_H*/
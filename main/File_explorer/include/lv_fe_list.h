@@ -0,0 +1,114 @@
+/**
+ * @file lv_fe_list.h
+ *
+ * Virtual list for the file explorer. Only the rows in view plus a small margin exist as
+ * objects, they are recycled while scrolling and filled by a bind callback. Open time and
+ * LVGL memory do not depend on the number of entries.
+ */
+#ifndef LV_FE_LIST_H
+#define LV_FE_LIST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Rows kept above and below the visible ones*/
+#define LV_FE_LIST_MARGIN   4
+#define LV_FE_LIST_NONE     UINT32_MAX
+/*Padding of the rows*/
+#define LV_FE_LIST_ROW_PAD  10
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+/**
+ * Fill a row (an lv_label) for an entry
+ * @param row       the row object
+ * @param index     entry index
+ * @param user_data as given to lv_fe_list_set_bind_cb()
+ */
+typedef void (*lv_fe_list_bind_cb_t)(lv_obj_t * row, uint32_t index, void * user_data);
+
+/*Data of the virtual list*/
+typedef struct {
+    lv_obj_t obj;
+    lv_fe_list_bind_cb_t bind_cb;
+    void * bind_user_data;
+    uint32_t count;
+    int32_t row_h;
+    uint32_t pool_size;
+    lv_obj_t ** rows;
+    uint32_t * row_index;   /*Entry shown in each row, LV_FE_LIST_NONE if the row is unused*/
+    uint32_t selected;
+} lv_fe_list_t;
+
+extern const lv_obj_class_t lv_fe_list_class;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+lv_obj_t * lv_fe_list_create(lv_obj_t * parent);
+
+/**
+ * Set the callback that fills the rows
+ * @param obj       pointer to a list object
+ * @param cb        bind callback
+ * @param user_data passed to the callback
+ */
+void lv_fe_list_set_bind_cb(lv_obj_t * obj, lv_fe_list_bind_cb_t cb, void * user_data);
+
+/**
+ * Set the number of entries, scrolls to the top and fills the visible rows
+ * @param obj   pointer to a list object
+ * @param count number of entries
+ */
+void lv_fe_list_set_count(lv_obj_t * obj, uint32_t count);
+
+/**
+ * Entries were added at the end, e.g. while a directory is read. Keeps the scroll
+ * position and the selection.
+ * @param obj   pointer to a list object
+ * @param count new number of entries
+ */
+void lv_fe_list_extend(lv_obj_t * obj, uint32_t count);
+
+/**
+ * Fill the visible rows again, after the entries changed (e.g. sorted)
+ * @param obj   pointer to a list object
+ */
+void lv_fe_list_refresh(lv_obj_t * obj);
+
+/**
+ * Fill the row of one entry again if it is in view, e.g. when its thumbnail is ready
+ * @param obj   pointer to a list object
+ * @param index entry index
+ */
+void lv_fe_list_refresh_entry(lv_obj_t * obj, uint32_t index);
+
+/**
+ * Get the number of entries
+ * @param obj   pointer to a list object
+ * @return      number of entries
+ */
+uint32_t lv_fe_list_get_count(const lv_obj_t * obj);
+
+/**
+ * Get the entry clicked last, sent with LV_EVENT_VALUE_CHANGED
+ * @param obj   pointer to a list object
+ * @return      entry index or LV_FE_LIST_NONE
+ */
+uint32_t lv_fe_list_get_selected(const lv_obj_t * obj);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_FE_LIST_H*/
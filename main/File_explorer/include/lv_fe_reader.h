@@ -0,0 +1,88 @@
+/**
+ * @file lv_fe_reader.h
+ *
+ * Read-ahead file reader. A storage task reads the file in blocks into a ring of
+ * LV_FE_READER_BUFS DMA-capable buffers while the consumer works on the blocks before.
+ * The consumer borrows the blocks in file order and releases them when done, nothing is
+ * copied. In steady state the next block is ready when it is borrowed; the time the
+ * consumer waited for the card anyway is in the stats.
+ */
+#ifndef LV_FE_READER_H
+#define LV_FE_READER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Blocks in the ring: one borrowed and one being read is double buffering*/
+#define LV_FE_READER_BUFS           2
+/*Default block size, a multiple of the FAT sector*/
+#define LV_FE_READER_BLOCK_SIZE     (8 * 1024)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint32_t blocks;        /*Borrowed by the consumer*/
+    uint32_t stalls;        /*Borrows that had to wait for the card*/
+    uint32_t stall_us;      /*Time the consumer waited in all*/
+    uint32_t read_us;       /*Time the storage task spent reading*/
+} lv_fe_reader_stats_t;
+
+typedef struct _lv_fe_reader_t lv_fe_reader_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Open a file and start reading ahead. The storage task runs just above the priority of
+ * the caller, it mostly waits for the card. Without memory for the task the blocks are
+ * read when they are borrowed.
+ * @param path          file to read
+ * @param offset        where to start in the file, best a multiple of the FAT sector
+ * @param block_size    bytes per block, 0 for LV_FE_READER_BLOCK_SIZE
+ * @param reader        the reader, close it with lv_fe_reader_close()
+ * @return              ESP_OK, ESP_ERR_NOT_FOUND or ESP_ERR_NO_MEM
+ */
+esp_err_t lv_fe_reader_open(const char * path, size_t offset, size_t block_size, lv_fe_reader_t ** reader);
+
+/**
+ * Borrow the next block, waiting for it if it is not read yet. Up to LV_FE_READER_BUFS
+ * blocks can be borrowed at once. The data stays valid until the block is released.
+ * @param reader    the reader
+ * @param data      set to the bytes of the block
+ * @param len       set to the bytes in the block, only the last one is short, 0 at the end
+ * @return          ESP_OK, ESP_FAIL on a read error,
+ *                  ESP_ERR_INVALID_STATE if all blocks are borrowed
+ */
+esp_err_t lv_fe_reader_borrow(lv_fe_reader_t * reader, const uint8_t ** data, size_t * len);
+
+/**
+ * Give back the oldest borrowed block, the storage task reads ahead into it
+ * @param reader    the reader
+ */
+void lv_fe_reader_release(lv_fe_reader_t * reader);
+
+/**
+ * Stop the storage task, close the file and free the reader
+ * @param reader    the reader
+ * @param stats     set to the counters, NULL if not needed
+ */
+void lv_fe_reader_close(lv_fe_reader_t * reader, lv_fe_reader_stats_t * stats);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_FE_READER_H*/
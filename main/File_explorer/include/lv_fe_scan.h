@@ -0,0 +1,104 @@
+/**
+ * @file lv_fe_scan.h
+ *
+ * Directory reading on a worker task. Entries are handed to the GUI task in batches under
+ * the GUI lock, the first batch as soon as a screen full has been read, so a slow card
+ * does not freeze the UI. The index cache is looked up on the worker too: an index is
+ * shown at once and replaced only if the directory turns out to have changed.
+ */
+#ifndef LV_FE_SCAN_H
+#define LV_FE_SCAN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lv_fe_dir.h"
+#include "lv_fe_cache.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Entries of the first batch when the config leaves it 0, a screen of rows*/
+#define LV_FE_SCAN_FIRST_BATCH  24
+/*Entries of the later batches*/
+#define LV_FE_SCAN_BATCH        128
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct _lv_fe_scan_t lv_fe_scan_t;
+
+typedef struct {
+    uint32_t first_us;  /*Start to first batch handed over*/
+    uint32_t total_us;  /*Start to whole directory handed over*/
+    uint32_t count;     /*Entries read*/
+    lv_fe_cache_src_t src;  /*Where the entries came from*/
+    bool final;             /*false for an index not checked yet, see lv_fe_scan_done_cb_t*/
+} lv_fe_scan_stats_t;
+
+/**
+ * Called on the GUI side (gui_lock held) with the next entries. The batch is cleared
+ * afterwards, copy what is needed.
+ */
+typedef void (*lv_fe_scan_batch_cb_t)(const lv_fe_dir_t * batch, void * user_data);
+
+/**
+ * Called on the GUI side (gui_lock held) when the index handed over is out of date. Drop
+ * the entries of the batches so far, the directory is read again.
+ */
+typedef void (*lv_fe_scan_reset_cb_t)(void * user_data);
+
+/**
+ * Called on the GUI side (gui_lock held) after the last batch, unless the scan was
+ * cancelled. res is ESP_OK, ESP_ERR_NOT_FOUND or ESP_ERR_NO_MEM.
+ * An index is handed over with stats->final false and checked afterwards. done_cb is then
+ * called again with final true: without a batch if the index was up to date, after
+ * reset_cb and the batches of the directory if not. Nothing follows the final call.
+ */
+typedef void (*lv_fe_scan_done_cb_t)(esp_err_t res, const lv_fe_scan_stats_t * stats, void * user_data);
+
+typedef struct {
+    uint32_t first_batch;               /*0 for LV_FE_SCAN_FIRST_BATCH*/
+    SemaphoreHandle_t gui_lock;         /*Mutex around lv_task_handler()*/
+    lv_fe_scan_batch_cb_t batch_cb;
+    lv_fe_scan_reset_cb_t reset_cb;
+    lv_fe_scan_done_cb_t done_cb;
+    void * user_data;
+} lv_fe_scan_config_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Start reading a directory on a worker task. Directories under MOUNT_POINT are looked up
+ * in the cache first, an index is handed over in one batch and checked afterwards. The
+ * others are indexed once read completely.
+ * Call it from the GUI task with gui_lock held.
+ * @param path      path of the directory
+ * @param config    lock and callbacks
+ * @return          the scan, NULL if the task could not be started
+ */
+lv_fe_scan_t * lv_fe_scan_start(const char * path, const lv_fe_scan_config_t * config);
+
+/**
+ * Stop a scan, no callback is called after this returns. The worker frees the scan,
+ * do not use it any more.
+ * Call it from the GUI task with gui_lock held, before the final done_cb was called.
+ * @param scan      the scan from lv_fe_scan_start()
+ */
+void lv_fe_scan_cancel(lv_fe_scan_t * scan);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_FE_SCAN_H*/
@@ -0,0 +1,55 @@
+/**
+ * @file lv_fe_sort.h
+ *
+ * Sorting of the explorer entries. Works on the lv_fe_dir array only, integer keys with
+ * the name in natural order as tie break; the list is refreshed once afterwards.
+ */
+#ifndef LV_FE_SORT_H
+#define LV_FE_SORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_fe_dir.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef enum {
+    LV_FE_SORT_KIND,    /*Kind, then name*/
+    LV_FE_SORT_NAME,    /*Directories first, then name*/
+    LV_FE_SORT_SIZE,    /*Directories first, then size, then name*/
+    LV_FE_SORT_DATE,    /*Directories first, then date, then name*/
+} lv_fe_sort_key_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Sort entries first..count of a directory. Stable merge sort, O(n log n), the scratch
+ * array is taken from PSRAM when there is some.
+ * @param dir   pointer to a directory
+ * @param first entries before it stay in place, e.g. "." and ".."
+ * @param key   the key from 'lv_fe_sort_key_t' enum
+ */
+void lv_fe_sort(lv_fe_dir_t * dir, uint32_t first, lv_fe_sort_key_t key);
+
+/**
+ * Compare names in natural order: case is ignored and digit runs compare as numbers,
+ * so "IMG2" comes before "IMG10"
+ * @param a     a name
+ * @param b     another name
+ * @return      < 0, 0 or > 0 like strcmp
+ */
+int lv_fe_natural_cmp(const char * a, const char * b);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_FE_SORT_H*/
@@ -0,0 +1,142 @@
+/**
+ * @file lv_fe_tabs.h
+ *
+ * Document tabs of the explorer app. Opened files get a tab each in a tab view, after the
+ * fixed tabs of the app. The number of tabs and the memory of their contents are bounded:
+ * beyond the tab limit the least recently used document is closed, beyond the memory budget
+ * the least recently used ones are unloaded. An unloaded tab keeps its button and is loaded
+ * again from its file when it is shown. A long press on a tab button closes it.
+ */
+#ifndef LV_FE_TABS_H
+#define LV_FE_TABS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+#include "lv_fe_type.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Upper limit of the max_tabs setting*/
+#define LV_FE_TABS_MAX      8
+#define LV_FE_TABS_NONE     UINT32_MAX
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    char * path;
+    lv_fe_type_t type;
+    lv_obj_t * tab;         /*Tab page, stays while the document is open*/
+    lv_obj_t * button;
+    bool loaded;
+    uint32_t state;         /*Where the reader was, kept by the unload callback, 0 at first*/
+    size_t heap_bytes;      /*Held outside the LVGL heap, as the load callback told*/
+    size_t lv_bytes;        /*LVGL heap taken by the load*/
+    uint32_t used;          /*LRU clock of the last time it was shown*/
+} lv_fe_doc_t;
+
+/**
+ * Fill the empty tab page of a document
+ * @param tab       the tab page
+ * @param doc       the document, doc->state to restore
+ * @param user_data as in the config
+ * @return          bytes of heap the content holds outside the LVGL heap
+ */
+typedef size_t (*lv_fe_tabs_load_cb_t)(lv_obj_t * tab, lv_fe_doc_t * doc, void * user_data);
+
+/**
+ * Called before the content of a tab page is deleted, to save doc->state
+ * @param tab       the tab page
+ * @param doc       the document
+ * @param user_data as in the config
+ */
+typedef void (*lv_fe_tabs_unload_cb_t)(lv_obj_t * tab, lv_fe_doc_t * doc, void * user_data);
+
+/**
+ * Called after documents were opened, loaded, unloaded or closed, e.g. to show the accounting
+ * @param user_data as in the config
+ */
+typedef void (*lv_fe_tabs_changed_cb_t)(void * user_data);
+
+typedef struct {
+    uint32_t max_tabs;      /*Documents open at once, up to LV_FE_TABS_MAX*/
+    size_t budget_bytes;    /*Memory of the loaded documents, heap and LVGL heap together*/
+    lv_fe_tabs_load_cb_t load_cb;
+    lv_fe_tabs_unload_cb_t unload_cb;
+    lv_fe_tabs_changed_cb_t changed_cb;
+    void * user_data;
+} lv_fe_tabs_config_t;
+
+typedef struct {
+    lv_obj_t * tabview;
+    uint32_t fixed;         /*Tabs of the app before the documents*/
+    lv_fe_tabs_config_t config;
+    lv_fe_doc_t docs[LV_FE_TABS_MAX];   /*In tab order*/
+    uint32_t count;
+    lv_obj_t * closing;     /*Button long pressed, closed after its event*/
+    uint32_t clock;
+    uint32_t loads;
+    uint32_t unloads;
+    uint32_t closes;
+} lv_fe_tabs_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Manage the document tabs of a tab view. The tabs it has now are the fixed ones.
+ * @param tabs      the manager, usually static
+ * @param tabview   pointer to a tab view
+ * @param config    limits and callbacks, copied
+ */
+void lv_fe_tabs_init(lv_fe_tabs_t * tabs, lv_obj_t * tabview, const lv_fe_tabs_config_t * config);
+
+/**
+ * Show a file in a tab: its tab if it is open already, else a new one. The least recently
+ * used documents are closed or unloaded to stay within the limits.
+ * @param tabs      the manager
+ * @param path      path of the file, copied
+ * @param type      type of the file, passed to the load callback
+ * @return          ESP_OK or ESP_ERR_NO_MEM
+ */
+esp_err_t lv_fe_tabs_open(lv_fe_tabs_t * tabs, const char * path, lv_fe_type_t type);
+
+/**
+ * Close a document, its tab is removed
+ * @param tabs      the manager
+ * @param index     document index from 0, in tab order
+ */
+void lv_fe_tabs_close(lv_fe_tabs_t * tabs, uint32_t index);
+
+/**
+ * Memory the loaded documents hold
+ * @param tabs      the manager
+ * @return          heap and LVGL heap bytes together
+ */
+size_t lv_fe_tabs_get_used(const lv_fe_tabs_t * tabs);
+
+/**
+ * Write the accounting as text, one line per document
+ * @param tabs      the manager
+ * @param buf       buffer for the text
+ * @param size      size of the buffer
+ */
+void lv_fe_tabs_format(const lv_fe_tabs_t * tabs, char * buf, size_t size);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_FE_TABS_H*/
@@ -0,0 +1,107 @@
+/**
+ * @file lv_fe_thumb.h
+ *
+ * Thumbnails of the explorer entries. A low priority worker makes small 4 bpp gray
+ * thumbnails of the photos in the current directory, keeps them in a hidden sidecar file
+ * in that directory, keyed by name, size and date, and the last ones in a RAM LRU. The list
+ * asks for the rows it shows and is called back when a thumbnail is ready, so they appear
+ * one by one while scrolling goes on.
+ * Only JPEG photos have thumbnails, the other entries keep their symbol.
+ */
+#ifndef LV_FE_THUMB_H
+#define LV_FE_THUMB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lvgl.h"
+#include "lv_fe_dir.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Largest width and height of a thumbnail*/
+#define LV_FE_THUMB_SIZE        32
+/*Thumbnails kept in RAM, more than the rows a list shows at once*/
+#define LV_FE_THUMB_RAM_SLOTS   64
+/*Requests waiting for the worker, the oldest are dropped first*/
+#define LV_FE_THUMB_QUEUE       16
+/*Sidecar file in each directory, 8.3 name as long names may be disabled*/
+#define LV_FE_THUMB_FILE        "FETHUMB.BIN"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+/**
+ * Called on the GUI side (gui_lock held) when the thumbnail of an entry is ready,
+ * lv_fe_thumb_get() returns it now
+ * @param index     entry index it was asked for
+ * @param user_data as given to lv_fe_thumb_set_dir()
+ */
+typedef void (*lv_fe_thumb_ready_cb_t)(uint32_t index, void * user_data);
+
+typedef struct {
+    uint32_t ram_hits;
+    uint32_t file_hits;     /*Read from the sidecar file*/
+    uint32_t made;          /*Decoded and added to the sidecar file*/
+    uint32_t failed;        /*Not decodable, e.g. progressive JPEG*/
+    uint32_t make_us;       /*Total time spent decoding*/
+} lv_fe_thumb_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Start the worker, once. The RAM slots are allocated here, in PSRAM when there is some.
+ * @param gui_lock  the mutex held around lv_task_handler()
+ * @return          ESP_OK, also if already started, or ESP_ERR_NO_MEM
+ */
+esp_err_t lv_fe_thumb_start(SemaphoreHandle_t gui_lock);
+
+/**
+ * Set the directory the thumbnails are asked for. Requests for the previous one are
+ * dropped and its callback is not called any more.
+ * Call it from the GUI task with gui_lock held.
+ * @param path      path of the directory with a trailing '/', NULL to stop
+ * @param cb        called when a thumbnail is ready
+ * @param user_data passed to cb
+ */
+void lv_fe_thumb_set_dir(const char * path, lv_fe_thumb_ready_cb_t cb, void * user_data);
+
+/**
+ * Get the thumbnail of an entry of the current directory. If it is not in RAM it is asked
+ * from the worker and NULL is returned; the callback tells when it is there.
+ * Call it from the GUI task with gui_lock held.
+ * @param dir       the entries of the directory set with lv_fe_thumb_set_dir()
+ * @param index     entry index
+ * @return          an LV_COLOR_FORMAT_I4 image, or NULL. It stays valid while fewer than
+ *                  LV_FE_THUMB_RAM_SLOTS other thumbnails were asked for since.
+ */
+const lv_image_dsc_t * lv_fe_thumb_get(const lv_fe_dir_t * dir, uint32_t index);
+
+/**
+ * Drop the thumbnails kept in RAM, e.g. after the card was changed. The sidecar files stay.
+ * Call it from the GUI task with gui_lock held.
+ */
+void lv_fe_thumb_clear(void);
+
+/**
+ * Get the counters
+ * @param stats pointer to the counters
+ */
+void lv_fe_thumb_get_stats(lv_fe_thumb_stats_t * stats);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_FE_THUMB_H*/
@@ -0,0 +1,83 @@
+/**
+ * @file lv_fe_type.h
+ *
+ * File type of the explorer entries: from the extension with one table lookup, and
+ * optionally confirmed from the first bytes of the file.
+ */
+#ifndef LV_FE_TYPE_H
+#define LV_FE_TYPE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stddef.h>
+#include <stdint.h>
+#include "lv_fe_dir.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Longest known extension, longer ones are not looked up*/
+#define LV_FE_TYPE_EXT_MAX      4
+/*Bytes lv_fe_type_from_data() needs to tell all known types apart*/
+#define LV_FE_TYPE_MAGIC_LEN    12
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef enum {
+    LV_FE_TYPE_UNKNOWN,
+    LV_FE_TYPE_PNG,
+    LV_FE_TYPE_JPEG,
+    LV_FE_TYPE_BMP,
+    LV_FE_TYPE_GIF,
+    LV_FE_TYPE_MP3,
+    LV_FE_TYPE_WAV,
+    LV_FE_TYPE_MP4,
+    LV_FE_TYPE_TXT,
+    LV_FE_TYPE_EPI,         /*Panel-native image of scripts/epi_convert.py*/
+} lv_fe_type_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Type of a file from its extension, any case
+ * @param name  file name
+ * @return      the type from 'lv_fe_type_t' enum, LV_FE_TYPE_UNKNOWN if not known
+ */
+lv_fe_type_t lv_fe_type_from_name(const char * name);
+
+/**
+ * Type of a file from its first bytes (JPEG SOI, PNG signature, GIF87a/89a, BMP, RIFF WAVE,
+ * ID3 or MPEG audio sync, MP4 ftyp, EPI). Text has no signature, it is LV_FE_TYPE_UNKNOWN.
+ * @param data  start of the file
+ * @param len   bytes in data, LV_FE_TYPE_MAGIC_LEN is enough
+ * @return      the type from 'lv_fe_type_t' enum
+ */
+lv_fe_type_t lv_fe_type_from_data(const uint8_t * data, size_t len);
+
+/**
+ * Read the first bytes of a file and check them, see lv_fe_type_from_data()
+ * @param path  file to check
+ * @return      the type from 'lv_fe_type_t' enum, LV_FE_TYPE_UNKNOWN also if it can not be read
+ */
+lv_fe_type_t lv_fe_type_from_file(const char * path);
+
+/**
+ * Kind of a type, what the explorer lists and sorts by
+ * @param type  the type from 'lv_fe_type_t' enum
+ * @return      the kind from 'lv_fe_kind_t' enum
+ */
+lv_fe_kind_t lv_fe_type_kind(lv_fe_type_t type);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_FE_TYPE_H*/
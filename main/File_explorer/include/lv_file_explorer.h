@@ -2,6 +2,9 @@
  * @file lv_file_explorer.h
  *
  */
+#ifndef LV_FILE_EXPLORER_H
+#define LV_FILE_EXPLORER_H
+
 #define LV_FILE_EXPLORER_QUICK_ACCESS 0
 #define LV_FILE_EXPLORER_PATH_MAX_LEN 256
 #define FILE_BUFSIZE 3000
@@ -15,14 +18,17 @@ extern "C" {
  *********************/
 #include "lv_conf_internal.h"
 #include "core/lv_obj.h"
+#include "lv_fe_dir.h"
+#include "lv_fe_scan.h"
 
 /*********************
  *      DEFINES
  *********************/
-// Set to true to use 4 wires for the SD Card
-#define CONFIG_EXAMPLE_SDMMC_BUS_WIDTH_4 false
 #define MOUNT_POINT "/S"
+/*FatFs drive of the card mounted at MOUNT_POINT (the first and only one)*/
+#define FATFS_DRIVE "0:"
 
+/*SD card pins, D1-D3 only with the 4 line bus of menuconfig, File explorer*/
 #define CONFIG_SD_CLK GPIO_NUM_10
 #define CONFIG_SD_CMD GPIO_NUM_14
 #define CONFIG_SD_D0 GPIO_NUM_0
@@ -36,6 +42,9 @@ extern "C" {
 typedef enum {
     LV_EXPLORER_SORT_NONE,
     LV_EXPLORER_SORT_KIND,
+    LV_EXPLORER_SORT_NAME,
+    LV_EXPLORER_SORT_SIZE,
+    LV_EXPLORER_SORT_DATE,
 } lv_file_explorer_sort_t;
 
 #if LV_FILE_EXPLORER_QUICK_ACCESS
@@ -55,7 +64,7 @@ typedef struct {
     lv_obj_t * cont;
     lv_obj_t * head_area;
     lv_obj_t * browser_area;
-    lv_obj_t * file_table;
+    lv_obj_t * file_list;
     lv_obj_t * path_label;
 #if LV_FILE_EXPLORER_QUICK_ACCESS
     lv_obj_t * quick_access_area;
@@ -70,7 +79,10 @@ typedef struct {
 #endif
     const char * sel_fn;
     char   current_path[LV_FILE_EXPLORER_PATH_MAX_LEN];
+    lv_fe_dir_t dir;    /*Entries of current_path, shown by file_list*/
     lv_file_explorer_sort_t sort;
+    SemaphoreHandle_t gui_lock; /*Set to read directories on a worker task*/
+    lv_fe_scan_t * scan;        /*Directory still being read, NULL if none*/
 } lv_file_explorer_t;
 
 extern const lv_obj_class_t lv_file_explorer_class;
@@ -106,7 +118,19 @@ void lv_file_explorer_set_quick_access_path(lv_obj_t * obj, lv_file_explorer_dir
  */
 void lv_file_explorer_set_sort(lv_obj_t * obj, lv_file_explorer_sort_t sort);
 
+/**
+ * Read directories that are not in the index cache on a worker task. The list fills in
+ * while they are read, LV_EVENT_READY is sent when they are complete.
+ * @param obj       pointer to a file explorer object
+ * @param gui_lock  the mutex held around lv_task_handler(), NULL to read on the GUI task
+ */
+void lv_file_explorer_set_gui_lock(lv_obj_t * obj, SemaphoreHandle_t gui_lock);
 
+/**
+ * Read a whole text file, see lv_text_load() for the length and error code
+ * @param path  file to read
+ * @return      the NUL terminated text (free with mem_tel_free(MEM_TEL_TEXT, ...)), or an error message
+ */
 char * lv_read_file(const char *path);
 /*=====================
  * Getter functions
@@ -164,11 +188,11 @@ lv_obj_t * lv_file_explorer_get_device_list(lv_obj_t * obj);
 #endif
 
 /**
- * Get file explorer file list obj(lv_table)
+ * Get file explorer file list obj(lv_fe_list)
  * @param obj   pointer to a file explorer object
- * @return      pointer to the file explorer file table obj(lv_table)
+ * @return      pointer to the file explorer file list obj(lv_fe_list)
  */
-lv_obj_t * lv_file_explorer_get_file_table(lv_obj_t * obj);
+lv_obj_t * lv_file_explorer_get_file_list(lv_obj_t * obj);
 
 /**
  * Set file_explorer sort
@@ -188,6 +212,15 @@ lv_file_explorer_sort_t lv_file_explorer_get_sort(const lv_obj_t * obj);
  */
 void lv_file_explorer_open_dir(lv_obj_t * obj, const char * dir);
 
+/**
+ * Open the parent of the current directory, as the ".." entry does
+ * @param obj   pointer to a file explorer object
+ * @return      false at the root of the drive
+ */
+bool lv_file_explorer_open_parent(lv_obj_t * obj);
+
 #ifdef __cplusplus
 } /*extern "C"*/
 #endif
+
+#endif /*LV_FILE_EXPLORER_H*/
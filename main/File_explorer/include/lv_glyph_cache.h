@@ -0,0 +1,94 @@
+/**
+ * @file lv_glyph_cache.h
+ *
+ * Glyph bitmap cache in PSRAM. LVGL asks the font for the bitmap of every letter it draws,
+ * and a font renders it again each time: compressed fonts unpack it, TrueType fonts raster
+ * it. A font from lv_glyph_cache_font() wraps a font and keeps the bitmaps it rendered,
+ * keyed by font, code point and glyph format, as 4 bpp in a byte budget; the least recently
+ * drawn are dropped first. A hit only widens the 4 bpp to the A8 the software renderer blends.
+ * A1, A2 and A4 glyphs come back exact, A8 ones with 16 levels.
+ * The bitmaps are asked for by the draw unit, between two refreshes nothing draws: clear the
+ * cache or switch it off then, with the GUI lock held.
+ */
+#ifndef LV_GLYPH_CACHE_H
+#define LV_GLYPH_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Fonts that can be wrapped*/
+#define LV_GLYPH_CACHE_FONTS        8
+/*Hash buckets in internal RAM, a power of 2*/
+#define LV_GLYPH_CACHE_BUCKETS      512
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;        /*Rendered by the font and added*/
+    uint32_t evictions;     /*Dropped for the budget*/
+    uint32_t bypassed;      /*Not cacheable: image glyphs, or larger than the budget*/
+    uint32_t entries;
+    size_t bytes;           /*Held in PSRAM, bitmaps and their keys*/
+} lv_glyph_cache_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Set the byte budget, once before the fonts are wrapped
+ * @param budget_bytes  largest PSRAM the cache holds, 0 to keep it off
+ * @return              ESP_OK, or ESP_ERR_NO_MEM for the hash buckets
+ */
+esp_err_t lv_glyph_cache_init(size_t budget_bytes);
+
+/**
+ * Get the caching font of a font, made on the first call. It has the metrics of the font
+ * and draws the same; set it as text font in its place.
+ * @param base      the font to cache
+ * @return          the caching font, base itself if the cache is off or all wrappers are used
+ */
+const lv_font_t * lv_glyph_cache_font(const lv_font_t * base);
+
+/**
+ * Switch the cache on or off, the wrapped fonts then render every glyph as base does
+ * @param en        true to use the cache
+ */
+void lv_glyph_cache_set_enabled(bool en);
+
+/**
+ * Drop all glyphs
+ */
+void lv_glyph_cache_clear(void);
+
+/**
+ * Get the counters
+ * @param stats     set to the counters since lv_glyph_cache_init() or the last reset
+ */
+void lv_glyph_cache_get_stats(lv_glyph_cache_stats_t * stats);
+
+/**
+ * Zero hits, misses, evictions and bypassed, the entries and bytes stay
+ */
+void lv_glyph_cache_reset_stats(void);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_GLYPH_CACHE_H*/
@@ -0,0 +1,86 @@
+/**
+ * @file lv_jpeg_loader.h
+ *
+ * JPEG photos for the viewer tab: decoded by the TJpgDec in the ESP32-S3 ROM while the
+ * file is read ahead in blocks (lv_fe_reader), scaled down in the DCT (1/2, 1/4, 1/8) to fit, and converted
+ * straight to the display format. Only the output image is as big as the photo, which also
+ * makes it the decoder for the explorer thumbnails.
+ */
+#ifndef LV_JPEG_LOADER_H
+#define LV_JPEG_LOADER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Bytes per block of the read-ahead reader, a multiple of the FAT sector*/
+#define LV_JPEG_LOADER_BLOCK_SIZE   4096
+/*Decoder work area, what the ROM TJpgDec needs for its tables and one MCU*/
+#define LV_JPEG_LOADER_WORK_SIZE    3100
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint32_t decode_us;     /*Open to last pixel converted*/
+    uint32_t reads;         /*Blocks read*/
+    uint32_t stall_us;      /*Of decode_us, waiting for the card*/
+    uint16_t src_w;         /*Size of the photo*/
+    uint16_t src_h;
+    uint8_t scale;          /*Divider used: 1, 2, 4 or 8*/
+    size_t peak_bytes;      /*Work area, read-ahead blocks and output image*/
+} lv_jpeg_load_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Decode a JPEG file to fit in max_w x max_h. The smallest DCT scaling that fits is used,
+ * beyond 1/8 pixels are picked (nearest) to fit. The pixels are in PSRAM when there is some.
+ * @param path      file to read
+ * @param max_w     largest width
+ * @param max_h     largest height
+ * @param cf        LV_COLOR_FORMAT_RGB332 or LV_COLOR_FORMAT_L8
+ * @param out       the image, free it with lv_jpeg_free()
+ * @param stats     optional timing and memory, NULL if not needed
+ * @return          ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NOT_FOUND, ESP_ERR_NO_MEM,
+ *                  or ESP_ERR_NOT_SUPPORTED if the decoder rejects the file (e.g. progressive)
+ */
+esp_err_t lv_jpeg_load(const char * path, uint32_t max_w, uint32_t max_h, lv_color_format_t cf,
+                       lv_image_dsc_t * out, lv_jpeg_load_stats_t * stats);
+
+/**
+ * Free the pixels of an image from lv_jpeg_load()
+ * @param dsc       the image, data is set to NULL
+ */
+void lv_jpeg_free(lv_image_dsc_t * dsc);
+
+/**
+ * Load a JPEG file into an image object, the pixels are freed with the object
+ * @param img       pointer to an image object
+ * @param path      file to read
+ * @param max_w     largest width
+ * @param max_h     largest height
+ * @param cf        LV_COLOR_FORMAT_RGB332 or LV_COLOR_FORMAT_L8
+ * @return          see lv_jpeg_load()
+ */
+esp_err_t lv_jpeg_image_set_src(lv_obj_t * img, const char * path, uint32_t max_w, uint32_t max_h,
+                                lv_color_format_t cf);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_JPEG_LOADER_H*/
@@ -0,0 +1,100 @@
+/**
+ * @file lv_text_loader.h
+ *
+ * Text file loading for the file explorer: one pass of large block reads straight into
+ * the destination buffer, and a streaming mode that shows the first screen at once and
+ * loads the rest in a background task.
+ */
+#ifndef LV_TEXT_LOADER_H
+#define LV_TEXT_LOADER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Bytes per read(), a multiple of the FAT sector and of the 16 KB allocation unit in fs_init*/
+#define LV_TEXT_LOADER_BLOCK_SIZE   (32 * 1024)
+/*Default size of the first part in streaming mode, about one 1000x700 text area*/
+#define LV_TEXT_LOADER_FIRST_SCREEN (4 * 1024)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+/*Loaded text, always NUL terminated*/
+typedef struct {
+    char * data;
+    size_t len;         /*Bytes of text, without the terminator*/
+} lv_text_buf_t;
+
+typedef struct {
+    uint32_t first_us;  /*Open to first screen shown*/
+    uint32_t total_us;  /*Open to whole file loaded*/
+    uint32_t reads;     /*read() calls*/
+} lv_text_load_stats_t;
+
+/**
+ * Called on the GUI side (gui_lock held) when the streamed file is complete.
+ * res is ESP_OK, or the read error; text then holds what was read before it.
+ */
+typedef void (*lv_text_stream_done_cb_t)(lv_obj_t * ta, const lv_text_buf_t * text, esp_err_t res,
+                                         const lv_text_load_stats_t * stats, void * user_data);
+
+typedef struct {
+    lv_obj_t * ta;                      /*Text area to fill, NULL to only load (benchmarks)*/
+    size_t first_bytes;                 /*Size of the first part, 0 for LV_TEXT_LOADER_FIRST_SCREEN*/
+    SemaphoreHandle_t gui_lock;         /*Mutex around lv_task_handler(), NULL if there is none*/
+    lv_text_stream_done_cb_t done_cb;   /*Optional*/
+    void * user_data;
+} lv_text_stream_config_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Load a whole file in one pass. The buffer is in PSRAM when there is some.
+ * @param path      file to read
+ * @param out       the text, free it with lv_text_buf_free()
+ * @param stats     optional timing, NULL if not needed
+ * @return          ESP_OK, ESP_ERR_NOT_FOUND if the file can not be opened,
+ *                  ESP_ERR_NO_MEM or ESP_FAIL on a read error
+ */
+esp_err_t lv_text_load(const char * path, lv_text_buf_t * out, lv_text_load_stats_t * stats);
+
+/**
+ * Free a buffer from lv_text_load()
+ * @param buf       text buffer, data is set to NULL
+ */
+void lv_text_buf_free(lv_text_buf_t * buf);
+
+/**
+ * Stream a file into a text area. The first part is read and shown before returning,
+ * the rest is read by a background task. The text area shows the buffer without copying
+ * it into the LVGL heap, the buffer is freed with the text area. The text area is made
+ * read-only (not focusable, out of its group): do not set its text or add to it.
+ * Without a text area the buffer goes to done_cb, which must free it with lv_text_buf_free().
+ * Call it from the GUI task with gui_lock held.
+ * @param path      file to read
+ * @param config    text area, lock and callback; a text area or done_cb is needed
+ * @return          ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NOT_FOUND, ESP_ERR_NO_MEM or ESP_FAIL
+ */
+esp_err_t lv_text_stream(const char * path, const lv_text_stream_config_t * config);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_TEXT_LOADER_H*/
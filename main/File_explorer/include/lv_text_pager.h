@@ -0,0 +1,147 @@
+/**
+ * @file lv_text_pager.h
+ *
+ * Paged viewer for large text files. A page is what fits the content area of the widget,
+ * so a page turn is one full screen update. Only the current page is read from the file,
+ * into a window buffer sized from the page, and laid out with explicit line ends.
+ * A worker lays out the whole file once and writes where every page starts to a hidden
+ * sidecar file next to the text (its name with LV_TEXT_PAGER_INDEX_EXT added). It is built
+ * in a file of its own and renamed when complete, so a cancelled worker leaves no index.
+ * Going to any page reads one offset from it. Memory does not depend on the file size.
+ * A tap on the left third shows the previous page, anywhere else the next one.
+ */
+#ifndef LV_TEXT_PAGER_H
+#define LV_TEXT_PAGER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Added to the name of the text for its page index. Only replaces the extension of the text
+ *when long names are disabled, the header of the index then tells the texts apart.*/
+#define LV_TEXT_PAGER_INDEX_EXT     "TPX"
+/*Page offsets collected by the worker before they are appended to the index*/
+#define LV_TEXT_PAGER_CHUNK         64
+/*Limits of the window buffer, the bytes one page can cover*/
+#define LV_TEXT_PAGER_WINDOW_MIN    1024
+#define LV_TEXT_PAGER_WINDOW_MAX    (32 * 1024)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint32_t index_us;      /*Laying out the whole file, 0 if the index was read back*/
+    uint32_t index_stall_us; /*Of index_us, waiting for the card*/
+    uint32_t page_us;       /*Last page: offset lookup, read and layout*/
+    uint32_t window;        /*Bytes of the window buffer*/
+    uint32_t held;          /*Heap held while open: window, page text and index state*/
+    bool index_reused;
+} lv_text_pager_stats_t;
+
+/*The layout the index is valid for, from the font and the content size*/
+typedef struct {
+    const lv_font_t * font;
+    int32_t max_w;
+    int32_t letter_space;
+    uint32_t lines;         /*Lines per page*/
+    uint32_t window;
+    uint32_t key;           /*Hash of all of the above that changes the page breaks*/
+    uint8_t ascii_w[128];   /*Glyph widths plus letter space, other characters ask the font*/
+} lv_text_pager_layout_t;
+
+struct _lv_text_pager_index_t;
+
+/*Data of the text pager*/
+typedef struct {
+    lv_obj_t obj;
+    lv_obj_t * label;
+    SemaphoreHandle_t gui_lock;
+    char * window;          /*Page bytes read from the file, then the laid out page*/
+    char * text;
+    lv_text_pager_layout_t layout;
+    struct _lv_text_pager_index_t * index;  /*Shared with the worker, freed by the last one*/
+    uint32_t page;
+    uint32_t page_start;    /*File offsets of the page shown*/
+    uint32_t page_end;
+    uint32_t size;
+    lv_text_pager_stats_t stats;
+} lv_text_pager_t;
+
+extern const lv_obj_class_t lv_text_pager_class;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+lv_obj_t * lv_text_pager_create(lv_obj_t * parent);
+
+/**
+ * Set the mutex held around lv_task_handler(). Without it the index is made in
+ * lv_text_pager_open() before it returns.
+ * @param obj       pointer to a text pager
+ * @param gui_lock  the mutex, or NULL
+ */
+void lv_text_pager_set_gui_lock(lv_obj_t * obj, SemaphoreHandle_t gui_lock);
+
+/**
+ * Show the first page of a file and get its page index: read back from the sidecar file
+ * if it matches the file and the layout, else made by the worker. The size and the text
+ * font of the widget should be set before, the pages are laid out for them.
+ * LV_EVENT_VALUE_CHANGED is sent when the page or the page count changes.
+ * @param obj       pointer to a text pager
+ * @param path      path of the text file
+ * @return          ESP_OK, ESP_ERR_NOT_FOUND or ESP_ERR_NO_MEM
+ */
+esp_err_t lv_text_pager_open(lv_obj_t * obj, const char * path);
+
+/**
+ * Go to a page. Pages the worker has not reached yet are ignored, except the next one.
+ * @param obj       pointer to a text pager
+ * @param page      page number from 0
+ * @return          true if the page is shown
+ */
+bool lv_text_pager_set_page(lv_obj_t * obj, uint32_t page);
+
+bool lv_text_pager_next(lv_obj_t * obj);
+
+bool lv_text_pager_prev(lv_obj_t * obj);
+
+/**
+ * Get the page shown
+ * @param obj       pointer to a text pager
+ * @return          page number from 0
+ */
+uint32_t lv_text_pager_get_page(const lv_obj_t * obj);
+
+/**
+ * Get the number of pages
+ * @param obj       pointer to a text pager
+ * @param complete  set to false while the worker is still counting, can be NULL
+ * @return          pages known so far
+ */
+uint32_t lv_text_pager_get_page_count(const lv_obj_t * obj, bool * complete);
+
+/**
+ * Get the timings and the window size
+ * @param obj       pointer to a text pager
+ * @return          pointer to the counters
+ */
+const lv_text_pager_stats_t * lv_text_pager_get_stats(const lv_obj_t * obj);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_TEXT_PAGER_H*/
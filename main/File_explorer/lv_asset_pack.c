@@ -0,0 +1,276 @@
+#include "include/lv_asset_pack.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_log.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*The font blob: glyph descriptions from glyph id 0, which LVGL keeps unused, then the bitmaps*/
+#define FE_ASSET_GLYPH_DSC_SIZE     8
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    lv_font_t font;
+    lv_font_fmt_txt_dsc_t dsc;
+    lv_font_fmt_txt_cmap_t cmap;
+} fe_asset_font_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static esp_err_t fe_asset_check(const uint8_t * data, uint32_t size);
+static const lv_asset_pack_entry_t * fe_asset_find(const char * name, uint8_t type, uint32_t * index);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * ASSET_TAG = "Explorer assets";
+
+static const uint8_t * pack_data;
+static const lv_asset_pack_header_t * pack_header;
+static const lv_asset_pack_entry_t * pack_entries;
+static esp_partition_mmap_handle_t pack_mmap;
+static bool pack_mapped;
+static void ** pack_dscs;       /*Descriptor of each entry once made*/
+static uint32_t pack_ram_bytes;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+esp_err_t lv_asset_pack_mount(const char * label)
+{
+    lv_asset_pack_header_t header;
+    const void * data;
+
+    lv_asset_pack_unmount();
+
+    const esp_partition_t * part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                            label ? label : LV_ASSET_PACK_PARTITION);
+    if(part == NULL) return ESP_ERR_NOT_FOUND;
+
+    /*Map only what the pack uses, the MMU pages are shared with the app rodata*/
+    esp_err_t res = esp_partition_read(part, 0, &header, sizeof(header));
+    if(res != ESP_OK) return res;
+    if(header.magic != LV_ASSET_PACK_MAGIC || header.version != LV_ASSET_PACK_VERSION ||
+       header.size < sizeof(header) || header.size > part->size) {
+        ESP_LOGW(ASSET_TAG, "No asset pack in partition %s", part->label);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    res = esp_partition_mmap(part, 0, header.size, ESP_PARTITION_MMAP_DATA, &data, &pack_mmap);
+    if(res != ESP_OK) {
+        ESP_LOGE(ASSET_TAG, "Failed to map %lu bytes of %s", (unsigned long)header.size, part->label);
+        return res;
+    }
+    pack_mapped = true;
+
+    res = fe_asset_check((const uint8_t *)data, header.size);
+    if(res != ESP_OK) lv_asset_pack_unmount();
+
+    return res;
+}
+
+esp_err_t lv_asset_pack_mount_buffer(const void * data, uint32_t size)
+{
+    lv_asset_pack_unmount();
+
+    if(size < sizeof(lv_asset_pack_header_t)) return ESP_ERR_INVALID_SIZE;
+
+    esp_err_t res = fe_asset_check((const uint8_t *)data, size);
+    if(res != ESP_OK) lv_asset_pack_unmount();
+
+    return res;
+}
+
+void lv_asset_pack_unmount(void)
+{
+    if(pack_dscs) {
+        for(uint32_t i = 0; i < pack_header->count; i++) free(pack_dscs[i]);
+        free(pack_dscs);
+        pack_dscs = NULL;
+    }
+    if(pack_mapped) esp_partition_munmap(pack_mmap);
+
+    pack_mapped = false;
+    pack_data = NULL;
+    pack_header = NULL;
+    pack_entries = NULL;
+    pack_ram_bytes = 0;
+}
+
+const lv_image_dsc_t * lv_asset_pack_image(const char * name)
+{
+    uint32_t index;
+    const lv_asset_pack_entry_t * e = fe_asset_find(name, LV_ASSET_PACK_TYPE_IMAGE, &index);
+    if(e == NULL) return NULL;
+    if(pack_dscs[index]) return (const lv_image_dsc_t *)pack_dscs[index];
+
+    lv_color_format_t cf;
+    switch(e->cf) {
+        case LV_ASSET_PACK_CF_RGB332:
+            cf = LV_COLOR_FORMAT_RGB332;
+            break;
+        case LV_ASSET_PACK_CF_L8:
+            cf = LV_COLOR_FORMAT_L8;
+            break;
+        case LV_ASSET_PACK_CF_A8:
+            cf = LV_COLOR_FORMAT_A8;
+            break;
+        default:
+            ESP_LOGW(ASSET_TAG, "%s: unknown format %u", name, e->cf);
+            return NULL;
+    }
+    if((uint32_t)e->stride * e->h > e->size) {
+        ESP_LOGW(ASSET_TAG, "%s: %u rows of %u bytes do not fit", name, e->h, e->stride);
+        return NULL;
+    }
+
+    lv_image_dsc_t * img = (lv_image_dsc_t *)calloc(1, sizeof(lv_image_dsc_t));
+    if(img == NULL) return NULL;
+    img->header.magic = LV_IMAGE_HEADER_MAGIC;
+    img->header.cf = cf;
+    img->header.w = e->w;
+    img->header.h = e->h;
+    img->header.stride = e->stride;
+    img->data_size = e->size;
+    img->data = pack_data + e->offset;
+
+    pack_dscs[index] = img;
+    pack_ram_bytes += sizeof(lv_image_dsc_t);
+    return img;
+}
+
+const lv_font_t * lv_asset_pack_font(const char * name)
+{
+    uint32_t index;
+    const lv_asset_pack_entry_t * e = fe_asset_find(name, LV_ASSET_PACK_TYPE_FONT, &index);
+    if(e == NULL) return NULL;
+    if(pack_dscs[index]) return &((fe_asset_font_t *)pack_dscs[index])->font;
+
+#if LV_FONT_FMT_TXT_LARGE
+    /*The pack has the 8 byte glyph descriptions*/
+    ESP_LOGW(ASSET_TAG, "%s: fonts need LV_FONT_FMT_TXT_LARGE disabled", name);
+    return NULL;
+#else
+    uint32_t dsc_size = ((uint32_t)e->glyph_count + 1) * FE_ASSET_GLYPH_DSC_SIZE;
+    if(e->glyph_count == 0 || dsc_size > e->size || (e->bpp != 1 && e->bpp != 2 && e->bpp != 4 && e->bpp != 8)) {
+        ESP_LOGW(ASSET_TAG, "%s: not a font this build reads", name);
+        return NULL;
+    }
+
+    fe_asset_font_t * f = (fe_asset_font_t *)calloc(1, sizeof(fe_asset_font_t));
+    if(f == NULL) return NULL;
+
+    /*One range of consecutive code points, glyph ids from 1*/
+    f->cmap.range_start = e->range_start;
+    f->cmap.range_length = e->glyph_count;
+    f->cmap.glyph_id_start = 1;
+    f->cmap.type = LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY;
+
+    f->dsc.glyph_dsc = (const lv_font_fmt_txt_glyph_dsc_t *)(pack_data + e->offset);
+    f->dsc.glyph_bitmap = pack_data + e->offset + dsc_size;
+    f->dsc.cmaps = &f->cmap;
+    f->dsc.cmap_num = 1;
+    f->dsc.bpp = e->bpp;
+    f->dsc.bitmap_format = LV_FONT_FMT_TXT_PLAIN;
+
+    f->font.get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt;
+    f->font.get_glyph_bitmap = lv_font_get_bitmap_fmt_txt;
+    f->font.line_height = e->line_height;
+    f->font.base_line = e->base_line;
+    f->font.subpx = LV_FONT_SUBPX_NONE;
+    f->font.dsc = &f->dsc;
+
+    pack_dscs[index] = f;
+    pack_ram_bytes += sizeof(fe_asset_font_t);
+    return &f->font;
+#endif
+}
+
+const void * lv_asset_pack_raw(const char * name, uint32_t * size)
+{
+    const lv_asset_pack_entry_t * e = fe_asset_find(name, 0, NULL);
+
+    if(size) *size = e ? e->size : 0;
+    return e ? pack_data + e->offset : NULL;
+}
+
+const lv_asset_pack_entry_t * lv_asset_pack_get_entry(uint32_t index)
+{
+    if(pack_header == NULL || index >= pack_header->count) return NULL;
+
+    return &pack_entries[index];
+}
+
+void lv_asset_pack_get_info(lv_asset_pack_info_t * info)
+{
+    memset(info, 0, sizeof(*info));
+    if(pack_header == NULL) return;
+
+    info->size = pack_header->size;
+    info->count = pack_header->count;
+    info->ram_bytes = pack_ram_bytes;
+    info->mapped = pack_mapped;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+/*Check the header and the index, and make the mount current*/
+static esp_err_t fe_asset_check(const uint8_t * data, uint32_t size)
+{
+    const lv_asset_pack_header_t * header = (const lv_asset_pack_header_t *)data;
+
+    if(header->magic != LV_ASSET_PACK_MAGIC || header->version != LV_ASSET_PACK_VERSION) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    uint32_t index_size = (uint32_t)header->count * sizeof(lv_asset_pack_entry_t);
+    if(header->size > size || sizeof(*header) + index_size > header->size) return ESP_ERR_INVALID_SIZE;
+
+    const lv_asset_pack_entry_t * entries = (const lv_asset_pack_entry_t *)(data + sizeof(*header));
+    /*Same as zlib.crc32() of the tool*/
+    if(esp_rom_crc32_le(0, (const uint8_t *)entries, index_size) != header->crc) {
+        ESP_LOGW(ASSET_TAG, "Asset pack index is corrupt");
+        return ESP_ERR_INVALID_CRC;
+    }
+    for(uint32_t i = 0; i < header->count; i++) {
+        if(entries[i].offset > header->size || entries[i].size > header->size - entries[i].offset ||
+           entries[i].name[LV_ASSET_PACK_NAME_MAX] != '\0') {
+            ESP_LOGW(ASSET_TAG, "Asset pack entry %lu is out of the pack", (unsigned long)i);
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+
+    pack_dscs = (void **)calloc(header->count ? header->count : 1, sizeof(void *));
+    if(pack_dscs == NULL) return ESP_ERR_NO_MEM;
+
+    pack_data = data;
+    pack_header = header;
+    pack_entries = entries;
+    pack_ram_bytes = header->count * sizeof(void *);
+    ESP_LOGI(ASSET_TAG, "%u assets, %lu bytes%s", header->count, (unsigned long)header->size,
+             pack_mapped ? " mapped from flash" : "");
+
+    return ESP_OK;
+}
+
+/*Entry of that name and type, any type for 0. A few dozen entries, a linear search is enough.*/
+static const lv_asset_pack_entry_t * fe_asset_find(const char * name, uint8_t type, uint32_t * index)
+{
+    if(pack_header == NULL) return NULL;
+
+    for(uint32_t i = 0; i < pack_header->count; i++) {
+        const lv_asset_pack_entry_t * e = &pack_entries[i];
+        if(strncmp(e->name, name, sizeof(e->name)) == 0 && (type == 0 || e->type == type)) {
+            if(index) *index = i;
+            return e;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,306 @@
+#include "include/lv_epi_loader.h"
+#include "include/lv_fe_reader.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "mem_telemetry.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    lv_fe_reader_t * reader;
+    const uint8_t * block;  /*Borrowed from the reader*/
+    size_t len;             /*Bytes in block*/
+    size_t pos;             /*Next byte to unpack*/
+    lv_epi_header_t header;
+    int64_t start;
+} epi_in_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static esp_err_t epi_open(const char * path, epi_in_t * in);
+static esp_err_t epi_unpack(epi_in_t * in, uint8_t * buf, uint32_t stride, uint32_t max_w, uint32_t max_h,
+                            lv_color_format_t cf, size_t * row_bytes);
+static void epi_close(epi_in_t * in, lv_epi_load_stats_t * stats, size_t peak_bytes);
+static size_t epi_in(epi_in_t * in, uint8_t * buf, size_t n);
+static bool epi_unpack_row(epi_in_t * in, uint8_t * row, size_t row_bytes);
+static bool epi_header_ok(const lv_epi_header_t * header);
+static void epi_image_delete_event_cb(lv_event_t * e);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * EPI_TAG = "EPI loader";
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+esp_err_t lv_epi_get_header(const char * path, lv_epi_header_t * header)
+{
+    FILE * f = fopen(path, "rb");
+    if(f == NULL) return ESP_ERR_NOT_FOUND;
+    size_t n = fread(header, 1, sizeof(*header), f);
+    fclose(f);
+
+    return n == sizeof(*header) && epi_header_ok(header) ? ESP_OK : ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t lv_epi_load_into(const char * path, uint8_t * buf, uint32_t stride, uint32_t max_w, uint32_t max_h,
+                           lv_color_format_t cf, lv_epi_load_stats_t * stats)
+{
+    epi_in_t in;
+    size_t row_bytes = 0;
+
+    if(cf != LV_COLOR_FORMAT_RGB332 && cf != LV_COLOR_FORMAT_L8) return ESP_ERR_INVALID_ARG;
+
+    esp_err_t res = epi_open(path, &in);
+    if(res != ESP_OK) return res;
+
+    res = epi_unpack(&in, buf, stride, max_w, max_h, cf, &row_bytes);
+    epi_close(&in, res == ESP_OK ? stats : NULL, LV_FE_READER_BUFS * LV_EPI_BLOCK_SIZE + row_bytes);
+
+    return res;
+}
+
+esp_err_t lv_epi_load(const char * path, uint32_t max_w, uint32_t max_h, lv_color_format_t cf,
+                      lv_image_dsc_t * out, lv_epi_load_stats_t * stats)
+{
+    epi_in_t in;
+    size_t row_bytes = 0;
+
+    memset(out, 0, sizeof(lv_image_dsc_t));
+    if(cf != LV_COLOR_FORMAT_RGB332 && cf != LV_COLOR_FORMAT_L8) return ESP_ERR_INVALID_ARG;
+
+    /*The header is in the first block, the image is sized before the rows are read*/
+    esp_err_t res = epi_open(path, &in);
+    if(res != ESP_OK) return res;
+
+    uint32_t w = LV_MIN(in.header.w, max_w);
+    uint32_t h = LV_MIN(in.header.h, max_h);
+    uint8_t * px = (uint8_t *)mem_tel_malloc_prefer(MEM_TEL_IMAGE, w * h, MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT);
+    if(px == NULL) {
+        ESP_LOGE(EPI_TAG, "No memory for %lux%lu", (unsigned long)w, (unsigned long)h);
+        epi_close(&in, NULL, 0);
+        return ESP_ERR_NO_MEM;
+    }
+
+    res = epi_unpack(&in, px, w, w, h, cf, &row_bytes);
+    if(res != ESP_OK) {
+        mem_tel_free(MEM_TEL_IMAGE, px);
+        epi_close(&in, NULL, 0);
+        return res;
+    }
+
+    out->header.magic = LV_IMAGE_HEADER_MAGIC;
+    out->header.cf = cf;
+    out->header.w = w;
+    out->header.h = h;
+    out->header.stride = w;
+    out->data_size = w * h;
+    out->data = px;
+    epi_close(&in, stats, LV_FE_READER_BUFS * LV_EPI_BLOCK_SIZE + row_bytes + out->data_size);
+
+    return ESP_OK;
+}
+
+void lv_epi_free(lv_image_dsc_t * dsc)
+{
+    mem_tel_free(MEM_TEL_IMAGE, (void *)dsc->data);
+    dsc->data = NULL;
+}
+
+esp_err_t lv_epi_image_set_src(lv_obj_t * img, const char * path, uint32_t max_w, uint32_t max_h,
+                               lv_color_format_t cf)
+{
+    lv_epi_load_stats_t stats;
+
+    lv_image_dsc_t * dsc = (lv_image_dsc_t *)mem_tel_malloc(MEM_TEL_IMAGE, sizeof(lv_image_dsc_t), MALLOC_CAP_DEFAULT);
+    if(dsc == NULL) return ESP_ERR_NO_MEM;
+
+    esp_err_t res = lv_epi_load(path, max_w, max_h, cf, dsc, &stats);
+    if(res != ESP_OK) {
+        mem_tel_free(MEM_TEL_IMAGE, dsc);
+        return res;
+    }
+    ESP_LOGI(EPI_TAG, "%s %ux%u in %lu us", path, stats.w, stats.h, (unsigned long)stats.load_us);
+
+    lv_image_set_src(img, dsc);
+    lv_obj_add_event_cb(img, epi_image_delete_event_cb, LV_EVENT_DELETE, dsc);
+
+    return ESP_OK;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+/*Start reading ahead from the start of the file, the header is taken from the first block*/
+static esp_err_t epi_open(const char * path, epi_in_t * in)
+{
+    memset(in, 0, sizeof(*in));
+    in->start = esp_timer_get_time();
+
+    esp_err_t res = lv_fe_reader_open(path, 0, LV_EPI_BLOCK_SIZE, &in->reader);
+    if(res != ESP_OK) return res;
+
+    if(epi_in(in, (uint8_t *)&in->header, sizeof(in->header)) != sizeof(in->header) ||
+       !epi_header_ok(&in->header)) {
+        ESP_LOGE(EPI_TAG, "%s: not an EPI image", path);
+        lv_fe_reader_close(in->reader, NULL);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    return ESP_OK;
+}
+
+/*Unpack the rows that fit, converting them to cf on the way*/
+static esp_err_t epi_unpack(epi_in_t * in, uint8_t * buf, uint32_t stride, uint32_t max_w, uint32_t max_h,
+                            lv_color_format_t cf, size_t * row_bytes)
+{
+    const lv_epi_header_t * hd = &in->header;
+    uint32_t w = LV_MIN(hd->w, max_w);
+    uint32_t h = LV_MIN(hd->h, max_h);
+    uint8_t map[256];
+
+    *row_bytes = hd->format == LV_EPI_FORMAT_GRAY4 ? (hd->w + 1) / 2 : hd->w;
+
+    /*Rows already in the display format and wide enough are unpacked in place*/
+    bool direct = hd->format == LV_EPI_FORMAT_RGB332 && cf == LV_COLOR_FORMAT_RGB332 && max_w >= hd->w;
+    uint8_t * row = NULL;
+    if(!direct) {
+        /*Read byte by byte by the conversion, keep it in internal RAM*/
+        row = (uint8_t *)mem_tel_malloc(MEM_TEL_FILE_BUF, *row_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if(row == NULL) return ESP_ERR_NO_MEM;
+    }
+    else {
+        *row_bytes = 0;
+    }
+
+    if(hd->format == LV_EPI_FORMAT_GRAY4) {
+        /*The 16 levels spread over 0..255*/
+        for(uint32_t v = 0; v < 16; v++) {
+            uint8_t g = (uint8_t)(v * 17);
+            map[v] = cf == LV_COLOR_FORMAT_L8 ? g : (g & 0xE0) | ((g & 0xE0) >> 3) | (g >> 6);
+        }
+    }
+    else {
+        for(uint32_t c = 0; c < 256; c++) {
+            /*RRRGGGBB widened to 8 bits a channel, then the same luma as the JPEG loader*/
+            uint32_t r = (c >> 5) * 255 / 7;
+            uint32_t g = ((c >> 2) & 7) * 255 / 7;
+            uint32_t b = (c & 3) * 255 / 3;
+            map[c] = cf == LV_COLOR_FORMAT_L8 ? (uint8_t)((r * 77 + g * 150 + b * 29) >> 8) : (uint8_t)c;
+        }
+    }
+
+    esp_err_t res = ESP_OK;
+    for(uint32_t y = 0; y < h; y++) {
+        uint8_t * d = buf + y * stride;
+        if(!epi_unpack_row(in, direct ? d : row, direct ? hd->w : *row_bytes)) {
+            ESP_LOGE(EPI_TAG, "Row %lu is cut short or corrupt", (unsigned long)y);
+            res = ESP_ERR_INVALID_SIZE;
+            break;
+        }
+        if(direct) continue;
+
+        if(hd->format == LV_EPI_FORMAT_GRAY4) {
+            for(uint32_t x = 0; x < w; x++) {
+                d[x] = map[(row[x >> 1] >> ((x & 1) ? 0 : 4)) & 0x0F];
+            }
+        }
+        else {
+            for(uint32_t x = 0; x < w; x++) {
+                d[x] = map[row[x]];
+            }
+        }
+    }
+
+    mem_tel_free(MEM_TEL_FILE_BUF, row);
+    return res;
+}
+
+static void epi_close(epi_in_t * in, lv_epi_load_stats_t * stats, size_t peak_bytes)
+{
+    lv_fe_reader_stats_t read_stats;
+
+    lv_fe_reader_close(in->reader, &read_stats);
+    if(stats == NULL) return;
+
+    stats->load_us = (uint32_t)(esp_timer_get_time() - in->start);
+    stats->reads = read_stats.blocks;
+    stats->stall_us = read_stats.stall_us;
+    stats->file_bytes = LV_EPI_HEADER_SIZE + in->header.data_size;
+    stats->w = in->header.w;
+    stats->h = in->header.h;
+    stats->format = in->header.format;
+    stats->peak_bytes = peak_bytes;
+}
+
+/*Copy the next n bytes to buf, fewer at the end of the file*/
+static size_t epi_in(epi_in_t * in, uint8_t * buf, size_t n)
+{
+    size_t done = 0;
+
+    while(done < n) {
+        if(in->pos == in->len) {
+            if(in->block) lv_fe_reader_release(in->reader);
+            lv_fe_reader_borrow(in->reader, &in->block, &in->len);
+            in->pos = 0;
+            if(in->len == 0) break;
+        }
+        size_t chunk = LV_MIN(n - done, in->len - in->pos);
+        memcpy(buf + done, in->block + in->pos, chunk);
+        in->pos += chunk;
+        done += chunk;
+    }
+
+    return done;
+}
+
+/*One row: stored as it is, or PackBits runs. A run past the end of the row is corrupt.*/
+static bool epi_unpack_row(epi_in_t * in, uint8_t * row, size_t row_bytes)
+{
+    if(in->header.compress == LV_EPI_COMPRESS_NONE) return epi_in(in, row, row_bytes) == row_bytes;
+
+    size_t done = 0;
+    while(done < row_bytes) {
+        uint8_t c;
+        if(epi_in(in, &c, 1) != 1) return false;
+        if(c < 128) {
+            /*c + 1 bytes as they are*/
+            size_t n = (size_t)c + 1;
+            if(n > row_bytes - done || epi_in(in, row + done, n) != n) return false;
+            done += n;
+        }
+        else if(c > 128) {
+            /*The next byte 257 - c times*/
+            size_t n = 257 - (size_t)c;
+            uint8_t v;
+            if(n > row_bytes - done || epi_in(in, &v, 1) != 1) return false;
+            memset(row + done, v, n);
+            done += n;
+        }
+    }
+
+    return true;
+}
+
+static bool epi_header_ok(const lv_epi_header_t * header)
+{
+    return memcmp(header->magic, LV_EPI_MAGIC, 3) == 0 && header->version == LV_EPI_VERSION &&
+           (header->format == LV_EPI_FORMAT_RGB332 || header->format == LV_EPI_FORMAT_GRAY4) &&
+           (header->compress == LV_EPI_COMPRESS_NONE || header->compress == LV_EPI_COMPRESS_PACKBITS) &&
+           header->w > 0 && header->h > 0;
+}
+
+static void epi_image_delete_event_cb(lv_event_t * e)
+{
+    lv_image_dsc_t * dsc = (lv_image_dsc_t *)lv_event_get_user_data(e);
+
+    lv_image_cache_drop(dsc);
+    lv_epi_free(dsc);
+    mem_tel_free(MEM_TEL_IMAGE, dsc);
+}
@@ -0,0 +1,421 @@
+#include "include/lv_fe_cache.h"
+#include "include/lv_file_explorer.h"
+#include "include/lv_fe_io.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "ff.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define FE_INDEX_MAGIC      0x58494546  /*"FEIX"*/
+#define FE_INDEX_VERSION    2
+#define FE_CACHE_PATH_MAX   (sizeof(MOUNT_POINT) + sizeof(LV_FE_CACHE_DIR) + 16)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+/*Index file: header, path, entries, names. Name offsets are relative to the stored names*/
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t path_len;
+    uint32_t stamp;         /*Of the visible entries, see fe_stamp_entry()*/
+    uint32_t count;
+    uint32_t names_len;
+    uint32_t crc;           /*Of entries and names*/
+} fe_index_header_t;
+
+typedef struct {
+    char path[LV_FILE_EXPLORER_PATH_MAX_LEN];
+    uint32_t stamp;
+    uint32_t used;          /*LRU clock, 0 for a free slot*/
+    lv_fe_dir_t dir;
+} fe_ram_slot_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static esp_err_t fe_cache_load(lv_fe_dir_t * dir, const char * path, lv_fe_cache_src_t * src, uint32_t * stamp,
+                               bool any);
+static void fe_cache_save(const char * path, const lv_fe_dir_t * dir, uint32_t first);
+static void fe_cache_drop(const char * path);
+static void fe_cache_lock(void);
+static void fe_cache_unlock(void);
+static bool fe_dir_stamp(const char * fatfs_path, uint32_t * stamp);
+static uint32_t fe_stamp_entry(uint32_t size, uint32_t mtime);
+static void fe_index_file(const char * path, char * out, size_t size);
+static fe_ram_slot_t * fe_ram_find(const char * path);
+static void fe_ram_store(const char * path, uint32_t stamp, const lv_fe_dir_t * dir, uint32_t first);
+static esp_err_t fe_card_load(lv_fe_dir_t * dir, const char * path, uint32_t * stamp, bool any);
+static void fe_card_store(const char * path, uint32_t stamp, const lv_fe_dir_t * dir, uint32_t first);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * CACHE_TAG = "Explorer cache";
+static fe_ram_slot_t fe_ram_slots[LV_FE_CACHE_RAM_DIRS];
+static uint32_t fe_ram_clock;
+static lv_fe_cache_stats_t fe_cache_stats;
+static bool fe_cache_dir_ready;
+/*Lookups run on the scan workers, a new one may start while the last one still saves*/
+static SemaphoreHandle_t fe_cache_mutex;
+static StaticSemaphore_t fe_cache_mutex_buf;
+static portMUX_TYPE fe_cache_mutex_init = portMUX_INITIALIZER_UNLOCKED;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+esp_err_t lv_fe_cache_read_dir(lv_fe_dir_t * dir, const char * path, lv_fe_cache_src_t * src)
+{
+    char fatfs_path[LV_FILE_EXPLORER_PATH_MAX_LEN];
+    uint32_t first = dir->count;
+    lv_fe_cache_src_t from = LV_FE_CACHE_SRC_SCAN;
+    uint32_t stamp;
+    esp_err_t res = ESP_ERR_INVALID_STATE;
+
+    int64_t start = esp_timer_get_time();
+
+    /*Checked before the index is loaded, the caller waits for both anyway*/
+    if(lv_fe_dir_fatfs_path(path, fatfs_path, sizeof(fatfs_path))) {
+        if(!fe_dir_stamp(fatfs_path, &stamp)) return ESP_ERR_NOT_FOUND;
+        res = fe_cache_load(dir, path, &from, &stamp, false);
+    }
+    if(res == ESP_ERR_INVALID_STATE) {
+        res = lv_fe_dir_scan(dir, path);
+        if(res == ESP_OK) fe_cache_save(path, dir, first);
+    }
+
+    fe_cache_stats.last_us = (uint32_t)(esp_timer_get_time() - start);
+    if(src) *src = from;
+
+    return res;
+}
+
+esp_err_t lv_fe_cache_lookup(lv_fe_dir_t * dir, const char * path, lv_fe_cache_src_t * src, uint32_t * stamp)
+{
+    char fatfs_path[LV_FILE_EXPLORER_PATH_MAX_LEN];
+
+    *src = LV_FE_CACHE_SRC_SCAN;
+    if(!lv_fe_dir_fatfs_path(path, fatfs_path, sizeof(fatfs_path))) return ESP_ERR_INVALID_STATE;
+
+    return fe_cache_load(dir, path, src, stamp, true);
+}
+
+esp_err_t lv_fe_cache_check(const char * path, uint32_t stamp)
+{
+    char fatfs_path[LV_FILE_EXPLORER_PATH_MAX_LEN];
+    uint32_t now;
+
+    if(!lv_fe_dir_fatfs_path(path, fatfs_path, sizeof(fatfs_path))) return ESP_ERR_INVALID_STATE;
+    if(!fe_dir_stamp(fatfs_path, &now)) return ESP_ERR_NOT_FOUND;
+    if(now == stamp) return ESP_OK;
+
+    ESP_LOGI(CACHE_TAG, "Index of %s is stale", path);
+    fe_cache_lock();
+    fe_cache_stats.stale++;
+    fe_cache_drop(path);
+    fe_cache_unlock();
+
+    return ESP_ERR_INVALID_STATE;
+}
+
+void lv_fe_cache_save(const char * path, const lv_fe_dir_t * dir, uint32_t first)
+{
+    fe_cache_save(path, dir, first);
+}
+
+void lv_fe_cache_invalidate(const char * path)
+{
+    fe_cache_lock();
+    fe_cache_drop(path);
+    fe_cache_unlock();
+}
+
+void lv_fe_cache_clear(void)
+{
+    FF_DIR ff_dir;
+    FILINFO fno;
+    char fn[FE_CACHE_PATH_MAX];
+
+    fe_cache_lock();
+    for(uint32_t i = 0; i < LV_FE_CACHE_RAM_DIRS; i++) {
+        lv_fe_dir_free(&fe_ram_slots[i].dir);
+        fe_ram_slots[i].used = 0;
+    }
+    if(f_opendir(&ff_dir, FATFS_DRIVE "/" LV_FE_CACHE_DIR) == FR_OK) {
+        while(f_readdir(&ff_dir, &fno) == FR_OK && fno.fname[0] != '\0') {
+            snprintf(fn, sizeof(fn), FATFS_DRIVE "/" LV_FE_CACHE_DIR "/%s", fno.fname);
+            f_unlink(fn);
+        }
+        f_closedir(&ff_dir);
+    }
+    fe_cache_unlock();
+}
+
+void lv_fe_cache_get_stats(lv_fe_cache_stats_t * stats)
+{
+    fe_cache_lock();
+    *stats = fe_cache_stats;
+    fe_cache_unlock();
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+/*RAM, then the card. With any the index is taken whatever its stamp, which is returned,
+ *otherwise only an index with *stamp is*/
+static esp_err_t fe_cache_load(lv_fe_dir_t * dir, const char * path, lv_fe_cache_src_t * src, uint32_t * stamp,
+                               bool any)
+{
+    uint32_t first = dir->count;
+    esp_err_t res = ESP_ERR_INVALID_STATE;
+
+    fe_cache_lock();
+    fe_ram_slot_t * slot = fe_ram_find(path);
+    if(slot && (any || slot->stamp == *stamp)) {
+        slot->used = ++fe_ram_clock;
+        if(lv_fe_dir_append(dir, &slot->dir)) {
+            fe_cache_stats.ram_hits++;
+            *src = LV_FE_CACHE_SRC_RAM;
+            *stamp = slot->stamp;
+            res = ESP_OK;
+        }
+    }
+    else if(slot) {
+        fe_cache_stats.stale++;
+        lv_fe_dir_free(&slot->dir);
+        slot->used = 0;
+    }
+
+    if(res != ESP_OK && fe_card_load(dir, path, stamp, any) == ESP_OK) {
+        fe_cache_stats.card_hits++;
+        *src = LV_FE_CACHE_SRC_CARD;
+        fe_ram_store(path, *stamp, dir, first);
+        res = ESP_OK;
+    }
+    if(res != ESP_OK) fe_cache_stats.misses++;
+    fe_cache_unlock();
+
+    return res;
+}
+
+/*The stamp of the entries just read, the same fe_dir_stamp() gives while nothing changed*/
+static void fe_cache_save(const char * path, const lv_fe_dir_t * dir, uint32_t first)
+{
+    uint32_t stamp = dir->count - first;
+
+    for(uint32_t i = first; i < dir->count; i++) {
+        stamp += fe_stamp_entry(dir->entries[i].size, dir->entries[i].mtime);
+    }
+
+    fe_cache_lock();
+    fe_card_store(path, stamp, dir, first);
+    fe_ram_store(path, stamp, dir, first);
+    fe_cache_unlock();
+}
+
+static void fe_cache_drop(const char * path)
+{
+    char fn[FE_CACHE_PATH_MAX];
+
+    fe_ram_slot_t * slot = fe_ram_find(path);
+    if(slot) {
+        lv_fe_dir_free(&slot->dir);
+        slot->used = 0;
+    }
+    fe_index_file(path, fn, sizeof(fn));
+    unlink(fn);
+}
+
+/*Around the RAM slots, the counters and the index files, so no lookup reads an index
+ *that is being written*/
+static void fe_cache_lock(void)
+{
+    taskENTER_CRITICAL(&fe_cache_mutex_init);
+    if(fe_cache_mutex == NULL) fe_cache_mutex = xSemaphoreCreateMutexStatic(&fe_cache_mutex_buf);
+    taskEXIT_CRITICAL(&fe_cache_mutex_init);
+
+    xSemaphoreTake(fe_cache_mutex, portMAX_DELAY);
+}
+
+static void fe_cache_unlock(void)
+{
+    xSemaphoreGive(fe_cache_mutex);
+}
+
+/*What an index is checked against. Neither FatFs nor a PC updates the date of a directory
+ *when its files change, so the visible entries (as lv_fe_dir_scan lists them) are read
+ *instead, without their names: no allocation, sorting or kind lookup.*/
+static bool fe_dir_stamp(const char * fatfs_path, uint32_t * stamp)
+{
+    FF_DIR ff_dir;
+    FILINFO fno;
+    uint32_t sum = 0;
+
+    if(f_opendir(&ff_dir, fatfs_path) != FR_OK) return false;
+    while(f_readdir(&ff_dir, &fno) == FR_OK && fno.fname[0] != '\0') {
+        if(fno.fattrib & AM_HID) continue;
+        uint32_t size = (fno.fattrib & AM_DIR) ? 0 : (uint32_t)fno.fsize;
+        sum += 1 + fe_stamp_entry(size, ((uint32_t)fno.fdate << 16) | fno.ftime);
+    }
+    f_closedir(&ff_dir);
+    *stamp = sum;
+
+    return true;
+}
+
+/*Count plus a sum over the entries, so the order they are listed in does not matter.
+ *A file written, added or removed changes it.*/
+static uint32_t fe_stamp_entry(uint32_t size, uint32_t mtime)
+{
+    return (size * 2654435761u) ^ (mtime * 40503u);
+}
+
+/*One file per directory, named by the FNV-1a hash of its path. The path is stored inside
+ *too, a hash collision only costs a scan.*/
+static void fe_index_file(const char * path, char * out, size_t size)
+{
+    uint32_t hash = 2166136261u;
+    for(const char * p = path; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    snprintf(out, size, MOUNT_POINT "/" LV_FE_CACHE_DIR "/%08lX.IDX", (unsigned long)hash);
+}
+
+static fe_ram_slot_t * fe_ram_find(const char * path)
+{
+    for(uint32_t i = 0; i < LV_FE_CACHE_RAM_DIRS; i++) {
+        if(fe_ram_slots[i].used && strcmp(fe_ram_slots[i].path, path) == 0) return &fe_ram_slots[i];
+    }
+
+    return NULL;
+}
+
+/*Keep entries first..count of dir, replacing the least recently used directory*/
+static void fe_ram_store(const char * path, uint32_t stamp, const lv_fe_dir_t * dir, uint32_t first)
+{
+    fe_ram_slot_t * slot = fe_ram_find(path);
+
+    if(slot == NULL) {
+        slot = &fe_ram_slots[0];
+        for(uint32_t i = 1; i < LV_FE_CACHE_RAM_DIRS; i++) {
+            if(fe_ram_slots[i].used < slot->used) slot = &fe_ram_slots[i];
+        }
+    }
+
+    /*The names of entries before first are copied too, a few bytes for "." and ".."*/
+    lv_fe_dir_t part = *dir;
+    part.entries = dir->entries + first;
+    part.count = dir->count - first;
+
+    lv_fe_dir_clear(&slot->dir);
+    if(!lv_fe_dir_append(&slot->dir, &part)) {
+        lv_fe_dir_free(&slot->dir);
+        slot->used = 0;
+        return;
+    }
+    snprintf(slot->path, sizeof(slot->path), "%s", path);
+    slot->stamp = stamp;
+    slot->used = ++fe_ram_clock;
+}
+
+static esp_err_t fe_card_load(lv_fe_dir_t * dir, const char * path, uint32_t * stamp, bool any)
+{
+    char fn[FE_CACHE_PATH_MAX];
+    char stored_path[LV_FILE_EXPLORER_PATH_MAX_LEN];
+    fe_index_header_t h;
+
+    fe_index_file(path, fn, sizeof(fn));
+    FILE * f = lv_fe_io_fopen(fn, "rb");
+    if(f == NULL) return ESP_ERR_NOT_FOUND;
+
+    size_t path_len = strlen(path);
+    bool valid = fread(&h, sizeof(h), 1, f) == 1 && h.magic == FE_INDEX_MAGIC && h.version == FE_INDEX_VERSION &&
+                 h.path_len == path_len && path_len < sizeof(stored_path) &&
+                 fread(stored_path, 1, path_len, f) == path_len && memcmp(stored_path, path, path_len) == 0;
+    if(!valid) {
+        /*Another directory with the same hash, or an old format: not stale, just not ours*/
+        fclose(f);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if((any || h.stamp == *stamp) && lv_fe_dir_reserve(dir, h.count, h.names_len)) {
+        lv_fe_entry_t * e = dir->entries + dir->count;
+        char * names = dir->names + dir->names_len;
+        if(fread(e, sizeof(lv_fe_entry_t), h.count, f) == h.count && fread(names, 1, h.names_len, f) == h.names_len) {
+            uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)e, h.count * sizeof(lv_fe_entry_t));
+            crc = esp_rom_crc32_le(crc, (const uint8_t *)names, h.names_len);
+            if(crc == h.crc) {
+                for(uint32_t i = 0; i < h.count; i++) {
+                    e[i].name += dir->names_len;
+                }
+                dir->count += h.count;
+                dir->names_len += h.names_len;
+                *stamp = h.stamp;
+                fclose(f);
+                return ESP_OK;
+            }
+        }
+    }
+
+    ESP_LOGI(CACHE_TAG, "Index of %s is stale", path);
+    fe_cache_stats.stale++;
+    fclose(f);
+    unlink(fn);
+
+    return ESP_ERR_INVALID_STATE;
+}
+
+/*Written to a temporary file and renamed, a power cut leaves the old index or none. FatFs
+ *does not rename over a file, the old one is removed first: the lock keeps lookups out
+ *of that gap.*/
+static void fe_card_store(const char * path, uint32_t stamp, const lv_fe_dir_t * dir, uint32_t first)
+{
+    char fn[FE_CACHE_PATH_MAX];
+    char tmp[FE_CACHE_PATH_MAX];
+    fe_index_header_t h;
+
+    if(dir->count - first < LV_FE_CACHE_MIN_ENTRIES) return;
+
+    if(!fe_cache_dir_ready) {
+        mkdir(MOUNT_POINT "/" LV_FE_CACHE_DIR, 0775);
+        f_chmod(FATFS_DRIVE "/" LV_FE_CACHE_DIR, AM_HID, AM_HID);
+        fe_cache_dir_ready = true;
+    }
+
+    const lv_fe_entry_t * e = dir->entries + first;
+    h.magic = FE_INDEX_MAGIC;
+    h.version = FE_INDEX_VERSION;
+    h.path_len = strlen(path);
+    h.stamp = stamp;
+    h.count = dir->count - first;
+    h.names_len = dir->names_len;
+    h.crc = esp_rom_crc32_le(0, (const uint8_t *)e, h.count * sizeof(lv_fe_entry_t));
+    h.crc = esp_rom_crc32_le(h.crc, (const uint8_t *)dir->names, h.names_len);
+
+    fe_index_file(path, fn, sizeof(fn));
+    snprintf(tmp, sizeof(tmp), "%.*sTMP", (int)(strlen(fn) - 3), fn);
+    FILE * f = lv_fe_io_fopen(tmp, "wb");
+    if(f == NULL) {
+        ESP_LOGW(CACHE_TAG, "Can not write %s", tmp);
+        return;
+    }
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(path, 1, h.path_len, f) == h.path_len &&
+              fwrite(e, sizeof(lv_fe_entry_t), h.count, f) == h.count &&
+              fwrite(dir->names, 1, h.names_len, f) == h.names_len;
+    ok = (fclose(f) == 0) && ok;
+
+    unlink(fn);
+    if(!ok || rename(tmp, fn) != 0) {
+        ESP_LOGW(CACHE_TAG, "Index of %s not written", path);
+        unlink(tmp);
+    }
+}
@@ -0,0 +1,234 @@
+#include "include/lv_fe_dir.h"
+#include "include/lv_fe_type.h"
+#include "include/lv_file_explorer.h"
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "esp_heap_caps.h"
+#include "mem_telemetry.h"
+#include "esp_log.h"
+#include "ff.h"
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define FE_DIR_MIN_ENTRIES  64
+#define FE_DIR_MIN_NAMES    1024
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void * fe_dir_grow(void * ptr, uint32_t * cap, uint32_t need, uint32_t min, size_t item_size);
+static esp_err_t fe_dir_scan_fatfs(lv_fe_dir_t * dir, const char * fatfs_path, lv_fe_dir_entry_cb_t cb,
+                                   void * user_data);
+static esp_err_t fe_dir_scan_vfs(lv_fe_dir_t * dir, const char * path, lv_fe_dir_entry_cb_t cb, void * user_data);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * DIR_TAG = "Explorer dir";
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+void lv_fe_dir_init(lv_fe_dir_t * dir)
+{
+    memset(dir, 0, sizeof(lv_fe_dir_t));
+}
+
+void lv_fe_dir_clear(lv_fe_dir_t * dir)
+{
+    dir->count = 0;
+    dir->names_len = 0;
+}
+
+void lv_fe_dir_free(lv_fe_dir_t * dir)
+{
+    mem_tel_free(MEM_TEL_EXPLORER, dir->entries);
+    mem_tel_free(MEM_TEL_EXPLORER, dir->names);
+    lv_fe_dir_init(dir);
+}
+
+bool lv_fe_dir_add(lv_fe_dir_t * dir, const char * name, lv_fe_kind_t kind, uint32_t size, uint32_t mtime)
+{
+    uint32_t len = strlen(name) + 1;
+
+    if(!lv_fe_dir_reserve(dir, 1, len)) return false;
+
+    lv_fe_entry_t * e = &dir->entries[dir->count++];
+    e->name = dir->names_len;
+    e->size = size;
+    e->mtime = mtime;
+    e->kind = kind;
+    memcpy(dir->names + dir->names_len, name, len);
+    dir->names_len += len;
+
+    return true;
+}
+
+bool lv_fe_dir_reserve(lv_fe_dir_t * dir, uint32_t entries, uint32_t names)
+{
+    if(dir->count + entries > dir->entries_cap) {
+        void * p = fe_dir_grow(dir->entries, &dir->entries_cap, dir->count + entries, FE_DIR_MIN_ENTRIES, sizeof(lv_fe_entry_t));
+        if(p == NULL) return false;
+        dir->entries = (lv_fe_entry_t *)p;
+    }
+    if(dir->names_len + names > dir->names_cap) {
+        void * p = fe_dir_grow(dir->names, &dir->names_cap, dir->names_len + names, FE_DIR_MIN_NAMES, 1);
+        if(p == NULL) return false;
+        dir->names = (char *)p;
+    }
+
+    return true;
+}
+
+bool lv_fe_dir_append(lv_fe_dir_t * dir, const lv_fe_dir_t * src)
+{
+    if(!lv_fe_dir_reserve(dir, src->count, src->names_len)) return false;
+
+    lv_fe_entry_t * e = dir->entries + dir->count;
+    memcpy(e, src->entries, src->count * sizeof(lv_fe_entry_t));
+    for(uint32_t i = 0; i < src->count; i++) {
+        e[i].name += dir->names_len;
+    }
+    memcpy(dir->names + dir->names_len, src->names, src->names_len);
+    dir->count += src->count;
+    dir->names_len += src->names_len;
+
+    return true;
+}
+
+esp_err_t lv_fe_dir_scan(lv_fe_dir_t * dir, const char * path)
+{
+    return lv_fe_dir_scan_each(dir, path, NULL, NULL);
+}
+
+esp_err_t lv_fe_dir_scan_each(lv_fe_dir_t * dir, const char * path, lv_fe_dir_entry_cb_t cb, void * user_data)
+{
+    char fatfs_path[LV_FILE_EXPLORER_PATH_MAX_LEN];
+
+    if(lv_fe_dir_fatfs_path(path, fatfs_path, sizeof(fatfs_path))) {
+        return fe_dir_scan_fatfs(dir, fatfs_path, cb, user_data);
+    }
+
+    return fe_dir_scan_vfs(dir, path, cb, user_data);
+}
+
+bool lv_fe_dir_fatfs_path(const char * path, char * out, size_t size)
+{
+    size_t mount_len = strlen(MOUNT_POINT);
+
+    if(strncmp(path, MOUNT_POINT, mount_len) != 0 || (path[mount_len] != '\0' && path[mount_len] != '/')) {
+        return false;
+    }
+    snprintf(out, size, FATFS_DRIVE "%s", path[mount_len] ? path + mount_len : "/");
+
+    return true;
+}
+
+lv_fe_kind_t lv_fe_kind_of(const char * fn)
+{
+    return lv_fe_type_kind(lv_fe_type_from_name(fn));
+}
+
+const char * lv_fe_kind_symbol(lv_fe_kind_t kind)
+{
+    switch(kind) {
+        case LV_FE_KIND_DIR:
+            return LV_SYMBOL_DIRECTORY;
+        case LV_FE_KIND_IMAGE:
+            return LV_SYMBOL_IMAGE;
+        case LV_FE_KIND_AUDIO:
+            return LV_SYMBOL_AUDIO;
+        case LV_FE_KIND_VIDEO:
+            return LV_SYMBOL_VIDEO;
+        default:
+            return LV_SYMBOL_FILE;
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+/*Double the capacity, in PSRAM when there is some*/
+static void * fe_dir_grow(void * ptr, uint32_t * cap, uint32_t need, uint32_t min, size_t item_size)
+{
+    uint32_t new_cap = *cap ? *cap : min;
+    while(new_cap < need) new_cap *= 2;
+
+    void * p = mem_tel_realloc_prefer(MEM_TEL_EXPLORER, ptr, new_cap * item_size, MALLOC_CAP_SPIRAM,
+                                     MALLOC_CAP_DEFAULT);
+    if(p == NULL) {
+        ESP_LOGE(DIR_TAG, "No memory for %u entries", (unsigned)need);
+        return NULL;
+    }
+    *cap = new_cap;
+
+    return p;
+}
+
+/*f_readdir returns size and date with the name, stat() would search the directory again per file*/
+static esp_err_t fe_dir_scan_fatfs(lv_fe_dir_t * dir, const char * fatfs_path, lv_fe_dir_entry_cb_t cb,
+                                   void * user_data)
+{
+    FF_DIR ff_dir;
+    FILINFO fno;
+
+    if(f_opendir(&ff_dir, fatfs_path) != FR_OK) {
+        ESP_LOGE(DIR_TAG, "Open dir %s failed", fatfs_path);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t res = ESP_OK;
+    while(f_readdir(&ff_dir, &fno) == FR_OK && fno.fname[0] != '\0') {
+        /*Hidden: the index cache, System Volume Information*/
+        if(fno.fattrib & AM_HID) continue;
+
+        bool is_dir = (fno.fattrib & AM_DIR) != 0;
+        lv_fe_kind_t kind = is_dir ? LV_FE_KIND_DIR : lv_fe_kind_of(fno.fname);
+        uint32_t mtime = ((uint32_t)fno.fdate << 16) | fno.ftime;
+        if(!lv_fe_dir_add(dir, fno.fname, kind, is_dir ? 0 : (uint32_t)fno.fsize, mtime)) {
+            res = ESP_ERR_NO_MEM;
+            break;
+        }
+        if(cb && !cb(dir, user_data)) break;
+    }
+    f_closedir(&ff_dir);
+
+    return res;
+}
+
+static esp_err_t fe_dir_scan_vfs(lv_fe_dir_t * dir, const char * path, lv_fe_dir_entry_cb_t cb, void * user_data)
+{
+    char fn[LV_FILE_EXPLORER_PATH_MAX_LEN];
+    struct dirent * dp;
+    struct stat st;
+
+    DIR * d = opendir(path);
+    if(d == NULL) {
+        ESP_LOGE(DIR_TAG, "Open dir %s failed", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t res = ESP_OK;
+    while((dp = readdir(d)) != NULL) {
+        if(strcmp(dp->d_name, ".") == 0 || strcmp(dp->d_name, "..") == 0) continue;
+
+        bool is_dir = (dp->d_type == DT_DIR);
+        uint32_t size = 0;
+        if(!is_dir) {
+            snprintf(fn, sizeof(fn), "%s/%s", path, dp->d_name);
+            if(stat(fn, &st) == 0) size = (uint32_t)st.st_size;
+        }
+        lv_fe_kind_t kind = is_dir ? LV_FE_KIND_DIR : lv_fe_kind_of(dp->d_name);
+        if(!lv_fe_dir_add(dir, dp->d_name, kind, size, 0)) {
+            res = ESP_ERR_NO_MEM;
+            break;
+        }
+        if(cb && !cb(dir, user_data)) break;
+    }
+    closedir(d);
+
+    return res;
+}
@@ -0,0 +1,99 @@
+#include "include/lv_fe_gesture.h"
+#include "include/lv_file_explorer.h"
+#include "include/lv_text_pager.h"
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void fe_gesture_timer_cb(lv_timer_t * t);
+static bool fe_gesture_page(lv_obj_t * target, uint8_t dir);
+static bool fe_gesture_inside(const lv_obj_t * obj, const lv_obj_t * parent);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+void lv_fe_gesture_init(lv_fe_gesture_t * gesture, lv_obj_t * explorer, QueueHandle_t queue)
+{
+    lv_memzero(gesture, sizeof(lv_fe_gesture_t));
+    gesture->explorer = explorer;
+    gesture->queue = queue;
+    /*A gesture takes more than a refresh period, so none waits longer than one*/
+    if(queue) gesture->timer = lv_timer_create(fe_gesture_timer_cb, LV_DEF_REFR_PERIOD, gesture);
+}
+
+bool lv_fe_gesture_dispatch(lv_fe_gesture_t * gesture, const esp_lcd_touch_gesture_event_t * event)
+{
+    lv_point_t point = {event->x, event->y};
+    lv_obj_t * target = lv_indev_search_obj(lv_screen_active(), &point);
+    bool done = false;
+
+    if(target) {
+        switch(event->type) {
+            case ESP_LCD_TOUCH_GESTURE_SWIPE:
+                done = fe_gesture_page(target, event->dir);
+                if(done) gesture->pages++;
+                break;
+            case ESP_LCD_TOUCH_GESTURE_TWO_FINGER_SWIPE:
+                if(event->dir == ESP_LCD_TOUCH_GESTURE_DIR_RIGHT && gesture->explorer &&
+                   fe_gesture_inside(target, gesture->explorer)) {
+                    done = lv_file_explorer_open_parent(gesture->explorer);
+                    if(done) gesture->parents++;
+                }
+                break;
+            default:
+                /*Taps and long presses came through the pointer already*/
+                break;
+        }
+    }
+    if(!done) gesture->ignored++;
+
+    return done;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+static void fe_gesture_timer_cb(lv_timer_t * t)
+{
+    lv_fe_gesture_t * gesture = (lv_fe_gesture_t *)lv_timer_get_user_data(t);
+    esp_lcd_touch_gesture_event_t event;
+
+    while(xQueueReceive(gesture->queue, &event, 0) == pdTRUE) {
+        lv_fe_gesture_dispatch(gesture, &event);
+    }
+}
+
+/*The text pager under the swipe, else the first object above it that scrolls vertically*/
+static bool fe_gesture_page(lv_obj_t * target, uint8_t dir)
+{
+    /*The content moves with the finger: a swipe to the left or up shows what comes next*/
+    bool next = (dir == ESP_LCD_TOUCH_GESTURE_DIR_LEFT || dir == ESP_LCD_TOUCH_GESTURE_DIR_UP);
+    bool vertical = (dir == ESP_LCD_TOUCH_GESTURE_DIR_UP || dir == ESP_LCD_TOUCH_GESTURE_DIR_DOWN);
+
+    if(dir == ESP_LCD_TOUCH_GESTURE_DIR_NONE) return false;
+
+    for(lv_obj_t * obj = target; obj; obj = lv_obj_get_parent(obj)) {
+        if(lv_obj_check_type(obj, &lv_text_pager_class)) {
+            uint32_t key = next ? LV_KEY_RIGHT : LV_KEY_LEFT;
+            lv_obj_send_event(obj, LV_EVENT_KEY, &key);
+            return true;
+        }
+        if(vertical && lv_obj_has_flag(obj, LV_OBJ_FLAG_SCROLLABLE) &&
+           (next ? lv_obj_get_scroll_bottom(obj) : lv_obj_get_scroll_top(obj)) > 0) {
+            int32_t page = lv_obj_get_content_height(obj);
+            lv_obj_scroll_by_bounded(obj, 0, next ? -page : page, LV_ANIM_OFF);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool fe_gesture_inside(const lv_obj_t * obj, const lv_obj_t * parent)
+{
+    for(; obj; obj = lv_obj_get_parent(obj)) {
+        if(obj == parent) return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,207 @@
+#include "include/lv_fe_io.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "mem_telemetry.h"
+#if !CONFIG_IDF_TARGET_LINUX
+    #include "esp_memory_utils.h"
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+/*FatFs reads the part of a sector before and after the whole ones into the sector buffer of
+ *the file, only whole sectors go to the buffer of the caller*/
+#define FE_IO_SECTOR        512
+/*Smallest bounce buffer still worth it when a larger one does not fit, and the static one*/
+#define FE_IO_BOUNCE_MIN    (4 * FE_IO_SECTOR)
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static uint8_t * fe_io_bounce_get(size_t want, size_t * size, bool * kept);
+static void fe_io_bounce_put(uint8_t * bounce, bool kept);
+static uint8_t * fe_io_bounce_alloc(size_t want, size_t * size);
+static SemaphoreHandle_t fe_io_bounce_lock_get(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+/*Static, so it is in internal RAM, and word aligned for the SD host DMA*/
+static uint8_t fe_io_bounce_static[FE_IO_BOUNCE_MIN] __attribute__((aligned(LV_FE_IO_ALIGN)));
+/*The bounce buffer, used by one read at a time: the static one or that of the throughput mode*/
+static uint8_t * fe_io_bounce = fe_io_bounce_static;
+static size_t fe_io_bounce_size = FE_IO_BOUNCE_MIN;
+static SemaphoreHandle_t fe_io_bounce_lock;
+static StaticSemaphore_t fe_io_bounce_lock_buf;
+static portMUX_TYPE fe_io_bounce_lock_init = portMUX_INITIALIZER_UNLOCKED;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+void * lv_fe_io_alloc(size_t size)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    return malloc(size);
+#else
+    /*Heap blocks are word aligned*/
+    return mem_tel_malloc(MEM_TEL_FILE_BUF, size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+#endif
+}
+
+void lv_fe_io_free(void * buf)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    free(buf);
+#else
+    mem_tel_free(MEM_TEL_FILE_BUF, buf);
+#endif
+}
+
+bool lv_fe_io_is_direct(const void * buf)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    (void)buf;
+    return true;
+#else
+    return esp_ptr_dma_capable(buf) && ((uintptr_t)buf & (LV_FE_IO_ALIGN - 1)) == 0;
+#endif
+}
+
+esp_err_t lv_fe_io_set_throughput(bool enable)
+{
+    SemaphoreHandle_t lock = fe_io_bounce_lock_get();
+    bool ok = true;
+
+    /*Waits for the read that has the buffer*/
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if(enable && fe_io_bounce == fe_io_bounce_static) {
+        size_t size;
+        uint8_t * bounce = fe_io_bounce_alloc(LV_FE_IO_BOUNCE_SIZE, &size);
+        if(bounce && size > FE_IO_BOUNCE_MIN) {
+            fe_io_bounce = bounce;
+            fe_io_bounce_size = size;
+        }
+        else {
+            lv_fe_io_free(bounce);
+            ok = false;
+        }
+    }
+    else if(!enable && fe_io_bounce != fe_io_bounce_static) {
+        lv_fe_io_free(fe_io_bounce);
+        fe_io_bounce = fe_io_bounce_static;
+        fe_io_bounce_size = FE_IO_BOUNCE_MIN;
+    }
+    xSemaphoreGive(lock);
+
+    return ok ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+ssize_t lv_fe_io_read(int fd, void * buf, size_t len)
+{
+    uint8_t * dst = (uint8_t *)buf;
+    uint8_t * bounce = NULL;
+    size_t bounce_size = 0;
+    bool kept = false;
+    size_t done = 0;
+
+    /*Up to the next sector boundary of the file the bytes come from the sector buffer. After it
+     *the reads start on whole sectors, and stay on them as the bounce buffer holds whole ones.*/
+    off_t pos = lseek(fd, 0, SEEK_CUR);
+    size_t head = pos > 0 && pos % FE_IO_SECTOR ? FE_IO_SECTOR - pos % FE_IO_SECTOR : 0;
+
+    while(done < len) {
+        size_t want = len - done;
+        ssize_t n;
+
+        if(head) {
+            n = read(fd, dst + done, head < want ? head : want);
+            head = 0;
+        }
+        else if(want < FE_IO_SECTOR || lv_fe_io_is_direct(dst + done)) {
+            n = read(fd, dst + done, want);
+        }
+        else {
+            if(bounce == NULL) bounce = fe_io_bounce_get(want, &bounce_size, &kept);
+            if(bounce) {
+                n = read(fd, bounce, want < bounce_size ? want : bounce_size);
+                if(n > 0) memcpy(dst + done, bounce, (size_t)n);
+            }
+            else {
+                /*Slow, but still right*/
+                n = read(fd, dst + done, want);
+            }
+        }
+
+        if(n < 0) {
+            fe_io_bounce_put(bounce, kept);
+            return -1;
+        }
+        if(n == 0) break;
+        done += (size_t)n;
+    }
+
+    fe_io_bounce_put(bounce, kept);
+    return (ssize_t)done;
+}
+
+FILE * lv_fe_io_fopen(const char * path, const char * mode)
+{
+    FILE * f = fopen(path, mode);
+
+    /*Allocated by stdio on the first access and freed by fclose()*/
+    if(f) setvbuf(f, NULL, _IOFBF, LV_FE_IO_STDIO_BUF);
+
+    return f;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+/*The kept buffer when no other read has it. Only reads at the same time allocate their own.*/
+static uint8_t * fe_io_bounce_get(size_t want, size_t * size, bool * kept)
+{
+    if(xSemaphoreTake(fe_io_bounce_lock_get(), 0) == pdTRUE) {
+        *size = fe_io_bounce_size;
+        *kept = true;
+        return fe_io_bounce;
+    }
+
+    return fe_io_bounce_alloc(want, size);
+}
+
+static void fe_io_bounce_put(uint8_t * bounce, bool kept)
+{
+    if(kept) xSemaphoreGive(fe_io_bounce_lock);
+    else lv_fe_io_free(bounce);
+}
+
+/*The largest buffer up to LV_FE_IO_BOUNCE_SIZE that fits, for at most want bytes*/
+static uint8_t * fe_io_bounce_alloc(size_t want, size_t * size)
+{
+    size_t try_size = LV_FE_IO_BOUNCE_SIZE;
+
+    while(try_size / 2 >= want && try_size > FE_IO_BOUNCE_MIN) try_size /= 2;
+    for(; try_size >= FE_IO_BOUNCE_MIN; try_size /= 2) {
+        uint8_t * bounce = (uint8_t *)lv_fe_io_alloc(try_size);
+        if(bounce) {
+            *size = try_size;
+            return bounce;
+        }
+    }
+
+    return NULL;
+}
+
+static SemaphoreHandle_t fe_io_bounce_lock_get(void)
+{
+    taskENTER_CRITICAL(&fe_io_bounce_lock_init);
+    if(fe_io_bounce_lock == NULL) fe_io_bounce_lock = xSemaphoreCreateMutexStatic(&fe_io_bounce_lock_buf);
+    taskEXIT_CRITICAL(&fe_io_bounce_lock_init);
+
+    return fe_io_bounce_lock;
+}
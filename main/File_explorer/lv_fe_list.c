@@ -0,0 +1,285 @@
+#include "include/lv_fe_list.h"
+#include "mem_telemetry.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define MY_LIST_CLASS (&lv_fe_list_class)
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void lv_fe_list_constructor(const lv_obj_class_t * class_p, lv_obj_t * obj);
+static void lv_fe_list_destructor(const lv_obj_class_t * class_p, lv_obj_t * obj);
+static void lv_fe_list_event(const lv_obj_class_t * class_p, lv_event_t * e);
+static void row_event_handler(lv_event_t * e);
+static void update_row_height(lv_obj_t * obj);
+static void ensure_pool(lv_obj_t * obj);
+static void bind_rows(lv_obj_t * obj, bool rebind);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+const lv_obj_class_t lv_fe_list_class = {
+    .base_class     = &lv_obj_class,
+    .constructor_cb = lv_fe_list_constructor,
+    .destructor_cb  = lv_fe_list_destructor,
+    .event_cb       = lv_fe_list_event,
+    .name = "fe-list",
+    .width_def      = LV_PCT(100),
+    .height_def     = LV_PCT(100),
+    .instance_size  = sizeof(lv_fe_list_t)
+};
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+lv_obj_t * lv_fe_list_create(lv_obj_t * parent)
+{
+    LV_LOG_INFO("begin");
+    lv_obj_t * obj = lv_obj_class_create_obj(MY_LIST_CLASS, parent);
+    lv_obj_class_init_obj(obj);
+    return obj;
+}
+
+void lv_fe_list_set_bind_cb(lv_obj_t * obj, lv_fe_list_bind_cb_t cb, void * user_data)
+{
+    LV_ASSERT_OBJ(obj, MY_LIST_CLASS);
+
+    lv_fe_list_t * list = (lv_fe_list_t *)obj;
+
+    list->bind_cb = cb;
+    list->bind_user_data = user_data;
+}
+
+void lv_fe_list_set_count(lv_obj_t * obj, uint32_t count)
+{
+    LV_ASSERT_OBJ(obj, MY_LIST_CLASS);
+
+    lv_fe_list_t * list = (lv_fe_list_t *)obj;
+
+    list->count = count;
+    list->selected = LV_FE_LIST_NONE;
+    lv_obj_refresh_self_size(obj);
+    lv_obj_scroll_to_y(obj, 0, LV_ANIM_OFF);
+    bind_rows(obj, true);
+}
+
+void lv_fe_list_extend(lv_obj_t * obj, uint32_t count)
+{
+    LV_ASSERT_OBJ(obj, MY_LIST_CLASS);
+
+    lv_fe_list_t * list = (lv_fe_list_t *)obj;
+
+    list->count = count;
+    lv_obj_refresh_self_size(obj);
+    bind_rows(obj, false);
+}
+
+void lv_fe_list_refresh(lv_obj_t * obj)
+{
+    LV_ASSERT_OBJ(obj, MY_LIST_CLASS);
+
+    bind_rows(obj, true);
+}
+
+void lv_fe_list_refresh_entry(lv_obj_t * obj, uint32_t index)
+{
+    LV_ASSERT_OBJ(obj, MY_LIST_CLASS);
+
+    lv_fe_list_t * list = (lv_fe_list_t *)obj;
+
+    if(list->pool_size == 0 || list->bind_cb == NULL) return;
+
+    uint32_t slot = index % list->pool_size;
+    if(list->row_index[slot] != index) return;
+
+    mem_tel_scope_begin(MEM_TEL_EXPLORER);
+    list->bind_cb(list->rows[slot], index, list->bind_user_data);
+    mem_tel_scope_end();
+}
+
+uint32_t lv_fe_list_get_count(const lv_obj_t * obj)
+{
+    LV_ASSERT_OBJ(obj, MY_LIST_CLASS);
+
+    return ((lv_fe_list_t *)obj)->count;
+}
+
+uint32_t lv_fe_list_get_selected(const lv_obj_t * obj)
+{
+    LV_ASSERT_OBJ(obj, MY_LIST_CLASS);
+
+    return ((lv_fe_list_t *)obj)->selected;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+static void lv_fe_list_constructor(const lv_obj_class_t * class_p, lv_obj_t * obj)
+{
+    LV_UNUSED(class_p);
+    LV_TRACE_OBJ_CREATE("begin");
+
+    lv_fe_list_t * list = (lv_fe_list_t *)obj;
+
+    list->selected = LV_FE_LIST_NONE;
+    lv_obj_set_scroll_dir(obj, LV_DIR_TOP | LV_DIR_BOTTOM);
+    update_row_height(obj);
+
+    LV_TRACE_OBJ_CREATE("finished");
+}
+
+static void lv_fe_list_destructor(const lv_obj_class_t * class_p, lv_obj_t * obj)
+{
+    LV_UNUSED(class_p);
+
+    lv_fe_list_t * list = (lv_fe_list_t *)obj;
+
+    /*The rows are children and deleted with the list*/
+    lv_free(list->rows);
+    lv_free(list->row_index);
+    list->rows = NULL;
+    list->row_index = NULL;
+    list->pool_size = 0;
+}
+
+static void lv_fe_list_event(const lv_obj_class_t * class_p, lv_event_t * e)
+{
+    LV_UNUSED(class_p);
+
+    lv_result_t res = lv_obj_event_base(MY_LIST_CLASS, e);
+    if(res != LV_RESULT_OK) return;
+
+    lv_event_code_t code = lv_event_get_code(e);
+    lv_obj_t * obj = (lv_obj_t *)lv_event_get_current_target(e);
+    lv_fe_list_t * list = (lv_fe_list_t *)obj;
+
+    if(code == LV_EVENT_SCROLL) {
+        bind_rows(obj, false);
+    }
+    else if(code == LV_EVENT_SIZE_CHANGED) {
+        ensure_pool(obj);
+        bind_rows(obj, false);
+    }
+    else if(code == LV_EVENT_STYLE_CHANGED) {
+        update_row_height(obj);
+        lv_obj_refresh_self_size(obj);
+        bind_rows(obj, true);
+    }
+    else if(code == LV_EVENT_GET_SELF_SIZE) {
+        /*The scrollable height comes from here, not from the few row objects*/
+        lv_point_t * p = (lv_point_t *)lv_event_get_param(e);
+        int32_t h = (int32_t)list->count * list->row_h;
+        p->y = LV_MAX(p->y, h);
+    }
+}
+
+static void row_event_handler(lv_event_t * e)
+{
+    lv_obj_t * obj = (lv_obj_t *)lv_event_get_user_data(e);
+    lv_obj_t * row = (lv_obj_t *)lv_event_get_current_target(e);
+    lv_fe_list_t * list = (lv_fe_list_t *)obj;
+
+    for(uint32_t i = 0; i < list->pool_size; i++) {
+        if(list->rows[i] == row) {
+            list->selected = list->row_index[i];
+            break;
+        }
+    }
+    if(list->selected != LV_FE_LIST_NONE) {
+        lv_obj_send_event(obj, LV_EVENT_VALUE_CHANGED, NULL);
+    }
+}
+
+static void update_row_height(lv_obj_t * obj)
+{
+    lv_fe_list_t * list = (lv_fe_list_t *)obj;
+    const lv_font_t * font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+
+    list->row_h = lv_font_get_line_height(font) + 2 * LV_FE_LIST_ROW_PAD;
+    for(uint32_t i = 0; i < list->pool_size; i++) {
+        lv_obj_set_height(list->rows[i], list->row_h);
+    }
+}
+
+/*Enough rows to cover the view plus the margin on both sides*/
+static void ensure_pool(lv_obj_t * obj)
+{
+    lv_fe_list_t * list = (lv_fe_list_t *)obj;
+
+    uint32_t need = lv_obj_get_content_height(obj) / list->row_h + 2 + 2 * LV_FE_LIST_MARGIN;
+    if(need <= list->pool_size) return;
+
+    /*The rows and their styles count for the explorer, not for LVGL*/
+    mem_tel_scope_begin(MEM_TEL_EXPLORER);
+    lv_obj_t ** rows = (lv_obj_t **)lv_realloc(list->rows, need * sizeof(lv_obj_t *));
+    uint32_t * row_index = (uint32_t *)lv_realloc(list->row_index, need * sizeof(uint32_t));
+    if(rows) list->rows = rows;
+    if(row_index) list->row_index = row_index;
+    LV_ASSERT_MALLOC(rows);
+    LV_ASSERT_MALLOC(row_index);
+    if(rows == NULL || row_index == NULL) {
+        mem_tel_scope_end();
+        return;
+    }
+
+    for(uint32_t i = list->pool_size; i < need; i++) {
+        lv_obj_t * row = lv_label_create(obj);
+        lv_label_set_long_mode(row, LV_LABEL_LONG_CLIP);
+        lv_obj_set_size(row, LV_PCT(100), list->row_h);
+        lv_obj_set_style_pad_all(row, LV_FE_LIST_ROW_PAD, 0);
+        lv_obj_set_style_border_side(row, LV_BORDER_SIDE_BOTTOM, 0);
+        lv_obj_set_style_border_width(row, 1, 0);
+        lv_obj_set_style_border_color(row, lv_color_hex(0xe0e0e0), 0);
+        lv_obj_set_style_bg_color(row, lv_color_hex(0xc0c0c0), LV_STATE_PRESSED);
+        lv_obj_set_style_bg_opa(row, LV_OPA_COVER, LV_STATE_PRESSED);
+        lv_obj_add_flag(row, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_HIDDEN);
+        lv_obj_remove_flag(row, LV_OBJ_FLAG_SCROLL_ON_FOCUS);
+        lv_obj_add_event_cb(row, row_event_handler, LV_EVENT_CLICKED, obj);
+        list->rows[i] = row;
+    }
+    list->pool_size = need;
+    mem_tel_scope_end();
+
+    /*Entries map to rows by index modulo pool size, that changed. A row without an entry is
+     *hidden, else bind_rows() would leave it showing its old entry if no index maps to it*/
+    for(uint32_t i = 0; i < list->pool_size; i++) {
+        list->row_index[i] = LV_FE_LIST_NONE;
+        lv_obj_add_flag(list->rows[i], LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+/*Entry i is always shown by row i % pool_size, so scrolling one row rebinds one row*/
+static void bind_rows(lv_obj_t * obj, bool rebind)
+{
+    lv_fe_list_t * list = (lv_fe_list_t *)obj;
+
+    if(list->pool_size == 0 || list->bind_cb == NULL) return;
+
+    int32_t first = lv_obj_get_scroll_y(obj) / list->row_h - LV_FE_LIST_MARGIN;
+    if(first < 0) first = 0;
+
+    mem_tel_scope_begin(MEM_TEL_EXPLORER);
+
+    for(uint32_t i = 0; i < list->pool_size; i++) {
+        uint32_t index = (uint32_t)first + i;
+        uint32_t slot = index % list->pool_size;
+        lv_obj_t * row = list->rows[slot];
+
+        if(index >= list->count) {
+            if(list->row_index[slot] != LV_FE_LIST_NONE) {
+                list->row_index[slot] = LV_FE_LIST_NONE;
+                lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+            }
+            continue;
+        }
+        if(!rebind && list->row_index[slot] == index) continue;
+
+        list->row_index[slot] = index;
+        lv_obj_set_y(row, (int32_t)index * list->row_h);
+        lv_obj_remove_flag(row, LV_OBJ_FLAG_HIDDEN);
+        list->bind_cb(row, index, list->bind_user_data);
+    }
+    mem_tel_scope_end();
+}
@@ -0,0 +1,201 @@
+#include "include/lv_fe_reader.h"
+#include "include/lv_fe_io.h"
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "mem_telemetry.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define FE_READER_TASK_STACK    3072
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+struct _lv_fe_reader_t {
+    int fd;
+    size_t block_size;
+    uint8_t * buf[LV_FE_READER_BUFS];
+    size_t len[LV_FE_READER_BUFS];  /*Bytes read into each block*/
+    uint32_t head;          /*Blocks read, the next one goes to buf[head % LV_FE_READER_BUFS]*/
+    uint32_t tail;          /*Blocks borrowed*/
+    uint32_t borrowed;      /*Not released yet*/
+    bool ended;             /*The consumer got the last block*/
+    esp_err_t error;
+    SemaphoreHandle_t free_blocks;  /*Counts blocks the storage task can read into*/
+    SemaphoreHandle_t full_blocks;  /*Counts blocks read and not borrowed yet*/
+    SemaphoreHandle_t done;
+    TaskHandle_t task;
+    volatile bool cancel;
+    lv_fe_reader_stats_t stats;
+};
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static bool fe_reader_fill(lv_fe_reader_t * r);
+static void fe_reader_task(void * arg);
+static void fe_reader_free(lv_fe_reader_t * r);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * READER_TAG = "Explorer reader";
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+esp_err_t lv_fe_reader_open(const char * path, size_t offset, size_t block_size, lv_fe_reader_t ** reader)
+{
+    *reader = NULL;
+
+    lv_fe_reader_t * r = (lv_fe_reader_t *)calloc(1, sizeof(lv_fe_reader_t));
+    if(r == NULL) return ESP_ERR_NO_MEM;
+    r->block_size = block_size ? block_size : LV_FE_READER_BLOCK_SIZE;
+
+    r->fd = open(path, O_RDONLY);
+    if(r->fd < 0) {
+        ESP_LOGE(READER_TAG, "Failed to open %s", path);
+        free(r);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if(offset && lseek(r->fd, offset, SEEK_SET) != (off_t)offset) r->error = ESP_FAIL;
+
+    for(uint32_t i = 0; i < LV_FE_READER_BUFS; i++) {
+        /*Without internal RAM to spare lv_fe_io_read() bounces the sectors*/
+        r->buf[i] = (uint8_t *)lv_fe_io_alloc(r->block_size);
+        if(r->buf[i] == NULL) {
+            r->buf[i] = (uint8_t *)mem_tel_malloc_prefer(MEM_TEL_FILE_BUF, r->block_size, MALLOC_CAP_SPIRAM,
+                                                          MALLOC_CAP_DEFAULT);
+        }
+        if(r->buf[i] == NULL) {
+            fe_reader_free(r);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    r->free_blocks = xSemaphoreCreateCounting(LV_FE_READER_BUFS, LV_FE_READER_BUFS);
+    r->full_blocks = xSemaphoreCreateCounting(LV_FE_READER_BUFS, 0);
+    r->done = xSemaphoreCreateBinary();
+    UBaseType_t prio = uxTaskPriorityGet(NULL) + 1;
+    if(prio > configMAX_PRIORITIES - 1) prio = configMAX_PRIORITIES - 1;
+    if(r->error != ESP_OK || r->free_blocks == NULL || r->full_blocks == NULL || r->done == NULL ||
+       xTaskCreate(fe_reader_task, "fe_reader", FE_READER_TASK_STACK, r, prio, &r->task) != pdPASS) {
+        /*Read on borrow*/
+        r->task = NULL;
+    }
+
+    *reader = r;
+    return ESP_OK;
+}
+
+esp_err_t lv_fe_reader_borrow(lv_fe_reader_t * reader, const uint8_t ** data, size_t * len)
+{
+    lv_fe_reader_t * r = reader;
+
+    *data = NULL;
+    *len = 0;
+    if(r->ended) return r->error;
+    if(r->borrowed == LV_FE_READER_BUFS) return ESP_ERR_INVALID_STATE;
+
+    if(r->task == NULL) {
+        if(r->error == ESP_OK) fe_reader_fill(r);
+        else r->len[r->head++ % LV_FE_READER_BUFS] = 0;
+    }
+    else if(xSemaphoreTake(r->full_blocks, 0) != pdTRUE) {
+        int64_t start = esp_timer_get_time();
+        xSemaphoreTake(r->full_blocks, portMAX_DELAY);
+        r->stats.stalls++;
+        r->stats.stall_us += (uint32_t)(esp_timer_get_time() - start);
+    }
+
+    uint32_t i = r->tail++ % LV_FE_READER_BUFS;
+    /*The storage task stops after a short block*/
+    if(r->len[i] < r->block_size) r->ended = true;
+    if(r->len[i] == 0) return r->error;
+
+    r->borrowed++;
+    r->stats.blocks++;
+    *data = r->buf[i];
+    *len = r->len[i];
+
+    return ESP_OK;
+}
+
+void lv_fe_reader_release(lv_fe_reader_t * reader)
+{
+    if(reader->borrowed == 0) return;
+
+    reader->borrowed--;
+    if(reader->task) xSemaphoreGive(reader->free_blocks);
+}
+
+void lv_fe_reader_close(lv_fe_reader_t * reader, lv_fe_reader_stats_t * stats)
+{
+    lv_fe_reader_t * r = reader;
+
+    if(r->task) {
+        /*Wakes it if it waits for a free block, else it sees the flag after the read*/
+        r->cancel = true;
+        xSemaphoreGive(r->free_blocks);
+        xSemaphoreTake(r->done, portMAX_DELAY);
+    }
+    if(stats) *stats = r->stats;
+    fe_reader_free(r);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+/*Read the next block, false if it was the last one*/
+static bool fe_reader_fill(lv_fe_reader_t * r)
+{
+    uint32_t i = r->head++ % LV_FE_READER_BUFS;
+    int64_t start = esp_timer_get_time();
+
+    ssize_t n = lv_fe_io_read(r->fd, r->buf[i], r->block_size);
+    r->stats.read_us += (uint32_t)(esp_timer_get_time() - start);
+    if(n < 0) {
+        ESP_LOGE(READER_TAG, "read failed at block %lu", (unsigned long)(r->head - 1));
+        r->error = ESP_FAIL;
+        n = 0;
+    }
+    r->len[i] = (size_t)n;
+
+    return (size_t)n == r->block_size;
+}
+
+static void fe_reader_task(void * arg)
+{
+    lv_fe_reader_t * r = (lv_fe_reader_t *)arg;
+    bool more = true;
+
+    while(more) {
+        xSemaphoreTake(r->free_blocks, portMAX_DELAY);
+        if(r->cancel) break;
+        more = fe_reader_fill(r);
+        xSemaphoreGive(r->full_blocks);
+    }
+
+    xSemaphoreGive(r->done);
+    vTaskDelete(NULL);
+}
+
+static void fe_reader_free(lv_fe_reader_t * r)
+{
+    close(r->fd);
+    for(uint32_t i = 0; i < LV_FE_READER_BUFS; i++) lv_fe_io_free(r->buf[i]);
+    if(r->free_blocks) vSemaphoreDelete(r->free_blocks);
+    if(r->full_blocks) vSemaphoreDelete(r->full_blocks);
+    if(r->done) vSemaphoreDelete(r->done);
+    free(r);
+}
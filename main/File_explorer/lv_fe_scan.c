@@ -0,0 +1,166 @@
+#include "include/lv_fe_scan.h"
+#include "include/lv_fe_cache.h"
+#include "include/lv_file_explorer.h"
+#include <stdio.h>
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "mem_telemetry.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define FE_SCAN_TASK_STACK  4096
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+struct _lv_fe_scan_t {
+    lv_fe_scan_config_t config;
+    char path[LV_FILE_EXPLORER_PATH_MAX_LEN];
+    lv_fe_dir_t batch;      /*Read, not handed over yet*/
+    lv_fe_dir_t all;        /*Everything handed over, written to the cache at the end*/
+    bool index;             /*false once 'all' ran out of memory*/
+    uint32_t next_batch;
+    int64_t start;
+    lv_fe_scan_stats_t stats;
+    volatile bool cancel;   /*Set by the GUI task, read under the GUI lock*/
+};
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void fe_scan_task(void * arg);
+static bool fe_scan_entry_cb(lv_fe_dir_t * batch, void * user_data);
+static bool fe_scan_hand_over(lv_fe_scan_t * s, bool last, esp_err_t res);
+static bool fe_scan_reset(lv_fe_scan_t * s);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * SCAN_TAG = "Explorer scan";
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+lv_fe_scan_t * lv_fe_scan_start(const char * path, const lv_fe_scan_config_t * config)
+{
+    lv_fe_scan_t * s = (lv_fe_scan_t *)mem_tel_calloc(MEM_TEL_EXPLORER, 1, sizeof(lv_fe_scan_t), MALLOC_CAP_DEFAULT);
+    if(s == NULL) return NULL;
+
+    s->config = *config;
+    snprintf(s->path, sizeof(s->path), "%s", path);
+    lv_fe_dir_init(&s->batch);
+    lv_fe_dir_init(&s->all);
+    s->index = true;
+    s->next_batch = config->first_batch ? config->first_batch : LV_FE_SCAN_FIRST_BATCH;
+    s->start = esp_timer_get_time();
+
+    if(xTaskCreate(fe_scan_task, "fe_scan", FE_SCAN_TASK_STACK, s, tskIDLE_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(SCAN_TAG, "Can not start the scan task");
+        mem_tel_free(MEM_TEL_EXPLORER, s);
+        return NULL;
+    }
+
+    return s;
+}
+
+void lv_fe_scan_cancel(lv_fe_scan_t * scan)
+{
+    scan->cancel = true;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+static void fe_scan_task(void * arg)
+{
+    lv_fe_scan_t * s = (lv_fe_scan_t *)arg;
+    bool complete = true;
+    bool read = true;
+    uint32_t stamp;
+
+    /*Looked up here rather than by the GUI task, which does not wait for the card. An index
+     *is shown at once and checked afterwards, the directory is read only when it changed.*/
+    if(lv_fe_cache_lookup(&s->batch, s->path, &s->stats.src, &stamp) == ESP_OK) {
+        s->index = false;
+        complete = fe_scan_hand_over(s, true, ESP_OK);
+        read = complete && lv_fe_cache_check(s->path, stamp) != ESP_OK;
+        s->stats.final = true;
+        if(complete) complete = read ? fe_scan_reset(s) : fe_scan_hand_over(s, true, ESP_OK);
+    }
+    else {
+        s->stats.final = true;
+    }
+
+    if(complete && read) {
+        esp_err_t res = lv_fe_dir_scan_each(&s->batch, s->path, fe_scan_entry_cb, s);
+        complete = fe_scan_hand_over(s, true, res);
+
+        /*After done_cb, the UI does not wait for the card write*/
+        if(complete && res == ESP_OK && s->index) lv_fe_cache_save(s->path, &s->all, 0);
+    }
+    if(!complete) ESP_LOGI(SCAN_TAG, "%s cancelled after %u entries", s->path, (unsigned)s->stats.count);
+
+    lv_fe_dir_free(&s->batch);
+    lv_fe_dir_free(&s->all);
+    mem_tel_free(MEM_TEL_EXPLORER, s);
+    vTaskDelete(NULL);
+}
+
+static bool fe_scan_entry_cb(lv_fe_dir_t * batch, void * user_data)
+{
+    lv_fe_scan_t * s = (lv_fe_scan_t *)user_data;
+
+    if(s->cancel) return false;
+    if(batch->count < s->next_batch) return true;
+
+    s->next_batch = LV_FE_SCAN_BATCH;
+    return fe_scan_hand_over(s, false, ESP_OK);
+}
+
+/*Give the batch to the GUI task, false if the scan was cancelled*/
+static bool fe_scan_hand_over(lv_fe_scan_t * s, bool last, esp_err_t res)
+{
+    if(s->index && !lv_fe_dir_append(&s->all, &s->batch)) {
+        s->index = false;
+        lv_fe_dir_free(&s->all);
+    }
+    s->stats.count += s->batch.count;
+
+    xSemaphoreTake(s->config.gui_lock, portMAX_DELAY);
+    bool go = !s->cancel;
+    if(go) {
+        if(s->batch.count && s->config.batch_cb) s->config.batch_cb(&s->batch, s->config.user_data);
+
+        uint32_t us = (uint32_t)(esp_timer_get_time() - s->start);
+        if(s->stats.first_us == 0) s->stats.first_us = us;
+        if(last) {
+            s->stats.total_us = us;
+            if(s->config.done_cb) s->config.done_cb(res, &s->stats, s->config.user_data);
+        }
+    }
+    xSemaphoreGive(s->config.gui_lock);
+
+    lv_fe_dir_clear(&s->batch);
+
+    return go;
+}
+
+/*The index handed over was out of date, the GUI drops it before the directory is read.
+ *False if the scan was cancelled.*/
+static bool fe_scan_reset(lv_fe_scan_t * s)
+{
+    s->index = true;
+    s->next_batch = s->config.first_batch ? s->config.first_batch : LV_FE_SCAN_FIRST_BATCH;
+    s->stats.count = 0;
+    s->stats.src = LV_FE_CACHE_SRC_SCAN;
+
+    xSemaphoreTake(s->config.gui_lock, portMAX_DELAY);
+    bool go = !s->cancel;
+    if(go && s->config.reset_cb) s->config.reset_cb(s->config.user_data);
+    xSemaphoreGive(s->config.gui_lock);
+
+    return go;
+}
@@ -0,0 +1,169 @@
+#include "include/lv_fe_sort.h"
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "mem_telemetry.h"
+#include "esp_log.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Runs sorted by insertion before merging*/
+#define FE_SORT_RUN 16
+#define FE_SORT_MIN(a, b) ((a) < (b) ? (a) : (b))
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    const char * names;
+    lv_fe_sort_key_t key;
+} fe_sort_ctx_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static int fe_sort_cmp(const fe_sort_ctx_t * ctx, const lv_fe_entry_t * a, const lv_fe_entry_t * b);
+static void fe_sort_insertion(const fe_sort_ctx_t * ctx, lv_fe_entry_t * e, uint32_t n);
+static void fe_sort_merge(const fe_sort_ctx_t * ctx, const lv_fe_entry_t * src, lv_fe_entry_t * dst,
+                          uint32_t lo, uint32_t mid, uint32_t hi);
+static inline bool fe_is_digit(char c);
+static inline char fe_lower(char c);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * SORT_TAG = "Explorer sort";
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+void lv_fe_sort(lv_fe_dir_t * dir, uint32_t first, lv_fe_sort_key_t key)
+{
+    if(dir->count <= first + 1) return;
+
+    fe_sort_ctx_t ctx = {
+        .names = dir->names,
+        .key = key,
+    };
+    lv_fe_entry_t * e = dir->entries + first;
+    uint32_t n = dir->count - first;
+
+    for(uint32_t lo = 0; lo < n; lo += FE_SORT_RUN) {
+        fe_sort_insertion(&ctx, e + lo, FE_SORT_MIN(FE_SORT_RUN, n - lo));
+    }
+    if(n <= FE_SORT_RUN) return;
+
+    lv_fe_entry_t * tmp = (lv_fe_entry_t *)mem_tel_malloc_prefer(MEM_TEL_EXPLORER, n * sizeof(lv_fe_entry_t),
+                                                                 MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT);
+    if(tmp == NULL) {
+        /*Still sorted and stable, only slow*/
+        ESP_LOGW(SORT_TAG, "No memory to merge %u entries", (unsigned)n);
+        fe_sort_insertion(&ctx, e, n);
+        return;
+    }
+
+    /*Bottom up, each pass merges pairs of runs into the other array*/
+    lv_fe_entry_t * src = e;
+    lv_fe_entry_t * dst = tmp;
+    for(uint32_t width = FE_SORT_RUN; width < n; width *= 2) {
+        for(uint32_t lo = 0; lo < n; lo += 2 * width) {
+            uint32_t mid = FE_SORT_MIN(lo + width, n);
+            uint32_t hi = FE_SORT_MIN(lo + 2 * width, n);
+            fe_sort_merge(&ctx, src, dst, lo, mid, hi);
+        }
+        lv_fe_entry_t * t = src;
+        src = dst;
+        dst = t;
+    }
+    if(src != e) memcpy(e, src, n * sizeof(lv_fe_entry_t));
+
+    mem_tel_free(MEM_TEL_EXPLORER, tmp);
+}
+
+int lv_fe_natural_cmp(const char * a, const char * b)
+{
+    while(*a && *b) {
+        if(fe_is_digit(*a) && fe_is_digit(*b)) {
+            while(*a == '0') a++;
+            while(*b == '0') b++;
+            const char * a_end = a;
+            const char * b_end = b;
+            while(fe_is_digit(*a_end)) a_end++;
+            while(fe_is_digit(*b_end)) b_end++;
+
+            /*Without leading zeros the longer number is the bigger one*/
+            if(a_end - a != b_end - b) return (int)((a_end - a) - (b_end - b));
+            int d = memcmp(a, b, a_end - a);
+            if(d) return d;
+            a = a_end;
+            b = b_end;
+            continue;
+        }
+
+        char ca = fe_lower(*a);
+        char cb = fe_lower(*b);
+        if(ca != cb) return (uint8_t)ca - (uint8_t)cb;
+        a++;
+        b++;
+    }
+
+    return (uint8_t)*a - (uint8_t)*b;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+static int fe_sort_cmp(const fe_sort_ctx_t * ctx, const lv_fe_entry_t * a, const lv_fe_entry_t * b)
+{
+    if(ctx->key == LV_FE_SORT_KIND) {
+        if(a->kind != b->kind) return (int)a->kind - (int)b->kind;
+    }
+    else {
+        bool a_dir = a->kind == LV_FE_KIND_DIR;
+        bool b_dir = b->kind == LV_FE_KIND_DIR;
+        if(a_dir != b_dir) return a_dir ? -1 : 1;
+        if(ctx->key == LV_FE_SORT_SIZE && a->size != b->size) return a->size < b->size ? -1 : 1;
+        if(ctx->key == LV_FE_SORT_DATE && a->mtime != b->mtime) return a->mtime < b->mtime ? -1 : 1;
+    }
+
+    return lv_fe_natural_cmp(ctx->names + a->name, ctx->names + b->name);
+}
+
+static void fe_sort_insertion(const fe_sort_ctx_t * ctx, lv_fe_entry_t * e, uint32_t n)
+{
+    for(uint32_t i = 1; i < n; i++) {
+        lv_fe_entry_t v = e[i];
+        uint32_t j = i;
+        while(j > 0 && fe_sort_cmp(ctx, &e[j - 1], &v) > 0) {
+            e[j] = e[j - 1];
+            j--;
+        }
+        e[j] = v;
+    }
+}
+
+/*Equal entries are taken from the left run first, that keeps the sort stable*/
+static void fe_sort_merge(const fe_sort_ctx_t * ctx, const lv_fe_entry_t * src, lv_fe_entry_t * dst,
+                          uint32_t lo, uint32_t mid, uint32_t hi)
+{
+    uint32_t i = lo;
+    uint32_t j = mid;
+    uint32_t k = lo;
+
+    while(i < mid && j < hi) {
+        if(fe_sort_cmp(ctx, &src[j], &src[i]) < 0) dst[k++] = src[j++];
+        else dst[k++] = src[i++];
+    }
+    while(i < mid) dst[k++] = src[i++];
+    while(j < hi) dst[k++] = src[j++];
+}
+
+static inline bool fe_is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static inline char fe_lower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
@@ -0,0 +1,254 @@
+#include "include/lv_fe_tabs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void fe_tabs_show(lv_fe_tabs_t * tabs, uint32_t index);
+static void fe_tabs_load(lv_fe_tabs_t * tabs, lv_fe_doc_t * doc);
+static void fe_tabs_unload(lv_fe_tabs_t * tabs, lv_fe_doc_t * doc);
+static void fe_tabs_fit(lv_fe_tabs_t * tabs, const lv_fe_doc_t * keep);
+static uint32_t fe_tabs_lru(const lv_fe_tabs_t * tabs, bool loaded_only, const lv_fe_doc_t * keep);
+static void fe_tabs_changed(lv_fe_tabs_t * tabs);
+static size_t fe_tabs_lv_used(void);
+static const char * fe_tabs_name(const char * path);
+static void fe_tabs_event_cb(lv_event_t * e);
+static void fe_tabs_button_event_cb(lv_event_t * e);
+static void fe_tabs_close_async_cb(void * user_data);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * TABS_TAG = "Explorer tabs";
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+void lv_fe_tabs_init(lv_fe_tabs_t * tabs, lv_obj_t * tabview, const lv_fe_tabs_config_t * config)
+{
+    memset(tabs, 0, sizeof(lv_fe_tabs_t));
+    tabs->tabview = tabview;
+    tabs->fixed = lv_tabview_get_tab_count(tabview);
+    tabs->config = *config;
+    tabs->config.max_tabs = LV_CLAMP(1, tabs->config.max_tabs, LV_FE_TABS_MAX);
+
+    /*Sent when a tab button is clicked or the content is swiped to another tab*/
+    lv_obj_add_event_cb(tabview, fe_tabs_event_cb, LV_EVENT_VALUE_CHANGED, tabs);
+}
+
+esp_err_t lv_fe_tabs_open(lv_fe_tabs_t * tabs, const char * path, lv_fe_type_t type)
+{
+    for(uint32_t i = 0; i < tabs->count; i++) {
+        if(strcmp(tabs->docs[i].path, path) == 0) {
+            lv_tabview_set_active(tabs->tabview, tabs->fixed + i, LV_ANIM_OFF);
+            fe_tabs_show(tabs, i);
+            return ESP_OK;
+        }
+    }
+
+    char * copy = (char *)malloc(strlen(path) + 1);
+    if(copy == NULL) return ESP_ERR_NO_MEM;
+    strcpy(copy, path);
+
+    if(tabs->count == tabs->config.max_tabs) {
+        uint32_t lru = fe_tabs_lru(tabs, false, NULL);
+        ESP_LOGI(TABS_TAG, "%u tabs open, closing %s", (unsigned)tabs->count, tabs->docs[lru].path);
+        lv_fe_tabs_close(tabs, lru);
+    }
+
+    lv_fe_doc_t * doc = &tabs->docs[tabs->count];
+    memset(doc, 0, sizeof(lv_fe_doc_t));
+    doc->path = copy;
+    doc->type = type;
+    doc->tab = lv_tabview_add_tab(tabs->tabview, fe_tabs_name(path));
+    doc->button = lv_obj_get_child(lv_tabview_get_tab_bar(tabs->tabview), -1);
+    lv_obj_add_event_cb(doc->button, fe_tabs_button_event_cb, LV_EVENT_LONG_PRESSED, tabs);
+    tabs->count++;
+
+    lv_tabview_set_active(tabs->tabview, tabs->fixed + tabs->count - 1, LV_ANIM_OFF);
+    fe_tabs_show(tabs, tabs->count - 1);
+
+    return ESP_OK;
+}
+
+void lv_fe_tabs_close(lv_fe_tabs_t * tabs, uint32_t index)
+{
+    if(index >= tabs->count) return;
+
+    lv_fe_doc_t * doc = &tabs->docs[index];
+    uint32_t tab = tabs->fixed + index;
+    uint32_t active = lv_tabview_get_tab_active(tabs->tabview);
+
+    /*The content goes with the page, its delete events free what it holds*/
+    lv_obj_delete(doc->tab);
+    lv_obj_delete(doc->button);
+    free(doc->path);
+    memmove(doc, doc + 1, (tabs->count - index - 1) * sizeof(lv_fe_doc_t));
+    tabs->count--;
+    tabs->closes++;
+
+    if(active == tab) {
+        /*Show the tab before it, that can be a document to load again*/
+        lv_tabview_set_active(tabs->tabview, tab - 1, LV_ANIM_OFF);
+        if(tab - 1 >= tabs->fixed) fe_tabs_show(tabs, tab - 1 - tabs->fixed);
+    }
+    else if(active > tab) {
+        lv_tabview_set_active(tabs->tabview, active - 1, LV_ANIM_OFF);
+    }
+    fe_tabs_changed(tabs);
+}
+
+size_t lv_fe_tabs_get_used(const lv_fe_tabs_t * tabs)
+{
+    size_t used = 0;
+
+    for(uint32_t i = 0; i < tabs->count; i++) {
+        if(tabs->docs[i].loaded) used += tabs->docs[i].heap_bytes + tabs->docs[i].lv_bytes;
+    }
+
+    return used;
+}
+
+void lv_fe_tabs_format(const lv_fe_tabs_t * tabs, char * buf, size_t size)
+{
+    int len = snprintf(buf, size, "Tabs %u of %u, %u of %u KB\nloaded %lu, unloaded %lu, closed %lu",
+                       (unsigned)tabs->count, (unsigned)tabs->config.max_tabs,
+                       (unsigned)(lv_fe_tabs_get_used(tabs) / 1024), (unsigned)(tabs->config.budget_bytes / 1024),
+                       (unsigned long)tabs->loads, (unsigned long)tabs->unloads, (unsigned long)tabs->closes);
+
+    for(uint32_t i = 0; i < tabs->count && len >= 0 && (size_t)len < size; i++) {
+        const lv_fe_doc_t * doc = &tabs->docs[i];
+        if(doc->loaded) {
+            len += snprintf(buf + len, size - len, "\n%s: %u KB + %u KB LVGL", fe_tabs_name(doc->path),
+                            (unsigned)(doc->heap_bytes / 1024), (unsigned)(doc->lv_bytes / 1024));
+        }
+        else {
+            len += snprintf(buf + len, size - len, "\n%s: unloaded", fe_tabs_name(doc->path));
+        }
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+/*The document is on screen: load it if it was unloaded, then make room*/
+static void fe_tabs_show(lv_fe_tabs_t * tabs, uint32_t index)
+{
+    lv_fe_doc_t * doc = &tabs->docs[index];
+
+    doc->used = ++tabs->clock;
+    if(!doc->loaded) fe_tabs_load(tabs, doc);
+    fe_tabs_fit(tabs, doc);
+    fe_tabs_changed(tabs);
+}
+
+static void fe_tabs_load(lv_fe_tabs_t * tabs, lv_fe_doc_t * doc)
+{
+    /*The content is sized to the page*/
+    lv_obj_update_layout(tabs->tabview);
+
+    size_t lv_used = fe_tabs_lv_used();
+    doc->heap_bytes = tabs->config.load_cb(doc->tab, doc, tabs->config.user_data);
+    size_t lv_after = fe_tabs_lv_used();
+    doc->lv_bytes = lv_after > lv_used ? lv_after - lv_used : 0;
+    doc->loaded = true;
+    tabs->loads++;
+}
+
+static void fe_tabs_unload(lv_fe_tabs_t * tabs, lv_fe_doc_t * doc)
+{
+    if(tabs->config.unload_cb) tabs->config.unload_cb(doc->tab, doc, tabs->config.user_data);
+    lv_obj_clean(doc->tab);
+    doc->loaded = false;
+    doc->heap_bytes = 0;
+    doc->lv_bytes = 0;
+    tabs->unloads++;
+}
+
+/*Unload the least recently shown documents until the rest fits the budget. The one on
+ *screen stays, even if it is bigger than the budget alone.*/
+static void fe_tabs_fit(lv_fe_tabs_t * tabs, const lv_fe_doc_t * keep)
+{
+    while(lv_fe_tabs_get_used(tabs) > tabs->config.budget_bytes) {
+        uint32_t lru = fe_tabs_lru(tabs, true, keep);
+        if(lru == LV_FE_TABS_NONE) break;
+
+        ESP_LOGI(TABS_TAG, "Over %u KB, unloading %s", (unsigned)(tabs->config.budget_bytes / 1024),
+                 tabs->docs[lru].path);
+        fe_tabs_unload(tabs, &tabs->docs[lru]);
+    }
+}
+
+static uint32_t fe_tabs_lru(const lv_fe_tabs_t * tabs, bool loaded_only, const lv_fe_doc_t * keep)
+{
+    uint32_t lru = LV_FE_TABS_NONE;
+
+    for(uint32_t i = 0; i < tabs->count; i++) {
+        const lv_fe_doc_t * doc = &tabs->docs[i];
+        if(doc == keep || (loaded_only && !doc->loaded)) continue;
+        if(lru == LV_FE_TABS_NONE || doc->used < tabs->docs[lru].used) lru = i;
+    }
+
+    return lru;
+}
+
+static void fe_tabs_changed(lv_fe_tabs_t * tabs)
+{
+    if(tabs->config.changed_cb) tabs->config.changed_cb(tabs->config.user_data);
+}
+
+static size_t fe_tabs_lv_used(void)
+{
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+
+    return mon.total_size - mon.free_size;
+}
+
+static const char * fe_tabs_name(const char * path)
+{
+    const char * name = strrchr(path, '/');
+
+    return name ? name + 1 : path;
+}
+
+static void fe_tabs_event_cb(lv_event_t * e)
+{
+    lv_fe_tabs_t * tabs = (lv_fe_tabs_t *)lv_event_get_user_data(e);
+
+    /*Bubbled up from a tab page*/
+    if(lv_event_get_target(e) != tabs->tabview) return;
+
+    uint32_t active = lv_tabview_get_tab_active(tabs->tabview);
+    if(active >= tabs->fixed && active < tabs->fixed + tabs->count) fe_tabs_show(tabs, active - tabs->fixed);
+}
+
+static void fe_tabs_button_event_cb(lv_event_t * e)
+{
+    lv_fe_tabs_t * tabs = (lv_fe_tabs_t *)lv_event_get_user_data(e);
+    lv_obj_t * button = (lv_obj_t *)lv_event_get_current_target(e);
+
+    /*The press closes the tab, its release must not click the button and show the tab*/
+    lv_indev_t * indev = lv_indev_active();
+    if(indev) lv_indev_wait_release(indev);
+
+    /*Not from inside the event of the button itself*/
+    if(tabs->closing == NULL) lv_async_call(fe_tabs_close_async_cb, tabs);
+    tabs->closing = button;
+}
+
+static void fe_tabs_close_async_cb(void * user_data)
+{
+    lv_fe_tabs_t * tabs = (lv_fe_tabs_t *)user_data;
+
+    for(uint32_t i = 0; i < tabs->count; i++) {
+        if(tabs->docs[i].button == tabs->closing) {
+            lv_fe_tabs_close(tabs, i);
+            break;
+        }
+    }
+    tabs->closing = NULL;
+}
@@ -0,0 +1,519 @@
+#include "include/lv_fe_thumb.h"
+#include "include/lv_fe_type.h"
+#include "include/lv_jpeg_loader.h"
+#include "include/lv_fe_io.h"
+#include "include/lv_file_explorer.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "mem_telemetry.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "ff.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define FE_THUMB_MAGIC          0x42485446  /*"FTHB"*/
+#define FE_THUMB_VERSION        1
+#define FE_THUMB_BYTES          (LV_FE_THUMB_SIZE * LV_FE_THUMB_SIZE / 2)
+#define FE_THUMB_PALETTE_BYTES  (16 * sizeof(lv_color32_t))
+/*Records of changed files are not removed, the file is started over when it gets this long*/
+#define FE_THUMB_FILE_MAX       4096
+#define FE_THUMB_PATH_MAX       (LV_FILE_EXPLORER_PATH_MAX_LEN + sizeof(LV_FE_THUMB_FILE))
+/*The ROM JPEG decoder runs on it*/
+#define FE_THUMB_TASK_STACK     6144
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint32_t name_hash;     /*FNV-1a of the file name*/
+    uint32_t size;
+    uint32_t mtime;
+} fe_thumb_key_t;
+
+/*Sidecar file: this header, then fixed size records*/
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;          /*LV_FE_THUMB_SIZE it was made with*/
+} fe_thumb_file_header_t;
+
+typedef struct {
+    fe_thumb_key_t key;
+    uint8_t w;              /*0 if the file could not be decoded*/
+    uint8_t h;
+    uint16_t reserved;
+    uint8_t data[FE_THUMB_BYTES];   /*4 bpp, rows of (w + 1) / 2 bytes, left pixel in the high nibble*/
+} fe_thumb_record_t;
+
+typedef struct {
+    uint32_t used;          /*LRU clock, 0 for a free slot*/
+    uint32_t dir_hash;
+    fe_thumb_key_t key;
+    lv_image_dsc_t dsc;     /*w is 0 if there is no thumbnail*/
+    uint8_t data[FE_THUMB_PALETTE_BYTES + FE_THUMB_BYTES];  /*Gray palette, then the pixels*/
+} fe_thumb_slot_t;
+
+typedef struct {
+    uint32_t gen;
+    uint32_t dir_hash;
+    uint32_t index;
+    fe_thumb_key_t key;
+    char name[LV_FILE_EXPLORER_PATH_MAX_LEN];
+} fe_thumb_req_t;
+
+typedef struct {
+    SemaphoreHandle_t gui_lock;
+    TaskHandle_t task;
+
+    /*GUI side, under gui_lock*/
+    char dir[LV_FILE_EXPLORER_PATH_MAX_LEN];
+    uint32_t dir_hash;
+    uint32_t gen;           /*Changed by every lv_fe_thumb_set_dir()*/
+    lv_fe_thumb_ready_cb_t cb;
+    void * user_data;
+    fe_thumb_req_t queue[LV_FE_THUMB_QUEUE];    /*Oldest first*/
+    uint32_t queued;
+    fe_thumb_slot_t slots[LV_FE_THUMB_RAM_SLOTS];
+    uint32_t clock;
+
+    /*Worker side*/
+    char work_dir[LV_FILE_EXPLORER_PATH_MAX_LEN];
+    uint32_t work_gen;
+    fe_thumb_key_t * keys;  /*Of the records in the sidecar file of work_dir*/
+    uint32_t key_count;
+    uint32_t key_cap;
+    bool file_valid;        /*The sidecar file exists with a valid header*/
+    FILE * file;
+    fe_thumb_req_t req;
+    fe_thumb_record_t rec;
+
+    lv_fe_thumb_stats_t stats;
+} fe_thumb_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void fe_thumb_task(void * arg);
+static bool fe_thumb_pop(fe_thumb_t * t);
+static void fe_thumb_push(fe_thumb_t * t, uint32_t index, const fe_thumb_key_t * key, const char * name);
+static fe_thumb_slot_t * fe_thumb_find(fe_thumb_t * t, uint32_t dir_hash, const fe_thumb_key_t * key);
+static void fe_thumb_store(fe_thumb_t * t, uint32_t dir_hash, const fe_thumb_record_t * rec);
+static void fe_thumb_make(const char * path, fe_thumb_record_t * rec);
+static void fe_thumb_file_load(fe_thumb_t * t);
+static bool fe_thumb_file_open(fe_thumb_t * t, bool create);
+static void fe_thumb_file_close(fe_thumb_t * t);
+static bool fe_thumb_file_read(fe_thumb_t * t, const fe_thumb_key_t * key, fe_thumb_record_t * rec);
+static void fe_thumb_file_append(fe_thumb_t * t, const fe_thumb_record_t * rec);
+static uint32_t fe_thumb_hash(const char * str);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * THUMB_TAG = "Explorer thumb";
+static fe_thumb_t * fe_thumb;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+esp_err_t lv_fe_thumb_start(SemaphoreHandle_t gui_lock)
+{
+    if(fe_thumb) return ESP_OK;
+
+    fe_thumb_t * t = (fe_thumb_t *)mem_tel_calloc_prefer(MEM_TEL_IMAGE, 1, sizeof(fe_thumb_t), MALLOC_CAP_SPIRAM,
+                                                          MALLOC_CAP_DEFAULT);
+    if(t == NULL) return ESP_ERR_NO_MEM;
+
+    t->gui_lock = gui_lock;
+    for(uint32_t i = 0; i < LV_FE_THUMB_RAM_SLOTS; i++) {
+        lv_color32_t * palette = (lv_color32_t *)t->slots[i].data;
+        for(uint32_t c = 0; c < 16; c++) {
+            palette[c].red = palette[c].green = palette[c].blue = (uint8_t)(c * 17);
+            palette[c].alpha = 0xFF;
+        }
+    }
+
+    if(xTaskCreate(fe_thumb_task, "fe_thumb", FE_THUMB_TASK_STACK, t, tskIDLE_PRIORITY, &t->task) != pdPASS) {
+        ESP_LOGE(THUMB_TAG, "Can not start the thumbnail task");
+        mem_tel_free(MEM_TEL_IMAGE, t);
+        return ESP_ERR_NO_MEM;
+    }
+    fe_thumb = t;
+
+    return ESP_OK;
+}
+
+void lv_fe_thumb_set_dir(const char * path, lv_fe_thumb_ready_cb_t cb, void * user_data)
+{
+    fe_thumb_t * t = fe_thumb;
+    if(t == NULL) return;
+
+    t->gen++;
+    t->queued = 0;
+    t->cb = path ? cb : NULL;
+    t->user_data = user_data;
+    snprintf(t->dir, sizeof(t->dir), "%s", path ? path : "");
+    t->dir_hash = fe_thumb_hash(t->dir);
+}
+
+const lv_image_dsc_t * lv_fe_thumb_get(const lv_fe_dir_t * dir, uint32_t index)
+{
+    fe_thumb_t * t = fe_thumb;
+    if(t == NULL || t->cb == NULL) return NULL;
+
+    const char * name = lv_fe_dir_name(dir, index);
+    if(lv_fe_type_from_name(name) != LV_FE_TYPE_JPEG) return NULL;
+
+    const lv_fe_entry_t * e = &dir->entries[index];
+    fe_thumb_key_t key;
+    key.name_hash = fe_thumb_hash(name);
+    key.size = e->size;
+    key.mtime = e->mtime;
+
+    fe_thumb_slot_t * slot = fe_thumb_find(t, t->dir_hash, &key);
+    if(slot) {
+        slot->used = ++t->clock;
+        t->stats.ram_hits++;
+        return slot->dsc.header.w ? &slot->dsc : NULL;
+    }
+
+    fe_thumb_push(t, index, &key, name);
+
+    return NULL;
+}
+
+void lv_fe_thumb_clear(void)
+{
+    fe_thumb_t * t = fe_thumb;
+    if(t == NULL) return;
+
+    for(uint32_t i = 0; i < LV_FE_THUMB_RAM_SLOTS; i++) {
+        if(t->slots[i].used && t->slots[i].dsc.header.w) lv_image_cache_drop(&t->slots[i].dsc);
+        t->slots[i].used = 0;
+    }
+}
+
+void lv_fe_thumb_get_stats(lv_fe_thumb_stats_t * stats)
+{
+    if(fe_thumb) *stats = fe_thumb->stats;
+    else memset(stats, 0, sizeof(lv_fe_thumb_stats_t));
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+static void fe_thumb_task(void * arg)
+{
+    fe_thumb_t * t = (fe_thumb_t *)arg;
+    char path[FE_THUMB_PATH_MAX];
+
+    while(1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while(fe_thumb_pop(t)) {
+            fe_thumb_req_t * req = &t->req;
+            fe_thumb_record_t * rec = &t->rec;
+
+            if(fe_thumb_file_read(t, &req->key, rec)) {
+                t->stats.file_hits++;
+            }
+            else {
+                snprintf(path, sizeof(path), "%s%s", t->work_dir, req->name);
+                int64_t start = esp_timer_get_time();
+                fe_thumb_make(path, rec);
+                rec->key = req->key;
+                t->stats.make_us += (uint32_t)(esp_timer_get_time() - start);
+                if(rec->w) t->stats.made++;
+                else t->stats.failed++;
+                fe_thumb_file_append(t, rec);
+            }
+
+            xSemaphoreTake(t->gui_lock, portMAX_DELAY);
+            if(req->gen == t->gen) {
+                fe_thumb_store(t, req->dir_hash, rec);
+                if(rec->w && t->cb) t->cb(req->index, t->user_data);
+            }
+            xSemaphoreGive(t->gui_lock);
+        }
+
+        /*Idle: the appended records are on the card once it is closed*/
+        fe_thumb_file_close(t);
+    }
+}
+
+/*Take the newest request, the rows that came into view last. false if there is none.*/
+static bool fe_thumb_pop(fe_thumb_t * t)
+{
+    bool dir_changed = false;
+
+    xSemaphoreTake(t->gui_lock, portMAX_DELAY);
+    bool have = t->queued > 0;
+    if(have) {
+        t->req = t->queue[--t->queued];
+        if(t->work_gen != t->gen) {
+            t->work_gen = t->gen;
+            if(strcmp(t->work_dir, t->dir) != 0) {
+                snprintf(t->work_dir, sizeof(t->work_dir), "%s", t->dir);
+                dir_changed = true;
+            }
+        }
+    }
+    xSemaphoreGive(t->gui_lock);
+
+    if(dir_changed) {
+        fe_thumb_file_close(t);
+        fe_thumb_file_load(t);
+    }
+
+    return have;
+}
+
+static void fe_thumb_push(fe_thumb_t * t, uint32_t index, const fe_thumb_key_t * key, const char * name)
+{
+    /*Asked again: it moves to the newest*/
+    for(uint32_t i = 0; i < t->queued; i++) {
+        if(memcmp(&t->queue[i].key, key, sizeof(fe_thumb_key_t)) == 0) {
+            memmove(&t->queue[i], &t->queue[i + 1], (t->queued - i - 1) * sizeof(fe_thumb_req_t));
+            t->queued--;
+            break;
+        }
+    }
+    /*Full: the oldest has likely scrolled out of view*/
+    if(t->queued == LV_FE_THUMB_QUEUE) {
+        memmove(&t->queue[0], &t->queue[1], (LV_FE_THUMB_QUEUE - 1) * sizeof(fe_thumb_req_t));
+        t->queued--;
+    }
+
+    fe_thumb_req_t * req = &t->queue[t->queued++];
+    req->gen = t->gen;
+    req->dir_hash = t->dir_hash;
+    req->index = index;
+    req->key = *key;
+    snprintf(req->name, sizeof(req->name), "%s", name);
+
+    xTaskNotifyGive(t->task);
+}
+
+static fe_thumb_slot_t * fe_thumb_find(fe_thumb_t * t, uint32_t dir_hash, const fe_thumb_key_t * key)
+{
+    for(uint32_t i = 0; i < LV_FE_THUMB_RAM_SLOTS; i++) {
+        fe_thumb_slot_t * slot = &t->slots[i];
+        if(slot->used && slot->dir_hash == dir_hash && memcmp(&slot->key, key, sizeof(fe_thumb_key_t)) == 0) {
+            return slot;
+        }
+    }
+
+    return NULL;
+}
+
+/*Into the least recently used slot. Called with gui_lock held, the slot may be drawn from.*/
+static void fe_thumb_store(fe_thumb_t * t, uint32_t dir_hash, const fe_thumb_record_t * rec)
+{
+    fe_thumb_slot_t * slot = fe_thumb_find(t, dir_hash, &rec->key);
+
+    if(slot == NULL) {
+        slot = &t->slots[0];
+        for(uint32_t i = 1; i < LV_FE_THUMB_RAM_SLOTS; i++) {
+            if(t->slots[i].used < slot->used) slot = &t->slots[i];
+        }
+    }
+    /*LVGL may have a decoded copy of the old one*/
+    if(slot->used && slot->dsc.header.w) lv_image_cache_drop(&slot->dsc);
+
+    uint32_t stride = (rec->w + 1) / 2;
+    memcpy(slot->data + FE_THUMB_PALETTE_BYTES, rec->data, stride * rec->h);
+    slot->dsc.header.magic = LV_IMAGE_HEADER_MAGIC;
+    slot->dsc.header.cf = LV_COLOR_FORMAT_I4;
+    slot->dsc.header.w = rec->w;
+    slot->dsc.header.h = rec->h;
+    slot->dsc.header.stride = stride;
+    slot->dsc.data = slot->data;
+    slot->dsc.data_size = FE_THUMB_PALETTE_BYTES + stride * rec->h;
+    slot->dir_hash = dir_hash;
+    slot->key = rec->key;
+    slot->used = ++t->clock;
+}
+
+/*Decode to fit LV_FE_THUMB_SIZE in 8 bit gray and keep the upper 4 bits*/
+static void fe_thumb_make(const char * path, fe_thumb_record_t * rec)
+{
+    lv_image_dsc_t img;
+
+    rec->w = 0;
+    rec->h = 0;
+    rec->reserved = 0;
+    memset(rec->data, 0, sizeof(rec->data));
+    if(lv_jpeg_load(path, LV_FE_THUMB_SIZE, LV_FE_THUMB_SIZE, LV_COLOR_FORMAT_L8, &img, NULL) != ESP_OK) return;
+
+    uint32_t w = img.header.w;
+    uint32_t h = img.header.h;
+    uint32_t stride = (w + 1) / 2;
+    for(uint32_t y = 0; y < h; y++) {
+        const uint8_t * s = img.data + y * w;
+        uint8_t * d = rec->data + y * stride;
+        for(uint32_t x = 0; x < w; x++) {
+            d[x / 2] |= (x & 1) ? (s[x] >> 4) : (s[x] & 0xF0);
+        }
+    }
+    rec->w = (uint8_t)w;
+    rec->h = (uint8_t)h;
+    lv_jpeg_free(&img);
+}
+
+/*Read the keys of the sidecar file of work_dir. A torn or foreign file is removed.*/
+static void fe_thumb_file_load(fe_thumb_t * t)
+{
+    char fn[FE_THUMB_PATH_MAX];
+    fe_thumb_file_header_t h;
+
+    t->key_count = 0;
+    t->file_valid = false;
+    if(t->work_dir[0] == '\0') return;
+
+    snprintf(fn, sizeof(fn), "%s" LV_FE_THUMB_FILE, t->work_dir);
+    /*The keys are read one record after the other*/
+    FILE * f = lv_fe_io_fopen(fn, "rb");
+    if(f == NULL) return;
+
+    bool valid = fread(&h, sizeof(h), 1, f) == 1 && h.magic == FE_THUMB_MAGIC && h.version == FE_THUMB_VERSION &&
+                 h.size == LV_FE_THUMB_SIZE;
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f) - (long)sizeof(h);
+    uint32_t count = len > 0 ? len / sizeof(fe_thumb_record_t) : 0;
+    valid = valid && len >= 0 && len % sizeof(fe_thumb_record_t) == 0 && count <= FE_THUMB_FILE_MAX;
+
+    if(valid && count > t->key_cap) {
+        fe_thumb_key_t * keys = (fe_thumb_key_t *)mem_tel_realloc_prefer(MEM_TEL_IMAGE, t->keys,
+                                                                          count * sizeof(fe_thumb_key_t),
+                                                                          MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT);
+        if(keys) {
+            t->keys = keys;
+            t->key_cap = count;
+        }
+        /*The keys index the records, without all of them the file is started over*/
+        valid = keys != NULL;
+    }
+
+    fseek(f, sizeof(h), SEEK_SET);
+    for(uint32_t i = 0; valid && i < count; i++) {
+        valid = fread(&t->keys[i], sizeof(fe_thumb_key_t), 1, f) == 1 &&
+                fseek(f, sizeof(fe_thumb_record_t) - sizeof(fe_thumb_key_t), SEEK_CUR) == 0;
+    }
+    fclose(f);
+
+    if(!valid) {
+        ESP_LOGI(THUMB_TAG, "%s is not valid, starting over", fn);
+        unlink(fn);
+        return;
+    }
+    t->key_count = count;
+    t->file_valid = true;
+}
+
+/*Open the sidecar file for reading and appending, create it (hidden) if asked to*/
+static bool fe_thumb_file_open(fe_thumb_t * t, bool create)
+{
+    char fn[FE_THUMB_PATH_MAX];
+    char fatfs_fn[FE_THUMB_PATH_MAX];
+
+    if(t->file) return true;
+    if(!t->file_valid && !create) return false;
+
+    snprintf(fn, sizeof(fn), "%s" LV_FE_THUMB_FILE, t->work_dir);
+    if(!t->file_valid) {
+        /*Only on the card: hidden there, lv_fe_dir_scan does not list it*/
+        if(!lv_fe_dir_fatfs_path(fn, fatfs_fn, sizeof(fatfs_fn))) return false;
+
+        fe_thumb_file_header_t h;
+        h.magic = FE_THUMB_MAGIC;
+        h.version = FE_THUMB_VERSION;
+        h.size = LV_FE_THUMB_SIZE;
+        FILE * f = fopen(fn, "wb");
+        if(f == NULL) return false;
+        bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+        ok = (fclose(f) == 0) && ok;
+        if(!ok) {
+            unlink(fn);
+            return false;
+        }
+        f_chmod(fatfs_fn, AM_HID, AM_HID);
+        t->key_count = 0;
+        t->file_valid = true;
+    }
+
+    t->file = fopen(fn, "a+b");
+
+    return t->file != NULL;
+}
+
+static void fe_thumb_file_close(fe_thumb_t * t)
+{
+    if(t->file == NULL) return;
+
+    fclose(t->file);
+    t->file = NULL;
+}
+
+static bool fe_thumb_file_read(fe_thumb_t * t, const fe_thumb_key_t * key, fe_thumb_record_t * rec)
+{
+    uint32_t i;
+
+    for(i = 0; i < t->key_count; i++) {
+        if(memcmp(&t->keys[i], key, sizeof(fe_thumb_key_t)) == 0) break;
+    }
+    if(i == t->key_count || !fe_thumb_file_open(t, false)) return false;
+
+    long pos = sizeof(fe_thumb_file_header_t) + (long)i * sizeof(fe_thumb_record_t);
+
+    return fseek(t->file, pos, SEEK_SET) == 0 && fread(rec, sizeof(fe_thumb_record_t), 1, t->file) == 1 &&
+           memcmp(&rec->key, key, sizeof(fe_thumb_key_t)) == 0 && rec->w <= LV_FE_THUMB_SIZE &&
+           rec->h <= LV_FE_THUMB_SIZE;
+}
+
+static void fe_thumb_file_append(fe_thumb_t * t, const fe_thumb_record_t * rec)
+{
+    if(t->key_count >= FE_THUMB_FILE_MAX) {
+        char fn[FE_THUMB_PATH_MAX];
+        fe_thumb_file_close(t);
+        snprintf(fn, sizeof(fn), "%s" LV_FE_THUMB_FILE, t->work_dir);
+        unlink(fn);
+        t->file_valid = false;
+        t->key_count = 0;
+    }
+    /*Record i of the file is key i, no record without its key*/
+    if(t->key_count == t->key_cap) {
+        uint32_t cap = t->key_cap ? t->key_cap * 2 : 64;
+        fe_thumb_key_t * keys = (fe_thumb_key_t *)mem_tel_realloc_prefer(MEM_TEL_IMAGE, t->keys, cap * sizeof(fe_thumb_key_t),
+                                                                          MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT);
+        if(keys == NULL) return;
+        t->keys = keys;
+        t->key_cap = cap;
+    }
+    if(!fe_thumb_file_open(t, true)) return;
+
+    /*A read may have moved the position, appending needs a seek in between*/
+    fseek(t->file, 0, SEEK_END);
+    if(fwrite(rec, sizeof(fe_thumb_record_t), 1, t->file) != 1) {
+        /*Maybe a part of it: no more appends to this file until it is loaded again*/
+        ESP_LOGW(THUMB_TAG, "Can not write the thumbnails of %s", t->work_dir);
+        fe_thumb_file_close(t);
+        t->file_valid = false;
+        t->key_count = 0;
+        return;
+    }
+    t->keys[t->key_count++] = rec->key;
+}
+
+static uint32_t fe_thumb_hash(const char * str)
+{
+    uint32_t hash = 2166136261u;
+    for(const char * p = str; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+
+    return hash;
+}
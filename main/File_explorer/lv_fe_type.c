@@ -0,0 +1,116 @@
+#include "include/lv_fe_type.h"
+#include <stdio.h>
+#include <string.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define FE_TYPE_SLOTS   16
+
+/*Perfect hash of a lower case extension: the known ones all land in different slots.
+ *Check the table with all of them when one is added, and change the factors on a clash.*/
+#define FE_TYPE_HASH(ext, len) \
+    ((5 * (uint8_t)(ext)[0] + 5 * (uint8_t)(ext)[1] + (uint8_t)(ext)[(len) - 1] + (len)) & (FE_TYPE_SLOTS - 1))
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    char ext[LV_FE_TYPE_EXT_MAX + 1];
+    uint8_t type;       /*lv_fe_type_t*/
+} fe_type_slot_t;
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+/*Indexed by FE_TYPE_HASH*/
+static const fe_type_slot_t fe_type_table[FE_TYPE_SLOTS] = {
+    /*0 */ {"png",  LV_FE_TYPE_PNG},
+    /*1 */ {"wav",  LV_FE_TYPE_WAV},
+    /*2 */ {"",     LV_FE_TYPE_UNKNOWN},
+    /*3 */ {"txt",  LV_FE_TYPE_TXT},
+    /*4 */ {"",     LV_FE_TYPE_UNKNOWN},
+    /*5 */ {"epi",  LV_FE_TYPE_EPI},
+    /*6 */ {"",     LV_FE_TYPE_UNKNOWN},
+    /*7 */ {"mp3",  LV_FE_TYPE_MP3},
+    /*8 */ {"mp4",  LV_FE_TYPE_MP4},
+    /*9 */ {"gif",  LV_FE_TYPE_GIF},
+    /*10*/ {"jpe",  LV_FE_TYPE_JPEG},
+    /*11*/ {"",     LV_FE_TYPE_UNKNOWN},
+    /*12*/ {"jpg",  LV_FE_TYPE_JPEG},
+    /*13*/ {"jpeg", LV_FE_TYPE_JPEG},
+    /*14*/ {"bmp",  LV_FE_TYPE_BMP},
+    /*15*/ {"",     LV_FE_TYPE_UNKNOWN},
+};
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+lv_fe_type_t lv_fe_type_from_name(const char * name)
+{
+    const char * dot = strrchr(name, '.');
+    if(dot == NULL) return LV_FE_TYPE_UNKNOWN;
+
+    char ext[LV_FE_TYPE_EXT_MAX + 1];
+    size_t len = 0;
+    for(const char * p = dot + 1; *p; p++) {
+        if(len == LV_FE_TYPE_EXT_MAX) return LV_FE_TYPE_UNKNOWN;
+        ext[len++] = (*p >= 'A' && *p <= 'Z') ? (char)(*p - 'A' + 'a') : *p;
+    }
+    if(len < 2) return LV_FE_TYPE_UNKNOWN;
+    ext[len] = '\0';
+
+    const fe_type_slot_t * slot = &fe_type_table[FE_TYPE_HASH(ext, len)];
+    if(memcmp(slot->ext, ext, len + 1) != 0) return LV_FE_TYPE_UNKNOWN;
+
+    return (lv_fe_type_t)slot->type;
+}
+
+lv_fe_type_t lv_fe_type_from_data(const uint8_t * d, size_t len)
+{
+    if(len >= 3 && d[0] == 0xFF && d[1] == 0xD8 && d[2] == 0xFF) return LV_FE_TYPE_JPEG;
+    if(len >= 8 && memcmp(d, "\x89PNG\r\n\x1a\n", 8) == 0) return LV_FE_TYPE_PNG;
+    if(len >= 6 && (memcmp(d, "GIF87a", 6) == 0 || memcmp(d, "GIF89a", 6) == 0)) return LV_FE_TYPE_GIF;
+    if(len >= 2 && d[0] == 'B' && d[1] == 'M') return LV_FE_TYPE_BMP;
+    if(len >= 4 && memcmp(d, "EPI", 3) == 0 && d[3] >= 1) return LV_FE_TYPE_EPI;
+    if(len >= 12 && memcmp(d, "RIFF", 4) == 0 && memcmp(d + 8, "WAVE", 4) == 0) return LV_FE_TYPE_WAV;
+    if(len >= 8 && memcmp(d + 4, "ftyp", 4) == 0) return LV_FE_TYPE_MP4;
+    /*ID3 tag, or a bare MPEG audio frame: 11 sync bits, then layer III*/
+    if(len >= 3 && memcmp(d, "ID3", 3) == 0) return LV_FE_TYPE_MP3;
+    if(len >= 2 && d[0] == 0xFF && (d[1] & 0xE6) == 0xE2) return LV_FE_TYPE_MP3;
+
+    return LV_FE_TYPE_UNKNOWN;
+}
+
+lv_fe_type_t lv_fe_type_from_file(const char * path)
+{
+    uint8_t magic[LV_FE_TYPE_MAGIC_LEN];
+
+    FILE * f = fopen(path, "rb");
+    if(f == NULL) return LV_FE_TYPE_UNKNOWN;
+    size_t len = fread(magic, 1, sizeof(magic), f);
+    fclose(f);
+
+    return lv_fe_type_from_data(magic, len);
+}
+
+lv_fe_kind_t lv_fe_type_kind(lv_fe_type_t type)
+{
+    switch(type) {
+        case LV_FE_TYPE_PNG:
+        case LV_FE_TYPE_JPEG:
+        case LV_FE_TYPE_BMP:
+        case LV_FE_TYPE_GIF:
+        case LV_FE_TYPE_EPI:
+            return LV_FE_KIND_IMAGE;
+        case LV_FE_TYPE_MP3:
+        case LV_FE_TYPE_WAV:
+            return LV_FE_KIND_AUDIO;
+        case LV_FE_TYPE_MP4:
+            return LV_FE_KIND_VIDEO;
+        case LV_FE_TYPE_TXT:
+            return LV_FE_KIND_TEXT;
+        default:
+            return LV_FE_KIND_OTHER;
+    }
+}
@@ -1,7 +1,17 @@
 #include "include/lv_file_explorer.h"
+#include "include/lv_text_loader.h"
+#include "include/lv_fe_list.h"
+#include "include/lv_fe_cache.h"
+#include "include/lv_fe_sort.h"
+#include "include/lv_fe_thumb.h"
+#include "include/lv_fe_io.h"
 #include "lvgl.h"
 #include "core/lv_global.h"
+#include "lv_tier_mem.h"
+#include "mem_telemetry.h"
 #include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 /*********************
  *      DEFINES
@@ -10,22 +20,28 @@
 
 #define FILE_EXPLORER_QUICK_ACCESS_AREA_WIDTH       (22)
 #define FILE_EXPLORER_BROWSER_AREA_WIDTH            (100 - FILE_EXPLORER_QUICK_ACCESS_AREA_WIDTH)
+/*Between a thumbnail and the name*/
+#define FILE_EXPLORER_THUMB_GAP                     6
 
 #define quick_access_list_button_style (LV_GLOBAL_DEFAULT()->fe_list_button_style)
 
 /**********************
  *      GLOBALS
  **********************/
-struct dirent *dp;
-DIR *dir;
 const bool format_if_mount_failed = false;
 static const char * TAG = "Explorer";
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 static void lv_file_explorer_constructor(const lv_obj_class_t * class_p, lv_obj_t * obj);
+static void lv_file_explorer_destructor(const lv_obj_class_t * class_p, lv_obj_t * obj);
 
 static void browser_file_event_handler(lv_event_t * e);
+static void file_list_bind_cb(lv_obj_t * row, uint32_t index, void * user_data);
+static void scan_batch_cb(const lv_fe_dir_t * batch, void * user_data);
+static void scan_reset_cb(void * user_data);
+static void scan_done_cb(esp_err_t res, const lv_fe_scan_stats_t * stats, void * user_data);
+static void thumb_ready_cb(uint32_t index, void * user_data);
 #if LV_FILE_EXPLORER_QUICK_ACCESS
     static void quick_access_event_handler(lv_event_t * e);
     static void quick_access_area_event_handler(lv_event_t * e);
@@ -35,17 +51,16 @@ static void init_style(lv_obj_t * obj);
 static void show_dir(lv_obj_t * obj, const char * path);
 static void strip_ext(char * dir);
 static void file_explorer_sort(lv_obj_t * obj);
-static void sort_by_file_kind(lv_obj_t * tb, int16_t lo, int16_t hi);
-static void exch_table_item(lv_obj_t * tb, int16_t i, int16_t j);
-static bool is_end_with(const char * str1, const char * str2);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+static const char * src_names[] = {"scan", "RAM", "card"};
 
 const lv_obj_class_t lv_file_explorer_class = {
     .base_class     = &lv_obj_class,
     .constructor_cb = lv_file_explorer_constructor,
+    .destructor_cb  = lv_file_explorer_destructor,
     .name = "file-explorer",
     .width_def      = LV_SIZE_CONTENT,
     .height_def     = LV_SIZE_CONTENT,
@@ -67,7 +82,7 @@ static void fs_init(void)
     // formatted in case when mounting fails.
     esp_vfs_fat_sdmmc_mount_config_t mount_config = {
         .format_if_mount_failed = format_if_mount_failed,
-        .max_files = 5,
+        .max_files = CONFIG_FE_SD_MAX_FILES,
         .allocation_unit_size = 16 * 1024
     };
     sdmmc_card_t *card;
@@ -75,17 +90,19 @@ static void fs_init(void)
     // Use settings defined above to initialize SD card and mount FAT filesystem.
     // Note: esp_vfs_fat_sdmmc/sdspi_mount is all-in-one convenience functions.
 
-    // By default, SD card frequency is initialized to SDMMC_FREQ_DEFAULT (20MHz)
-    // For setting a specific frequency, use host.max_freq_khz (range 400kHz - 40MHz for SDMMC)
-    // Example: for fixed frequency of 10MHz, use host.max_freq_khz = 10000;
+    // By default, SD card frequency is initialized to SDMMC_FREQ_DEFAULT (20MHz).
+    // The high speed mode of menuconfig, File explorer, doubles it to SDMMC_FREQ_HIGHSPEED.
     sdmmc_host_t host = SDMMC_HOST_DEFAULT();
+#if CONFIG_FE_SD_HIGH_SPEED
+    host.max_freq_khz = SDMMC_FREQ_HIGHSPEED;
+#endif
 
     // This initializes the slot without card detect (CD) and write protect (WP) signals.
     // Modify slot_config.gpio_cd and slot_config.gpio_wp if your board has these signals.
     sdmmc_slot_config_t slot_config = SDMMC_SLOT_CONFIG_DEFAULT();
 
     // Set bus width to use:
-#if CONFIG_EXAMPLE_SDMMC_BUS_WIDTH_4
+#if CONFIG_FE_SD_BUS_WIDTH_4
     slot_config.width = 4;
 #else
     slot_config.width = 1;
@@ -97,11 +114,11 @@ static void fs_init(void)
     slot_config.clk = CONFIG_SD_CLK;
     slot_config.cmd = CONFIG_SD_CMD;
     slot_config.d0 = CONFIG_SD_D0;
-#ifdef CONFIG_EXAMPLE_SDMMC_BUS_WIDTH_4
+#if CONFIG_FE_SD_BUS_WIDTH_4
     slot_config.d1 = CONFIG_SD_D1;
     slot_config.d2 = CONFIG_SD_D2;
     slot_config.d3 = CONFIG_SD_D3;
-#endif  // CONFIG_EXAMPLE_SDMMC_BUS_WIDTH_4
+#endif  // CONFIG_FE_SD_BUS_WIDTH_4
 #endif
 
     // Enable internal pullups on enabled pins. The internal pullups
@@ -111,6 +128,17 @@ static void fs_init(void)
 
     ret = esp_vfs_fat_sdmmc_mount(mount_point, &host, &slot_config, &mount_config, &card);
 
+    // A card or wiring that does not take the faster bus gets the safe one: 1 line, 20 MHz.
+    // ESP_FAIL is the filesystem, the card itself came up.
+    if (ret != ESP_OK && ret != ESP_FAIL &&
+        (slot_config.width != 1 || host.max_freq_khz != SDMMC_FREQ_DEFAULT)) {
+        ESP_LOGW(TAG, "SD card at %d bit %d kHz failed (%s), trying 1 bit %d kHz", slot_config.width,
+                 host.max_freq_khz, esp_err_to_name(ret), SDMMC_FREQ_DEFAULT);
+        slot_config.width = 1;
+        host.max_freq_khz = SDMMC_FREQ_DEFAULT;
+        ret = esp_vfs_fat_sdmmc_mount(mount_point, &host, &slot_config, &mount_config, &card);
+    }
+
     if (ret != ESP_OK) {
         if (ret == ESP_FAIL) {
             ESP_LOGE(TAG, "Failed to mount filesystem. "
@@ -121,7 +149,16 @@ static void fs_init(void)
         }
         return;
     }
-    ESP_LOGI(TAG, "Filesystem mounted in %s", MOUNT_POINT);
+    ESP_LOGI(TAG, "Filesystem mounted in %s, %d bit bus up to %d kHz", MOUNT_POINT, slot_config.width,
+             host.max_freq_khz);
+
+    // The faster bus is worth it only when the reads into PSRAM still move many sectors a command:
+    // keep their bounce buffer instead of allocating it on every read.
+    if (slot_config.width != 1 || host.max_freq_khz != SDMMC_FREQ_DEFAULT) {
+        if (lv_fe_io_set_throughput(true) != ESP_OK) {
+            ESP_LOGW(TAG, "No internal RAM to keep the read bounce buffer");
+        }
+    }
 
     // Card has been initialized, print its properties
     sdmmc_card_print_info(stdout, card);
@@ -195,6 +232,18 @@ void lv_file_explorer_set_sort(lv_obj_t * obj, lv_file_explorer_sort_t sort)
     explorer->sort = sort;
 
     file_explorer_sort(obj);
+    lv_fe_list_refresh(explorer->file_list);
+}
+
+void lv_file_explorer_set_gui_lock(lv_obj_t * obj, SemaphoreHandle_t gui_lock)
+{
+    LV_ASSERT_OBJ(obj, MY_CLASS);
+
+    lv_file_explorer_t * explorer = (lv_file_explorer_t *)obj;
+
+    explorer->gui_lock = gui_lock;
+    /*Thumbnails are made on a worker too*/
+    if(gui_lock && lv_fe_thumb_start(gui_lock) != ESP_OK) ESP_LOGW(TAG, "No thumbnails");
 }
 
 /*=====================
@@ -218,13 +267,13 @@ const char * lv_file_explorer_get_current_path(const lv_obj_t * obj)
     return explorer->current_path;
 }
 
-lv_obj_t * lv_file_explorer_get_file_table(lv_obj_t * obj)
+lv_obj_t * lv_file_explorer_get_file_list(lv_obj_t * obj)
 {
     LV_ASSERT_OBJ(obj, MY_CLASS);
 
     lv_file_explorer_t * explorer = (lv_file_explorer_t *)obj;
 
-    return explorer->file_table;
+    return explorer->file_list;
 }
 
 lv_obj_t * lv_file_explorer_get_header(lv_obj_t * obj)
@@ -294,6 +343,24 @@ void lv_file_explorer_open_dir(lv_obj_t * obj, const char * dir)
     show_dir(obj, dir);
 }
 
+bool lv_file_explorer_open_parent(lv_obj_t * obj)
+{
+    LV_ASSERT_OBJ(obj, MY_CLASS);
+
+    lv_file_explorer_t * explorer = (lv_file_explorer_t *)obj;
+    char path[LV_FILE_EXPLORER_PATH_MAX_LEN];
+
+    if(lv_strlen(explorer->current_path) <= 3) return false;
+
+    lv_snprintf(path, sizeof(path), "%s", explorer->current_path);
+    strip_ext(path);
+    /*Remove the last '/' character*/
+    strip_ext(path);
+    show_dir(obj, path);
+
+    return true;
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -314,8 +381,11 @@ static void lv_file_explorer_constructor(const lv_obj_class_t * class_p, lv_obj_
 #endif
 
     explorer->sort = LV_EXPLORER_SORT_NONE;
+    explorer->gui_lock = NULL;
+    explorer->scan = NULL;
 
     lv_memzero(explorer->current_path, sizeof(explorer->current_path));
+    lv_fe_dir_init(&explorer->dir);
 
     lv_obj_set_size(obj, LV_PCT(100), LV_PCT(100));
     lv_obj_set_flex_flow(obj, LV_FLEX_FLOW_COLUMN);
@@ -380,15 +450,11 @@ static void lv_file_explorer_constructor(const lv_obj_class_t * class_p, lv_obj_
     lv_label_set_text(explorer->path_label, LV_SYMBOL_EYE_OPEN"https://lvgl.io");
     lv_obj_center(explorer->path_label);
 
-    /*Table showing the contents of the table of contents*/
-    explorer->file_table = lv_table_create(explorer->browser_area);
-    lv_obj_set_size(explorer->file_table, LV_PCT(100), LV_PCT(86));
-    lv_table_set_column_width(explorer->file_table, 0, LV_PCT(100));
-    lv_table_set_column_count(explorer->file_table, 1);
-    lv_obj_add_event_cb(explorer->file_table, browser_file_event_handler, LV_EVENT_ALL, obj);
-
-    /*only scroll up and down*/
-    lv_obj_set_scroll_dir(explorer->file_table, LV_DIR_TOP | LV_DIR_BOTTOM);
+    /*Virtual list showing the contents of the directory, it only scrolls up and down*/
+    explorer->file_list = lv_fe_list_create(explorer->browser_area);
+    lv_obj_set_size(explorer->file_list, LV_PCT(100), LV_PCT(86));
+    lv_fe_list_set_bind_cb(explorer->file_list, file_list_bind_cb, explorer);
+    lv_obj_add_event_cb(explorer->file_list, browser_file_event_handler, LV_EVENT_ALL, obj);
 
     /*Initialize style*/
     init_style(obj);
@@ -396,6 +462,17 @@ static void lv_file_explorer_constructor(const lv_obj_class_t * class_p, lv_obj_
     LV_TRACE_OBJ_CREATE("finished");
 }
 
+static void lv_file_explorer_destructor(const lv_obj_class_t * class_p, lv_obj_t * obj)
+{
+    LV_UNUSED(class_p);
+
+    lv_file_explorer_t * explorer = (lv_file_explorer_t *)obj;
+
+    if(explorer->scan) lv_fe_scan_cancel(explorer->scan);
+    if(explorer->gui_lock) lv_fe_thumb_set_dir(NULL, NULL, NULL);
+    lv_fe_dir_free(&explorer->dir);
+}
+
 static void init_style(lv_obj_t * obj)
 {
     lv_file_explorer_t * explorer = (lv_file_explorer_t *)obj;
@@ -438,12 +515,12 @@ static void init_style(lv_obj_t * obj)
     lv_obj_set_style_outline_width(explorer->browser_area, 0, 0);
     lv_obj_set_style_bg_color(explorer->browser_area, lv_color_hex(0xffffff), 0);
 
-    /*Style of the table in the browser container*/
-    lv_obj_set_style_bg_color(explorer->file_table, lv_color_hex(0xffffff), 0);
-    lv_obj_set_style_pad_all(explorer->file_table, 0, 0);
-    lv_obj_set_style_radius(explorer->file_table, 0, 0);
-    lv_obj_set_style_border_width(explorer->file_table, 0, 0);
-    lv_obj_set_style_outline_width(explorer->file_table, 0, 0);
+    /*Style of the list in the browser container*/
+    lv_obj_set_style_bg_color(explorer->file_list, lv_color_hex(0xffffff), 0);
+    lv_obj_set_style_pad_all(explorer->file_list, 0, 0);
+    lv_obj_set_style_radius(explorer->file_list, 0, 0);
+    lv_obj_set_style_border_width(explorer->file_list, 0, 0);
+    lv_obj_set_style_outline_width(explorer->file_list, 0, 0);
 
 #if LV_FILE_EXPLORER_QUICK_ACCESS
     /*Style of the list in the quick access bar*/
@@ -544,14 +621,14 @@ static void browser_file_event_handler(lv_event_t * e)
     if(code == LV_EVENT_VALUE_CHANGED) {
         char file_name[LV_FILE_EXPLORER_PATH_MAX_LEN];
         const char * str_fn = NULL;
-        uint32_t row;
-        uint32_t col;
+        uint32_t index = lv_fe_list_get_selected(explorer->file_list);
+
+        if(index == LV_FE_LIST_NONE) return;
 
         lv_memzero(file_name, sizeof(file_name));
-        lv_table_get_selected_cell(explorer->file_table, &row, &col);
-        str_fn = lv_table_get_cell_value(explorer->file_table, row, col);
+        str_fn = lv_fe_dir_name(&explorer->dir, index);
+        bool is_dir = (explorer->dir.entries[index].kind == LV_FE_KIND_DIR);
 
-        str_fn = str_fn + 5;
         if((lv_strcmp(str_fn, ".") == 0))  return;
 
         if((lv_strcmp(str_fn, "..") == 0) && (lv_strlen(explorer->current_path) > 3)) {
@@ -566,159 +643,200 @@ static void browser_file_event_handler(lv_event_t * e)
             }
         }
 
-        lv_fs_dir_t dir;
-        if(lv_fs_dir_open(&dir, file_name) == LV_FS_RES_OK) {
-            lv_fs_dir_close(&dir);
-            show_dir(obj, (char *)file_name);
+        if(is_dir) {
+            if(file_name[0] != '\0') show_dir(obj, (char *)file_name);
         }
         else {
-            if(lv_strcmp(str_fn, "..") != 0) {
-                explorer->sel_fn = str_fn;
-                lv_obj_send_event(obj, LV_EVENT_VALUE_CHANGED, NULL);
-            }
+            explorer->sel_fn = str_fn;
+            lv_obj_send_event(obj, LV_EVENT_VALUE_CHANGED, NULL);
         }
     }
-    else if(code == LV_EVENT_SIZE_CHANGED) {
-        lv_table_set_column_width(explorer->file_table, 0, lv_obj_get_width(explorer->file_table));
-    }
     else if((code == LV_EVENT_CLICKED) || (code == LV_EVENT_RELEASED)) {
         lv_obj_send_event(obj, LV_EVENT_CLICKED, NULL);
     }
 }
 
-const static int read_block_size = 1025;
+static void file_list_bind_cb(lv_obj_t * row, uint32_t index, void * user_data)
+{
+    lv_file_explorer_t * explorer = (lv_file_explorer_t *)user_data;
+    const lv_fe_entry_t * entry = &explorer->dir.entries[index];
+    const lv_image_dsc_t * thumb = NULL;
+
+    if(explorer->gui_lock && entry->kind == LV_FE_KIND_IMAGE) thumb = lv_fe_thumb_get(&explorer->dir, index);
+
+    /*The thumbnail is a child of the row, in its left padding*/
+    lv_obj_t * img = lv_obj_get_child(row, 0);
+    if(thumb) {
+        if(img == NULL) {
+            img = lv_image_create(row);
+            lv_obj_align(img, LV_ALIGN_LEFT_MID, -(LV_FE_THUMB_SIZE + FILE_EXPLORER_THUMB_GAP), 0);
+        }
+        lv_image_set_src(img, thumb);
+        lv_obj_remove_flag(img, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_set_style_pad_left(row, LV_FE_LIST_ROW_PAD + LV_FE_THUMB_SIZE + FILE_EXPLORER_THUMB_GAP, 0);
+        lv_tier_mem_cold_begin();
+        lv_label_set_text(row, lv_fe_dir_name(&explorer->dir, index));
+        lv_tier_mem_cold_end();
+        return;
+    }
+
+    if(img) {
+        lv_obj_add_flag(img, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_set_style_pad_left(row, LV_FE_LIST_ROW_PAD, 0);
+    }
+    /*The names are only read when a row is redrawn, keep them out of internal RAM*/
+    lv_tier_mem_cold_begin();
+    lv_label_set_text_fmt(row, "%s  %s", lv_fe_kind_symbol((lv_fe_kind_t)entry->kind),
+                          lv_fe_dir_name(&explorer->dir, index));
+    lv_tier_mem_cold_end();
+}
+
+static void scan_batch_cb(const lv_fe_dir_t * batch, void * user_data)
+{
+    lv_file_explorer_t * explorer = (lv_file_explorer_t *)user_data;
+    const char * names = explorer->dir.names;
+
+    if(!lv_fe_dir_append(&explorer->dir, batch)) return;
+
+    /*The names may have moved*/
+    if(explorer->sel_fn) explorer->sel_fn = explorer->dir.names + (explorer->sel_fn - names);
+    lv_fe_list_extend(explorer->file_list, explorer->dir.count);
+}
+
+static void scan_reset_cb(void * user_data)
+{
+    lv_file_explorer_t * explorer = (lv_file_explorer_t *)user_data;
+
+    /*The index shown was out of date, back to "." and ".." for the directory as it is now*/
+    lv_fe_dir_clear(&explorer->dir);
+    lv_fe_dir_add(&explorer->dir, ".", LV_FE_KIND_DIR, 0, 0);
+    lv_fe_dir_add(&explorer->dir, "..", LV_FE_KIND_DIR, 0, 0);
+    explorer->sel_fn = NULL;
+    lv_fe_thumb_set_dir(explorer->current_path, thumb_ready_cb, user_data);
+    lv_fe_list_set_count(explorer->file_list, explorer->dir.count);
+}
+
+static void thumb_ready_cb(uint32_t index, void * user_data)
+{
+    lv_file_explorer_t * explorer = (lv_file_explorer_t *)user_data;
+
+    /*Sorted meanwhile, the row asks again for whatever is at index now*/
+    if(index < explorer->dir.count) lv_fe_list_refresh_entry(explorer->file_list, index);
+}
+
+static void scan_done_cb(esp_err_t res, const lv_fe_scan_stats_t * stats, void * user_data)
+{
+    lv_obj_t * obj = (lv_obj_t *)user_data;
+    lv_file_explorer_t * explorer = (lv_file_explorer_t *)obj;
+
+    if(stats->final) explorer->scan = NULL;
+    /*The index shown is up to date*/
+    if(stats->final && stats->src != LV_FE_CACHE_SRC_SCAN) return;
+    if(res != ESP_OK) LV_LOG_USER("Open dir error");
+
+    /*Sorted once at the end, the rows do not jump around while they come in*/
+    file_explorer_sort(obj);
+    lv_fe_list_refresh(explorer->file_list);
+    ESP_LOGI(TAG, "%lu entries, first rows after %lu us, complete after %lu us (%s)", (unsigned long)explorer->dir.count,
+             (unsigned long)stats->first_us, (unsigned long)stats->total_us, src_names[stats->src]);
+    lv_obj_send_event(obj, LV_EVENT_READY, NULL);
+}
+
+/*Kept for callers that want a plain string, the text is loaded by lv_text_load()*/
 char * lv_read_file(const char *path) {
-    FILE *f = fopen(path, "r");
-    if (f == NULL) {
-        ESP_LOGE(TAG, "Failed to open file for reading");
+    lv_text_buf_t text;
+    esp_err_t res = lv_text_load(path, &text, NULL);
+
+    if (res == ESP_ERR_NOT_FOUND) {
         return (char*)"Failed to open file";
     }
-    struct stat file_stat;
-    // Check file size
-    int status = stat(path, &file_stat);
-    int file_size_bytes = file_stat.st_size;
-    char * output = (char*)heap_caps_malloc(file_size_bytes, MALLOC_CAP_SPIRAM);
-
-    if (status == ESP_OK) {
-        
-        ESP_LOGI(TAG, "Reading %d bytes from file %s", file_size_bytes, path);
-        // File should be read per blocks. Does not work to fgets(buf, fullsize)
-        char buf[read_block_size];
-        while (fgets(buf, read_block_size, f) != NULL) {
-            //printf("%s", f);
-            strcat(output, buf);
-        }
-        fclose(f);
-        return output;
-    } else {
-        output = "Reading file properties failed";
-        ESP_LOGI(TAG, "stat file Failed with %d\n" , status);
-        return output;
+    if (res != ESP_OK) {
+        lv_text_buf_free(&text);
+        return (char*)"Reading file failed";
     }
+    ESP_LOGI(TAG, "Read %u bytes from file %s", (unsigned)text.len, path);
+    return text.data;
 }
 
 uint8_t * lv_read_img(const char *path, lv_image_dsc_t &imgdsc) {
-    FILE *f = fopen(path, "r");
-    if (f == NULL) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
         ESP_LOGE(TAG, "Failed to open img for reading");
         return 0;
     }
     struct stat file_stat;
     // Check file size
-    int status = stat(path, &file_stat);
-    int file_size_bytes = file_stat.st_size;
-    uint8_t * output = (uint8_t *)heap_caps_malloc(file_size_bytes, MALLOC_CAP_SPIRAM);
-
-    if (status == ESP_OK) {
-        //ESP_LOGI(TAG, "Reading %d bytes from img %s", file_size_bytes, path);
-        imgdsc.data_size = file_size_bytes;
-        // File should be read per blocks. Does not work to fgets(buf, fullsize)
-        fread(output, 1, file_size_bytes, f);
-        fclose(f);
-        return output;
-    } else {
+    int status = fstat(fd, &file_stat);
+    if (status != 0) {
         ESP_LOGI(TAG, "stat file Failed with %d\n" , status);
+        close(fd);
         return 0;
     }
+    size_t file_size_bytes = file_stat.st_size;
+    uint8_t * output = (uint8_t *)mem_tel_malloc(MEM_TEL_IMAGE, file_size_bytes, MALLOC_CAP_SPIRAM);
+
+    // A bulk load, past stdio and its small buffer: many sectors per SD command
+    ssize_t n = output ? lv_fe_io_read(fd, output, file_size_bytes) : -1;
+    close(fd);
+    if (n != (ssize_t)file_size_bytes) {
+        ESP_LOGE(TAG, "Reading %u bytes from img %s failed", (unsigned)file_size_bytes, path);
+        mem_tel_free(MEM_TEL_IMAGE, output);
+        return 0;
+    }
+    imgdsc.data_size = file_size_bytes;
+    return output;
 }
 
 static void show_dir(lv_obj_t * obj, const char * path)
 {
     lv_file_explorer_t * explorer = (lv_file_explorer_t *)obj;
 
-    char fn[LV_FILE_EXPLORER_PATH_MAX_LEN];
-    uint16_t index = 0;
-    lv_fs_res_t res;
-
-    // No need to "open directory" for now TODO: Check if makes sense to validate that exists
     ESP_LOGI(TAG, "dir_open %s", path);
-    dir = opendir(path);
+    int64_t start = esp_timer_get_time();
 
-    if (dir == NULL) {
+    /*Navigating away stops the directory still being read*/
+    if(explorer->scan) {
+        lv_fe_scan_cancel(explorer->scan);
+        explorer->scan = NULL;
+    }
+
+    /*The entry names stay valid while the list shows them, so read into a new array*/
+    lv_fe_dir_t dir;
+    lv_fe_dir_init(&dir);
+    lv_fe_dir_add(&dir, ".", LV_FE_KIND_DIR, 0, 0);
+    lv_fe_dir_add(&dir, "..", LV_FE_KIND_DIR, 0, 0);
+
+    /*Big directories come from the index cache, listing them on the card is the slow part.
+     *With a GUI lock both are done on the worker task, the GUI task does not touch the card.*/
+    lv_fe_cache_src_t src = LV_FE_CACHE_SRC_SCAN;
+    esp_err_t res = ESP_OK;
+    if(explorer->gui_lock) {
+        lv_fe_scan_config_t scan_cfg = {
+            .first_batch = 0,
+            .gui_lock = explorer->gui_lock,
+            .batch_cb = scan_batch_cb,
+            .reset_cb = scan_reset_cb,
+            .done_cb = scan_done_cb,
+            .user_data = obj,
+        };
+        explorer->scan = lv_fe_scan_start(path, &scan_cfg);
+    }
+    if(explorer->scan == NULL) res = lv_fe_cache_read_dir(&dir, path, &src);
+    if(res == ESP_ERR_NOT_FOUND) {
         LV_LOG_USER("Open dir error");
+        lv_fe_dir_free(&dir);
         return;
     }
 
-    lv_table_set_cell_value_fmt(explorer->file_table, index++, 0, LV_SYMBOL_DIRECTORY "  %s", ".");
-    lv_table_set_cell_value_fmt(explorer->file_table, index++, 0, LV_SYMBOL_DIRECTORY "  %s", "..");
-    lv_table_set_cell_value(explorer->file_table, 0, 1, "0");
-    lv_table_set_cell_value(explorer->file_table, 1, 1, "0");
-
-    while ((dp = readdir (dir)) != NULL) {
-        /*fn is empty, if not more files to read*/
-        strcpy(fn, dp->d_name);
-        if(lv_strlen(fn) == 0) {
-            LV_LOG_USER("No more files to read");
-            ESP_LOGI(TAG, "No more files to read");
-            break;
-        }
-
-        if((is_end_with(fn, ".png") == true)  || (is_end_with(fn, ".PNG") == true)  || \
-           (is_end_with(fn, ".jpg") == true) || (is_end_with(fn, ".JPG") == true) || \
-           (is_end_with(fn, ".bmp") == true) || (is_end_with(fn, ".BMP") == true) || \
-           (is_end_with(fn, ".gif") == true) || (is_end_with(fn, ".GIF") == true) || \
-           (is_end_with(fn, ".jpeg") == true)) {
-            lv_table_set_cell_value_fmt(explorer->file_table, index, 0, LV_SYMBOL_IMAGE "  %s", fn);
-            lv_table_set_cell_value(explorer->file_table, index, 1, "1");
-        }
-        else if((is_end_with(fn, ".mp3") == true) || (is_end_with(fn, ".MP3") == true) || \
-                (is_end_with(fn, ".wav") == true) || (is_end_with(fn, ".WAV") == true)) {
-            lv_table_set_cell_value_fmt(explorer->file_table, index, 0, LV_SYMBOL_AUDIO "  %s", fn);
-            lv_table_set_cell_value(explorer->file_table, index, 1, "2");
-        }
-        else if((is_end_with(fn, ".mp4") == true) || (is_end_with(fn, ".MP4") == true)) {
-            lv_table_set_cell_value_fmt(explorer->file_table, index, 0, LV_SYMBOL_VIDEO "  %s", fn);
-            lv_table_set_cell_value(explorer->file_table, index, 1, "3");
-        }
-        else if((is_end_with(fn, ".txt") == true) || (is_end_with(fn, ".TXT") == true)) {
-            lv_table_set_cell_value_fmt(explorer->file_table, index, 0, LV_SYMBOL_FILE "  %s", fn);
-            lv_table_set_cell_value(explorer->file_table, index, 1, "3");
-        }
-        else if((is_end_with(fn, ".") == true) || (is_end_with(fn, "..") == true)) {
-            /*is dir*/
-            continue;
-        }
-        else if(fn[0] == '/') {/*is dir*/
-            lv_table_set_cell_value_fmt(explorer->file_table, index, 0, LV_SYMBOL_DIRECTORY "  %s", fn + 1);
-            lv_table_set_cell_value(explorer->file_table, index, 1, "0");
-        }
-        else {
-            lv_table_set_cell_value_fmt(explorer->file_table, index, 0, LV_SYMBOL_FILE "  %s", fn);
-            lv_table_set_cell_value(explorer->file_table, index, 1, "4");
-        }
-
-        index++;
+    lv_fe_dir_free(&explorer->dir);
+    explorer->dir = dir;
+    explorer->sel_fn = NULL;
+    if(explorer->scan == NULL) {
+        file_explorer_sort(obj);
+        ESP_LOGI(TAG, "%lu entries in %lu us (%s)", (unsigned long)explorer->dir.count,
+                 (unsigned long)(esp_timer_get_time() - start), src_names[src]);
     }
 
-     closedir(dir);
-
-    lv_table_set_row_count(explorer->file_table, index);
-    file_explorer_sort(obj);
-    lv_obj_send_event(obj, LV_EVENT_READY, NULL);
-
-    /*Move the table to the top*/
-    lv_obj_scroll_to_y(explorer->file_table, 0, LV_ANIM_OFF);
-
     lv_memzero(explorer->current_path, sizeof(explorer->current_path));
     lv_strncpy(explorer->current_path, path, sizeof(explorer->current_path) - 1);
     lv_label_set_text_fmt(explorer->path_label, LV_SYMBOL_EYE_OPEN" %s", path);
@@ -727,6 +845,11 @@ static void show_dir(lv_obj_t * obj, const char * path)
     if((*((explorer->current_path) + current_path_len) != '/') && (current_path_len < LV_FILE_EXPLORER_PATH_MAX_LEN)) {
         *((explorer->current_path) + current_path_len) = '/';
     }
+
+    /*Before the rows are bound, they ask for the thumbnails of the new directory*/
+    if(explorer->gui_lock) lv_fe_thumb_set_dir(explorer->current_path, thumb_ready_cb, obj);
+    lv_fe_list_set_count(explorer->file_list, explorer->dir.count);
+    if(explorer->scan == NULL) lv_obj_send_event(obj, LV_EVENT_READY, NULL);
 }
 
 /*Remove the specified suffix*/
@@ -746,80 +869,29 @@ static void strip_ext(char * dir)
     }
 }
 
-static void exch_table_item(lv_obj_t * tb, int16_t i, int16_t j)
-{
-    const char * tmp;
-    tmp = lv_table_get_cell_value(tb, i, 0);
-    lv_table_set_cell_value(tb, 0, 2, tmp);
-    lv_table_set_cell_value(tb, i, 0, lv_table_get_cell_value(tb, j, 0));
-    lv_table_set_cell_value(tb, j, 0, lv_table_get_cell_value(tb, 0, 2));
-
-    tmp = lv_table_get_cell_value(tb, i, 1);
-    lv_table_set_cell_value(tb, 0, 2, tmp);
-    lv_table_set_cell_value(tb, i, 1, lv_table_get_cell_value(tb, j, 1));
-    lv_table_set_cell_value(tb, j, 1, lv_table_get_cell_value(tb, 0, 2));
-}
-
 static void file_explorer_sort(lv_obj_t * obj)
 {
     LV_ASSERT_OBJ(obj, MY_CLASS);
 
     lv_file_explorer_t * explorer = (lv_file_explorer_t *)obj;
 
-    uint16_t sum = lv_table_get_row_count(explorer->file_table);
-
-    if(sum > 1) {
-        switch(explorer->sort) {
-            case LV_EXPLORER_SORT_NONE:
-                break;
-            case LV_EXPLORER_SORT_KIND:
-                sort_by_file_kind(explorer->file_table, 0, (sum - 1));
-                break;
-            default:
-                break;
-        }
-    }
-}
-
-/*Quick sort 3 way*/
-static void sort_by_file_kind(lv_obj_t * tb, int16_t lo, int16_t hi)
-{
-    if(lo >= hi) return;
-
-    int16_t lt = lo;
-    int16_t i = lo + 1;
-    int16_t gt = hi;
-    const char * v = lv_table_get_cell_value(tb, lo, 1);
-    while(i <= gt) {
-        if(lv_strcmp(lv_table_get_cell_value(tb, i, 1), v) < 0)
-            exch_table_item(tb, lt++, i++);
-        else if(lv_strcmp(lv_table_get_cell_value(tb, i, 1), v) > 0)
-            exch_table_item(tb, i, gt--);
-        else
-            i++;
-    }
-
-    sort_by_file_kind(tb, lo, lt - 1);
-    sort_by_file_kind(tb, gt + 1, hi);
-}
-
-static bool is_end_with(const char * str1, const char * str2)
-{
-    if(str1 == NULL || str2 == NULL)
-        return false;
-
-    uint16_t len1 = lv_strlen(str1);
-    uint16_t len2 = lv_strlen(str2);
-    if((len1 < len2) || (len1 == 0 || len2 == 0))
-        return false;
-
-    while(len2 >= 1) {
-        if(str2[len2 - 1] != str1[len1 - 1])
-            return false;
-
-        len2--;
-        len1--;
+    /*"." and ".." stay on top*/
+    switch(explorer->sort) {
+        case LV_EXPLORER_SORT_NONE:
+            break;
+        case LV_EXPLORER_SORT_KIND:
+            lv_fe_sort(&explorer->dir, 2, LV_FE_SORT_KIND);
+            break;
+        case LV_EXPLORER_SORT_NAME:
+            lv_fe_sort(&explorer->dir, 2, LV_FE_SORT_NAME);
+            break;
+        case LV_EXPLORER_SORT_SIZE:
+            lv_fe_sort(&explorer->dir, 2, LV_FE_SORT_SIZE);
+            break;
+        case LV_EXPLORER_SORT_DATE:
+            lv_fe_sort(&explorer->dir, 2, LV_FE_SORT_DATE);
+            break;
+        default:
+            break;
     }
-
-    return true;
 }
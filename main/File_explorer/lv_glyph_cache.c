@@ -0,0 +1,312 @@
+#include "include/lv_glyph_cache.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "mem_telemetry.h"
+#include "esp_log.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+/*A cached glyph, its 4 bpp rows of (w + 1) / 2 bytes follow it, left pixel in the high nibble*/
+typedef struct _fe_glyph_t {
+    struct _fe_glyph_t * next_in_bucket;
+    struct _fe_glyph_t * newer;     /*LRU list, newest at glyph_newest*/
+    struct _fe_glyph_t * older;
+    const lv_font_t * font;
+    uint32_t letter;
+    uint16_t w;
+    uint16_t h;
+    uint8_t format;                 /*lv_font_glyph_format_t it was rendered as*/
+    uint32_t bytes;                 /*This struct and the bitmap*/
+} fe_glyph_t;
+
+typedef struct {
+    lv_font_t font;                 /*The caching font, its dsc is the base font*/
+    const lv_font_t * base;
+} fe_glyph_font_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static bool glyph_get_dsc_cb(const lv_font_t * font, lv_font_glyph_dsc_t * dsc_out, uint32_t letter,
+                             uint32_t letter_next);
+static const void * glyph_get_bitmap_cb(lv_font_glyph_dsc_t * g_dsc, uint32_t letter, lv_draw_buf_t * draw_buf);
+static void glyph_release_cb(const lv_font_t * font, lv_font_glyph_dsc_t * g_dsc);
+static const void * glyph_render(const lv_font_t * base, lv_font_glyph_dsc_t * g_dsc, uint32_t letter,
+                                 lv_draw_buf_t * draw_buf);
+static fe_glyph_t * glyph_find(const lv_font_t * font, uint32_t letter, uint8_t format, uint32_t bucket);
+static void glyph_add(const lv_font_t * font, uint32_t letter, const lv_font_glyph_dsc_t * g_dsc,
+                      const lv_draw_buf_t * draw_buf, uint32_t bucket);
+static void glyph_unlink(fe_glyph_t * g);
+static void glyph_make_newest(fe_glyph_t * g);
+static inline uint32_t glyph_bucket(const lv_font_t * font, uint32_t letter, uint8_t format);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * GLYPH_TAG = "Glyph cache";
+
+static fe_glyph_t ** glyph_buckets;
+static fe_glyph_t * glyph_newest;
+static fe_glyph_t * glyph_oldest;
+static size_t glyph_budget;
+static bool glyph_enabled;
+static fe_glyph_font_t glyph_fonts[LV_GLYPH_CACHE_FONTS];
+static uint32_t glyph_font_cnt;
+static lv_glyph_cache_stats_t glyph_stats;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+esp_err_t lv_glyph_cache_init(size_t budget_bytes)
+{
+    if(glyph_buckets || budget_bytes == 0) return ESP_OK;
+
+    /*Looked up for every letter drawn*/
+    glyph_buckets = (fe_glyph_t **)mem_tel_calloc(MEM_TEL_GLYPH, LV_GLYPH_CACHE_BUCKETS, sizeof(fe_glyph_t *),
+                                                  MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if(glyph_buckets == NULL) return ESP_ERR_NO_MEM;
+
+    glyph_budget = budget_bytes;
+    glyph_enabled = true;
+    ESP_LOGI(GLYPH_TAG, "%u KB of PSRAM for glyphs", (unsigned)(budget_bytes / 1024));
+
+    return ESP_OK;
+}
+
+const lv_font_t * lv_glyph_cache_font(const lv_font_t * base)
+{
+    if(glyph_buckets == NULL || base == NULL) return base;
+
+    for(uint32_t i = 0; i < glyph_font_cnt; i++) {
+        if(glyph_fonts[i].base == base || &glyph_fonts[i].font == base) return &glyph_fonts[i].font;
+    }
+    if(glyph_font_cnt == LV_GLYPH_CACHE_FONTS) {
+        ESP_LOGW(GLYPH_TAG, "All %d fonts are wrapped", LV_GLYPH_CACHE_FONTS);
+        return base;
+    }
+
+    /*Same metrics, the letters are described by the base font*/
+    fe_glyph_font_t * f = &glyph_fonts[glyph_font_cnt++];
+    f->base = base;
+    f->font = *base;
+    f->font.get_glyph_dsc = glyph_get_dsc_cb;
+    f->font.get_glyph_bitmap = glyph_get_bitmap_cb;
+    f->font.release_glyph = base->release_glyph ? glyph_release_cb : NULL;
+    f->font.dsc = base;
+
+    return &f->font;
+}
+
+void lv_glyph_cache_set_enabled(bool en)
+{
+    glyph_enabled = en && glyph_buckets;
+}
+
+void lv_glyph_cache_clear(void)
+{
+    while(glyph_oldest) {
+        fe_glyph_t * g = glyph_oldest;
+        glyph_unlink(g);
+        mem_tel_free(MEM_TEL_GLYPH, g);
+    }
+}
+
+void lv_glyph_cache_get_stats(lv_glyph_cache_stats_t * stats)
+{
+    *stats = glyph_stats;
+}
+
+void lv_glyph_cache_reset_stats(void)
+{
+    glyph_stats.hits = 0;
+    glyph_stats.misses = 0;
+    glyph_stats.evictions = 0;
+    glyph_stats.bypassed = 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+static bool glyph_get_dsc_cb(const lv_font_t * font, lv_font_glyph_dsc_t * dsc_out, uint32_t letter,
+                             uint32_t letter_next)
+{
+    const lv_font_t * base = (const lv_font_t *)font->dsc;
+
+    return base->get_glyph_dsc(base, dsc_out, letter, letter_next);
+}
+
+static const void * glyph_get_bitmap_cb(lv_font_glyph_dsc_t * g_dsc, uint32_t letter, lv_draw_buf_t * draw_buf)
+{
+    const lv_font_t * font = g_dsc->resolved_font;
+    const lv_font_t * base = (const lv_font_t *)font->dsc;
+    uint8_t format = (uint8_t)g_dsc->format;
+
+    /*Images and vectors are drawn as they are, the A formats are rendered to A8 in draw_buf*/
+    if(!glyph_enabled || draw_buf == NULL || format < LV_FONT_GLYPH_FORMAT_A1 || format > LV_FONT_GLYPH_FORMAT_A8) {
+        if(glyph_enabled) glyph_stats.bypassed++;
+        return glyph_render(base, g_dsc, letter, draw_buf);
+    }
+
+    uint32_t bucket = glyph_bucket(font, letter, format);
+    fe_glyph_t * g = glyph_find(font, letter, format, bucket);
+    if(g == NULL || g->w != g_dsc->box_w || g->h != g_dsc->box_h) {
+        const void * bitmap = glyph_render(base, g_dsc, letter, draw_buf);
+        /*Only what is in draw_buf can be kept*/
+        if(bitmap != draw_buf) {
+            glyph_stats.bypassed++;
+            return bitmap;
+        }
+        glyph_stats.misses++;
+        glyph_add(font, letter, g_dsc, draw_buf, bucket);
+        return bitmap;
+    }
+
+    glyph_stats.hits++;
+    glyph_make_newest(g);
+
+    const uint8_t * src = (const uint8_t *)(g + 1);
+    uint32_t src_stride = (g->w + 1) / 2;
+    uint32_t stride = draw_buf->header.stride;
+    for(uint32_t y = 0; y < g->h; y++) {
+        uint8_t * d = draw_buf->data + y * stride;
+        const uint8_t * s = src + y * src_stride;
+        for(uint32_t x = 0; x < g->w; x += 2) {
+            uint8_t v = *s++;
+            d[x] = (v >> 4) * 17;
+            if(x + 1 < g->w) d[x + 1] = (v & 0x0F) * 17;
+        }
+    }
+
+    return draw_buf;
+}
+
+static void glyph_release_cb(const lv_font_t * font, lv_font_glyph_dsc_t * g_dsc)
+{
+    const lv_font_t * base = (const lv_font_t *)font->dsc;
+
+    g_dsc->resolved_font = base;
+    base->release_glyph(base, g_dsc);
+    g_dsc->resolved_font = font;
+}
+
+/*Let the base font render, it finds its own data through resolved_font*/
+static const void * glyph_render(const lv_font_t * base, lv_font_glyph_dsc_t * g_dsc, uint32_t letter,
+                                 lv_draw_buf_t * draw_buf)
+{
+    const lv_font_t * font = g_dsc->resolved_font;
+
+    g_dsc->resolved_font = base;
+    const void * bitmap = base->get_glyph_bitmap(g_dsc, letter, draw_buf);
+    g_dsc->resolved_font = font;
+
+    return bitmap;
+}
+
+static fe_glyph_t * glyph_find(const lv_font_t * font, uint32_t letter, uint8_t format, uint32_t bucket)
+{
+    for(fe_glyph_t * g = glyph_buckets[bucket]; g; g = g->next_in_bucket) {
+        if(g->letter == letter && g->font == font && g->format == format) return g;
+    }
+
+    return NULL;
+}
+
+/*Keep the A8 bitmap in draw_buf as 4 bpp, dropping the oldest glyphs to stay in the budget*/
+static void glyph_add(const lv_font_t * font, uint32_t letter, const lv_font_glyph_dsc_t * g_dsc,
+                      const lv_draw_buf_t * draw_buf, uint32_t bucket)
+{
+    uint32_t w = g_dsc->box_w;
+    uint32_t h = g_dsc->box_h;
+    uint32_t dst_stride = (w + 1) / 2;
+    uint32_t bytes = sizeof(fe_glyph_t) + dst_stride * h;
+
+    if(bytes > glyph_budget) {
+        glyph_stats.bypassed++;
+        return;
+    }
+
+    /*A stale one of another size*/
+    fe_glyph_t * old = glyph_find(font, letter, g_dsc->format, bucket);
+    if(old) {
+        glyph_unlink(old);
+        mem_tel_free(MEM_TEL_GLYPH, old);
+    }
+    while(glyph_oldest && glyph_stats.bytes + bytes > glyph_budget) {
+        fe_glyph_t * g = glyph_oldest;
+        glyph_unlink(g);
+        mem_tel_free(MEM_TEL_GLYPH, g);
+        glyph_stats.evictions++;
+    }
+
+    fe_glyph_t * g = (fe_glyph_t *)mem_tel_malloc(MEM_TEL_GLYPH, bytes, MALLOC_CAP_SPIRAM);
+    if(g == NULL) return;
+
+    g->font = font;
+    g->letter = letter;
+    g->w = (uint16_t)w;
+    g->h = (uint16_t)h;
+    g->format = (uint8_t)g_dsc->format;
+    g->bytes = bytes;
+
+    uint8_t * dst = (uint8_t *)(g + 1);
+    uint32_t stride = draw_buf->header.stride;
+    for(uint32_t y = 0; y < h; y++) {
+        const uint8_t * s = draw_buf->data + y * stride;
+        uint8_t * d = dst + y * dst_stride;
+        for(uint32_t x = 0; x < w; x += 2) {
+            uint8_t lo = x + 1 < w ? s[x + 1] >> 4 : 0;
+            *d++ = (uint8_t)((s[x] & 0xF0) | lo);
+        }
+    }
+
+    g->next_in_bucket = glyph_buckets[bucket];
+    glyph_buckets[bucket] = g;
+    g->newer = NULL;
+    g->older = glyph_newest;
+    if(glyph_newest) glyph_newest->newer = g;
+    glyph_newest = g;
+    if(glyph_oldest == NULL) glyph_oldest = g;
+    glyph_stats.entries++;
+    glyph_stats.bytes += bytes;
+}
+
+/*Out of its bucket and the LRU list, the caller frees it*/
+static void glyph_unlink(fe_glyph_t * g)
+{
+    fe_glyph_t ** p = &glyph_buckets[glyph_bucket(g->font, g->letter, g->format)];
+    while(*p != g) p = &(*p)->next_in_bucket;
+    *p = g->next_in_bucket;
+
+    if(g->newer) g->newer->older = g->older;
+    else glyph_newest = g->older;
+    if(g->older) g->older->newer = g->newer;
+    else glyph_oldest = g->newer;
+
+    glyph_stats.entries--;
+    glyph_stats.bytes -= g->bytes;
+}
+
+static void glyph_make_newest(fe_glyph_t * g)
+{
+    if(g == glyph_newest) return;
+
+    /*Out of the list*/
+    g->newer->older = g->older;
+    if(g->older) g->older->newer = g->newer;
+    else glyph_oldest = g->newer;
+
+    g->newer = NULL;
+    g->older = glyph_newest;
+    glyph_newest->newer = g;
+    glyph_newest = g;
+}
+
+static inline uint32_t glyph_bucket(const lv_font_t * font, uint32_t letter, uint8_t format)
+{
+    uint32_t h = ((uint32_t)(uintptr_t)font >> 2) * 2654435761u;
+    h ^= letter * 31 + format;
+
+    return (h ^ (h >> 15)) & (LV_GLYPH_CACHE_BUCKETS - 1);
+}
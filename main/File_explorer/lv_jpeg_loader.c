@@ -0,0 +1,252 @@
+#include "include/lv_jpeg_loader.h"
+#include "include/lv_fe_reader.h"
+#include <string.h>
+#include "rom/tjpgd.h"
+#include "esp_heap_caps.h"
+#include "mem_telemetry.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    lv_fe_reader_t * reader;
+    const uint8_t * block;  /*Borrowed from the reader*/
+    size_t len;             /*Bytes in block*/
+    size_t pos;             /*Next byte to hand to the decoder*/
+    uint8_t * px;
+    uint32_t w;             /*Output image*/
+    uint32_t h;
+    uint32_t sw;            /*What the decoder outputs at the chosen scale*/
+    uint32_t sh;
+    lv_color_format_t cf;
+} jpeg_dev_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static uint32_t jpeg_in_cb(JDEC * jd, uint8_t * buff, uint32_t nbyte);
+static uint32_t jpeg_out_cb(JDEC * jd, void * bitmap, JRECT * rect);
+static uint8_t jpeg_fit_scale(uint32_t w, uint32_t h, uint32_t max_w, uint32_t max_h);
+static inline uint8_t jpeg_px(lv_color_format_t cf, const uint8_t * rgb);
+static void jpeg_image_delete_event_cb(lv_event_t * e);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * JPEG_TAG = "JPEG loader";
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+esp_err_t lv_jpeg_load(const char * path, uint32_t max_w, uint32_t max_h, lv_color_format_t cf,
+                       lv_image_dsc_t * out, lv_jpeg_load_stats_t * stats)
+{
+    int64_t start = esp_timer_get_time();
+    JDEC jd;
+    JRESULT jres;
+    jpeg_dev_t dev;
+    lv_fe_reader_stats_t read_stats;
+    void * work = NULL;
+    uint8_t scale;
+    esp_err_t res = ESP_OK;
+
+    memset(out, 0, sizeof(lv_image_dsc_t));
+    if(cf != LV_COLOR_FORMAT_RGB332 && cf != LV_COLOR_FORMAT_L8) return ESP_ERR_INVALID_ARG;
+
+    memset(&dev, 0, sizeof(dev));
+    dev.cf = cf;
+    /*The next blocks are read while the decoder works on this one*/
+    res = lv_fe_reader_open(path, 0, LV_JPEG_LOADER_BLOCK_SIZE, &dev.reader);
+    if(res != ESP_OK) return res;
+
+    /*The decoder tables are read for every MCU, keep them in internal RAM*/
+    work = mem_tel_malloc(MEM_TEL_IMAGE, LV_JPEG_LOADER_WORK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if(work == NULL) {
+        res = ESP_ERR_NO_MEM;
+        goto done;
+    }
+
+    jres = jd_prepare(&jd, jpeg_in_cb, work, LV_JPEG_LOADER_WORK_SIZE, &dev);
+    if(jres != JDR_OK) {
+        ESP_LOGE(JPEG_TAG, "%s: not a baseline JPEG (%d)", path, (int)jres);
+        res = jres == JDR_MEM1 ? ESP_ERR_NO_MEM : ESP_ERR_NOT_SUPPORTED;
+        goto done;
+    }
+
+    scale = jpeg_fit_scale(jd.width, jd.height, max_w, max_h);
+    /*Partial MCUs at the right and bottom are rounded down by the decoder*/
+    dev.sw = LV_MAX(jd.width >> scale, 1);
+    dev.sh = LV_MAX(jd.height >> scale, 1);
+    dev.w = dev.sw;
+    dev.h = dev.sh;
+    if(dev.w > max_w || dev.h > max_h) {
+        /*Still too big at 1/8: pick pixels, keeping the aspect ratio*/
+        if(dev.sw * max_h > dev.sh * max_w) {
+            dev.w = max_w;
+            dev.h = LV_MAX(dev.sh * max_w / dev.sw, 1);
+        }
+        else {
+            dev.h = max_h;
+            dev.w = LV_MAX(dev.sw * max_h / dev.sh, 1);
+        }
+    }
+    dev.px = (uint8_t *)mem_tel_malloc_prefer(MEM_TEL_IMAGE, dev.w * dev.h, MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT);
+    if(dev.px == NULL) {
+        ESP_LOGE(JPEG_TAG, "No memory for %lux%lu", (unsigned long)dev.w, (unsigned long)dev.h);
+        res = ESP_ERR_NO_MEM;
+        goto done;
+    }
+
+    jres = jd_decomp(&jd, jpeg_out_cb, scale);
+    if(jres != JDR_OK) {
+        ESP_LOGE(JPEG_TAG, "%s: decode failed (%d)", path, (int)jres);
+        res = ESP_FAIL;
+        mem_tel_free(MEM_TEL_IMAGE, dev.px);
+        goto done;
+    }
+
+    out->header.magic = LV_IMAGE_HEADER_MAGIC;
+    out->header.cf = cf;
+    out->header.w = dev.w;
+    out->header.h = dev.h;
+    out->header.stride = dev.w;
+    out->data_size = dev.w * dev.h;
+    out->data = dev.px;
+
+done:
+    lv_fe_reader_close(dev.reader, &read_stats);
+    mem_tel_free(MEM_TEL_IMAGE, work);
+
+    if(stats && res == ESP_OK) {
+        stats->decode_us = (uint32_t)(esp_timer_get_time() - start);
+        stats->reads = read_stats.blocks;
+        stats->stall_us = read_stats.stall_us;
+        stats->src_w = jd.width;
+        stats->src_h = jd.height;
+        stats->scale = 1U << scale;
+        stats->peak_bytes = LV_JPEG_LOADER_WORK_SIZE + LV_FE_READER_BUFS * LV_JPEG_LOADER_BLOCK_SIZE +
+                            out->data_size;
+    }
+
+    return res;
+}
+
+void lv_jpeg_free(lv_image_dsc_t * dsc)
+{
+    mem_tel_free(MEM_TEL_IMAGE, (void *)dsc->data);
+    dsc->data = NULL;
+}
+
+esp_err_t lv_jpeg_image_set_src(lv_obj_t * img, const char * path, uint32_t max_w, uint32_t max_h,
+                                lv_color_format_t cf)
+{
+    lv_jpeg_load_stats_t stats;
+
+    lv_image_dsc_t * dsc = (lv_image_dsc_t *)mem_tel_malloc(MEM_TEL_IMAGE, sizeof(lv_image_dsc_t), MALLOC_CAP_DEFAULT);
+    if(dsc == NULL) return ESP_ERR_NO_MEM;
+
+    esp_err_t res = lv_jpeg_load(path, max_w, max_h, cf, dsc, &stats);
+    if(res != ESP_OK) {
+        mem_tel_free(MEM_TEL_IMAGE, dsc);
+        return res;
+    }
+    ESP_LOGI(JPEG_TAG, "%s %ux%u 1/%u in %lu us", path, stats.src_w, stats.src_h, stats.scale,
+             (unsigned long)stats.decode_us);
+
+    lv_image_set_src(img, dsc);
+    lv_obj_add_event_cb(img, jpeg_image_delete_event_cb, LV_EVENT_DELETE, dsc);
+
+    return ESP_OK;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+/*Hand nbyte to the decoder, or skip them when buff is NULL*/
+static uint32_t jpeg_in_cb(JDEC * jd, uint8_t * buff, uint32_t nbyte)
+{
+    jpeg_dev_t * dev = (jpeg_dev_t *)jd->device;
+    uint32_t done = 0;
+
+    while(done < nbyte) {
+        if(dev->pos == dev->len) {
+            if(dev->block) lv_fe_reader_release(dev->reader);
+            lv_fe_reader_borrow(dev->reader, &dev->block, &dev->len);
+            dev->pos = 0;
+            if(dev->len == 0) break;
+        }
+        size_t chunk = LV_MIN(nbyte - done, dev->len - dev->pos);
+        if(buff) memcpy(buff + done, dev->block + dev->pos, chunk);
+        dev->pos += chunk;
+        done += chunk;
+    }
+
+    return done;
+}
+
+/*One MCU of RGB888 in, converted into the output image*/
+static uint32_t jpeg_out_cb(JDEC * jd, void * bitmap, JRECT * rect)
+{
+    jpeg_dev_t * dev = (jpeg_dev_t *)jd->device;
+    const uint8_t * rgb = (const uint8_t *)bitmap;
+    uint32_t rect_w = rect->right - rect->left + 1;
+
+    if(dev->w == dev->sw && dev->h == dev->sh) {
+        uint32_t w = LV_MIN(rect_w, dev->w - rect->left);
+        uint32_t bottom = LV_MIN((uint32_t)rect->bottom + 1, dev->h);
+        for(uint32_t y = rect->top; y < bottom; y++) {
+            const uint8_t * s = rgb + (y - rect->top) * rect_w * 3;
+            uint8_t * d = dev->px + y * dev->w + rect->left;
+            for(uint32_t x = 0; x < w; x++, s += 3) {
+                d[x] = jpeg_px(dev->cf, s);
+            }
+        }
+        return 1;
+    }
+
+    /*Smaller than the decoder output: the nearest pixel of each output pixel in this block*/
+    uint32_t ox0 = (rect->left * dev->w + dev->sw - 1) / dev->sw;
+    for(uint32_t oy = (rect->top * dev->h + dev->sh - 1) / dev->sh; oy < dev->h; oy++) {
+        uint32_t sy = oy * dev->sh / dev->h;
+        if(sy > rect->bottom) break;
+        const uint8_t * row = rgb + (sy - rect->top) * rect_w * 3;
+        uint8_t * d = dev->px + oy * dev->w;
+        for(uint32_t ox = ox0; ox < dev->w; ox++) {
+            uint32_t sx = ox * dev->sw / dev->w;
+            if(sx > rect->right) break;
+            d[ox] = jpeg_px(dev->cf, row + (sx - rect->left) * 3);
+        }
+    }
+
+    return 1;
+}
+
+/*0..3 for 1/1..1/8, the first that fits*/
+static uint8_t jpeg_fit_scale(uint32_t w, uint32_t h, uint32_t max_w, uint32_t max_h)
+{
+    uint8_t scale = 0;
+
+    while(scale < 3 && ((w >> scale) > max_w || (h >> scale) > max_h)) {
+        scale++;
+    }
+
+    return scale;
+}
+
+static inline uint8_t jpeg_px(lv_color_format_t cf, const uint8_t * rgb)
+{
+    if(cf == LV_COLOR_FORMAT_RGB332) return (rgb[0] & 0xE0) | ((rgb[1] & 0xE0) >> 3) | (rgb[2] >> 6);
+
+    return (uint8_t)((rgb[0] * 77 + rgb[1] * 150 + rgb[2] * 29) >> 8);
+}
+
+static void jpeg_image_delete_event_cb(lv_event_t * e)
+{
+    lv_image_dsc_t * dsc = (lv_image_dsc_t *)lv_event_get_user_data(e);
+
+    lv_image_cache_drop(dsc);
+    lv_jpeg_free(dsc);
+    mem_tel_free(MEM_TEL_IMAGE, dsc);
+}
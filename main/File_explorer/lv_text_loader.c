@@ -0,0 +1,316 @@
+#include "include/lv_text_loader.h"
+#include "include/lv_fe_io.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "mem_telemetry.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*How far back from the end of the first part to look for a line end*/
+#define TEXT_LOADER_LINE_SEARCH 512
+#define TEXT_LOADER_TASK_STACK  3072
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    int fd;
+    lv_text_buf_t text;
+    size_t size;            /*File size at open*/
+    size_t off;             /*Bytes read so far*/
+    size_t cut;             /*End of the first part, where the temporary terminator is*/
+    char cut_char;          /*Byte the terminator replaced*/
+    lv_text_stream_config_t config;
+    int64_t start_us;
+    lv_text_load_stats_t stats;
+    volatile bool cancel;   /*Text area deleted while loading*/
+    bool done;
+} text_stream_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static char * text_alloc(size_t size);
+static esp_err_t text_open(const char * path, int * fd, size_t * size);
+static esp_err_t text_read(int fd, char * dst, size_t * off, size_t * size, size_t limit,
+                           volatile bool * cancel, uint32_t * reads);
+static size_t text_first_cut(const char * data, size_t len);
+static void text_stream_task(void * arg);
+static void text_stream_finish(text_stream_t * s, esp_err_t res);
+static void text_stream_free(text_stream_t * s);
+static void text_area_delete_event_cb(lv_event_t * e);
+static void text_area_read_only(lv_obj_t * ta);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * TEXT_TAG = "Text loader";
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+esp_err_t lv_text_load(const char * path, lv_text_buf_t * out, lv_text_load_stats_t * stats)
+{
+    int64_t start = esp_timer_get_time();
+    uint32_t reads = 0;
+    size_t size = 0;
+    size_t off = 0;
+    int fd;
+
+    out->data = NULL;
+    out->len = 0;
+
+    esp_err_t res = text_open(path, &fd, &size);
+    if(res != ESP_OK) return res;
+
+    char * data = text_alloc(size + 1);
+    if(data == NULL) {
+        ESP_LOGE(TEXT_TAG, "No memory for %u bytes of %s", (unsigned)size, path);
+        close(fd);
+        return ESP_ERR_NO_MEM;
+    }
+
+    res = text_read(fd, data, &off, &size, size, NULL, &reads);
+    close(fd);
+    data[off] = '\0';
+
+    out->data = data;
+    out->len = off;
+    if(stats) {
+        stats->total_us = (uint32_t)(esp_timer_get_time() - start);
+        stats->first_us = stats->total_us;
+        stats->reads = reads;
+    }
+
+    return res;
+}
+
+void lv_text_buf_free(lv_text_buf_t * buf)
+{
+    if(buf == NULL) return;
+
+    mem_tel_free(MEM_TEL_TEXT, buf->data);
+    buf->data = NULL;
+    buf->len = 0;
+}
+
+esp_err_t lv_text_stream(const char * path, const lv_text_stream_config_t * config)
+{
+    if(path == NULL || config == NULL) return ESP_ERR_INVALID_ARG;
+    /*The loader task updates the text area, that needs the GUI lock*/
+    if(config->ta != NULL && config->gui_lock == NULL) return ESP_ERR_INVALID_ARG;
+    /*Without either nobody would free the buffer*/
+    if(config->ta == NULL && config->done_cb == NULL) return ESP_ERR_INVALID_ARG;
+
+    text_stream_t * s = (text_stream_t *)calloc(1, sizeof(text_stream_t));
+    if(s == NULL) return ESP_ERR_NO_MEM;
+
+    s->config = *config;
+    if(s->config.first_bytes == 0) s->config.first_bytes = LV_TEXT_LOADER_FIRST_SCREEN;
+    s->start_us = esp_timer_get_time();
+
+    esp_err_t res = text_open(path, &s->fd, &s->size);
+    if(res != ESP_OK) {
+        free(s);
+        return res;
+    }
+
+    s->text.data = text_alloc(s->size + 1);
+    if(s->text.data == NULL) {
+        ESP_LOGE(TEXT_TAG, "No memory for %u bytes of %s", (unsigned)s->size, path);
+        close(s->fd);
+        free(s);
+        return ESP_ERR_NO_MEM;
+    }
+
+    if(s->config.ta) text_area_read_only(s->config.ta);
+
+    size_t first = s->config.first_bytes < s->size ? s->config.first_bytes : s->size;
+    res = text_read(s->fd, s->text.data, &s->off, &s->size, first, NULL, &s->stats.reads);
+
+    if(res != ESP_OK || s->off == s->size) {
+        /*Read error, or the whole file fitted in the first part*/
+        s->cut = s->off;
+        s->cut_char = '\0';
+        if(s->config.ta) {
+            lv_obj_add_event_cb(s->config.ta, text_area_delete_event_cb, LV_EVENT_DELETE, s);
+        }
+        s->stats.first_us = (uint32_t)(esp_timer_get_time() - s->start_us);
+        text_stream_finish(s, res);
+        return res;
+    }
+
+    /*Show the first part up to a line end, the byte under the terminator is put back at the end*/
+    s->cut = text_first_cut(s->text.data, s->off);
+    s->cut_char = s->text.data[s->cut];
+    s->text.data[s->cut] = '\0';
+    s->text.len = s->cut;
+
+    if(s->config.ta) {
+        lv_label_set_text_static(lv_textarea_get_label(s->config.ta), s->text.data);
+        lv_obj_add_event_cb(s->config.ta, text_area_delete_event_cb, LV_EVENT_DELETE, s);
+    }
+    s->stats.first_us = (uint32_t)(esp_timer_get_time() - s->start_us);
+
+    if(xTaskCreate(text_stream_task, "text_load", TEXT_LOADER_TASK_STACK, s, tskIDLE_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGW(TEXT_TAG, "No loader task, reading %s in place", path);
+        res = text_read(s->fd, s->text.data, &s->off, &s->size, s->size, NULL, &s->stats.reads);
+        text_stream_finish(s, res);
+    }
+
+    return ESP_OK;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+static char * text_alloc(size_t size)
+{
+    return (char *)mem_tel_malloc_prefer(MEM_TEL_TEXT, size, MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT);
+}
+
+static esp_err_t text_open(const char * path, int * fd, size_t * size)
+{
+    struct stat st;
+
+    *fd = open(path, O_RDONLY);
+    if(*fd < 0) {
+        ESP_LOGE(TEXT_TAG, "Failed to open %s", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if(fstat(*fd, &st) != 0) {
+        ESP_LOGE(TEXT_TAG, "stat %s failed", path);
+        close(*fd);
+        return ESP_FAIL;
+    }
+    *size = (size_t)st.st_size;
+
+    return ESP_OK;
+}
+
+/*Read from *off up to limit straight into dst. Reads end on block boundaries of the file,
+ *so only the first one can be short. A file that got shorter since open ends the text early.*/
+static esp_err_t text_read(int fd, char * dst, size_t * off, size_t * size, size_t limit,
+                           volatile bool * cancel, uint32_t * reads)
+{
+    while(*off < limit) {
+        if(cancel && *cancel) return ESP_ERR_INVALID_STATE;
+
+        size_t chunk = LV_TEXT_LOADER_BLOCK_SIZE - (*off % LV_TEXT_LOADER_BLOCK_SIZE);
+        if(chunk > limit - *off) chunk = limit - *off;
+
+        ssize_t n = lv_fe_io_read(fd, dst + *off, chunk);
+        (*reads)++;
+        if(n < 0) {
+            ESP_LOGE(TEXT_TAG, "read failed at %u", (unsigned)*off);
+            return ESP_FAIL;
+        }
+        if(n == 0) {
+            *size = *off;
+            break;
+        }
+        *off += (size_t)n;
+    }
+
+    return ESP_OK;
+}
+
+/*End the first part after its last full line. Without one, drop a possibly split UTF-8 sequence.
+ *The result is always below len: the byte at the cut has been read and can be restored.*/
+static size_t text_first_cut(const char * data, size_t len)
+{
+    size_t stop = len > TEXT_LOADER_LINE_SEARCH ? len - TEXT_LOADER_LINE_SEARCH : 0;
+    size_t cut;
+
+    for(cut = len; cut > stop; cut--) {
+        if(data[cut - 1] == '\n') break;
+    }
+    if(cut == stop) {
+        cut = len;
+        while(cut > 0 && ((uint8_t)data[cut - 1] & 0xC0) == 0x80) cut--;
+        if(cut > 0 && ((uint8_t)data[cut - 1] & 0x80)) cut--;
+    }
+    if(cut == len) cut--;
+
+    return cut;
+}
+
+static void text_stream_task(void * arg)
+{
+    text_stream_t * s = (text_stream_t *)arg;
+
+    esp_err_t res = text_read(s->fd, s->text.data, &s->off, &s->size, s->size, &s->cancel, &s->stats.reads);
+
+    if(s->config.gui_lock) xSemaphoreTake(s->config.gui_lock, portMAX_DELAY);
+    text_stream_finish(s, res);
+    if(s->config.gui_lock) xSemaphoreGive(s->config.gui_lock);
+
+    vTaskDelete(NULL);
+}
+
+/*Called with the GUI lock held*/
+static void text_stream_finish(text_stream_t * s, esp_err_t res)
+{
+    close(s->fd);
+    s->fd = -1;
+
+    if(s->cancel) {
+        /*The text area is gone, nobody else holds the buffer*/
+        text_stream_free(s);
+        return;
+    }
+
+    s->text.data[s->cut] = s->cut_char;
+    s->text.data[s->off] = '\0';
+    s->text.len = s->off;
+    s->stats.total_us = (uint32_t)(esp_timer_get_time() - s->start_us);
+    s->done = true;
+
+    if(s->config.ta) {
+        lv_label_set_text_static(lv_textarea_get_label(s->config.ta), s->text.data);
+    }
+    ESP_LOGI(TEXT_TAG, "%u bytes, first screen %lu us, all %lu us, %lu reads", (unsigned)s->text.len,
+             (unsigned long)s->stats.first_us, (unsigned long)s->stats.total_us, (unsigned long)s->stats.reads);
+
+    if(s->config.done_cb) {
+        s->config.done_cb(s->config.ta, &s->text, res, &s->stats, s->config.user_data);
+    }
+    /*Without a text area the buffer now belongs to the callback*/
+    if(s->config.ta == NULL) {
+        free(s);
+    }
+}
+
+static void text_stream_free(text_stream_t * s)
+{
+    lv_text_buf_free(&s->text);
+    free(s);
+}
+
+static void text_area_delete_event_cb(lv_event_t * e)
+{
+    text_stream_t * s = (text_stream_t *)lv_event_get_user_data(e);
+
+    if(s->done) {
+        text_stream_free(s);
+    }
+    else {
+        /*Still loading: the task stops at the next block and frees it*/
+        s->cancel = true;
+    }
+}
+
+/*The label shows the buffer in place, an edit would write into it or replace it under the loader*/
+static void text_area_read_only(lv_obj_t * ta)
+{
+    lv_obj_remove_flag(ta, LV_OBJ_FLAG_CLICK_FOCUSABLE);
+    lv_obj_remove_state(ta, LV_STATE_FOCUSED);
+    lv_group_remove_obj(ta);
+    lv_textarea_set_cursor_click_pos(ta, false);
+}
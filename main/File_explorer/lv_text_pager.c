@@ -0,0 +1,826 @@
+#include "include/lv_text_pager.h"
+#include "include/lv_fe_dir.h"
+#include "include/lv_fe_io.h"
+#include "include/lv_fe_reader.h"
+#include "include/lv_file_explorer.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "mem_telemetry.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "ff.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define MY_CLASS (&lv_text_pager_class)
+#define TEXT_PAGER_MAGIC        0x58475054  /*"TPGX"*/
+#define TEXT_PAGER_VERSION      2
+#define TEXT_PAGER_TASK_STACK   4096
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+/*Index file: this header, then the file offset of every page as uint32_t*/
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t size;          /*Of the text file*/
+    uint32_t mtime;
+    uint32_t layout_key;
+    uint32_t name_hash;     /*Of the text file name, two texts may share an 8.3 index name*/
+    uint32_t pages;         /*0 until the index is complete*/
+} text_pager_header_t;
+
+/*Outlives the widget while the worker runs, like the text stream of lv_text_loader*/
+typedef struct _lv_text_pager_index_t {
+    char * path;
+    char * index_path;      /*NULL if the index can not be kept next to the text*/
+    char * build_path;      /*Where this worker writes, renamed to index_path when complete*/
+    const char * read_path; /*The one of the two the offsets are read from*/
+    lv_text_pager_layout_t layout;
+    text_pager_header_t header;
+    SemaphoreHandle_t gui_lock;
+    lv_obj_t * obj;
+    uint32_t pages;         /*Offsets in the index file, under gui_lock while the worker runs*/
+    uint32_t index_us;
+    uint32_t index_stall_us;
+    volatile bool persist;  /*The index file can be read*/
+    volatile bool cancel;
+    bool complete;
+    bool running;
+} text_pager_index_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void lv_text_pager_constructor(const lv_obj_class_t * class_p, lv_obj_t * obj);
+static void lv_text_pager_destructor(const lv_obj_class_t * class_p, lv_obj_t * obj);
+static void lv_text_pager_event(const lv_obj_class_t * class_p, lv_event_t * e);
+static void pager_layout_init(lv_obj_t * obj, lv_text_pager_layout_t * l);
+static size_t pager_layout_page(const lv_text_pager_layout_t * l, const char * data, size_t len, char * out);
+static uint32_t pager_utf8_next(const char * s, size_t len, bool at_end, uint32_t * n);
+static bool pager_show(lv_obj_t * obj, uint32_t page, uint32_t start);
+static bool pager_page_offset(lv_text_pager_t * pager, uint32_t page, uint32_t * off);
+static void pager_close(lv_obj_t * obj);
+static char * pager_index_path(const char * path);
+static char * pager_build_path(const char * index_path);
+static uint32_t pager_name_hash(const char * path);
+static bool pager_index_load(text_pager_index_t * ix);
+static void pager_index_build(text_pager_index_t * ix);
+static void pager_index_append(text_pager_index_t * ix, const uint32_t * offsets, uint32_t n);
+static void pager_index_task(void * arg);
+static void pager_index_done(text_pager_index_t * ix);
+static void pager_index_commit(text_pager_index_t * ix);
+static void pager_index_detach(text_pager_index_t * ix);
+static void pager_index_free(text_pager_index_t * ix);
+static char * pager_strdup(const char * s);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * PAGER_TAG = "Text pager";
+static uint32_t pager_builds;   /*Names the build file of each worker*/
+
+const lv_obj_class_t lv_text_pager_class = {
+    .base_class     = &lv_obj_class,
+    .constructor_cb = lv_text_pager_constructor,
+    .destructor_cb  = lv_text_pager_destructor,
+    .event_cb       = lv_text_pager_event,
+    .name = "text-pager",
+    .width_def      = LV_PCT(100),
+    .height_def     = LV_PCT(100),
+    .instance_size  = sizeof(lv_text_pager_t)
+};
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+lv_obj_t * lv_text_pager_create(lv_obj_t * parent)
+{
+    LV_LOG_INFO("begin");
+    lv_obj_t * obj = lv_obj_class_create_obj(MY_CLASS, parent);
+    lv_obj_class_init_obj(obj);
+    return obj;
+}
+
+void lv_text_pager_set_gui_lock(lv_obj_t * obj, SemaphoreHandle_t gui_lock)
+{
+    LV_ASSERT_OBJ(obj, MY_CLASS);
+
+    ((lv_text_pager_t *)obj)->gui_lock = gui_lock;
+}
+
+esp_err_t lv_text_pager_open(lv_obj_t * obj, const char * path)
+{
+    LV_ASSERT_OBJ(obj, MY_CLASS);
+
+    lv_text_pager_t * pager = (lv_text_pager_t *)obj;
+    struct stat st;
+
+    /*The label shows the window buffer, let it go first*/
+    lv_label_set_text_static(pager->label, "");
+    pager_close(obj);
+
+    if(stat(path, &st) != 0) {
+        ESP_LOGE(PAGER_TAG, "Failed to open %s", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    pager_layout_init(obj, &pager->layout);
+    pager->size = (uint32_t)st.st_size;
+    pager->stats.window = pager->layout.window;
+    pager->window = (char *)mem_tel_malloc_prefer(MEM_TEL_TEXT, pager->layout.window, MALLOC_CAP_SPIRAM,
+                                                    MALLOC_CAP_DEFAULT);
+    /*The page with a line end added for every wrapped line*/
+    pager->text = (char *)mem_tel_malloc_prefer(MEM_TEL_TEXT, pager->layout.window + pager->layout.lines + 1,
+                                                MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT);
+    text_pager_index_t * ix = (text_pager_index_t *)calloc(1, sizeof(text_pager_index_t));
+    if(ix) ix->path = pager_strdup(path);
+    if(pager->window == NULL || pager->text == NULL || ix == NULL || ix->path == NULL) {
+        if(ix) pager_index_free(ix);
+        pager_close(obj);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ix->index_path = pager_index_path(path);
+    ix->persist = ix->index_path != NULL;
+    ix->layout = pager->layout;
+    ix->obj = obj;
+    ix->header.magic = TEXT_PAGER_MAGIC;
+    ix->header.version = TEXT_PAGER_VERSION;
+    ix->header.size = pager->size;
+    ix->header.mtime = (uint32_t)st.st_mtime;
+    ix->header.layout_key = pager->layout.key;
+    ix->header.name_hash = pager_name_hash(path);
+    pager->index = ix;
+    pager->stats.held = pager->layout.window * 2 + pager->layout.lines + 1 + sizeof(text_pager_index_t) +
+                        strlen(path) * 3 + sizeof("." LV_TEXT_PAGER_INDEX_EXT) + sizeof("/~TP12345.TMP") + 1;
+
+    if(pager_index_load(ix)) {
+        ix->read_path = ix->index_path;
+        ix->complete = true;
+        pager->stats.index_reused = true;
+    }
+    else {
+        if(ix->persist) {
+            ix->build_path = pager_build_path(ix->index_path);
+            ix->read_path = ix->build_path;
+            ix->persist = ix->build_path != NULL;
+        }
+        ix->gui_lock = pager->gui_lock;
+        ix->running = ix->gui_lock != NULL;
+        if(ix->running && xTaskCreate(pager_index_task, "text_pager", TEXT_PAGER_TASK_STACK, ix, tskIDLE_PRIORITY,
+                                      NULL) != pdPASS) {
+            ESP_LOGW(PAGER_TAG, "No index task, indexing %s in place", path);
+            ix->running = false;
+        }
+        if(!ix->running) {
+            /*In the calling task, it has the GUI lock if there is one*/
+            ix->gui_lock = NULL;
+            pager_index_build(ix);
+            pager_index_done(ix);
+        }
+    }
+
+    pager_show(obj, 0, 0);
+
+    return ESP_OK;
+}
+
+bool lv_text_pager_set_page(lv_obj_t * obj, uint32_t page)
+{
+    LV_ASSERT_OBJ(obj, MY_CLASS);
+
+    lv_text_pager_t * pager = (lv_text_pager_t *)obj;
+    int64_t start = esp_timer_get_time();
+    uint32_t off;
+
+    if(pager->index == NULL || page == pager->page) return false;
+    if(!pager_page_offset(pager, page, &off)) return false;
+    if(!pager_show(obj, page, off)) return false;
+
+    pager->stats.page_us = (uint32_t)(esp_timer_get_time() - start);
+
+    return true;
+}
+
+bool lv_text_pager_next(lv_obj_t * obj)
+{
+    return lv_text_pager_set_page(obj, lv_text_pager_get_page(obj) + 1);
+}
+
+bool lv_text_pager_prev(lv_obj_t * obj)
+{
+    uint32_t page = lv_text_pager_get_page(obj);
+
+    return page > 0 && lv_text_pager_set_page(obj, page - 1);
+}
+
+uint32_t lv_text_pager_get_page(const lv_obj_t * obj)
+{
+    LV_ASSERT_OBJ(obj, MY_CLASS);
+
+    return ((lv_text_pager_t *)obj)->page;
+}
+
+uint32_t lv_text_pager_get_page_count(const lv_obj_t * obj, bool * complete)
+{
+    LV_ASSERT_OBJ(obj, MY_CLASS);
+
+    lv_text_pager_t * pager = (lv_text_pager_t *)obj;
+
+    if(complete) *complete = pager->index && pager->index->complete;
+    if(pager->index == NULL) return 0;
+
+    /*Pages read one after the other can be ahead of the worker*/
+    return LV_MAX(pager->index->pages, pager->page + 1);
+}
+
+const lv_text_pager_stats_t * lv_text_pager_get_stats(const lv_obj_t * obj)
+{
+    LV_ASSERT_OBJ(obj, MY_CLASS);
+
+    return &((lv_text_pager_t *)obj)->stats;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+static void lv_text_pager_constructor(const lv_obj_class_t * class_p, lv_obj_t * obj)
+{
+    LV_UNUSED(class_p);
+    LV_TRACE_OBJ_CREATE("begin");
+
+    lv_text_pager_t * pager = (lv_text_pager_t *)obj;
+
+    /*Taps turn the pages, nothing scrolls*/
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_SCROLL_CHAIN);
+    lv_obj_add_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+    pager->label = lv_label_create(obj);
+    /*The lines are broken by the pager, the label must not wrap them again*/
+    lv_obj_set_size(pager->label, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+    lv_label_set_text_static(pager->label, "");
+
+    LV_TRACE_OBJ_CREATE("finished");
+}
+
+static void lv_text_pager_destructor(const lv_obj_class_t * class_p, lv_obj_t * obj)
+{
+    LV_UNUSED(class_p);
+
+    /*The label is a child and already deleted*/
+    pager_close(obj);
+}
+
+static void lv_text_pager_event(const lv_obj_class_t * class_p, lv_event_t * e)
+{
+    LV_UNUSED(class_p);
+
+    lv_result_t res = lv_obj_event_base(MY_CLASS, e);
+    if(res != LV_RESULT_OK) return;
+
+    lv_event_code_t code = lv_event_get_code(e);
+    lv_obj_t * obj = (lv_obj_t *)lv_event_get_current_target(e);
+    lv_text_pager_t * pager = (lv_text_pager_t *)obj;
+
+    if(code == LV_EVENT_CLICKED) {
+        lv_point_t p;
+        lv_area_t area;
+        lv_indev_get_point(lv_indev_active(), &p);
+        lv_obj_get_coords(obj, &area);
+        if(p.x < area.x1 + lv_area_get_width(&area) / 3) lv_text_pager_prev(obj);
+        else lv_text_pager_next(obj);
+    }
+    else if(code == LV_EVENT_KEY) {
+        uint32_t key = lv_event_get_key(e);
+        if(key == LV_KEY_RIGHT || key == LV_KEY_DOWN) lv_text_pager_next(obj);
+        else if(key == LV_KEY_LEFT || key == LV_KEY_UP) lv_text_pager_prev(obj);
+    }
+    else if(code == LV_EVENT_SIZE_CHANGED || code == LV_EVENT_STYLE_CHANGED) {
+        if(pager->index == NULL) return;
+
+        /*Other page breaks need another index, start over on the first page*/
+        lv_text_pager_layout_t l;
+        pager_layout_init(obj, &l);
+        if(l.key == pager->layout.key) return;
+
+        char * path = pager_strdup(pager->index->path);
+        if(path == NULL) return;
+        lv_text_pager_open(obj, path);
+        free(path);
+    }
+}
+
+/*What a page is for the current size and style of the widget*/
+static void pager_layout_init(lv_obj_t * obj, lv_text_pager_layout_t * l)
+{
+    const lv_font_t * font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+    int32_t line_space = lv_obj_get_style_text_line_space(obj, LV_PART_MAIN);
+    int32_t line_h = lv_font_get_line_height(font) + line_space;
+    int32_t min_w = UINT8_MAX;
+
+    memset(l, 0, sizeof(lv_text_pager_layout_t));
+    l->font = font;
+    l->letter_space = lv_obj_get_style_text_letter_space(obj, LV_PART_MAIN);
+    l->max_w = LV_MAX(lv_obj_get_content_width(obj), 1);
+    l->lines = LV_MAX((lv_obj_get_content_height(obj) + line_space) / LV_MAX(line_h, 1), 1);
+
+    for(uint32_t c = ' '; c < 128; c++) {
+        int32_t w = lv_font_get_glyph_width(font, c, 0) + l->letter_space;
+        w = LV_CLAMP(0, w, UINT8_MAX);
+        l->ascii_w[c] = (uint8_t)w;
+        if(w > 0 && w < min_w) min_w = w;
+    }
+
+    /*Room for a page of the narrowest glyph in the longest UTF-8 sequences*/
+    uint32_t window = l->lines * ((uint32_t)(l->max_w / min_w) + 1) * 4;
+    l->window = LV_CLAMP(LV_TEXT_PAGER_WINDOW_MIN, window, LV_TEXT_PAGER_WINDOW_MAX);
+
+    /*FNV-1a of everything that moves a page break*/
+    const uint8_t * p = (const uint8_t *)&l->max_w;
+    const uint8_t * end = (const uint8_t *)(l + 1);
+    uint32_t hash = 2166136261u;
+    for(; p < end; p++) {
+        if(p == (const uint8_t *)&l->key) p += sizeof(l->key);
+        hash = (hash ^ *p) * 16777619u;
+    }
+    l->key = hash;
+}
+
+/*Lay out one page from data, which starts at the page start. len is below l->window only at
+ *the end of the file. Returns the bytes the page covers. If out is not NULL the page is copied
+ *there with a '\n' at every line end and terminated. The worker and the widget both run this,
+ *so the index and the pages shown always agree.*/
+static size_t pager_layout_page(const lv_text_pager_layout_t * l, const char * data, size_t len, char * out)
+{
+    bool at_end = len < l->window;
+    uint32_t lines = 0;
+    size_t line_start = 0;
+    size_t brk = 0;         /*After the last space of the line, 0 if none*/
+    size_t o = 0;
+    size_t out_len = 0;
+    int32_t line_w = 0;
+    int32_t brk_w = 0;      /*Width after the last space*/
+
+    while(o < len && lines < l->lines) {
+        uint32_t n;
+        uint32_t c = pager_utf8_next(data + o, len - o, at_end, &n);
+        if(n == 0) break;   /*Split by the window end*/
+
+        size_t end;
+        if(c == '\n') {
+            end = o;
+            o += n;
+        }
+        else {
+            int32_t w = c < 128 ? l->ascii_w[c] : lv_font_get_glyph_width(l->font, c, 0) + l->letter_space;
+            if(line_w + w <= l->max_w || o == line_start) {
+                line_w += w;
+                brk_w += w;
+                o += n;
+                if(c == ' ') {
+                    brk = o;
+                    brk_w = 0;
+                }
+                continue;
+            }
+            /*Wrap after the last space, or in the word if there is none*/
+            end = brk > line_start ? brk : o;
+        }
+
+        if(out) {
+            for(size_t i = line_start; i < end; i++) {
+                if(data[i] != '\r') out[out_len++] = data[i];
+            }
+            out[out_len++] = '\n';
+        }
+        lines++;
+        line_w = c != '\n' && brk > line_start ? brk_w : 0;
+        line_start = c == '\n' ? o : end;
+        brk = 0;
+        brk_w = line_w;
+    }
+
+    /*The last line of the file, or a page of zero width characters that filled the window*/
+    if(lines < l->lines && o > line_start) {
+        if(out) {
+            for(size_t i = line_start; i < o; i++) {
+                if(data[i] != '\r') out[out_len++] = data[i];
+            }
+        }
+        line_start = o;
+    }
+    if(out) {
+        if(out_len > 0 && out[out_len - 1] == '\n') out_len--;
+        out[out_len] = '\0';
+    }
+
+    return line_start;
+}
+
+/*Decode one character. n is 0 if it is cut by the end of the data and more could follow,
+ *invalid bytes are taken one by one.*/
+static uint32_t pager_utf8_next(const char * s, size_t len, bool at_end, uint32_t * n)
+{
+    uint8_t b = (uint8_t)s[0];
+    uint32_t need;
+    uint32_t c;
+
+    if(b < 0x80) {
+        *n = 1;
+        return b;
+    }
+    if((b & 0xE0) == 0xC0) {
+        need = 2;
+        c = b & 0x1F;
+    }
+    else if((b & 0xF0) == 0xE0) {
+        need = 3;
+        c = b & 0x0F;
+    }
+    else if((b & 0xF8) == 0xF0) {
+        need = 4;
+        c = b & 0x07;
+    }
+    else {
+        *n = 1;
+        return 0xFFFD;
+    }
+
+    if(need > len) {
+        *n = at_end ? 1 : 0;
+        return 0xFFFD;
+    }
+    for(uint32_t i = 1; i < need; i++) {
+        if(((uint8_t)s[i] & 0xC0) != 0x80) {
+            *n = 1;
+            return 0xFFFD;
+        }
+        c = (c << 6) | ((uint8_t)s[i] & 0x3F);
+    }
+    *n = need;
+
+    return c;
+}
+
+/*Read the page starting at start into the window and show it*/
+static bool pager_show(lv_obj_t * obj, uint32_t page, uint32_t start)
+{
+    lv_text_pager_t * pager = (lv_text_pager_t *)obj;
+    ssize_t n = -1;
+
+    int fd = open(pager->index->path, O_RDONLY);
+    if(fd < 0) {
+        ESP_LOGE(PAGER_TAG, "Failed to open %s", pager->index->path);
+        return false;
+    }
+    if(lseek(fd, start, SEEK_SET) == (off_t)start) n = lv_fe_io_read(fd, pager->window, pager->layout.window);
+    close(fd);
+    if(n < 0) {
+        ESP_LOGE(PAGER_TAG, "read failed at %lu", (unsigned long)start);
+        return false;
+    }
+
+    size_t used = pager_layout_page(&pager->layout, pager->window, (size_t)n, pager->text);
+    lv_label_set_text_static(pager->label, pager->text);
+    pager->page = page;
+    pager->page_start = start;
+    pager->page_end = start + (uint32_t)used;
+    lv_obj_send_event(obj, LV_EVENT_VALUE_CHANGED, NULL);
+
+    return true;
+}
+
+/*Where a page starts: the next one is known from the page shown, any other one is one
+ *read from the index file*/
+static bool pager_page_offset(lv_text_pager_t * pager, uint32_t page, uint32_t * off)
+{
+    text_pager_index_t * ix = pager->index;
+
+    if(page == 0) {
+        *off = 0;
+        return true;
+    }
+    if(page == pager->page + 1) {
+        *off = pager->page_end;
+        return pager->page_end < pager->size;
+    }
+    if(!ix->persist || page >= ix->pages) return false;
+
+    FILE * f = fopen(ix->read_path, "rb");
+    if(f == NULL) return false;
+    bool ok = fseek(f, sizeof(text_pager_header_t) + page * sizeof(uint32_t), SEEK_SET) == 0 &&
+              fread(off, sizeof(uint32_t), 1, f) == 1;
+    fclose(f);
+
+    return ok && *off < pager->size;
+}
+
+static void pager_close(lv_obj_t * obj)
+{
+    lv_text_pager_t * pager = (lv_text_pager_t *)obj;
+
+    if(pager->index) pager_index_detach(pager->index);
+    pager->index = NULL;
+    mem_tel_free(MEM_TEL_TEXT, pager->window);
+    mem_tel_free(MEM_TEL_TEXT, pager->text);
+    pager->window = NULL;
+    pager->text = NULL;
+    pager->page = 0;
+    pager->page_start = 0;
+    pager->page_end = 0;
+    pager->size = 0;
+    memset(&pager->stats, 0, sizeof(pager->stats));
+}
+
+/*The name of the text with LV_TEXT_PAGER_INDEX_EXT added, only on the card where it can be hidden.
+ *Without long names the extension of the text is replaced, the header tells the texts apart.*/
+static char * pager_index_path(const char * path)
+{
+#if CONFIG_FATFS_LFN_NONE
+    const char * name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    const char * dot = strrchr(name, '.');
+    size_t base = dot ? (size_t)(dot - path) : strlen(path);
+#else
+    size_t base = strlen(path);
+#endif
+
+    char * out = (char *)malloc(base + sizeof("." LV_TEXT_PAGER_INDEX_EXT));
+    if(out == NULL) return NULL;
+    memcpy(out, path, base);
+    strcpy(out + base, "." LV_TEXT_PAGER_INDEX_EXT);
+
+    if(!lv_fe_dir_fatfs_path(out, NULL, 0)) {
+        free(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+/*A file of its own in the directory of the index for each worker, so a worker that is cancelled
+ *never writes into the index of the next one. 8.3, like the index.*/
+static char * pager_build_path(const char * index_path)
+{
+    const char * name = strrchr(index_path, '/');
+    size_t dir = name ? (size_t)(name - index_path) : 0;
+
+    char * out = (char *)malloc(dir + sizeof("/~TP12345.TMP"));
+    if(out == NULL) return NULL;
+    memcpy(out, index_path, dir);
+    sprintf(out + dir, "/~TP%05lX.TMP", (unsigned long)(pager_builds++ & 0xFFFFF));
+
+    return out;
+}
+
+/*FNV-1a of the file name*/
+static uint32_t pager_name_hash(const char * path)
+{
+    const char * name = strrchr(path, '/');
+    uint32_t h = 2166136261u;
+
+    for(name = name ? name + 1 : path; *name; name++) h = (h ^ (uint8_t)*name) * 16777619u;
+
+    return h;
+}
+
+/*Use the index file if it was made for this file and layout. A file of that name that is not
+ *an index is left alone and nothing is kept.*/
+static bool pager_index_load(text_pager_index_t * ix)
+{
+    text_pager_header_t h;
+
+    if(ix->index_path == NULL) return false;
+
+    FILE * f = fopen(ix->index_path, "rb");
+    if(f == NULL) return false;
+
+    bool read = fread(&h, sizeof(h), 1, f) == 1;
+    if(!read || h.magic != TEXT_PAGER_MAGIC) {
+        fclose(f);
+        ESP_LOGW(PAGER_TAG, "%s is not a page index, not kept", ix->index_path);
+        ix->persist = false;
+        return false;
+    }
+
+    bool valid = h.version == ix->header.version && h.size == ix->header.size && h.mtime == ix->header.mtime &&
+                 h.layout_key == ix->header.layout_key && h.name_hash == ix->header.name_hash && h.pages > 0;
+    fseek(f, 0, SEEK_END);
+    valid = valid && ftell(f) == (long)(sizeof(h) + h.pages * sizeof(uint32_t));
+    fclose(f);
+    if(!valid) return false;
+
+    ix->pages = h.pages;
+
+    return true;
+}
+
+/*Lay out the whole file. The window slides through a buffer of twice its size, so every page
+ *sees the same bytes as when it is shown.*/
+static void pager_index_build(text_pager_index_t * ix)
+{
+    int64_t start = esp_timer_get_time();
+    uint32_t chunk[LV_TEXT_PAGER_CHUNK];
+    uint32_t n = 0;
+    uint32_t total = 0;
+    size_t window = ix->layout.window;
+    size_t off = 0;         /*File offset of buf[0]*/
+    size_t len = 0;
+    size_t pos = 0;
+    bool eof = false;
+    lv_fe_reader_t * reader = NULL;
+    lv_fe_reader_stats_t read_stats;
+    const uint8_t * block = NULL;
+    size_t block_len = 0;
+    size_t block_pos = 0;
+
+    /*The file is read ahead while the pages are laid out*/
+    char * buf = (char *)mem_tel_malloc_prefer(MEM_TEL_TEXT, 2 * window, MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT);
+    if(buf == NULL || lv_fe_reader_open(ix->path, 0, 0, &reader) != ESP_OK) {
+        ESP_LOGE(PAGER_TAG, "Can not index %s", ix->path);
+        ix->persist = false;
+        mem_tel_free(MEM_TEL_TEXT, buf);
+        return;
+    }
+
+    if(ix->persist) {
+        /*Hidden, lv_fe_dir_scan does not list it. The page count is written when complete.*/
+        size_t fatfs_size = strlen(ix->build_path) + sizeof(FATFS_DRIVE);
+        char * fatfs_fn = (char *)malloc(fatfs_size);
+        FILE * f = fopen(ix->build_path, "wb");
+        bool ok = f && fwrite(&ix->header, sizeof(ix->header), 1, f) == 1;
+        if(f) ok = (fclose(f) == 0) && ok;
+        if(ok && fatfs_fn && lv_fe_dir_fatfs_path(ix->build_path, fatfs_fn, fatfs_size)) {
+            f_chmod(fatfs_fn, AM_HID, AM_HID);
+        }
+        free(fatfs_fn);
+        ix->persist = ok;
+    }
+
+    while(!ix->cancel) {
+        if(len - pos < window && !eof) {
+            memmove(buf, buf + pos, len - pos);
+            off += pos;
+            len -= pos;
+            pos = 0;
+            while(len < 2 * window) {
+                if(block_pos == block_len) {
+                    if(block) lv_fe_reader_release(reader);
+                    lv_fe_reader_borrow(reader, &block, &block_len);
+                    block_pos = 0;
+                    if(block_len == 0) {
+                        eof = true;
+                        break;
+                    }
+                }
+                size_t copy = LV_MIN(2 * window - len, block_len - block_pos);
+                memcpy(buf + len, block + block_pos, copy);
+                len += copy;
+                block_pos += copy;
+            }
+        }
+        /*An empty file still has its one empty page*/
+        if(pos == len && total + n > 0) break;
+
+        chunk[n++] = (uint32_t)(off + pos);
+        if(n == LV_TEXT_PAGER_CHUNK) {
+            pager_index_append(ix, chunk, n);
+            total += n;
+            n = 0;
+        }
+
+        size_t avail = LV_MIN(window, len - pos);
+        /*Glyphs other than ASCII come from the font, that is not safe from another task*/
+        bool lock = false;
+        for(size_t i = 0; ix->gui_lock && i < avail && !lock; i++) lock = (uint8_t)buf[pos + i] >= 0x80;
+        if(lock) xSemaphoreTake(ix->gui_lock, portMAX_DELAY);
+        size_t used = pager_layout_page(&ix->layout, buf + pos, avail, NULL);
+        if(lock) xSemaphoreGive(ix->gui_lock);
+        if(used == 0) break;
+        pos += used;
+    }
+    if(n > 0) {
+        pager_index_append(ix, chunk, n);
+        total += n;
+    }
+    lv_fe_reader_close(reader, &read_stats);
+    mem_tel_free(MEM_TEL_TEXT, buf);
+    ix->index_stall_us = read_stats.stall_us;
+
+    if(ix->persist && !ix->cancel) {
+        FILE * f = fopen(ix->build_path, "r+b");
+        text_pager_header_t h = ix->header;
+        h.pages = total;
+        bool ok = f && fwrite(&h, sizeof(h), 1, f) == 1;
+        if(f) ok = (fclose(f) == 0) && ok;
+        if(!ok) ESP_LOGW(PAGER_TAG, "%s not written", ix->build_path);
+    }
+    ix->index_us = (uint32_t)(esp_timer_get_time() - start);
+}
+
+/*Append page offsets to the build file, then let the widget use them. Nothing is written
+ *once the worker is cancelled.*/
+static void pager_index_append(text_pager_index_t * ix, const uint32_t * offsets, uint32_t n)
+{
+    if(ix->cancel) return;
+    if(ix->persist) {
+        /*Closed every time, so the widget can read what is there from its own handle*/
+        FILE * f = fopen(ix->build_path, "ab");
+        bool ok = f && fwrite(offsets, sizeof(uint32_t), n, f) == n;
+        if(f) ok = (fclose(f) == 0) && ok;
+        if(!ok) {
+            ESP_LOGW(PAGER_TAG, "%s not written, only paging forward", ix->build_path);
+            ix->persist = false;
+        }
+    }
+
+    if(ix->gui_lock) xSemaphoreTake(ix->gui_lock, portMAX_DELAY);
+    ix->pages += n;
+    if(ix->gui_lock) xSemaphoreGive(ix->gui_lock);
+}
+
+static void pager_index_task(void * arg)
+{
+    text_pager_index_t * ix = (text_pager_index_t *)arg;
+    SemaphoreHandle_t gui_lock = ix->gui_lock;  /*ix is freed when cancelled*/
+
+    pager_index_build(ix);
+
+    xSemaphoreTake(gui_lock, portMAX_DELAY);
+    pager_index_done(ix);
+    xSemaphoreGive(gui_lock);
+
+    vTaskDelete(NULL);
+}
+
+/*Called with the GUI lock held*/
+static void pager_index_done(text_pager_index_t * ix)
+{
+    ix->running = false;
+    if(ix->cancel) {
+        /*The widget is gone or opened something else*/
+        pager_index_free(ix);
+        return;
+    }
+
+    pager_index_commit(ix);
+    ix->complete = true;
+    ((lv_text_pager_t *)ix->obj)->stats.index_us = ix->index_us;
+    ((lv_text_pager_t *)ix->obj)->stats.index_stall_us = ix->index_stall_us;
+    ESP_LOGI(PAGER_TAG, "%s: %lu pages of %lu lines in %lu us", ix->path, (unsigned long)ix->pages,
+             (unsigned long)ix->layout.lines, (unsigned long)ix->index_us);
+    lv_obj_send_event(ix->obj, LV_EVENT_VALUE_CHANGED, NULL);
+}
+
+/*Called with the GUI lock held, so the widget does not read while the file is renamed.
+ *FatFs does not rename over an existing file.*/
+static void pager_index_commit(text_pager_index_t * ix)
+{
+    if(!ix->persist) return;
+
+    remove(ix->index_path);
+    if(rename(ix->build_path, ix->index_path) == 0) {
+        ix->read_path = ix->index_path;
+    }
+    else {
+        ESP_LOGW(PAGER_TAG, "%s not renamed to %s, not kept", ix->build_path, ix->index_path);
+    }
+}
+
+/*Called with the GUI lock held*/
+static void pager_index_detach(text_pager_index_t * ix)
+{
+    if(ix->running) {
+        /*The worker stops at the next page and frees it*/
+        ix->cancel = true;
+    }
+    else {
+        pager_index_free(ix);
+    }
+}
+
+static void pager_index_free(text_pager_index_t * ix)
+{
+    /*What a cancelled or failed worker wrote*/
+    if(ix->build_path && ix->read_path != ix->index_path) remove(ix->build_path);
+    free(ix->path);
+    free(ix->index_path);
+    free(ix->build_path);
+    free(ix);
+}
+
+static char * pager_strdup(const char * s)
+{
+    char * d = (char *)malloc(strlen(s) + 1);
+    if(d) strcpy(d, s);
+
+    return d;
+}
@@ -0,0 +1,221 @@
+/* Demo benchmark: the bring-up of guiTask in main.cpp on a display without a panel, running each
+ * LVGL demo enabled in menuconfig (widgets, benchmark, stress) for BENCH_FRAMES frames.
+ * The display of bench_display.h is RGB332 with one partial buffer of DISP_BUF_SIZE, and LVGL
+ * uses the heap of the sdkconfig. The flush copies the areas into a framebuffer. The tick advances BENCH_TICK_MS per
+ * frame instead of following the clock, so every run renders the same frames and only the time
+ * changes.
+ * Per demo it records the time of each lv_timer_handler() call that flushed, the flushed pixels
+ * and the refreshes. The results are printed as JSON between BENCH_DEMOS lines.
+ * scripts/bench_demos.py shows a report, or compares two with a threshold for regressions.
+ * Built for the IDF linux target (idf.py --preview set-target linux) it runs on the host and
+ * writes bench-demos.json as well. The host has no epaper driver, so it uses the 960x540 panel
+ * of the epdiy boards with 1/10 of it as the buffer, like the examples.
+ * Select this file in main/CMakeLists.txt
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "lvgl.h"
+#include "demos/lv_demos.h"
+#define BENCH_DISPLAY_PANEL 1
+#include "bench_display.h"
+
+extern "C"
+{
+    void app_main();
+}
+
+#define BENCH_FRAMES 300
+#define BENCH_TICK_MS LV_DEF_REFR_PERIOD
+#define BENCH_JSON_PATH "bench-demos.json"
+
+typedef struct {
+    const char * name;
+    void (*create)(void);
+} bench_demo_t;
+
+typedef struct {
+    const char * name;
+    uint32_t create_us;
+    uint32_t flushes;
+    uint64_t flushed_px;
+    uint32_t refreshes;
+    uint32_t rendered;              /* Frames that flushed, the ones in frame_us */
+    uint64_t total_us;
+    uint32_t min_us, p50_us, p95_us, max_us;
+    uint32_t heap_total, heap_max_used;
+    uint32_t frame_us[BENCH_FRAMES];
+} bench_result_t;
+
+#if !CONFIG_LV_USE_DEMO_WIDGETS && !CONFIG_LV_USE_DEMO_BENCHMARK && !CONFIG_LV_USE_DEMO_STRESS
+#error "No demo application selected."
+#endif
+
+static const bench_demo_t demos[] = {
+#if CONFIG_LV_USE_DEMO_WIDGETS
+    {"widgets", lv_demo_widgets},
+#endif
+#if CONFIG_LV_USE_DEMO_BENCHMARK
+    {"benchmark", lv_demo_benchmark},
+#endif
+#if CONFIG_LV_USE_DEMO_STRESS
+    {"stress", lv_demo_stress},
+#endif
+};
+#define BENCH_DEMOS (sizeof(demos) / sizeof(demos[0]))
+
+static bench_result_t results[BENCH_DEMOS];
+static bench_result_t * current;
+static uint32_t sorted[BENCH_FRAMES];
+static uint8_t * fb;
+
+/* The framebuffer, in PSRAM like the one of epdiy */
+static uint8_t * bench_alloc(size_t size)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    return (uint8_t *)malloc(size);
+#else
+    return (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+#endif
+}
+
+static void bench_flush_cb(lv_display_t * disp, const lv_area_t * area, uint8_t * px_map)
+{
+    int32_t w = lv_area_get_width(area);
+
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        memcpy(fb + (size_t)y * BENCH_HOR_RES + area->x1, px_map, w);
+        px_map += w;
+    }
+    current->flushes++;
+    current->flushed_px += (uint64_t)w * lv_area_get_height(area);
+    if (lv_display_flush_is_last(disp)) {
+        current->refreshes++;
+    }
+    lv_display_flush_ready(disp);
+}
+
+static int cmp_u32(const void * a, const void * b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* As guiTask brings LVGL up, then BENCH_FRAMES frames of the demo */
+static void bench_demo(const bench_demo_t * demo, bench_result_t * r)
+{
+    current = r;
+    r->name = demo->name;
+    lv_init();
+    lv_display_t * disp = bench_display_create(bench_flush_cb);
+
+    int64_t start = esp_timer_get_time();
+    demo->create();
+    r->create_us = esp_timer_get_time() - start;
+
+    for (uint32_t i = 0; i < BENCH_FRAMES; i++) {
+        uint32_t flushes = r->flushes;
+        lv_tick_inc(BENCH_TICK_MS);
+        start = esp_timer_get_time();
+        lv_timer_handler();
+        uint32_t us = esp_timer_get_time() - start;
+        if (r->flushes != flushes) {
+            r->frame_us[r->rendered++] = us;
+            r->total_us += us;
+        }
+    }
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    r->heap_total = mon.total_size;
+    r->heap_max_used = mon.max_used;
+    lv_display_delete(disp);
+    lv_deinit();
+
+    if (r->rendered) {
+        memcpy(sorted, r->frame_us, r->rendered * sizeof(uint32_t));
+        qsort(sorted, r->rendered, sizeof(uint32_t), cmp_u32);
+        r->min_us = sorted[0];
+        r->p50_us = sorted[(r->rendered - 1) * 50 / 100];
+        r->p95_us = sorted[(r->rendered - 1) * 95 / 100];
+        r->max_us = sorted[r->rendered - 1];
+    }
+}
+
+static void print_json(FILE * f)
+{
+    fprintf(f, "{\n  \"bench\": \"demos\",\n  \"version\": 1,\n  \"target\": \"%s\",\n  \"lvgl\": \"%d.%d.%d\",\n",
+            CONFIG_IDF_TARGET, LVGL_VERSION_MAJOR, LVGL_VERSION_MINOR, LVGL_VERSION_PATCH);
+    fprintf(f, "  \"display\": {\"hor_res\": %d, \"ver_res\": %d, \"color_format\": \"RGB332\", "
+            "\"buf_size\": %d, \"render_mode\": \"partial\"},\n", BENCH_HOR_RES, BENCH_VER_RES, BENCH_BUF_SIZE);
+    fprintf(f, "  \"frames\": %d,\n  \"tick_ms\": %d,\n  \"scenarios\": [\n", BENCH_FRAMES, BENCH_TICK_MS);
+    for (size_t i = 0; i < BENCH_DEMOS; i++) {
+        const bench_result_t * r = &results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"create_us\": %u, \"rendered\": %u, \"refreshes\": %u, \"flushes\": %u, "
+                "\"flushed_px\": %llu,\n", r->name, (unsigned)r->create_us, (unsigned)r->rendered,
+                (unsigned)r->refreshes, (unsigned)r->flushes, (unsigned long long)r->flushed_px);
+        fprintf(f, "     \"render_us\": {\"total\": %llu, \"avg\": %u, \"min\": %u, \"p50\": %u, \"p95\": %u, "
+                "\"max\": %u},\n", (unsigned long long)r->total_us,
+                (unsigned)(r->rendered ? r->total_us / r->rendered : 0), (unsigned)r->min_us, (unsigned)r->p50_us,
+                (unsigned)r->p95_us, (unsigned)r->max_us);
+        fprintf(f, "     \"heap\": {\"total\": %u, \"max_used\": %u},\n", (unsigned)r->heap_total,
+                (unsigned)r->heap_max_used);
+        fprintf(f, "     \"frame_us\": [");
+        for (uint32_t j = 0; j < r->rendered; j++) {
+            fprintf(f, "%s%u", j ? ", " : "", (unsigned)r->frame_us[j]);
+        }
+        fprintf(f, "]}%s\n", i + 1 < BENCH_DEMOS ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+/* Rendering needs the stack of guiTask */
+static void bench_task(void * arg)
+{
+    fb = bench_alloc((size_t)BENCH_HOR_RES * BENCH_VER_RES);
+    if (bench_display_alloc() == NULL || fb == NULL) {
+        printf("No memory for the draw buffer and the framebuffer\n");
+        free(fb);
+        vTaskDelete(NULL);
+    }
+
+    printf("%dx%d RGB332, buffer %d B, %d frames of %d ms\n", BENCH_HOR_RES, BENCH_VER_RES, BENCH_BUF_SIZE,
+           BENCH_FRAMES, BENCH_TICK_MS);
+    printf("%-10s | %9s | %6s %9s %10s | %8s %8s %8s %8s | %7s\n", "demo", "create us", "frames", "refreshes",
+           "flushed px", "avg us", "p50 us", "p95 us", "max us", "heap KB");
+    for (size_t i = 0; i < BENCH_DEMOS; i++) {
+        bench_result_t * r = &results[i];
+        bench_demo(&demos[i], r);
+        printf("%-10s | %9u | %6u %9u %10llu | %8u %8u %8u %8u | %7u\n", r->name, (unsigned)r->create_us,
+               (unsigned)r->rendered, (unsigned)r->refreshes, (unsigned long long)r->flushed_px,
+               (unsigned)(r->rendered ? r->total_us / r->rendered : 0), (unsigned)r->p50_us, (unsigned)r->p95_us,
+               (unsigned)r->max_us, (unsigned)(r->heap_max_used / 1024));
+    }
+
+    printf("BENCH_DEMOS begin\n");
+    print_json(stdout);
+    printf("BENCH_DEMOS end\n");
+#if CONFIG_IDF_TARGET_LINUX
+    FILE * f = fopen(BENCH_JSON_PATH, "w");
+    if (f) {
+        print_json(f);
+        fclose(f);
+        printf("Wrote %s\n", BENCH_JSON_PATH);
+    }
+#endif
+    free(fb);
+#if CONFIG_IDF_TARGET_LINUX
+    exit(0);
+#endif
+    vTaskDelete(NULL);
+}
+
+void app_main()
+{
+    /* As main.cpp creates guiTask */
+    xTaskCreatePinnedToCore(bench_task, "gui", 4096*2, NULL, 0, NULL, 1);
+}
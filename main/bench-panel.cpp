@@ -0,0 +1,141 @@
+/* Panel flush benchmark: the kernels of components/panel_profile built for each panel profile
+ * against panel::generic_flush(), which maps, checks and converts every pixel at run time.
+ * Per profile and rotation an RGB332 screen is written into the panel framebuffer in the areas
+ * LVGL flushes: strips of the full width, 1/10 of the screen as the examples set the partial
+ * buffers, and 120x48 areas of a button. Both framebuffers are compared after each run.
+ * Built for the IDF linux target (idf.py --preview set-target linux) it measures the host,
+ * on the board the buffers are in PSRAM like the LVGL draw buffers and the epdiy framebuffer.
+ * Select this file in main/CMakeLists.txt, panel_profile is required with it
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "panel_profile.hpp"
+
+extern "C"
+{
+    void app_main();
+}
+
+#define BENCH_RUNS 5
+#define BENCH_BUTTON_W 120
+#define BENCH_BUTTON_H 48
+
+using panel::Rotation;
+
+static uint8_t * bench_alloc(size_t size)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    return (uint8_t *)malloc(size);
+#else
+    return (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+#endif
+}
+
+static void print_row(const char * name, const char * rot, const char * areas, uint64_t px, int64_t generic_us,
+                      int64_t profile_us, bool same)
+{
+    printf("%-12s %4s %-7s | %7.2f %8.1f | %7.2f %8.1f | %5.1fx %s\n", name, rot, areas,
+           generic_us * 1000.0 / px, (double)px / generic_us, profile_us * 1000.0 / px, (double)px / profile_us,
+           (double)generic_us / profile_us, same ? "same" : "DIFFERENT");
+}
+
+/* One screen in strips of the full width, or in button sized areas, BENCH_RUNS times */
+template <class K, bool BUTTONS>
+static uint64_t bench_areas(const uint8_t * src, uint8_t * fb, bool generic, int64_t * us)
+{
+    constexpr panel::Desc desc = panel::describe<typename K::profile>();
+    constexpr int32_t strip_h = K::ver_res / 10;
+    uint64_t px = 0;
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t run = 0; run < BENCH_RUNS; run++) {
+        if (BUTTONS) {
+            for (int32_t y = 0; y + BENCH_BUTTON_H <= K::ver_res; y += BENCH_BUTTON_H) {
+                for (int32_t x = 0; x + BENCH_BUTTON_W <= K::hor_res; x += BENCH_BUTTON_W) {
+                    if (generic) {
+                        panel::generic_flush(desc, K::rotation, x, y, x + BENCH_BUTTON_W - 1,
+                                             y + BENCH_BUTTON_H - 1, src, fb);
+                    } else {
+                        K::flush(x, y, x + BENCH_BUTTON_W - 1, y + BENCH_BUTTON_H - 1, src, fb);
+                    }
+                    px += BENCH_BUTTON_W * BENCH_BUTTON_H;
+                }
+            }
+        } else {
+            for (int32_t y = 0; y < K::ver_res; y += strip_h) {
+                int32_t y2 = y + strip_h - 1 < K::ver_res ? y + strip_h - 1 : K::ver_res - 1;
+                if (generic) {
+                    panel::generic_flush(desc, K::rotation, 0, y, K::hor_res - 1, y2, src, fb);
+                } else {
+                    K::flush(0, y, K::hor_res - 1, y2, src, fb);
+                }
+                px += (uint64_t)K::hor_res * (y2 - y + 1);
+            }
+        }
+    }
+    *us = esp_timer_get_time() - start;
+    return px;
+}
+
+template <class K>
+static void bench_panel(const char * rot)
+{
+    using P = typename K::profile;
+    int64_t generic_us, profile_us;
+
+    /* A strip of noise, every area reads it from the start */
+    size_t src_size = (size_t)K::hor_res * (K::ver_res / 10 + 1);
+    uint8_t * src = bench_alloc(src_size);
+    uint8_t * fb_generic = bench_alloc(P::size);
+    uint8_t * fb_profile = bench_alloc(P::size);
+    if (src == NULL || fb_generic == NULL || fb_profile == NULL) {
+        printf("%-12s %4s no memory for %u KB\n", P::name, rot, (unsigned)((src_size + 2 * P::size) / 1024));
+        free(src);
+        free(fb_generic);
+        free(fb_profile);
+        return;
+    }
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < src_size; i++) {
+        seed = seed * 1103515245 + 12345;
+        src[i] = seed >> 16;
+    }
+
+    memset(fb_generic, 0, P::size);
+    memset(fb_profile, 0, P::size);
+    uint64_t px = bench_areas<K, false>(src, fb_generic, true, &generic_us);
+    bench_areas<K, false>(src, fb_profile, false, &profile_us);
+    print_row(P::name, rot, "strips", px, generic_us, profile_us, memcmp(fb_generic, fb_profile, P::size) == 0);
+
+    px = bench_areas<K, true>(src, fb_generic, true, &generic_us);
+    bench_areas<K, true>(src, fb_profile, false, &profile_us);
+    print_row(P::name, rot, "buttons", px, generic_us, profile_us, memcmp(fb_generic, fb_profile, P::size) == 0);
+
+    free(src);
+    free(fb_generic);
+    free(fb_profile);
+}
+
+template <class P>
+static void bench_profile(void)
+{
+    bench_panel<panel::Panel<P, Rotation::R0>>("0");
+    bench_panel<panel::Panel<P, Rotation::R90>>("90");
+    bench_panel<panel::Panel<P, Rotation::R180>>("180");
+    bench_panel<panel::Panel<P, Rotation::R270>>("270");
+}
+
+void app_main()
+{
+    printf("RGB332 into the panel framebuffer, %d runs, ns per pixel and Mpx/s\n", BENCH_RUNS);
+    printf("%-12s %4s %-7s | %16s | %16s |\n", "panel", "rot", "areas", "generic", "profile");
+    bench_profile<panel::ED047TC1>();
+    bench_profile<panel::ED097OC4>();
+    bench_profile<panel::ED060SC4>();
+    bench_profile<panel::SharpLS027>();
+    bench_profile<panel::Kaleido>();
+}
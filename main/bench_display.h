@@ -0,0 +1,65 @@
+/* The display of the benches, without a panel behind it: RGB332 with one partial buffer, as
+ * guiTask in main.cpp sets it up. It is the 960x540 panel of the epdiy boards with 1/10 of it as
+ * the buffer, like the examples, so the numbers of two boards compare. A bench that defines
+ * BENCH_DISPLAY_PANEL to 1 before the include gets the panel of menuconfig on the board instead.
+ * The buffer is allocated once, where guiTask puts it, and kept for the displays created after
+ * an lv_deinit().
+ */
+#ifndef BENCH_DISPLAY_H
+#define BENCH_DISPLAY_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "esp_heap_caps.h"
+#include "lvgl.h"
+
+#if BENCH_DISPLAY_PANEL && !CONFIG_IDF_TARGET_LINUX
+#include "lvgl_helpers.h"
+#define BENCH_HOR_RES DISPLAY_WIDTH
+#define BENCH_VER_RES DISPLAY_HEIGHT
+#define BENCH_BUF_SIZE DISP_BUF_SIZE
+#else
+#define BENCH_HOR_RES 960
+#define BENCH_VER_RES 540
+#define BENCH_BUF_SIZE (BENCH_HOR_RES * BENCH_VER_RES / 10)
+#endif
+
+static uint8_t * bench_display_buf;
+
+/* Nothing to send the pixels to, the area is done at once */
+static inline void bench_null_flush_cb(lv_display_t * disp, const lv_area_t * area, uint8_t * px_map)
+{
+    LV_UNUSED(area);
+    LV_UNUSED(px_map);
+    lv_display_flush_ready(disp);
+}
+
+/* The draw buffer of BENCH_BUF_SIZE bytes, NULL when there is no memory for it */
+static inline uint8_t * bench_display_alloc(void)
+{
+    if (bench_display_buf == NULL) {
+#if CONFIG_IDF_TARGET_LINUX
+        bench_display_buf = (uint8_t *)malloc(BENCH_BUF_SIZE);
+#else
+        bench_display_buf = (uint8_t *)heap_caps_malloc(BENCH_BUF_SIZE, MALLOC_CAP_8BIT);
+#endif
+    }
+    return bench_display_buf;
+}
+
+/* The display of BENCH_HOR_RES x BENCH_VER_RES, flushed by flush_cb or the null flush when it is
+ * NULL. Call it after lv_init(). NULL when there is no memory for the buffer */
+static inline lv_display_t * bench_display_create(lv_display_flush_cb_t flush_cb)
+{
+    if (bench_display_alloc() == NULL) {
+        return NULL;
+    }
+
+    lv_display_t * disp = lv_display_create(BENCH_HOR_RES, BENCH_VER_RES);
+    lv_display_set_color_format(disp, LV_COLOR_FORMAT_RGB332);
+    lv_display_set_flush_cb(disp, flush_cb ? flush_cb : bench_null_flush_cb);
+    lv_display_set_buffers(disp, bench_display_buf, NULL, BENCH_BUF_SIZE, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    return disp;
+}
+
+#endif /* BENCH_DISPLAY_H */
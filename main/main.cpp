@@ -33,6 +33,7 @@
 #endif
 
 #include "lvgl_helpers.h"
+#include "perf_iram.h"
 
 //#ifndef CONFIG_LV_TFT_DISPLAY_MONOCHROME
     #if defined CONFIG_LV_USE_DEMO_WIDGETS
@@ -141,6 +142,9 @@ static void guiTask(void *pvParameter) {
     ESP_ERROR_CHECK(esp_timer_create(&periodic_timer_args, &periodic_timer));
     ESP_ERROR_CHECK(esp_timer_start_periodic(periodic_timer, LV_TICK_PERIOD_MS * 1000));
 
+    /* Frame times, and the profile in the profile build: see components/perf_iram */
+    ESP_ERROR_CHECK(perf_iram_start(disp));
+
     /* Create the demo application */
     create_demo_application();
     /* Force screen refresh */
@@ -0,0 +1,264 @@
+/* GT911 read benchmark: I2C transactions, bytes and bus time per sample in legacy and burst
+ * read mode, and the maximum sample rate the bus can sustain.
+ * First a simulated GT911 (mock panel IO, no hardware) replays idle, one finger and two finger
+ * phases, polled at and above the controller report rate. Then the real controller is measured
+ * when one answers on the bus: touch the panel during the "touched" run.
+ * Select this file in main/CMakeLists.txt, the clock is CONFIG_TOUCH_I2C_CLK_HZ.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/i2c.h"
+#include "esp_timer.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_io_interface.h"
+#include "esp_lcd_touch_gt911.h"
+
+#define SDA_PIN  CONFIG_TOUCH_I2C_SDA
+#define SCL_PIN  CONFIG_TOUCH_I2C_SCL
+#define I2C_PORT ((i2c_port_t)CONFIG_TOUCH_I2C_PORT)
+
+#define REAL_SAMPLES 500
+
+/* Simulated GT911 register window 0x8040..0x817F */
+#define MOCK_REG_BASE 0x8040
+#define MOCK_REG_SIZE 0x140
+
+typedef struct {
+    esp_lcd_panel_io_t base;
+    uint8_t regs[MOCK_REG_SIZE];
+    uint32_t transactions;
+    uint32_t bytes;
+    uint64_t bits;
+} mock_gt911_t;
+
+typedef struct {
+    uint16_t samples;
+    uint8_t points;     // Fingers on the panel
+    uint8_t ready_div;  // A new report every n samples, 0: never
+    const char *name;
+} phase_t;
+
+/* Polled at the report rate (ready_div 1) and at twice the report rate (ready_div 2),
+ * where every other read finds no new report */
+static const phase_t scenario[] = {
+    {200, 0, 0, "idle"},
+    { 60, 1, 1, "one finger"},
+    {  1, 0, 1, "release"},
+    {100, 0, 0, "idle"},
+    {120, 1, 2, "one finger, fast poll"},
+    {  1, 0, 1, "release"},
+    {100, 0, 0, "idle"},
+    { 60, 2, 1, "two fingers"},
+    {  1, 0, 1, "release"},
+    {100, 0, 0, "idle"},
+};
+
+typedef struct {
+    uint32_t samples;
+    uint32_t transactions;
+    uint32_t bytes;
+    uint64_t bits;
+    int64_t cpu_us;
+} bench_result_t;
+
+// I2C frame: START, address, 16 bit register, (RESTART, address, data | data), STOP; 9 clocks per byte
+static esp_err_t mock_rx_param(esp_lcd_panel_io_t *io, int lcd_cmd, void *param, size_t param_size)
+{
+    mock_gt911_t *mock = __containerof(io, mock_gt911_t, base);
+    int off = lcd_cmd - MOCK_REG_BASE;
+
+    if (off < 0 || off + param_size > MOCK_REG_SIZE) {
+        memset(param, 0, param_size);
+    } else {
+        memcpy(param, &mock->regs[off], param_size);
+    }
+    mock->transactions++;
+    mock->bytes += 4 + param_size;
+    mock->bits += (4 + param_size) * 9 + 3;
+    return ESP_OK;
+}
+
+static esp_err_t mock_tx_param(esp_lcd_panel_io_t *io, int lcd_cmd, const void *param, size_t param_size)
+{
+    mock_gt911_t *mock = __containerof(io, mock_gt911_t, base);
+    int off = lcd_cmd - MOCK_REG_BASE;
+
+    if (off >= 0 && off + param_size <= MOCK_REG_SIZE) {
+        memcpy(&mock->regs[off], param, param_size);
+    }
+    mock->transactions++;
+    mock->bytes += 3 + param_size;
+    mock->bits += (3 + param_size) * 9 + 2;
+    return ESP_OK;
+}
+
+static esp_err_t mock_del(esp_lcd_panel_io_t *io)
+{
+    return ESP_OK;
+}
+
+static void mock_report(mock_gt911_t *mock, uint8_t points, uint32_t t)
+{
+    uint8_t *st = &mock->regs[0x814E - MOCK_REG_BASE];
+
+    st[0] = 0x80 | points;
+    for (int i = 0; i < points; i++) {
+        uint8_t *p = &st[1 + i * 8];
+        uint16_t x = 100 + i * 200 + (t % 300);
+        uint16_t y = 300 + i * 50;
+        p[0] = i;                   // Track id
+        p[1] = x & 0xff;
+        p[2] = x >> 8;
+        p[3] = y & 0xff;
+        p[4] = y >> 8;
+        p[5] = 30;                  // Size
+        p[6] = 0;
+        p[7] = 0;
+    }
+}
+
+static bench_result_t bench_mock(esp_lcd_touch_handle_t tp, mock_gt911_t *mock, bool touched, int *errors)
+{
+    bench_result_t res = {0};
+    uint32_t t = 0;
+
+    mock->transactions = 0;
+    mock->bytes = 0;
+    mock->bits = 0;
+    for (int ph = 0; ph < sizeof(scenario) / sizeof(scenario[0]); ph++) {
+        const phase_t *p = &scenario[ph];
+        if ((p->points > 0 || p->ready_div) != touched) {
+            continue;
+        }
+        for (int s = 0; s < p->samples; s++, t++) {
+            bool ready = (p->ready_div && (s % p->ready_div) == 0);
+            if (ready) {
+                mock_report(mock, p->points, t);
+            }
+
+            int64_t start = esp_timer_get_time();
+            esp_lcd_touch_read_data(tp);
+            res.cpu_us += esp_timer_get_time() - start;
+            res.samples++;
+
+            uint16_t x[5], y[5];
+            uint8_t cnt = 0;
+            esp_lcd_touch_get_coordinates(tp, x, y, NULL, &cnt, 5);
+            if (ready && (cnt != p->points || (cnt > 0 && x[0] != 100 + (t % 300)))) {
+                (*errors)++;
+            }
+        }
+    }
+    res.transactions = mock->transactions;
+    res.bytes = mock->bytes;
+    res.bits = mock->bits;
+    return res;
+}
+
+static void print_result(const char *mode, const char *load, const bench_result_t *r)
+{
+    uint32_t bus_us = (uint32_t)((r->bits * 1000000ULL) / CONFIG_TOUCH_I2C_CLK_HZ / r->samples);
+    printf("%-6s %-8s %5.2f trans %5.1f bytes %6lu us bus %5lu us cpu  max %5lu Hz\n", mode, load,
+           (float)r->transactions / r->samples, (float)r->bytes / r->samples, (unsigned long)bus_us,
+           (unsigned long)(r->cpu_us / r->samples), (unsigned long)(bus_us ? 1000000 / bus_us : 0));
+}
+
+static void run_mock(void)
+{
+    static mock_gt911_t mock;
+    esp_lcd_touch_handle_t tp = NULL;
+    esp_lcd_touch_config_t tp_cfg = {
+        .x_max = 1024,
+        .y_max = 768,
+        .rst_gpio_num = -1,
+        .int_gpio_num = -1,
+    };
+
+    mock.base.rx_param = mock_rx_param;
+    mock.base.tx_param = mock_tx_param;
+    mock.base.del = mock_del;
+    memcpy(&mock.regs[0x8140 - MOCK_REG_BASE], "911", 3);
+    esp_lcd_touch_new_i2c_gt911(&mock.base, &tp_cfg, &tp);
+
+    printf("\nSimulated GT911, bus time at %d Hz (CPU time excludes the bus)\n", CONFIG_TOUCH_I2C_CLK_HZ);
+    const char *names[] = {"burst", "legacy"};
+    for (int mode = 0; mode < 2; mode++) {
+        int errors = 0;
+        esp_lcd_touch_gt911_set_read_mode(tp, (esp_lcd_touch_gt911_read_mode_t)mode);
+        bench_result_t idle = bench_mock(tp, &mock, false, &errors);
+        bench_result_t touched = bench_mock(tp, &mock, true, &errors);
+        print_result(names[mode], "idle", &idle);
+        print_result(names[mode], "touched", &touched);
+        if (errors) {
+            printf("%s: %d samples with wrong points!\n", names[mode], errors);
+        }
+    }
+    esp_lcd_touch_del(tp);
+}
+
+static void run_real(void)
+{
+    const i2c_config_t i2c_conf = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = SDA_PIN,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_io_num = SCL_PIN,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = CONFIG_TOUCH_I2C_CLK_HZ
+    };
+    i2c_param_config(I2C_PORT, &i2c_conf);
+    if (i2c_driver_install(I2C_PORT, i2c_conf.mode, 0, 0, 0) != ESP_OK) {
+        printf("I2C driver install failed\n");
+        return;
+    }
+
+    esp_lcd_panel_io_handle_t io = NULL;
+    esp_lcd_panel_io_i2c_config_t io_cfg = ESP_LCD_TOUCH_IO_I2C_GT911_CONFIG();
+    esp_lcd_new_panel_io_i2c((esp_lcd_i2c_bus_handle_t)I2C_PORT, &io_cfg, &io);
+
+    uint8_t id[3];
+    if (esp_lcd_panel_io_rx_param(io, 0x8140, id, 3) != ESP_OK) {
+        printf("\nNo GT911 at 0x%02x, real device run skipped\n", ESP_LCD_TOUCH_IO_I2C_GT911_ADDRESS);
+        return;
+    }
+
+    esp_lcd_touch_handle_t tp = NULL;
+    esp_lcd_touch_config_t tp_cfg = {
+        .x_max = 1024,
+        .y_max = 768,
+        .rst_gpio_num = -1,
+        .int_gpio_num = -1,
+    };
+    esp_lcd_touch_new_i2c_gt911(io, &tp_cfg, &tp);
+
+    printf("\nReal GT911 at %d Hz, %d back to back samples per run\n", CONFIG_TOUCH_I2C_CLK_HZ, REAL_SAMPLES);
+    const char *names[] = {"burst", "legacy"};
+    for (int load = 0; load < 2; load++) {
+        printf(load ? "Touch and move on the panel now\n" : "Do not touch the panel\n");
+        vTaskDelay(pdMS_TO_TICKS(3000));
+        for (int mode = 0; mode < 2; mode++) {
+            int touched = 0;
+            esp_lcd_touch_gt911_set_read_mode(tp, (esp_lcd_touch_gt911_read_mode_t)mode);
+            int64_t start = esp_timer_get_time();
+            for (int s = 0; s < REAL_SAMPLES; s++) {
+                uint16_t x[5], y[5];
+                uint8_t cnt = 0;
+                esp_lcd_touch_read_data(tp);
+                touched += esp_lcd_touch_get_coordinates(tp, x, y, NULL, &cnt, 5);
+            }
+            int64_t us = (esp_timer_get_time() - start) / REAL_SAMPLES;
+            printf("%-6s %-8s %6ld us per sample  max %5ld Hz  (%d reports)\n", names[mode], load ? "touched" : "idle",
+                   (long)us, (long)(us ? 1000000 / us : 0), touched);
+        }
+    }
+    esp_lcd_touch_del(tp);
+}
+
+void app_main()
+{
+    printf("GT911 read benchmark\n");
+    run_mock();
+    run_real();
+}
@@ -0,0 +1,238 @@
+/* Replays a recorded GT911 drag through the esp_lcd_touch jitter filter into LVGL and counts
+ * what it costs to draw. The pointer drags a knob, as a slider or a scrolled list follow the
+ * finger, on the display of bench_display.h. Per run: the pointer moves LVGL read, the areas
+ * the knob invalidated, the refreshes that flushed and the flushed pixels. On epaper each
+ * refresh is a slow update of the panel, the filter saves the ones of a resting finger.
+ * Then two fingers crossing, matched to their tracks by the track id of the controller as the
+ * GT911 reports it, and by distance as for controllers without ids.
+ * No touch hardware is needed: select this file in main/CMakeLists.txt and flash.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lvgl.h"
+#include "esp_lcd_touch_filter.h"
+#include "bench_display.h"
+
+#define TRACE_X_MAX 1024
+#define TRACE_Y_MAX 768
+
+typedef struct {
+    uint16_t t_ms;
+    uint16_t x;
+    uint16_t y;
+} trace_sample_t;
+
+/* GT911 on a 4.7" panel sampled every 20 ms: rest, slow drag, rest, fast drag, rest */
+static const trace_sample_t drag_trace[] = {
+    {   0, 120, 299}, {  20, 121, 298}, {  40, 118, 302}, {  60, 118, 300},
+    {  80, 122, 298}, { 100, 122, 299}, { 120, 118, 298}, { 140, 121, 301},
+    { 160, 118, 299}, { 180, 118, 302}, { 200, 121, 298}, { 220, 122, 298},
+    { 240, 119, 302}, { 260, 118, 302}, { 280, 122, 301}, { 300, 121, 299},
+    { 320, 124, 302}, { 340, 128, 300}, { 360, 133, 299}, { 380, 137, 298},
+    { 400, 140, 300}, { 420, 143, 299}, { 440, 142, 302}, { 460, 149, 299},
+    { 480, 150, 298}, { 500, 155, 298}, { 520, 158, 298}, { 540, 161, 299},
+    { 560, 163, 302}, { 580, 166, 300}, { 600, 169, 302}, { 620, 172, 300},
+    { 640, 174, 299}, { 660, 176, 299}, { 680, 178, 302}, { 700, 183, 302},
+    { 720, 187, 300}, { 740, 190, 300}, { 760, 194, 298}, { 780, 193, 302},
+    { 800, 199, 299}, { 820, 201, 299}, { 840, 205, 301}, { 860, 205, 298},
+    { 880, 212, 302}, { 900, 213, 300}, { 920, 216, 302}, { 940, 220, 302},
+    { 960, 223, 298}, { 980, 223, 300}, {1000, 229, 298}, {1020, 229, 300},
+    {1040, 236, 301}, {1060, 237, 301}, {1080, 240, 298}, {1100, 241, 300},
+    {1120, 239, 302}, {1140, 238, 301}, {1160, 238, 299}, {1180, 240, 299},
+    {1200, 239, 301}, {1220, 241, 301}, {1240, 238, 299}, {1260, 241, 301},
+    {1280, 242, 300}, {1300, 239, 301}, {1320, 242, 300}, {1340, 241, 300},
+    {1360, 241, 299}, {1380, 239, 298}, {1400, 257, 295}, {1420, 275, 291},
+    {1440, 292, 289}, {1460, 314, 283}, {1480, 330, 280}, {1500, 346, 275},
+    {1520, 367, 274}, {1540, 384, 270}, {1560, 404, 264}, {1580, 419, 262},
+    {1600, 440, 254}, {1620, 457, 254}, {1640, 475, 249}, {1660, 493, 245},
+    {1680, 508, 241}, {1700, 529, 234}, {1720, 545, 230}, {1740, 563, 229},
+    {1760, 581, 222}, {1780, 600, 222}, {1800, 598, 218}, {1820, 598, 222},
+    {1840, 599, 222}, {1860, 598, 220}, {1880, 602, 218}, {1900, 598, 219},
+    {1920, 602, 221}, {1940, 599, 220}, {1960, 600, 222}, {1980, 600, 221},
+    {2000, 598, 218}, {2020, 601, 221}, {2040, 601, 221}, {2060, 600, 218},
+    {2080, 599, 218},
+};
+#define TRACE_LEN (sizeof(drag_trace) / sizeof(drag_trace[0]))
+
+#define KNOB_SIZE 40
+/* Two fingers crossing, as in a pinch that overshoots: 14 px per 20 ms sample each */
+#define CROSS_SAMPLES 31
+#define CROSS_STEP 14
+
+typedef struct {
+    int moves;              // Pointer moves LVGL read
+    int invalidations;      // Areas invalidated on the display
+    int refreshes;          // Refreshes that flushed something
+    uint64_t flushed_px;
+    int max_lag;            // Worst distance from the raw point, in px
+} replay_result_t;
+
+static replay_result_t result;
+static esp_lcd_touch_filter_handle_t replay_filter;
+static int replay_sample;
+static lv_point_t last_point;
+
+static void replay_flush_cb(lv_display_t * disp, const lv_area_t * area, uint8_t * px_map)
+{
+    result.flushed_px += (uint64_t)lv_area_get_width(area) * lv_area_get_height(area);
+    if (lv_display_flush_is_last(disp)) {
+        result.refreshes++;
+    }
+    lv_display_flush_ready(disp);
+}
+
+static void replay_invalidate_cb(lv_event_t * e)
+{
+    result.invalidations++;
+}
+
+/* What esp_lcd_touch_get_coordinates() returns for the sample of the moment */
+static void replay_read_cb(lv_indev_t * indev, lv_indev_data_t * data)
+{
+    const trace_sample_t * s = &drag_trace[replay_sample];
+    uint16_t x = s->x;
+    uint16_t y = s->y;
+
+    if (replay_filter) {
+        esp_lcd_touch_filter_process(replay_filter, &x, &y, NULL, 1, TRACE_X_MAX, TRACE_Y_MAX, (int64_t)s->t_ms * 1000);
+    }
+    int lag = abs((int)x - (int)s->x) + abs((int)y - (int)s->y);
+    if (lag > result.max_lag) {
+        result.max_lag = lag;
+    }
+    if (x != last_point.x || y != last_point.y) {
+        result.moves++;
+    }
+    last_point.x = x;
+    last_point.y = y;
+
+    data->point = last_point;
+    data->state = LV_INDEV_STATE_PRESSED;
+}
+
+/* The knob follows the finger, it invalidates its old and new area when it moves */
+static void knob_pressing_cb(lv_event_t * e)
+{
+    lv_obj_t * knob = (lv_obj_t *)lv_event_get_target(e);
+    lv_point_t p;
+
+    lv_indev_get_point(lv_indev_active(), &p);
+    lv_obj_set_pos(knob, p.x - KNOB_SIZE / 2, p.y - KNOB_SIZE / 2);
+}
+
+static replay_result_t replay(esp_lcd_touch_filter_handle_t filter)
+{
+    memset(&result, 0, sizeof(result));
+    replay_filter = filter;
+    replay_sample = 0;
+    last_point.x = drag_trace[0].x;
+    last_point.y = drag_trace[0].y;
+
+    lv_init();
+    lv_display_t * disp = bench_display_create(replay_flush_cb);
+    if (disp == NULL) {
+        printf("No memory for the draw buffer\n");
+        lv_deinit();
+        return result;
+    }
+    lv_obj_remove_flag(lv_screen_active(), LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_t * knob = lv_obj_create(lv_screen_active());
+    lv_obj_set_size(knob, KNOB_SIZE, KNOB_SIZE);
+    lv_obj_set_pos(knob, last_point.x - KNOB_SIZE / 2, last_point.y - KNOB_SIZE / 2);
+    lv_obj_remove_flag(knob, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(knob, knob_pressing_cb, LV_EVENT_PRESSING, NULL);
+    lv_indev_t * indev = lv_indev_create();
+    lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_read_cb(indev, replay_read_cb);
+
+    /* The screen as it is before the finger comes down is not counted */
+    lv_refr_now(disp);
+    memset(&result, 0, sizeof(result));
+    lv_display_add_event_cb(disp, replay_invalidate_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+
+    /* LVGL reads the pointer and refreshes at its own periods, as in guiTask */
+    for (replay_sample = 0; replay_sample < TRACE_LEN; replay_sample++) {
+        if (replay_sample > 0) {
+            lv_tick_inc(drag_trace[replay_sample].t_ms - drag_trace[replay_sample - 1].t_ms);
+        }
+        lv_timer_handler();
+    }
+
+    lv_deinit();
+    return result;
+}
+
+static void print_result(const char * name, const replay_result_t * res, const replay_result_t * raw)
+{
+    printf("%-15s | %5d %13d %9d %10llu | %4d%% | %7d\n", name, res->moves, res->invalidations, res->refreshes,
+           (unsigned long long)res->flushed_px,
+           raw->refreshes ? 100 - res->refreshes * 100 / raw->refreshes : 0, res->max_lag);
+}
+
+/* Worst lag of two fingers crossing, the points listed left to right as the controller does */
+static int replay_crossing(esp_lcd_touch_filter_handle_t filter, bool by_id)
+{
+    int max_lag = 0;
+
+    esp_lcd_touch_filter_reset(filter);
+    for (int i = 0; i < CROSS_SAMPLES; i++) {
+        uint16_t ax = 300 + i * CROSS_STEP;
+        uint16_t bx = 720 - i * CROSS_STEP;
+        int first = (ax > bx);
+        uint16_t x[2], y[2], raw_x[2];
+        uint8_t id[2];
+
+        x[first] = ax;
+        y[first] = 300;
+        id[first] = 0;
+        x[!first] = bx;
+        y[!first] = 310;
+        id[!first] = 1;
+        raw_x[0] = x[0];
+        raw_x[1] = x[1];
+        esp_lcd_touch_filter_process(filter, x, y, by_id ? id : NULL, 2, TRACE_X_MAX, TRACE_Y_MAX, (int64_t)i * 20000);
+        for (int p = 0; p < 2; p++) {
+            int lag = abs((int)x[p] - (int)raw_x[p]);
+            if (lag > max_lag) {
+                max_lag = lag;
+            }
+        }
+    }
+    return max_lag;
+}
+
+void app_main() {
+    esp_lcd_touch_filter_config_t cfg = ESP_LCD_TOUCH_FILTER_DEFAULT_CONFIG();
+    esp_lcd_touch_filter_handle_t filter;
+    ESP_ERROR_CHECK(esp_lcd_touch_filter_new(&cfg, &filter));
+
+    printf("Replaying %d samples on %dx%d, a %d px knob follows the pointer\n", (int)TRACE_LEN, BENCH_HOR_RES,
+           BENCH_VER_RES, KNOB_SIZE);
+    printf("%-15s | %5s %13s %9s %10s | %5s | %7s\n", "", "moves", "invalidations", "refreshes", "flushed px", "saved",
+           "max lag");
+    replay_result_t raw = replay(NULL);
+    print_result("raw", &raw, &raw);
+
+    replay_result_t res = replay(filter);
+    print_result("filter", &res, &raw);
+
+    /* Parameters can be changed at runtime */
+    cfg.predict_ms = 20;
+    esp_lcd_touch_filter_set_config(filter, &cfg);
+    esp_lcd_touch_filter_reset(filter);
+    res = replay(filter);
+    print_result("filter+predict", &res, &raw);
+
+    cfg.predict_ms = 0;
+    esp_lcd_touch_filter_set_config(filter, &cfg);
+    printf("\nTwo fingers crossing, max lag: %dpx by track id, %dpx by distance\n", replay_crossing(filter, true),
+           replay_crossing(filter, false));
+
+    esp_lcd_touch_filter_del(filter);
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+}
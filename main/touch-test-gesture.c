@@ -0,0 +1,123 @@
+/* Replays recorded multi-touch traces (GT911, 5" panel) through the esp_lcd_touch
+ * gesture recogniser and checks the recognised gestures. No touch hardware is needed:
+ * select this file in main/CMakeLists.txt and flash, or build it for the IDF linux target
+ * (idf.py --preview set-target linux) and run it on the host. There it exits with the
+ * number of failed traces, so a script can run it.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_lcd_touch_gesture.h"
+
+typedef struct {
+    uint16_t t_ms;
+    uint8_t points;
+    uint16_t x0, y0;
+    uint16_t x1, y1;
+} trace_sample_t;
+
+static const trace_sample_t trace_tap[] = {
+    {   0, 1, 399, 301,   0,   0}, {  15, 1, 401, 299,   0,   0}, {  30, 1, 400, 301,   0,   0},
+    {  45, 1, 400, 301,   0,   0}, {  60, 1, 401, 299,   0,   0}, { 120, 0,   0,   0,   0,   0},
+};
+static const trace_sample_t trace_double_tap[] = {
+    {   0, 1, 401, 299,   0,   0}, {  15, 1, 400, 300,   0,   0}, {  30, 1, 401, 299,   0,   0},
+    {  45, 1, 399, 301,   0,   0}, {  60, 1, 400, 301,   0,   0}, { 105, 0,   0,   0,   0,   0},
+    { 210, 1, 404, 302,   0,   0}, { 225, 1, 403, 303,   0,   0}, { 240, 1, 402, 301,   0,   0},
+    { 255, 1, 404, 301,   0,   0}, { 270, 1, 404, 302,   0,   0}, { 330, 0,   0,   0,   0,   0},
+};
+static const trace_sample_t trace_long_press[] = {
+    {   0, 1, 201, 499,   0,   0}, {  30, 1, 201, 499,   0,   0}, {  60, 1, 199, 501,   0,   0},
+    {  90, 1, 199, 500,   0,   0}, { 120, 1, 199, 500,   0,   0}, { 150, 1, 200, 501,   0,   0},
+    { 180, 1, 201, 500,   0,   0}, { 210, 1, 201, 500,   0,   0}, { 240, 1, 200, 501,   0,   0},
+    { 270, 1, 201, 500,   0,   0}, { 300, 1, 199, 500,   0,   0}, { 330, 1, 199, 499,   0,   0},
+    { 360, 1, 199, 500,   0,   0}, { 390, 1, 199, 500,   0,   0}, { 420, 1, 201, 500,   0,   0},
+    { 450, 1, 201, 500,   0,   0}, { 480, 1, 200, 501,   0,   0}, { 510, 1, 200, 501,   0,   0},
+    { 540, 1, 200, 501,   0,   0}, { 570, 1, 201, 500,   0,   0}, { 600, 1, 201, 499,   0,   0},
+    { 630, 1, 200, 501,   0,   0}, { 660, 1, 199, 500,   0,   0}, { 690, 1, 201, 501,   0,   0},
+    { 720, 1, 201, 499,   0,   0}, { 750, 1, 201, 500,   0,   0}, { 780, 1, 201, 501,   0,   0},
+    { 810, 1, 201, 499,   0,   0}, { 840, 1, 201, 501,   0,   0}, { 870, 1, 199, 501,   0,   0},
+    { 945, 0,   0,   0,   0,   0},
+};
+static const trace_sample_t trace_swipe_left[] = {
+    {   0, 1, 701, 400,   0,   0}, {  20, 1, 667, 400,   0,   0}, {  40, 1, 633, 402,   0,   0},
+    {  60, 1, 602, 403,   0,   0}, {  80, 1, 567, 404,   0,   0}, { 100, 1, 534, 405,   0,   0},
+    { 120, 1, 501, 405,   0,   0}, { 140, 1, 469, 407,   0,   0}, { 160, 1, 436, 407,   0,   0},
+    { 180, 1, 402, 410,   0,   0}, { 225, 0,   0,   0,   0,   0},
+};
+static const trace_sample_t trace_pinch_out[] = {
+    {   0, 2, 451, 399, 550, 401}, {  20, 2, 444, 400, 558, 400}, {  40, 2, 437, 399, 563, 400},
+    {  60, 2, 428, 399, 570, 401}, {  80, 2, 423, 399, 577, 400}, { 100, 2, 415, 401, 585, 399},
+    { 120, 2, 409, 399, 592, 400}, { 140, 2, 401, 399, 599, 400}, { 160, 2, 394, 401, 606, 401},
+    { 180, 2, 388, 401, 614, 399}, { 200, 2, 381, 401, 620, 400}, { 220, 2, 374, 401, 628, 399},
+    { 265, 0,   0,   0,   0,   0},
+};
+static const trace_sample_t trace_two_finger_up[] = {
+    {   0, 2, 450, 600, 560, 601}, {  20, 2, 450, 576, 560, 574}, {  40, 2, 450, 551, 560, 549},
+    {  60, 2, 450, 526, 561, 526}, {  80, 2, 449, 499, 561, 501}, { 100, 2, 450, 475, 560, 476},
+    { 120, 2, 450, 451, 561, 450}, { 140, 2, 451, 425, 559, 426}, { 160, 2, 449, 401, 559, 400},
+    { 180, 2, 450, 376, 560, 375}, { 200, 2, 451, 351, 560, 349}, { 220, 2, 450, 324, 560, 325},
+    { 265, 0,   0,   0,   0,   0},
+};
+
+typedef struct {
+    const char *name;
+    const trace_sample_t *samples;
+    int len;
+    uint8_t expect_type;    // Last gesture the trace must produce
+    uint8_t expect_dir;
+} trace_case_t;
+
+#define TRACE(n, type, dir) { #n, trace_##n, sizeof(trace_##n) / sizeof(trace_sample_t), type, dir }
+
+static const trace_case_t cases[] = {
+    TRACE(tap, ESP_LCD_TOUCH_GESTURE_TAP, ESP_LCD_TOUCH_GESTURE_DIR_NONE),
+    TRACE(double_tap, ESP_LCD_TOUCH_GESTURE_DOUBLE_TAP, ESP_LCD_TOUCH_GESTURE_DIR_NONE),
+    TRACE(long_press, ESP_LCD_TOUCH_GESTURE_LONG_PRESS, ESP_LCD_TOUCH_GESTURE_DIR_NONE),
+    TRACE(swipe_left, ESP_LCD_TOUCH_GESTURE_SWIPE, ESP_LCD_TOUCH_GESTURE_DIR_LEFT),
+    TRACE(pinch_out, ESP_LCD_TOUCH_GESTURE_PINCH, ESP_LCD_TOUCH_GESTURE_DIR_NONE),
+    TRACE(two_finger_up, ESP_LCD_TOUCH_GESTURE_TWO_FINGER_SWIPE, ESP_LCD_TOUCH_GESTURE_DIR_UP),
+};
+
+static const char *gesture_names[] = {
+    "none", "tap", "double tap", "long press", "swipe", "pinch", "two finger swipe"
+};
+
+void app_main() {
+    esp_lcd_touch_gesture_config_t cfg = ESP_LCD_TOUCH_GESTURE_DEFAULT_CONFIG();
+    cfg.queue_len = 0;
+    int failed = 0;
+
+    for (int c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        esp_lcd_touch_gesture_handle_t gesture;
+        esp_lcd_touch_gesture_event_t events[2];
+        esp_lcd_touch_gesture_event_t last = {0};
+        ESP_ERROR_CHECK(esp_lcd_touch_gesture_new(&cfg, &gesture));
+
+        for (int i = 0; i < cases[c].len; i++) {
+            const trace_sample_t *s = &cases[c].samples[i];
+            uint16_t x[2] = { s->x0, s->x1 };
+            uint16_t y[2] = { s->y0, s->y1 };
+            uint8_t n = esp_lcd_touch_gesture_process(gesture, x, y, s->points, (int64_t)s->t_ms * 1000, events, 2);
+            for (int e = 0; e < n && e < 2; e++) {
+                printf("  %-14s t:%4d %s dir:%d value:%d at %d,%d\n", cases[c].name, s->t_ms,
+                       gesture_names[events[e].type], events[e].dir, events[e].value, events[e].x, events[e].y);
+                last = events[e];
+            }
+        }
+
+        bool ok = (last.type == cases[c].expect_type && last.dir == cases[c].expect_dir);
+        printf("%s %s\n", ok ? "PASS" : "FAIL", cases[c].name);
+        failed += !ok;
+        esp_lcd_touch_gesture_del(gesture);
+    }
+
+    printf("\n%d of %d traces failed\n", failed, (int)(sizeof(cases) / sizeof(cases[0])));
+#if CONFIG_IDF_TARGET_LINUX
+    exit(failed);
+#endif
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+}
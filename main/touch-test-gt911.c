@@ -5,9 +5,9 @@
 #include "driver/i2c.h"
 #include "esp_lcd_touch_gt911.h"
 #include "esp_log.h"
-#define SDA_PIN  GPIO_NUM_39
-#define SCL_PIN  GPIO_NUM_40
-#define I2C_PORT I2C_NUM_0
+#define SDA_PIN  CONFIG_TOUCH_I2C_SDA
+#define SCL_PIN  CONFIG_TOUCH_I2C_SCL
+#define I2C_PORT ((i2c_port_t)CONFIG_TOUCH_I2C_PORT)
 
 // When the touch panel has different pixels definition
 float x_adjust = 1.55;
@@ -21,7 +21,7 @@ esp_err_t i2c_init(void)
         .sda_pullup_en = GPIO_PULLUP_ENABLE,
         .scl_io_num = SCL_PIN,
         .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = 50000
+        .master.clk_speed = CONFIG_TOUCH_I2C_CLK_HZ
     };
     i2c_param_config(I2C_PORT, &i2c_conf);
 
@@ -43,7 +43,7 @@ void i2cscan() {
         i2c_master_start(cmd);
         i2c_master_write_byte(cmd, (i << 1) | I2C_MASTER_WRITE, 1);
         i2c_master_stop(cmd);
-        ret = i2c_master_cmd_begin(I2C_NUM_0, cmd, 100 / portTICK_RATE_MS);
+        ret = i2c_master_cmd_begin(I2C_PORT, cmd, 100 / portTICK_RATE_MS);
         i2c_cmd_link_delete(cmd);
     
         char * device;
@@ -72,7 +72,7 @@ void i2cscan() {
     }
 }
 void app_main() {
-    printf("GT911 test SDA:%d SCL:%d GPIO_NUM_NC:%d\n",SDA_PIN,SCL_PIN,GPIO_NUM_NC);
+    printf("GT911 test SDA:%d SCL:%d GPIO_NUM_NC:%d I2C:%d Hz\n",SDA_PIN,SCL_PIN,GPIO_NUM_NC,CONFIG_TOUCH_I2C_CLK_HZ);
     i2c_init();
 
     esp_lcd_panel_io_handle_t tp_io_handle = NULL;
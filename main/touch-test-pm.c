@@ -0,0 +1,85 @@
+/* Touch power manager test on the Kindle TMA445 board: samples at 100 Hz while touched, 10 Hz
+ * when idle and puts the controller to sleep after 10 s without touch. INT wakes it.
+ * Prints the time in each state and the latency of the first touch after sleep every 10 s.
+ */
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/i2c.h"
+#include "esp_timer.h"
+#include "esp_lcd_panel_io.h"
+#include "touch_tma445.h"
+#include "esp_lcd_touch_pm.h"
+
+#define SDA_PIN  CONFIG_TOUCH_I2C_SDA
+#define SCL_PIN  CONFIG_TOUCH_I2C_SCL
+#define TS_INT   GPIO_NUM_3
+#define TS_RES   GPIO_NUM_9
+#define I2C_PORT ((i2c_port_t)CONFIG_TOUCH_I2C_PORT)
+
+static const char *state_names[] = {"active", "idle", "sleep"};
+
+static void print_stats(esp_lcd_touch_pm_handle_t pm)
+{
+    esp_lcd_touch_pm_stats_t st;
+    esp_lcd_touch_pm_get_stats(pm, &st);
+
+    for (int s = 0; s < ESP_LCD_TOUCH_PM_STATE_MAX; s++) {
+        printf("%-6s %7llu ms %6lu samples\n", state_names[s], st.state_us[s] / 1000, (unsigned long)st.samples[s]);
+    }
+    printf("sleeps:%lu wakeups:%lu wake latency last:%lu us max:%lu us\n\n", (unsigned long)st.sleeps,
+           (unsigned long)st.wakeups, (unsigned long)st.wake_latency_us, (unsigned long)st.wake_latency_max_us);
+}
+
+void app_main()
+{
+    printf("Touch power manager test SDA:%d SCL:%d INT:%d I2C:%d Hz\n", SDA_PIN, SCL_PIN, TS_INT, CONFIG_TOUCH_I2C_CLK_HZ);
+
+    const i2c_config_t i2c_conf = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = SDA_PIN,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_io_num = SCL_PIN,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = CONFIG_TOUCH_I2C_CLK_HZ
+    };
+    i2c_param_config(I2C_PORT, &i2c_conf);
+    i2c_driver_install(I2C_PORT, i2c_conf.mode, 0, 0, 0);
+
+    esp_lcd_panel_io_handle_t io = NULL;
+    esp_lcd_panel_io_i2c_config_t io_cfg = ESP_LCD_TOUCH_IO_I2C_TMA445_CONFIG();
+    esp_lcd_new_panel_io_i2c((esp_lcd_i2c_bus_handle_t)I2C_PORT, &io_cfg, &io);
+
+    esp_lcd_touch_handle_t tp;
+    esp_lcd_touch_config_t tp_cfg = {
+        .x_max = 758,
+        .y_max = 1024,
+        .rst_gpio_num = TS_RES,
+        .int_gpio_num = TS_INT,
+        .levels = {
+            .reset = 0,
+            .interrupt = 0,
+        },
+    };
+    ESP_ERROR_CHECK(esp_lcd_touch_new_i2c_tma445(io, &tp_cfg, &tp));
+
+    esp_lcd_touch_pm_handle_t pm;
+    esp_lcd_touch_pm_config_t pm_cfg = ESP_LCD_TOUCH_PM_DEFAULT_CONFIG();
+    ESP_ERROR_CHECK(esp_lcd_touch_pm_new(tp, &pm_cfg, &pm));
+
+    int64_t next_print = esp_timer_get_time() + 10000000;
+    while (true) {
+        esp_lcd_touch_pm_read_data(pm);
+
+        uint16_t x[2], y[2];
+        uint8_t cnt = 0;
+        if (esp_lcd_touch_get_coordinates(tp, x, y, NULL, &cnt, 2)) {
+            printf("x:%d y:%d count:%d\n", x[0], y[0], cnt);
+        }
+        // While sleeping read_data blocks, stats are printed after the next wake
+        if (esp_timer_get_time() > next_print) {
+            print_stats(pm);
+            next_print = esp_timer_get_time() + 10000000;
+        }
+    }
+}
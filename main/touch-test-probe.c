@@ -0,0 +1,110 @@
+/* Touch controller auto-probe test. Prints the boot time spent finding the controller:
+ *  1. Full address scan as in touch-test.c (every address, 100 ms timeout)
+ *  2. Cold probe of the known addresses (cache cleared)
+ *  3. Cached probe in a background task, as on every later boot
+ */
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/i2c.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "touch_probe.h"
+
+#define SDA_PIN  CONFIG_TOUCH_I2C_SDA
+#define SCL_PIN  CONFIG_TOUCH_I2C_SCL
+#define TS_RES   GPIO_NUM_NC
+#define TS_INT   GPIO_NUM_NC
+#define I2C_PORT ((i2c_port_t)CONFIG_TOUCH_I2C_PORT)
+
+static uint32_t full_scan(void)
+{
+    int found = 0;
+    int64_t start = esp_timer_get_time();
+
+    for (uint8_t i = 1; i < 127; i++) {
+        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, (i << 1) | I2C_MASTER_WRITE, 1);
+        i2c_master_stop(cmd);
+        if (i2c_master_cmd_begin(I2C_PORT, cmd, 100 / portTICK_PERIOD_MS) == ESP_OK) {
+            found++;
+        }
+        i2c_cmd_link_delete(cmd);
+    }
+    printf("Full scan: %d devices\n", found);
+
+    return (uint32_t)(esp_timer_get_time() - start);
+}
+
+static void release(touch_probe_result_t *res)
+{
+    if (res->tp) {
+        esp_lcd_touch_del(res->tp);
+    }
+    if (res->io) {
+        esp_lcd_panel_io_del(res->io);
+    }
+}
+
+void app_main()
+{
+    printf("Touch probe test SDA:%d SCL:%d I2C:%d Hz\n", SDA_PIN, SCL_PIN, CONFIG_TOUCH_I2C_CLK_HZ);
+
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        nvs_flash_init();
+    }
+
+    const i2c_config_t i2c_conf = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = SDA_PIN,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_io_num = SCL_PIN,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = CONFIG_TOUCH_I2C_CLK_HZ
+    };
+    i2c_param_config(I2C_PORT, &i2c_conf);
+    i2c_driver_install(I2C_PORT, i2c_conf.mode, 0, 0, 0);
+
+    touch_probe_config_t cfg = TOUCH_PROBE_DEFAULT_CONFIG();
+    cfg.port = I2C_PORT;
+    cfg.touch.x_max = 1024;
+    cfg.touch.y_max = 768;
+    cfg.touch.rst_gpio_num = TS_RES;
+    cfg.touch.int_gpio_num = TS_INT;
+
+    uint32_t scan_us = full_scan();
+
+    touch_probe_result_t cold;
+    touch_probe_forget();
+    ret = touch_probe_new(&cfg, &cold);
+    printf("Cold probe: %s (%s) at 0x%02x\n", touch_probe_chip_name(cold.chip), esp_err_to_name(ret), cold.addr);
+    release(&cold);
+
+    touch_probe_result_t warm;
+    int64_t start = esp_timer_get_time();
+    touch_probe_start(&cfg);
+    int64_t blocked = esp_timer_get_time() - start;
+    // Display init would run here
+    ret = touch_probe_wait(portMAX_DELAY, &warm);
+    printf("Cached probe: %s (%s) at 0x%02x from cache:%d\n", touch_probe_chip_name(warm.chip), esp_err_to_name(ret),
+           warm.addr, warm.from_cache);
+
+    printf("\nBoot cost to find the controller\n");
+    printf("full scan    %8lu us\n", (unsigned long)scan_us);
+    printf("cold probe   %8lu us (driver init included: %lu us)\n", (unsigned long)cold.probe_us, (unsigned long)cold.total_us);
+    printf("cached probe %8lu us (driver init included: %lu us, caller blocked %ld us)\n", (unsigned long)warm.probe_us,
+           (unsigned long)warm.total_us, (long)blocked);
+
+    while (warm.tp) {
+        uint16_t x[1], y[1];
+        uint8_t cnt = 0;
+        esp_lcd_touch_read_data(warm.tp);
+        if (esp_lcd_touch_get_coordinates(warm.tp, x, y, NULL, &cnt, 1)) {
+            printf("x:%d y:%d\n", x[0], y[0]);
+        }
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+}
@@ -7,10 +7,10 @@
 #include "esp_lcd_touch_tt21100.h"
 #include "esp_log.h"
 
-#define SDA_PIN  GPIO_NUM_39
-#define SCL_PIN  GPIO_NUM_40
+#define SDA_PIN  CONFIG_TOUCH_I2C_SDA
+#define SCL_PIN  CONFIG_TOUCH_I2C_SCL
 // Only for I2C scanner
-#define I2C_PORT I2C_NUM_0
+#define I2C_PORT ((i2c_port_t)CONFIG_TOUCH_I2C_PORT)
 
 #define I2C_MASTER_FREQ_HZ 20000                      /*!< I2C master clock frequency */
 #define I2C_SCLK_SRC_FLAG_FOR_NOMAL       (0)         /*!< Any one clock source that is available for the specified frequency may be choosen*/
@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+"""Build the asset pack the firmware maps from the "assets" partition (lv_asset_pack.h).
+
+The manifest is JSON, paths are relative to it:
+
+    {
+      "assets": [
+        {"name": "logo", "type": "image", "file": "logo.png", "format": "RGB332"},
+        {"name": "icon_dir", "type": "image", "file": "dir.png", "format": "A8"},
+        {"name": "ui", "type": "font", "file": "DejaVuSans.ttf", "size": 20, "bpp": 4,
+         "range": [32, 126]},
+        {"name": "help", "type": "raw", "file": "help.txt"}
+      ]
+    }
+
+Image formats are RGB332, L8 and A8 (from the alpha channel). Fonts have one range of
+consecutive code points, 1, 2, 4 or 8 bpp. Names are up to 15 characters.
+
+    python scripts/asset_pack.py assets.json -o build/assets.bin
+    parttool.py write_partition --partition-name assets --input build/assets.bin
+
+--c-out also writes the pack as a C array, to compare with assets compiled into the app
+(main/File_explorer/bench-assets.cpp picks it up as asset_pack_data.c next to it).
+Copied to the SD card as ASSETS.EPK the benchmark also loads it into PSRAM.
+"""
+import argparse
+import json
+import os
+import struct
+import sys
+import zlib
+
+from PIL import Image, ImageFont
+
+MAGIC = 0x4B415045  # "EPAK"
+VERSION = 1
+ALIGN = 64
+NAME_MAX = 15
+
+HEADER = struct.Struct('<IHHII')
+ENTRY = struct.Struct('<16sBBBBIIHHHHhHI')
+
+TYPE_IMAGE, TYPE_FONT, TYPE_RAW = 1, 2, 3
+FORMATS = {'RGB332': 1, 'L8': 2, 'A8': 3}
+
+
+def align(n, to):
+    return (n + to - 1) // to * to
+
+
+def entry(name, typ, blob, cf=0, bpp=0, w=0, h=0, stride=0, line_height=0, base_line=0,
+          glyph_count=0, range_start=0):
+    return {'name': name, 'type': typ, 'blob': blob, 'fields': (cf, bpp, w, h, stride, line_height,
+                                                                 base_line, glyph_count, range_start)}
+
+
+def convert_image(name, path, fmt):
+    img = Image.open(path)
+    w, h = img.size
+    if fmt == 'RGB332':
+        # Same bits as lv_color_format RGB332: RRRGGGBB
+        px = img.convert('RGB').tobytes()
+        data = bytes((px[i] & 0xE0) | ((px[i + 1] & 0xE0) >> 3) | (px[i + 2] >> 6)
+                     for i in range(0, len(px), 3))
+    elif fmt == 'L8':
+        px = img.convert('RGB').tobytes()
+        data = bytes((77 * px[i] + 150 * px[i + 1] + 29 * px[i + 2]) >> 8 for i in range(0, len(px), 3))
+    elif fmt == 'A8':
+        data = img.convert('RGBA').getchannel('A').tobytes()
+    else:
+        sys.exit('%s: unknown format %s, use %s' % (name, fmt, ', '.join(FORMATS)))
+    return entry(name, TYPE_IMAGE, data, cf=FORMATS[fmt], w=w, h=h, stride=w)
+
+
+def pack_bits(values, bpp):
+    """Pixels one after the other, rows not padded, the first pixel in the high bits"""
+    out = bytearray()
+    acc = 0
+    bits = 0
+    for v in values:
+        acc = (acc << bpp) | (v >> (8 - bpp))
+        bits += bpp
+        if bits == 8:
+            out.append(acc)
+            acc = 0
+            bits = 0
+    if bits:
+        out.append(acc << (8 - bits))
+    return bytes(out)
+
+
+def convert_font(name, path, size, bpp, first, last):
+    """lv_font_fmt_txt layout: 8 byte glyph descriptions from glyph id 0 (unused), then the bitmaps"""
+    if bpp not in (1, 2, 4, 8):
+        sys.exit('%s: bpp is 1, 2, 4 or 8' % name)
+    font = ImageFont.truetype(path, size)
+    ascent, descent = font.getmetrics()
+    dscs = [struct.pack('<IBBbb', 0, 0, 0, 0, 0)]
+    bitmaps = bytearray()
+
+    for cp in range(first, last + 1):
+        ch = chr(cp)
+        adv_w = min(int(round(font.getlength(ch) * 16)), 0xFFF)
+        x0, y0, x1, y1 = font.getbbox(ch, anchor='ls')
+        box_w, box_h = max(x1 - x0, 0), max(y1 - y0, 0)
+        if box_w > 255 or box_h > 255:
+            sys.exit('%s: glyph U+%04X is larger than 255 px' % (name, cp))
+        index = len(bitmaps)
+        if index >= 1 << 20:
+            sys.exit('%s: more than 1 MB of glyph bitmaps' % name)
+        if box_w and box_h:
+            mask = font.getmask(ch, mode='L', anchor='ls')
+            # The mask is cropped to the ink, (x0, y0) is its place from the origin
+            glyph = Image.new('L', (box_w, box_h))
+            glyph.im.paste(mask, (0, 0, mask.size[0], mask.size[1]))
+            bitmaps += pack_bits(glyph.tobytes(), bpp)
+        else:
+            box_w = box_h = 0
+        # LVGL: ofs_y from the base line up to the bottom of the box
+        dscs.append(struct.pack('<IBBbb', index | (adv_w << 20), box_w, box_h, x0, -y1))
+
+    blob = b''.join(dscs) + bytes(bitmaps)
+    return entry(name, TYPE_FONT, blob, bpp=bpp, line_height=ascent + descent, base_line=descent,
+                 glyph_count=last - first + 1, range_start=first)
+
+
+def build(manifest_path):
+    base = os.path.dirname(os.path.abspath(manifest_path))
+    with open(manifest_path) as f:
+        manifest = json.load(f)
+
+    entries = []
+    for a in manifest['assets']:
+        name = a['name']
+        if len(name.encode()) > NAME_MAX:
+            sys.exit('%s: names are up to %d characters' % (name, NAME_MAX))
+        if any(e['name'] == name for e in entries):
+            sys.exit('%s: name used twice' % name)
+        path = os.path.join(base, a['file'])
+        if a['type'] == 'image':
+            entries.append(convert_image(name, path, a.get('format', 'RGB332')))
+        elif a['type'] == 'font':
+            first, last = a.get('range', [32, 126])
+            entries.append(convert_font(name, path, a['size'], a.get('bpp', 4), first, last))
+        elif a['type'] == 'raw':
+            with open(path, 'rb') as f:
+                entries.append(entry(name, TYPE_RAW, f.read()))
+        else:
+            sys.exit('%s: unknown type %s' % (name, a['type']))
+
+    offset = align(HEADER.size + ENTRY.size * len(entries), ALIGN)
+    index = bytearray()
+    for e in entries:
+        e['offset'] = offset
+        cf, bpp, w, h, stride, line_height, base_line, glyph_count, range_start = e['fields']
+        index += ENTRY.pack(e['name'].encode(), e['type'], cf, bpp, 0, offset, len(e['blob']), w, h, stride,
+                            line_height, base_line, glyph_count, range_start)
+        offset = align(offset + len(e['blob']), ALIGN)
+
+    pack = bytearray(offset)
+    pack[0:HEADER.size] = HEADER.pack(MAGIC, VERSION, len(entries), offset, zlib.crc32(index))
+    pack[HEADER.size:HEADER.size + len(index)] = index
+    for e in entries:
+        pack[e['offset']:e['offset'] + len(e['blob'])] = e['blob']
+    return bytes(pack), entries
+
+
+def write_c(path, pack):
+    with open(path, 'w') as f:
+        f.write('/* Generated by scripts/asset_pack.py, the asset pack compiled into the app */\n')
+        f.write('#include <stdint.h>\n\n')
+        f.write('const uint32_t asset_pack_data_size = %d;\n' % len(pack))
+        f.write('const uint8_t asset_pack_data[] __attribute__((aligned(4))) = {\n')
+        for i in range(0, len(pack), 16):
+            f.write('    ' + ', '.join('0x%02x' % b for b in pack[i:i + 16]) + ',\n')
+        f.write('};\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('manifest', help='JSON manifest')
+    parser.add_argument('-o', '--output', required=True, help='pack to write to the partition')
+    parser.add_argument('--c-out', help='also write the pack as a C array')
+    parser.add_argument('--partition-size', type=lambda s: int(s, 0), default=0xF0000,
+                        help='size of the assets partition in partitions.csv')
+    args = parser.parse_args()
+
+    pack, entries = build(args.manifest)
+    if len(pack) > args.partition_size:
+        sys.exit('The pack is %d bytes, the partition %d' % (len(pack), args.partition_size))
+    with open(args.output, 'wb') as f:
+        f.write(pack)
+    if args.c_out:
+        write_c(args.c_out, pack)
+
+    for e in entries:
+        print('%-15s %-5s %8d bytes at 0x%06x' % (e['name'], ('image', 'font', 'raw')[e['type'] - 1],
+                                                  len(e['blob']), e['offset']))
+    print('%d assets, %d bytes of %d' % (len(entries), len(pack), args.partition_size))
+
+
+if __name__ == '__main__':
+    main()
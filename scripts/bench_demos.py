@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Show and compare the reports of main/bench-demos.cpp.
+
+A report is the JSON the bench prints between the "BENCH_DEMOS begin" and "BENCH_DEMOS end"
+lines, and writes to bench-demos.json on the host. It is read from that file or from the last
+report of a console log.
+
+    python scripts/bench_demos.py show bench-demos.json
+    python scripts/bench_demos.py compare base.json new.json --threshold 10
+
+compare exits with 1 when the render time (avg or p95) of a demo, or its flushed pixels, grew
+by more than --threshold percent. The tick of the bench does not follow the clock, so two runs
+of the same build flush the same pixels. Only the times change.
+"""
+import argparse
+import json
+import sys
+
+BEGIN = 'BENCH_DEMOS begin'
+END = 'BENCH_DEMOS end'
+VERSION = 1
+# (key, from the render_us times) the regressions are checked on
+CHECKED = (('avg', True), ('p95', True), ('flushed_px', False))
+SHOWN = ('avg', 'p50', 'p95', 'max')
+
+
+def load(path):
+    with open(path, 'rb') as f:
+        text = f.read().decode('utf-8', 'replace')
+    if not text.lstrip().startswith('{'):
+        # A log: the report is between the last markers
+        start = text.rfind(BEGIN)
+        end = text.find(END, start)
+        if start < 0 or end < 0:
+            sys.exit('%s: no report and no %s line' % (path, BEGIN))
+        text = text[start + len(BEGIN):end]
+    report = json.loads(text)
+    if report.get('bench') != 'demos' or report.get('version') != VERSION:
+        sys.exit('%s: not a version %d demos report' % (path, VERSION))
+    return report
+
+
+def setup(report):
+    d = report['display']
+    return '%dx%d %s, buffer %d B %s, %d frames of %d ms, LVGL %s on %s' % (
+        d['hor_res'], d['ver_res'], d['color_format'], d['buf_size'], d['render_mode'], report['frames'],
+        report['tick_ms'], report['lvgl'], report['target'])
+
+
+def value(scenario, key, timed):
+    return scenario['render_us'][key] if timed else scenario[key]
+
+
+def show(report):
+    print(setup(report))
+    print('%-10s %9s %7s %9s %11s' % ('demo', 'create us', 'frames', 'refreshes', 'flushed px')
+          + ''.join('%9s' % ('%s us' % k) for k in SHOWN) + '%9s' % 'heap KB')
+    for s in report['scenarios']:
+        print('%-10s %9d %7d %9d %11d' % (s['name'], s['create_us'], s['rendered'], s['refreshes'], s['flushed_px'])
+              + ''.join('%9d' % s['render_us'][k] for k in SHOWN) + '%9d' % (s['heap']['max_used'] // 1024))
+
+
+def compare(base, new, threshold):
+    if setup(base) != setup(new):
+        print('warning: the runs differ\n  base: %s\n  new:  %s' % (setup(base), setup(new)))
+    old = {s['name']: s for s in base['scenarios']}
+    regressions = 0
+    print('%-10s %-10s %12s %12s %9s' % ('demo', '', 'base', 'new', 'change'))
+    for s in new['scenarios']:
+        b = old.pop(s['name'], None)
+        if b is None:
+            print('%-10s only in the new run' % s['name'])
+            continue
+        for key, timed in CHECKED:
+            was, now = value(b, key, timed), value(s, key, timed)
+            change = 100.0 * (now - was) / was if was else 0.0
+            flag = change > threshold
+            regressions += flag
+            print('%-10s %-10s %12d %12d %+8.1f%%%s' % (s['name'], key + (' us' if timed else ''), was, now, change,
+                                                        '  REGRESSION' if flag else ''))
+    for name in old:
+        print('%-10s only in the base run' % name)
+    if regressions:
+        print('%d regressions over %.1f %%' % (regressions, threshold))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n', 1)[0])
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    s = sub.add_parser('show', help='print a report')
+    s.add_argument('report')
+    c = sub.add_parser('compare', help='compare a report with a base one')
+    c.add_argument('base')
+    c.add_argument('new')
+    c.add_argument('--threshold', type=float, default=10.0, help='percent of growth that is a regression')
+    args = parser.parse_args()
+    if args.cmd == 'show':
+        show(load(args.report))
+    elif compare(load(args.base), load(args.new), args.threshold):
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
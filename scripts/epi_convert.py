@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""Convert images to EPI, the panel-native image of the explorer (lv_epi_loader.h).
+
+EPI is a 16 byte header, then the rows in the pixel format of the panel, each row packed
+with PackBits on its own:
+
+    magic "EPI", version 1, u16 width, u16 height, u8 format (1 RGB332, 2 GRAY4),
+    u8 compression (0 none, 1 PackBits), u16 reserved, u32 bytes after the header
+
+GRAY4 has two pixels a byte, the left one in the high nibble, 0 black to 15 white.
+Images are scaled down to fit --fit, keeping the aspect ratio, never up.
+
+    python scripts/epi_convert.py photos/*.jpg -o /media/sd --format gray4 --dither
+
+The output is named like the input with the .EPI extension, 8.3 names stay 8.3.
+"""
+import argparse
+import os
+import struct
+import sys
+
+from PIL import Image
+
+HEADER = struct.Struct('<3sBHHBBHI')
+VERSION = 1
+FORMATS = {'rgb332': 1, 'gray4': 2}
+
+
+def packbits(row):
+    """Runs of 3 or more equal bytes as (257 - n, byte), the rest as (n - 1, bytes), n up to 128"""
+    out = bytearray()
+    i = 0
+    n = len(row)
+    while i < n:
+        run = 1
+        while i + run < n and run < 128 and row[i + run] == row[i]:
+            run += 1
+        if run >= 3:
+            out += bytes((257 - run, row[i]))
+            i += run
+            continue
+        start = i
+        while i < n and i - start < 128:
+            if i + 2 < n and row[i] == row[i + 1] == row[i + 2]:
+                break
+            i += 1
+        out.append(i - start - 1)
+        out += row[start:i]
+    return bytes(out)
+
+
+def rgb332_rows(img):
+    px = img.convert('RGB').tobytes()
+    w = img.size[0]
+    data = bytes((px[i] & 0xE0) | ((px[i + 1] & 0xE0) >> 3) | (px[i + 2] >> 6) for i in range(0, len(px), 3))
+    return [data[y * w:(y + 1) * w] for y in range(img.size[1])]
+
+
+def gray4_rows(img, dither):
+    gray = img.convert('L')
+    if dither:
+        # Error diffusion to the 16 levels the panel shows
+        pal = Image.new('P', (1, 1))
+        pal.putpalette([v * 17 for v in range(16) for _ in range(3)] + [0] * (256 - 16) * 3)
+        levels = gray.convert('RGB').quantize(palette=pal, dither=Image.Dither.FLOYDSTEINBERG).tobytes()
+    else:
+        levels = bytes((v * 15 + 127) // 255 for v in gray.tobytes())
+    w, h = gray.size
+    rows = []
+    for y in range(h):
+        line = levels[y * w:(y + 1) * w] + (b'\0' if w & 1 else b'')
+        rows.append(bytes((line[x] << 4) | line[x + 1] for x in range(0, len(line), 2)))
+    return rows
+
+
+def convert(src, dst, fmt, fit, dither, compress):
+    img = Image.open(src)
+    img.thumbnail(fit, Image.Resampling.LANCZOS)
+    rows = rgb332_rows(img) if fmt == 'rgb332' else gray4_rows(img, dither)
+    raw = sum(len(r) for r in rows)
+    data = b''.join(packbits(r) for r in rows) if compress else b''.join(rows)
+    with open(dst, 'wb') as f:
+        f.write(HEADER.pack(b'EPI', VERSION, img.size[0], img.size[1], FORMATS[fmt], 1 if compress else 0, 0,
+                            len(data)))
+        f.write(data)
+    return img.size, raw, len(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('images', nargs='+', help='images Pillow opens')
+    parser.add_argument('-o', '--out-dir', default='.', help='where the .EPI files go')
+    parser.add_argument('--format', choices=FORMATS, default='rgb332', help='pixels of the panel')
+    parser.add_argument('--fit', default='960x540', help='largest WxH, the display of the explorer')
+    parser.add_argument('--dither', action='store_true', help='Floyd-Steinberg to the 16 gray levels')
+    parser.add_argument('--no-rle', action='store_true', help='store the rows as they are')
+    args = parser.parse_args()
+
+    fit = tuple(int(v) for v in args.fit.lower().split('x'))
+    if len(fit) != 2:
+        sys.exit('--fit is WxH')
+    for src in args.images:
+        name = os.path.splitext(os.path.basename(src))[0]
+        dst = os.path.join(args.out_dir, name + '.EPI')
+        (w, h), raw, packed = convert(src, dst, args.format, fit, args.dither, not args.no_rle)
+        print('%-24s %4d x %-4d %8d -> %8d bytes' % (dst, w, h, raw, packed))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+"""Pick the functions the performance build runs from IRAM, and compare frame times.
+
+place reads the profile of the profile build (components/perf_iram) from its console log, the
+"PIRAM1 profile" block, and the link map of that build. It writes the linker fragment that
+puts the functions with the most cycles in IRAM: at most --top of them, in --budget bytes of
+code and literals. Both default to CONFIG_PERF_IRAM_TOP_N and CONFIG_PERF_IRAM_BUDGET of the
+sdkconfig. A function that does not fit is skipped for the next one. Functions already in
+IRAM or in ROM are not in the flash text of the map and are left out.
+
+    python scripts/iram_placement.py place profile.log build-profile/lvgl-demo.map \\
+        --sdkconfig build-profile/sdkconfig -o components/perf_iram/perf_iram.lf
+
+compare reads the "PIRAM1 frames" lines of two console logs, before and after, and prints
+the frame times of both. --skip drops the first reports of each log, taken while warming up.
+
+    python scripts/iram_placement.py compare before.log after.log
+"""
+import argparse
+import bisect
+import os
+import re
+import sys
+
+LINE = 'PIRAM1 '
+PROFILE = re.compile(r'PIRAM1 profile (\d+) functions (\d+) dropped (\d+) ms (\d+) MHz (\d+) cycles')
+FN = re.compile(r'PIRAM1 fn ([0-9a-fA-F]+) (\d+) (\d+)')
+FRAMES = re.compile(r'PIRAM1 frames (\d+) avg (\d+) min (\d+) max (\d+) us in (\d+) ms')
+# " .text.name  0xaddr  0xsize  path/libx.a(obj.c.obj)", the name alone on its line when long
+SECTION = re.compile(r'^ \.(text|literal)\.(\S+)(?:\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S.*))?$')
+PLACE = re.compile(r'^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S.*)$')
+MEMBER = re.compile(r'([^/\\(]+\.a)\((.+)\)$')
+FLASH_TEXT = '.flash.text'
+DEFAULT_BUDGET = 16384
+DEFAULT_TOP = 48
+
+
+def read_lines(path):
+    with open(path, 'rb') as f:
+        return f.read().decode('utf-8', 'replace').splitlines()
+
+
+def load_profile(path):
+    """The last profile block: header, and (address, calls, cycles) the hottest first"""
+    header, fns = None, []
+    for l in read_lines(path):
+        if LINE not in l:
+            continue
+        m = PROFILE.search(l)
+        if m:
+            header, fns = [int(v) for v in m.groups()], []
+            continue
+        m = FN.search(l)
+        if m and header:
+            fns.append((int(m.group(1), 16), int(m.group(2)), int(m.group(3))))
+    if header is None:
+        sys.exit('%s: no PIRAM1 profile, was it the profile build?' % path)
+    keys = ('functions', 'dropped', 'ms', 'mhz', 'cycles')
+    return dict(zip(keys, header)), sorted(fns, key=lambda f: -f[2])
+
+
+def load_map(path):
+    """Functions of the flash text: {(archive, object, symbol): [address, text bytes, literal bytes]}"""
+    funcs = {}
+    out, pending = None, None
+    for l in read_lines(path):
+        if l and not l[0].isspace():
+            out, pending = l.split()[0], None
+            continue
+        if out != FLASH_TEXT:
+            continue
+        m = SECTION.match(l)
+        if m:
+            kind, sym, addr, size, member = m.groups()
+            if addr is None:
+                pending = (kind, sym)
+                continue
+        elif pending:
+            m = PLACE.match(l)
+            (kind, sym), pending = pending, None
+            if not m:
+                continue
+            addr, size, member = m.groups()
+        else:
+            continue
+        a = MEMBER.search(member.strip())
+        if not a or int(size, 16) == 0:
+            continue
+        key = (a.group(1), a.group(2), sym)
+        f = funcs.setdefault(key, [0, 0, 0])
+        if kind == 'text':
+            f[0], f[1] = int(addr, 16), int(size, 16)
+        else:
+            f[2] = int(size, 16)
+    if not funcs:
+        sys.exit('%s: no %s input sections, is it the link map of the build?' % (path, FLASH_TEXT))
+    return funcs
+
+
+def read_sdkconfig(path):
+    values = {}
+    if path and os.path.exists(path):
+        for l in read_lines(path):
+            m = re.match(r'(CONFIG_PERF_IRAM_\w+)=(\d+)$', l.strip())
+            if m:
+                values[m.group(1)] = int(m.group(2))
+    return values
+
+
+def object_name(obj):
+    # ldgen names an object without its extensions: lv_obj.c.obj is lv_obj
+    return re.sub(r'(\.(c|cpp|cc|S))?\.(obj|o)$', '', obj)
+
+
+def align4(n):
+    return (n + 3) & ~3
+
+
+def place(args):
+    header, fns = load_profile(args.profile)
+    funcs = load_map(args.map)
+    config = read_sdkconfig(args.sdkconfig)
+    budget = args.budget if args.budget is not None else config.get('CONFIG_PERF_IRAM_BUDGET', DEFAULT_BUDGET)
+    top = args.top if args.top is not None else config.get('CONFIG_PERF_IRAM_TOP_N', DEFAULT_TOP)
+
+    text = sorted((f[0], f[1], key) for key, f in funcs.items() if f[1])
+    starts = [t[0] for t in text]
+    total = header['cycles'] or 1
+    placed, used, cycles, outside, too_big = [], 0, 0, 0, 0
+    for addr, calls, fn_cycles in fns:
+        if len(placed) >= top:
+            break
+        i = bisect.bisect_right(starts, addr) - 1
+        if i < 0 or addr >= text[i][0] + text[i][1]:
+            outside += 1
+            continue
+        key = text[i][2]
+        size = align4(funcs[key][1]) + align4(funcs[key][2])
+        if used + size > budget:
+            too_big += 1
+            continue
+        placed.append((key, calls, fn_cycles, size))
+        used += size
+        cycles += fn_cycles
+
+    print('%4s %7s %10s %6s  %s' % ('#', 'cycles', 'calls', 'bytes', 'function'))
+    for n, (key, calls, fn_cycles, size) in enumerate(placed, 1):
+        print('%4d %6.2f%% %10d %6d  %s %s' % (n, 100.0 * fn_cycles / total, calls, size, key[0], key[2]))
+    summary = '%d functions, %d of %d bytes, %.1f %% of the profiled cycles' % (len(placed), used, budget,
+                                                                                 100.0 * cycles / total)
+    print(summary)
+    print('left out: %d hot functions not in the flash text, %d over the budget' % (outside, too_big))
+    if header['dropped']:
+        print('the profile table was full, %d functions were not counted' % header['dropped'])
+
+    archives = {}
+    for key, _, _, _ in placed:
+        archives.setdefault(key[0], []).append(key)
+    with open(args.output, 'w') as f:
+        f.write('# Made by scripts/iram_placement.py from %s and %s, do not edit\n'
+                % (os.path.basename(args.profile), os.path.basename(args.map)))
+        f.write('# %s\n' % summary)
+        for archive in sorted(archives):
+            f.write('\n[mapping:perf_iram_%s]\n' % re.sub(r'\W', '_', archive[:-2]))
+            f.write('archive: %s\n' % archive)
+            f.write('entries:\n')
+            for _, obj, sym in archives[archive]:
+                f.write('    %s:%s (noflash)\n' % (object_name(obj), sym))
+    print('wrote %s' % args.output)
+
+
+def load_frames(path, skip):
+    reports = [[int(v) for v in m.groups()] for m in (FRAMES.search(l) for l in read_lines(path)) if m][skip:]
+    if not reports:
+        sys.exit('%s: no PIRAM1 frames line, is CONFIG_PERF_IRAM_FRAME_STATS on?' % path)
+    count = sum(r[0] for r in reports)
+    ms = sum(r[4] for r in reports)
+    return {'frames': count,
+            'avg us': sum(r[0] * r[1] for r in reports) // count,
+            'min us': min(r[2] for r in reports),
+            'max us': max(r[3] for r in reports),
+            'frames/s': 1000.0 * count / ms if ms else 0.0}
+
+
+def compare(args):
+    before, after = load_frames(args.before, args.skip), load_frames(args.after, args.skip)
+    print('%-10s %12s %12s %9s' % ('', 'before', 'after', 'change'))
+    for k in before:
+        b, a = before[k], after[k]
+        change = '%+8.1f%%' % (100.0 * (a - b) / b) if b and k != 'frames' else ''
+        fmt = '%-10s %12.1f %12.1f %9s' if isinstance(b, float) else '%-10s %12d %12d %9s'
+        print(fmt % (k, b, a, change))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n', 1)[0])
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    p = sub.add_parser('place', help='write the linker fragment from a profile and a link map')
+    p.add_argument('profile', help='console log of the profile build')
+    p.add_argument('map', help='link map of the profile build')
+    p.add_argument('-o', '--output', default='components/perf_iram/perf_iram.lf')
+    p.add_argument('--sdkconfig', default='sdkconfig', help='for the budget and the count')
+    p.add_argument('--budget', type=int, help='bytes of IRAM')
+    p.add_argument('--top', type=int, help='most functions')
+    c = sub.add_parser('compare', help='frame times of two console logs')
+    c.add_argument('before')
+    c.add_argument('after')
+    c.add_argument('--skip', type=int, default=0, help='first reports of each log to drop')
+    args = parser.parse_args()
+    if args.cmd == 'place':
+        place(args)
+    else:
+        compare(args)
+
+
+if __name__ == '__main__':
+    main()
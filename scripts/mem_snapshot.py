@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""Show and diff the memory snapshots of the mem_telemetry component.
+
+A snapshot is what mem_tel_snapshot() packs, little endian:
+
+    header  u32 magic "MTEL", u16 version 1, u16 tag count, u16 stack count, u16 reserved,
+            u32 uptime ms, char app version[32], u8 ELF SHA-256[8],
+            u32 internal free, min free, largest block, u32 PSRAM free, min free, largest block,
+            u32 LVGL heap total, used, max used
+    tags    char name[12], u32 heap internal, heap PSRAM, LVGL internal, LVGL PSRAM, peak,
+            allocs, failed
+    stacks  char name[16], u32 lowest free bytes
+
+It is read from a file of mem_tel_write_snapshot(), or from a console log: the last
+"MTEL1 <hex>" line of mem_tel_print_snapshot().
+
+    python scripts/mem_snapshot.py show monitor.log
+    python scripts/mem_snapshot.py diff old.log new.log --max-growth 4096
+
+diff exits with 1 when a tag peak grew, or a stack lost, more than --max-growth bytes.
+"""
+import argparse
+import struct
+import sys
+
+HEADER = struct.Struct('<IHHHHI32s8s9I')
+TAG = struct.Struct('<12s7I')
+STACK = struct.Struct('<16sI')
+MAGIC = 0x4C45544D
+VERSION = 1
+LINE = 'MTEL1 '
+COUNTERS = ('heap_internal', 'heap_psram', 'lvgl_internal', 'lvgl_psram', 'peak', 'allocs', 'failed')
+HEAPS = ('internal_free', 'internal_min_free', 'internal_largest', 'psram_free', 'psram_min_free',
+         'psram_largest', 'lvgl_total', 'lvgl_used', 'lvgl_max_used')
+
+
+def cstr(b):
+    return b.split(b'\0', 1)[0].decode('ascii', 'replace')
+
+
+def load(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:4] != struct.pack('<I', MAGIC):
+        # A log: the snapshot is the hex after the last marker
+        lines = [l for l in data.decode('utf-8', 'replace').splitlines() if LINE in l]
+        if not lines:
+            sys.exit('%s: no snapshot and no %s line' % (path, LINE.strip()))
+        data = bytes.fromhex(lines[-1].split(LINE, 1)[1].strip())
+    return parse(path, data)
+
+
+def parse(path, data):
+    if len(data) < HEADER.size:
+        sys.exit('%s: %d bytes, shorter than the header' % (path, len(data)))
+    h = HEADER.unpack_from(data)
+    magic, version, tag_count, stack_count, _, uptime, app, sha = h[:8]
+    if magic != MAGIC or version != VERSION:
+        sys.exit('%s: not a version %d snapshot' % (path, VERSION))
+    if len(data) < HEADER.size + tag_count * TAG.size + stack_count * STACK.size:
+        sys.exit('%s: truncated' % path)
+    snap = {'uptime_ms': uptime, 'app': cstr(app), 'sha': sha.hex(), 'heaps': dict(zip(HEAPS, h[8:])),
+            'tags': {}, 'stacks': {}}
+    off = HEADER.size
+    for _ in range(tag_count):
+        t = TAG.unpack_from(data, off)
+        snap['tags'][cstr(t[0])] = dict(zip(COUNTERS, t[1:]))
+        off += TAG.size
+    for _ in range(stack_count):
+        name, free = STACK.unpack_from(data, off)
+        snap['stacks'][cstr(name)] = free
+        off += STACK.size
+    return snap
+
+
+def show(snap):
+    print('%s (%s), %.1f s up' % (snap['app'], snap['sha'], snap['uptime_ms'] / 1000))
+    for k, v in snap['heaps'].items():
+        print('  %-18s %9d' % (k, v))
+    print('%-10s' % 'tag' + ''.join('%14s' % c for c in COUNTERS))
+    for name, c in snap['tags'].items():
+        print('%-10s' % name + ''.join('%14d' % c[k] for k in COUNTERS))
+    print('%-16s %9s' % ('stack', 'min free'))
+    for name, free in sorted(snap['stacks'].items(), key=lambda s: s[1]):
+        print('%-16s %9d' % (name, free))
+
+
+def diff(a, b, max_growth):
+    """Prints B - A, returns the lines over max_growth"""
+    over = []
+    print('%s (%s) -> %s (%s)' % (a['app'], a['sha'], b['app'], b['sha']))
+    for k in HEAPS:
+        print('  %-18s %9d %9d %+9d' % (k, a['heaps'][k], b['heaps'][k], b['heaps'][k] - a['heaps'][k]))
+    print('%-10s %9s %9s %9s' % ('tag peak', 'A', 'B', 'B - A'))
+    for name in list(a['tags']) + [n for n in b['tags'] if n not in a['tags']]:
+        pa = a['tags'].get(name, {}).get('peak', 0)
+        pb = b['tags'].get(name, {}).get('peak', 0)
+        mark = ''
+        if max_growth is not None and pb - pa > max_growth:
+            mark = ' !'
+            over.append('tag %s +%d' % (name, pb - pa))
+        print('%-10s %9d %9d %+9d%s' % (name, pa, pb, pb - pa, mark))
+    print('%-16s %9s %9s %9s' % ('stack min free', 'A', 'B', 'B - A'))
+    for name in sorted(set(a['stacks']) | set(b['stacks'])):
+        fa = a['stacks'].get(name)
+        fb = b['stacks'].get(name)
+        if fa is None or fb is None:
+            print('%-16s %9s %9s' % (name, '-' if fa is None else fa, '-' if fb is None else fb))
+            continue
+        mark = ''
+        if max_growth is not None and fa - fb > max_growth:
+            mark = ' !'
+            over.append('stack %s %d' % (name, fb - fa))
+        print('%-16s %9d %9d %+9d%s' % (name, fa, fb, fb - fa, mark))
+    return over
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    p = sub.add_parser('show', help='print a snapshot')
+    p.add_argument('snapshot', help='.bin of mem_tel_write_snapshot() or a console log')
+    p = sub.add_parser('diff', help='print B - A')
+    p.add_argument('a', help='snapshot of the old build')
+    p.add_argument('b', help='snapshot of the new build')
+    p.add_argument('--max-growth', type=int, help='exit 1 when a tag peak or a stack grew more bytes')
+    args = parser.parse_args()
+
+    if args.cmd == 'show':
+        show(load(args.snapshot))
+        return
+    over = diff(load(args.a), load(args.b), args.max_growth)
+    if over:
+        sys.exit('Over %d bytes: %s' % (args.max_growth, ', '.join(over)))
+
+
+if __name__ == '__main__':
+    main()
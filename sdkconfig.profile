@@ -0,0 +1,7 @@
+# Profile build for components/perf_iram: the performance build with the GUI task profiled, to
+# make perf_iram.lf. The instrumented calls are slow, its frame times are not the ones to compare.
+#   idf.py -B build-profile -D SDKCONFIG=build-profile/sdkconfig -D SDKCONFIG_DEFAULTS="sdkconfig;sdkconfig.perf;sdkconfig.profile" build
+CONFIG_PERF_IRAM_PROFILE=y
+CONFIG_PERF_IRAM_PROFILE_COMPONENTS="lvgl main"
+CONFIG_PERF_IRAM_PROFILE_S=60
+# CONFIG_PERF_IRAM_PLACE is not set